@@ -38,7 +38,6 @@
 #include "gnc-engine.h"
 #include "gnc-event.h"
 #include "gnc-gobject-utils.h"
-#include "gnc-ui-balances.h"
 #include "gnc-ui-util.h"
 
 #define TREE_MODEL_ACCOUNT_CM_CLASS "tree-model-account"
@@ -90,13 +89,28 @@ static void gnc_tree_model_account_event_handler (QofInstance *entity,
         GncTreeModelAccount *model,
         GncEventData *ed);
 
+static void gnc_tree_model_account_price_event_handler (QofInstance *entity,
+        QofEventId event_type,
+        GncTreeModelAccount *model,
+        gpointer event_data);
+
 /** The instance private data for an account tree model. */
 typedef struct GncTreeModelAccountPrivate
 {
     QofBook *book;
     Account *root;
     gint event_handler_id;
+    gint price_handler_id;
     const gchar *negative_color;
+
+    /* Balance cache: a BalanceCacheEntry per account, and what the
+     * cached values were worked out for. */
+    GHashTable *balances;
+    const gnc_commodity *balance_report_commodity;
+    time64 balance_day_end;
+    time64 period_start;
+    time64 period_end;
+    gboolean period_known;
 } GncTreeModelAccountPrivate;
 
 #define GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(o)  \
@@ -137,6 +151,435 @@ gnc_tree_model_account_update_color (gpointer gsettings, gchar *key, gpointer us
     use_red = gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED);
     priv->negative_color = use_red ? get_negative_color () : NULL;
 }
+
+/************************************************************/
+/*             Account Tree Model - Balance Cache           */
+/************************************************************/
+
+/* Drawing a balance column used to convert and sum the balances of
+ * all of an account's descendants for every cell.  Instead the model
+ * keeps each account's own balances and the totals of its subtree by
+ * commodity, worked out bottom-up from the leaves, along with the
+ * strings shown.  Engine events drop an account and its ancestors;
+ * price events and a change of report currency only drop the strings,
+ * which are the only converted values. */
+
+typedef enum
+{
+    BALANCE_PRESENT,
+    BALANCE_BALANCE,
+    BALANCE_CLEARED,
+    BALANCE_RECONCILED,
+    BALANCE_FUTURE_MIN,
+    /* These two are computed together and must stay in this order. */
+    BALANCE_PERIOD_START,
+    BALANCE_PERIOD_END,
+    NUM_BALANCES
+} BalanceKind;
+
+/* The balance columns, each in the account's commodity or in the
+ * report currency. */
+typedef enum
+{
+    BALANCE_COL_PRESENT,
+    BALANCE_COL_BALANCE,
+    BALANCE_COL_PERIOD,
+    BALANCE_COL_CLEARED,
+    BALANCE_COL_RECONCILED,
+    BALANCE_COL_FUTURE_MIN,
+    BALANCE_COL_TOTAL,
+    BALANCE_COL_TOTAL_PERIOD,
+    NUM_BALANCE_COLS
+} BalanceColumn;
+
+static const struct
+{
+    BalanceKind kind;
+    gboolean recurse;
+} balance_columns[NUM_BALANCE_COLS] =
+{
+    { BALANCE_PRESENT,    TRUE  },
+    { BALANCE_BALANCE,    FALSE },
+    { BALANCE_PERIOD_END, FALSE },
+    { BALANCE_CLEARED,    TRUE  },
+    { BALANCE_RECONCILED, TRUE  },
+    { BALANCE_FUTURE_MIN, TRUE  },
+    { BALANCE_BALANCE,    TRUE  },
+    { BALANCE_PERIOD_END, TRUE  },
+};
+
+typedef struct
+{
+    const gnc_commodity *commodity;
+    gnc_numeric amount;
+} CommodityAmount;
+
+typedef struct
+{
+    /* A bit per BalanceKind. */
+    guint own_known;
+    guint totals_known;
+    gnc_numeric own[NUM_BALANCES];
+    /* CommodityAmounts summing the account and its descendants; the
+     * account's own commodity comes first. */
+    GArray *totals[NUM_BALANCES];
+    /* Indexed by column, then by whether it is in the report currency. */
+    gchar *strings[NUM_BALANCE_COLS][2];
+    gboolean negative[NUM_BALANCE_COLS][2];
+} BalanceCacheEntry;
+
+static void
+balance_cache_entry_clear_strings (BalanceCacheEntry *entry)
+{
+    int col, report;
+
+    for (col = 0; col < NUM_BALANCE_COLS; col++)
+        for (report = 0; report < 2; report++)
+        {
+            g_free (entry->strings[col][report]);
+            entry->strings[col][report] = NULL;
+        }
+}
+
+static void
+balance_cache_entry_free (gpointer data)
+{
+    BalanceCacheEntry *entry = data;
+    int kind;
+
+    for (kind = 0; kind < NUM_BALANCES; kind++)
+        if (entry->totals[kind])
+            g_array_free (entry->totals[kind], TRUE);
+    balance_cache_entry_clear_strings (entry);
+    g_free (entry);
+}
+
+/** Forget cached balances.  With strings_only set the engine balances
+ *  are kept and only the converted and formatted values are dropped.
+ *
+ *  @internal
+ */
+static void
+gnc_tree_model_account_clear_balances (GncTreeModelAccount *model,
+                                       gboolean strings_only)
+{
+    GncTreeModelAccountPrivate *priv;
+    GHashTableIter iter;
+    gpointer entry;
+
+    priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    if (!strings_only)
+    {
+        g_hash_table_remove_all (priv->balances);
+        priv->period_known = FALSE;
+        return;
+    }
+
+    g_hash_table_iter_init (&iter, priv->balances);
+    while (g_hash_table_iter_next (&iter, NULL, &entry))
+        balance_cache_entry_clear_strings (entry);
+}
+
+/** Forget the cached balances of an account and of all its
+ *  ancestors, whose totals include it.  An ancestor only has totals
+ *  if all its descendants have entries, so the walk can stop at the
+ *  first account without one.
+ *
+ *  @internal
+ */
+static void
+gnc_tree_model_account_forget_balances (GncTreeModelAccount *model,
+                                        Account *account)
+{
+    GncTreeModelAccountPrivate *priv;
+
+    priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    for (; account; account = gnc_account_get_parent (account))
+        if (!g_hash_table_remove (priv->balances, account))
+            break;
+}
+
+/* The accounting period preferences changed. */
+static void
+gnc_tree_model_account_period_changed (gpointer prefs, gchar *pref,
+                                       gpointer user_data)
+{
+    gnc_tree_model_account_clear_balances (user_data, FALSE);
+}
+
+/* The cached strings have the sign of the reversed-balance setting. */
+static void
+gnc_tree_model_account_reverse_changed (gpointer prefs, gchar *pref,
+                                        gpointer user_data)
+{
+    gnc_tree_model_account_clear_balances (user_data, TRUE);
+}
+
+static BalanceCacheEntry *
+gnc_tree_model_account_get_balance_entry (GncTreeModelAccountPrivate *priv,
+                                          Account *account)
+{
+    BalanceCacheEntry *entry = g_hash_table_lookup (priv->balances, account);
+
+    if (!entry)
+    {
+        entry = g_new0 (BalanceCacheEntry, 1);
+        g_hash_table_insert (priv->balances, account, entry);
+    }
+    return entry;
+}
+
+static void
+gnc_tree_model_account_fill_own_balance (GncTreeModelAccountPrivate *priv,
+                                         Account *account,
+                                         BalanceCacheEntry *entry,
+                                         BalanceKind kind)
+{
+    if (entry->own_known & (1 << kind))
+        return;
+
+    switch (kind)
+    {
+    case BALANCE_PRESENT:
+        entry->own[kind] = xaccAccountGetPresentBalance (account);
+        break;
+    case BALANCE_BALANCE:
+        entry->own[kind] = xaccAccountGetBalance (account);
+        break;
+    case BALANCE_CLEARED:
+        entry->own[kind] = xaccAccountGetClearedBalance (account);
+        break;
+    case BALANCE_RECONCILED:
+        entry->own[kind] = xaccAccountGetReconciledBalance (account);
+        break;
+    case BALANCE_FUTURE_MIN:
+        entry->own[kind] = xaccAccountGetProjectedMinimumBalance (account);
+        break;
+    case BALANCE_PERIOD_START:
+    case BALANCE_PERIOD_END:
+    {
+        time64 dates[2] = { priv->period_start, priv->period_end };
+
+        xaccAccountGetBalancesAsOfDates (account, dates, 2,
+                                         &entry->own[BALANCE_PERIOD_START]);
+        entry->own_known |= 1 << BALANCE_PERIOD_START;
+        entry->own_known |= 1 << BALANCE_PERIOD_END;
+        return;
+    }
+    default:
+        g_assert_not_reached ();
+        break;
+    }
+    entry->own_known |= 1 << kind;
+}
+
+static void
+add_commodity_amount (GArray *totals, const gnc_commodity *commodity,
+                      gnc_numeric amount)
+{
+    CommodityAmount ca;
+    guint i;
+
+    for (i = 0; i < totals->len; i++)
+    {
+        CommodityAmount *total = &g_array_index (totals, CommodityAmount, i);
+
+        if (total->commodity == commodity)
+        {
+            total->amount = gnc_numeric_add (total->amount, amount,
+                                             GNC_DENOM_AUTO,
+                                             GNC_HOW_DENOM_LCD);
+            return;
+        }
+    }
+
+    ca.commodity = commodity;
+    ca.amount = amount;
+    g_array_append_val (totals, ca);
+}
+
+/** Make sure the account has its subtree totals of the given kind,
+ *  filling in those of its descendants first.
+ *
+ *  @internal
+ */
+static BalanceCacheEntry *
+gnc_tree_model_account_fill_totals (GncTreeModelAccountPrivate *priv,
+                                    Account *account, BalanceKind kind)
+{
+    BalanceCacheEntry *entry;
+    const gnc_commodity *commodity;
+    GList *children, *node;
+    GArray *totals;
+
+    entry = gnc_tree_model_account_get_balance_entry (priv, account);
+    if (entry->totals_known & (1 << kind))
+        return entry;
+
+    gnc_tree_model_account_fill_own_balance (priv, account, entry, kind);
+
+    totals = g_array_new (FALSE, FALSE, sizeof (CommodityAmount));
+    commodity = xaccAccountGetCommodity (account);
+    if (commodity)
+        add_commodity_amount (totals, commodity, entry->own[kind]);
+
+    children = gnc_account_get_children (account);
+    for (node = children; node; node = node->next)
+    {
+        BalanceCacheEntry *child;
+        guint i;
+
+        child = gnc_tree_model_account_fill_totals (priv, node->data, kind);
+        for (i = 0; i < child->totals[kind]->len; i++)
+        {
+            CommodityAmount *ca = &g_array_index (child->totals[kind],
+                                                  CommodityAmount, i);
+            add_commodity_amount (totals, ca->commodity, ca->amount);
+        }
+    }
+    g_list_free (children);
+
+    if (entry->totals[kind])
+        g_array_free (entry->totals[kind], TRUE);
+    entry->totals[kind] = totals;
+    entry->totals_known |= 1 << kind;
+    return entry;
+}
+
+/** An account's balance in a currency, made from the cached balances.
+ *  A NULL currency means the account's commodity.  An account's own
+ *  balance is the value xaccAccountGet*BalanceInCurrency returns.  With
+ *  recurse set, the subtree's total in each commodity is converted
+ *  rather than each account's balance, so the result can differ from
+ *  theirs by rounding.
+ *
+ *  @internal
+ */
+static gnc_numeric
+gnc_tree_model_account_balance_in (GncTreeModelAccountPrivate *priv,
+                                   Account *account, BalanceKind kind,
+                                   gboolean recurse,
+                                   const gnc_commodity *currency)
+{
+    BalanceCacheEntry *entry;
+    gnc_numeric balance = gnc_numeric_zero ();
+    guint i;
+
+    if (!currency)
+        currency = xaccAccountGetCommodity (account);
+    if (!currency)
+        return balance;
+
+    if (!recurse)
+    {
+        entry = gnc_tree_model_account_get_balance_entry (priv, account);
+        gnc_tree_model_account_fill_own_balance (priv, account, entry, kind);
+        return xaccAccountConvertBalanceToCurrency (account, entry->own[kind],
+                xaccAccountGetCommodity (account), currency);
+    }
+
+    /* Each commodity's total is converted once, rather than each
+     * account's balance. */
+    entry = gnc_tree_model_account_fill_totals (priv, account, kind);
+    for (i = 0; i < entry->totals[kind]->len; i++)
+    {
+        CommodityAmount *ca = &g_array_index (entry->totals[kind],
+                                              CommodityAmount, i);
+        gnc_numeric amount;
+
+        amount = xaccAccountConvertBalanceToCurrency (account, ca->amount,
+                 ca->commodity, currency);
+        if (i == 0)
+            balance = amount;
+        else
+            balance = gnc_numeric_add (balance, amount,
+                                       gnc_commodity_get_fraction (currency),
+                                       GNC_HOW_RND_ROUND_HALF_UP);
+    }
+    return balance;
+}
+
+/** Return the string to show in a balance column, which belongs to
+ *  the cache.
+ *
+ *  @internal
+ */
+static const gchar *
+gnc_tree_model_account_get_balance (GncTreeModelAccount *model,
+                                    Account *account, BalanceColumn col,
+                                    gboolean report, gboolean *negative)
+{
+    GncTreeModelAccountPrivate *priv;
+    BalanceCacheEntry *entry;
+    const gnc_commodity *report_commodity;
+    GNCPrintAmountInfo print_info;
+    BalanceKind kind = balance_columns[col].kind;
+    gboolean recurse = balance_columns[col].recurse;
+    gnc_numeric balance;
+
+    priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+
+    /* Present and future balances depend on the day. */
+    if (gnc_time (NULL) > priv->balance_day_end)
+    {
+        gnc_tree_model_account_clear_balances (model, FALSE);
+        priv->balance_day_end = gnc_time64_get_today_end ();
+    }
+    report_commodity = gnc_default_report_currency ();
+    if (report_commodity != priv->balance_report_commodity)
+    {
+        gnc_tree_model_account_clear_balances (model, TRUE);
+        priv->balance_report_commodity = report_commodity;
+    }
+
+    entry = gnc_tree_model_account_get_balance_entry (priv, account);
+    if (entry->strings[col][report])
+    {
+        *negative = entry->negative[col][report];
+        return entry->strings[col][report];
+    }
+
+    if (kind == BALANCE_PERIOD_END)
+    {
+        if (!priv->period_known)
+        {
+            priv->period_start = gnc_accounting_period_fiscal_start ();
+            priv->period_end = gnc_accounting_period_fiscal_end ();
+            priv->period_known = TRUE;
+        }
+        if (account == priv->root || priv->period_start > priv->period_end)
+        {
+            entry->negative[col][report] = FALSE;
+            entry->strings[col][report] = g_strdup ("");
+            *negative = FALSE;
+            return entry->strings[col][report];
+        }
+        balance = gnc_numeric_sub (
+                      gnc_tree_model_account_balance_in (priv, account,
+                              BALANCE_PERIOD_END, recurse, NULL),
+                      gnc_tree_model_account_balance_in (priv, account,
+                              BALANCE_PERIOD_START, recurse, NULL),
+                      GNC_DENOM_AUTO, GNC_HOW_DENOM_FIXED);
+    }
+    else
+        balance = gnc_tree_model_account_balance_in (priv, account, kind,
+                  recurse, report ? report_commodity : NULL);
+
+    if (gnc_reverse_balance (account))
+        balance = gnc_numeric_neg (balance);
+
+    if (report)
+        print_info = gnc_commodity_print_info (report_commodity, TRUE);
+    else
+        print_info = gnc_account_print_info (account, TRUE);
+
+    entry->negative[col][report] = gnc_numeric_negative_p (balance);
+    entry->strings[col][report] = g_strdup (xaccPrintAmount (balance,
+                                            print_info));
+    *negative = entry->negative[col][report];
+    return entry->strings[col][report];
+}
+
 /************************************************************/
 /*               g_object required functions                */
 /************************************************************/
@@ -217,10 +660,21 @@ gnc_tree_model_account_init (GncTreeModelAccount *model)
     priv->book = NULL;
     priv->root = NULL;
     priv->negative_color = red ? get_negative_color () : NULL;
+    priv->balances = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                            NULL, balance_cache_entry_free);
 
     gnc_prefs_register_cb(GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED,
                           gnc_tree_model_account_update_color,
                           model);
+    gnc_prefs_register_group_cb (GNC_PREFS_GROUP_ACCT_SUMMARY,
+                                 gnc_tree_model_account_period_changed,
+                                 model);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_REVERSED_ACCTS_NONE,
+                           gnc_tree_model_account_reverse_changed, model);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_REVERSED_ACCTS_CREDIT,
+                           gnc_tree_model_account_reverse_changed, model);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_REVERSED_ACCTS_INC_EXP,
+                           gnc_tree_model_account_reverse_changed, model);
 
     LEAVE(" ");
 }
@@ -240,6 +694,8 @@ gnc_tree_model_account_finalize (GObject *object)
     priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
 
     priv->book = NULL;
+    g_hash_table_destroy (priv->balances);
+    priv->balances = NULL;
 
     if (G_OBJECT_CLASS (parent_class)->finalize)
         G_OBJECT_CLASS(parent_class)->finalize (object);
@@ -265,10 +721,27 @@ gnc_tree_model_account_dispose (GObject *object)
         qof_event_unregister_handler (priv->event_handler_id);
         priv->event_handler_id = 0;
     }
+    if (priv->price_handler_id)
+    {
+        qof_event_unregister_handler (priv->price_handler_id);
+        priv->price_handler_id = 0;
+    }
 
     gnc_prefs_remove_cb_by_func(GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED,
                                 gnc_tree_model_account_update_color,
                                 model);
+    gnc_prefs_remove_group_cb_by_func (GNC_PREFS_GROUP_ACCT_SUMMARY,
+                                       gnc_tree_model_account_period_changed,
+                                       model);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL,
+                                 GNC_PREF_REVERSED_ACCTS_NONE,
+                                 gnc_tree_model_account_reverse_changed, model);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL,
+                                 GNC_PREF_REVERSED_ACCTS_CREDIT,
+                                 gnc_tree_model_account_reverse_changed, model);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL,
+                                 GNC_PREF_REVERSED_ACCTS_INC_EXP,
+                                 gnc_tree_model_account_reverse_changed, model);
 
     if (G_OBJECT_CLASS (parent_class)->dispose)
         G_OBJECT_CLASS (parent_class)->dispose (object);
@@ -308,8 +781,13 @@ gnc_tree_model_account_new (Account *root)
     priv->book = gnc_get_current_book();
     priv->root = root;
 
-    priv->event_handler_id = qof_event_register_handler
-                             ((QofEventHandler)gnc_tree_model_account_event_handler, model);
+    priv->event_handler_id = qof_event_register_filtered_handler
+                             ((QofEventHandler)gnc_tree_model_account_event_handler, model,
+                              GNC_ID_ACCOUNT, ~QOF_EVENT_NONE);
+    priv->price_handler_id = qof_event_register_filtered_handler
+                             ((QofEventHandler)gnc_tree_model_account_price_event_handler, model,
+                              GNC_ID_PRICE, QOF_EVENT_ADD | QOF_EVENT_REMOVE |
+                              QOF_EVENT_MODIFY | QOF_EVENT_DESTROY);
 
     LEAVE("model %p", model);
     return GTK_TREE_MODEL (model);
@@ -564,39 +1042,6 @@ gnc_tree_model_account_set_color(GncTreeModelAccount *model,
         g_value_set_static_string (value, NULL);
 }
 
-static gchar *
-gnc_tree_model_account_compute_period_balance(GncTreeModelAccount *model,
-        Account *acct,
-        gboolean recurse,
-        gboolean *negative)
-{
-    GncTreeModelAccountPrivate *priv;
-    time64 t1, t2;
-    gnc_numeric b3;
-
-    if ( negative )
-        *negative = FALSE;
-
-    priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
-    if (acct == priv->root)
-        return g_strdup("");
-
-    t1 = gnc_accounting_period_fiscal_start();
-    t2 = gnc_accounting_period_fiscal_end();
-
-    if (t1 > t2)
-        return g_strdup("");
-
-    b3 = xaccAccountGetBalanceChangeForPeriod(acct, t1, t2, recurse);
-    if (gnc_reverse_balance (acct))
-        b3 = gnc_numeric_neg (b3);
-
-    if (negative)
-        *negative = gnc_numeric_negative_p(b3);
-
-    return g_strdup(xaccPrintAmount(b3, gnc_account_print_info(acct, TRUE)));
-}
-
 static void
 gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
                                   GtkTreeIter *iter,
@@ -607,7 +1052,7 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
     GncTreeModelAccountPrivate *priv;
     Account *account;
     gboolean negative; /* used to set "deficit style" also known as red numbers */
-    gchar *string;
+    const gchar *string;
     time64 last_date;
 
     g_return_if_fail (GNC_IS_TREE_MODEL_ACCOUNT (model));
@@ -651,86 +1096,84 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
 
     case GNC_TREE_MODEL_ACCOUNT_COL_PRESENT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetPresentBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        string = gnc_tree_model_account_get_balance (model, account,
+                 BALANCE_COL_PRESENT, FALSE, &negative);
+        g_value_set_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_PRESENT_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance(xaccAccountGetPresentBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        string = gnc_tree_model_account_get_balance (model, account,
+                 BALANCE_COL_PRESENT, TRUE, &negative);
+        g_value_set_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_PRESENT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetPresentBalanceInCurrency,
-                 account, TRUE, &negative);
+        gnc_tree_model_account_get_balance (model, account,
+                                            BALANCE_COL_PRESENT, FALSE, &negative);
         gnc_tree_model_account_set_color(model, negative, value);
-        g_free(string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetBalanceInCurrency,
-                 account, FALSE, &negative);
-        g_value_take_string (value, string);
+        string = gnc_tree_model_account_get_balance (model, account,
+                 BALANCE_COL_BALANCE, FALSE, &negative);
+        g_value_set_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance(xaccAccountGetBalanceInCurrency,
-                 account, FALSE, &negative);
-        g_value_take_string (value, string);
+        string = gnc_tree_model_account_get_balance (model, account,
+                 BALANCE_COL_BALANCE, TRUE, &negative);
+        g_value_set_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_BALANCE:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetBalanceInCurrency,
-                 account, FALSE, &negative);
+        gnc_tree_model_account_get_balance (model, account,
+                                            BALANCE_COL_BALANCE, FALSE, &negative);
         gnc_tree_model_account_set_color(model, negative, value);
-        g_free(string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_PERIOD:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_tree_model_account_compute_period_balance(model, account, FALSE, &negative);
-        g_value_take_string (value, string);
+        string = gnc_tree_model_account_get_balance (model, account,
+                 BALANCE_COL_PERIOD, FALSE, &negative);
+        g_value_set_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_BALANCE_PERIOD:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_tree_model_account_compute_period_balance(model, account, FALSE, &negative);
+        gnc_tree_model_account_get_balance (model, account,
+                                            BALANCE_COL_PERIOD, FALSE, &negative);
         gnc_tree_model_account_set_color(model, negative, value);
-        g_free (string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_CLEARED:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetClearedBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        string = gnc_tree_model_account_get_balance (model, account,
+                 BALANCE_COL_CLEARED, FALSE, &negative);
+        g_value_set_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_CLEARED_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance(xaccAccountGetClearedBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        string = gnc_tree_model_account_get_balance (model, account,
+                 BALANCE_COL_CLEARED, TRUE, &negative);
+        g_value_set_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_CLEARED:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetClearedBalanceInCurrency,
-                 account, TRUE, &negative);
+        gnc_tree_model_account_get_balance (model, account,
+                                            BALANCE_COL_CLEARED, FALSE, &negative);
         gnc_tree_model_account_set_color(model, negative, value);
-        g_free(string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetReconciledBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        string = gnc_tree_model_account_get_balance (model, account,
+                 BALANCE_COL_RECONCILED, FALSE, &negative);
+        g_value_set_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance(xaccAccountGetReconciledBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        string = gnc_tree_model_account_get_balance (model, account,
+                 BALANCE_COL_RECONCILED, TRUE, &negative);
+        g_value_set_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED_DATE:
         g_value_init (value, G_TYPE_STRING);
@@ -742,61 +1185,59 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
 
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_RECONCILED:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetReconciledBalanceInCurrency,
-                 account, TRUE, &negative);
+        gnc_tree_model_account_get_balance (model, account,
+                                            BALANCE_COL_RECONCILED, FALSE, &negative);
         gnc_tree_model_account_set_color(model, negative, value);
-        g_free (string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetProjectedMinimumBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        string = gnc_tree_model_account_get_balance (model, account,
+                 BALANCE_COL_FUTURE_MIN, FALSE, &negative);
+        g_value_set_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance(xaccAccountGetProjectedMinimumBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        string = gnc_tree_model_account_get_balance (model, account,
+                 BALANCE_COL_FUTURE_MIN, TRUE, &negative);
+        g_value_set_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_FUTURE_MIN:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetProjectedMinimumBalanceInCurrency,
-                 account, TRUE, &negative);
+        gnc_tree_model_account_get_balance (model, account,
+                                            BALANCE_COL_FUTURE_MIN, FALSE, &negative);
         gnc_tree_model_account_set_color(model, negative, value);
-        g_free (string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        string = gnc_tree_model_account_get_balance (model, account,
+                 BALANCE_COL_TOTAL, FALSE, &negative);
+        g_value_set_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance(xaccAccountGetBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        string = gnc_tree_model_account_get_balance (model, account,
+                 BALANCE_COL_TOTAL, TRUE, &negative);
+        g_value_set_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_TOTAL:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance(xaccAccountGetBalanceInCurrency,
-                 account, TRUE, &negative);
+        gnc_tree_model_account_get_balance (model, account,
+                                            BALANCE_COL_TOTAL, FALSE, &negative);
         gnc_tree_model_account_set_color(model, negative, value);
-        g_free (string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_PERIOD:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_tree_model_account_compute_period_balance(model, account, TRUE, &negative);
-        g_value_take_string (value, string);
+        string = gnc_tree_model_account_get_balance (model, account,
+                 BALANCE_COL_TOTAL_PERIOD, FALSE, &negative);
+        g_value_set_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_TOTAL_PERIOD:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_tree_model_account_compute_period_balance(model, account, TRUE, &negative);
+        gnc_tree_model_account_get_balance (model, account,
+                                            BALANCE_COL_TOTAL_PERIOD, FALSE, &negative);
         gnc_tree_model_account_set_color(model, negative, value);
-        g_free (string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_ACCOUNT:
@@ -1313,6 +1754,14 @@ gnc_tree_model_account_event_handler (QofInstance *entity,
         LEAVE("not in this book");
         return;
     }
+
+    /* Any event may change balances; one that moves accounts around
+     * changes which totals include them. */
+    if (event_type & (QOF_EVENT_ADD | QOF_EVENT_REMOVE | QOF_EVENT_DESTROY))
+        gnc_tree_model_account_clear_balances (model, FALSE);
+    else
+        gnc_tree_model_account_forget_balances (model, account);
+
     if (gnc_account_get_root(account) != priv->root)
     {
         LEAVE("not in this model");
@@ -1385,3 +1834,20 @@ gnc_tree_model_account_event_handler (QofInstance *entity,
     LEAVE(" ");
     return;
 }
+
+/** This function is the handler for price events.  The account
+ *  balances do not change, but the cached values converted with the
+ *  old prices are dropped.
+ *
+ *  @internal
+ */
+static void
+gnc_tree_model_account_price_event_handler (QofInstance *entity,
+        QofEventId event_type,
+        GncTreeModelAccount *model,
+        gpointer event_data)
+{
+    g_return_if_fail(model);	/* Required */
+
+    gnc_tree_model_account_clear_balances (model, TRUE);
+}
@@ -55,6 +55,10 @@ do_find_cb (QofQuery *query, gpointer user_data, gpointer *result)
     gboolean new_ledger = FALSE;
     GncPluginPage *page;
 
+    /* Every parameter offered below has a read-only getter, so a search
+     * of a large book can test splits on several threads. */
+    qof_query_set_parallel (query, TRUE);
+
     ledger = gnc_ledger_display_find_by_query (ftd->ledger_q);
     if (!ledger)
     {
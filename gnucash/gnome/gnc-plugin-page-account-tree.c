@@ -1763,6 +1763,7 @@ gnc_plugin_page_account_tree_cmd_scrub (GtkAction *action, GncPluginPageAccountT
     g_return_if_fail (account != NULL);
 
     gnc_suspend_gui_refresh ();
+    qof_event_begin_batch ();
 
     window = GNC_WINDOW(GNC_PLUGIN_PAGE (page)->window);
     gnc_window_set_progressbar_window (window);
@@ -1777,6 +1778,7 @@ gnc_plugin_page_account_tree_cmd_scrub (GtkAction *action, GncPluginPageAccountT
     gncScrubBusinessAccount(account, gnc_window_show_progress);
 
 
+    qof_event_end_batch ();
     gnc_resume_gui_refresh ();
 }
 
@@ -1789,6 +1791,7 @@ gnc_plugin_page_account_tree_cmd_scrub_sub (GtkAction *action, GncPluginPageAcco
     g_return_if_fail (account != NULL);
 
     gnc_suspend_gui_refresh ();
+    qof_event_begin_batch ();
 
     window = GNC_WINDOW(GNC_PLUGIN_PAGE (page)->window);
     gnc_window_set_progressbar_window (window);
@@ -1802,6 +1805,7 @@ gnc_plugin_page_account_tree_cmd_scrub_sub (GtkAction *action, GncPluginPageAcco
 
     gncScrubBusinessAccountTree(account, gnc_window_show_progress);
 
+    qof_event_end_batch ();
     gnc_resume_gui_refresh ();
 }
 
@@ -1812,6 +1816,7 @@ gnc_plugin_page_account_tree_cmd_scrub_all (GtkAction *action, GncPluginPageAcco
     GncWindow *window;
 
     gnc_suspend_gui_refresh ();
+    qof_event_begin_batch ();
 
     window = GNC_WINDOW(GNC_PLUGIN_PAGE (page)->window);
     gnc_window_set_progressbar_window (window);
@@ -1824,6 +1829,7 @@ gnc_plugin_page_account_tree_cmd_scrub_all (GtkAction *action, GncPluginPageAcco
 
     gncScrubBusinessAccountTree(root, gnc_window_show_progress);
 
+    qof_event_end_batch ();
     gnc_resume_gui_refresh ();
 }
 
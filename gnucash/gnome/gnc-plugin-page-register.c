@@ -3917,6 +3917,9 @@ gnc_plugin_page_register_cmd_view_filter_by (GtkAction *action,
     button = GTK_WIDGET(gtk_builder_get_object (builder, "filter_show_days"));
 
     query = gnc_ledger_display_get_query (priv->ledger);
+    /* The ledger's results come from a live query, so this one hasn't
+     * been run for the earliest and latest dates found below. */
+    qof_query_run (query);
 
     if (priv->fd.days > 0) // using number of days
     {
@@ -1566,6 +1566,23 @@ gnc_split_reg_expand_trans_toolbar_cb (GtkWidget *widget, gpointer data)
     gsr_emit_simple_signal( gsr, "expand_ent" );
 }
 
+/**
+ * A long register only has part of its splits loaded; reload it around
+ * the split if that is not among them.
+ **/
+static void
+gsr_load_split (GNCSplitReg *gsr, SplitRegister *reg, Split *split)
+{
+    VirtualCellLocation vcell_loc;
+
+    if (!gnc_table_is_windowed (reg->table) ||
+            gnc_split_register_get_split_virt_loc (reg, split, &vcell_loc))
+        return;
+
+    if (gnc_split_register_window_to_split (reg, split))
+        gnc_ledger_display_refresh (gsr->ledger);
+}
+
 /**
  * move the cursor to the split, if present in register
 **/
@@ -1583,6 +1600,7 @@ gnc_split_reg_jump_to_split(GNCSplitReg *gsr, Split *split)
     gsr_emit_include_date_signal( gsr, xaccTransGetDate(trans) );
 
     reg = gnc_ledger_display_get_split_register( gsr->ledger );
+    gsr_load_split (gsr, reg, split);
 
     if (gnc_split_register_get_split_virt_loc(reg, split, &vcell_loc))
         gnucash_register_goto_virt_cell( gsr->reg, vcell_loc );
@@ -1607,6 +1625,7 @@ gnc_split_reg_jump_to_split_amount(GNCSplitReg *gsr, Split *split)
     gsr_emit_include_date_signal( gsr, xaccTransGetDate(trans) );
 
     reg = gnc_ledger_display_get_split_register (gsr->ledger);
+    gsr_load_split (gsr, reg, split);
 
     if (gnc_split_register_get_split_amount_virt_loc (reg, split, &virt_loc))
         gnucash_register_goto_virt_loc (gsr->reg, virt_loc);
@@ -1630,6 +1649,8 @@ gnc_split_reg_jump_to_blank (GNCSplitReg *gsr)
         return;
     }
 
+    gsr_load_split (gsr, reg, blank);
+
     if (gnc_split_register_get_split_virt_loc (reg, blank, &vcell_loc))
         gnucash_register_goto_virt_cell (gsr->reg, vcell_loc);
 
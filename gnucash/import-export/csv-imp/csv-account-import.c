@@ -204,6 +204,9 @@ csv_account_import (CsvImportInfo *info)
     /* Move to the first valid entry in store */
     row = info->header_rows;
     valid = gtk_tree_model_iter_nth_child (GTK_TREE_MODEL(info->store), &iter, NULL, row );
+    /* Refresh the GUI once, for all the new and changed accounts. */
+    gnc_suspend_gui_refresh ();
+    qof_event_begin_batch ();
     while (valid)
     {
         /* Walk through the list, reading each row */
@@ -350,5 +353,7 @@ csv_account_import (CsvImportInfo *info)
         g_free (tax);
         g_free (place_holder);
     }
+    qof_event_end_batch ();
+    gnc_resume_gui_refresh ();
     LEAVE("");
 }
@@ -58,6 +58,7 @@ struct gnc_ledger_display
     GncGUID leader;
 
     Query *query;
+    QofLiveQuery *live;
 
     GNCLedgerDisplayType ld_type;
 
@@ -509,6 +510,16 @@ gnc_ledger_display_parent (void *user_data)
     return gnc_ledger_display_get_parent( ld );
 }
 
+/* The register scrolled near an end of the splits it has loaded. */
+static void
+gnc_ledger_display_window_cb (Table *table, int start, gpointer user_data)
+{
+    GNCLedgerDisplay *ld = user_data;
+
+    if (gnc_split_register_set_window (ld->reg, start))
+        gnc_ledger_display_refresh (ld);
+}
+
 static void
 gnc_ledger_display_set_watches (GNCLedgerDisplay *ld, GList *splits)
 {
@@ -532,6 +543,64 @@ gnc_ledger_display_set_watches (GNCLedgerDisplay *ld, GList *splits)
     }
 }
 
+/* Whether the query has terms that look at a split's account other
+ * than by GUID.  The live query only retests splits on split and
+ * transaction events, so it misses a renamed or recoded account. */
+static gboolean
+gnc_ledger_display_query_uses_accounts (Query *q)
+{
+    static const char *account_params[] =
+    {
+        ACCOUNT_NAME_, ACCOUNT_CODE_, ACCOUNT_DESCRIPTION_, ACCOUNT_NOTES_,
+        ACCOUNT_TYPE_, NULL
+    };
+    const char **param;
+
+    for (param = account_params; *param; param++)
+    {
+        GSList *path = qof_query_build_param_list (SPLIT_ACCOUNT, *param,
+                                                   NULL);
+        gboolean found = qof_query_has_term_type (q, path);
+
+        g_slist_free (path);
+        if (found)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static gboolean
+gnc_ledger_display_account_modified (gpointer key, gpointer value,
+                                     gpointer user_data)
+{
+    const EventInfo *info = value;
+
+    return ((info->event_mask & QOF_EVENT_MODIFY) &&
+            xaccAccountLookup (key, gnc_get_current_book ()) != NULL);
+}
+
+/* The query results, kept up to date from engine events by a live
+ * query so that a refresh doesn't search the whole book again.  The
+ * live query is rebuilt whenever ld->query has been changed. */
+static GList *
+gnc_ledger_display_run_query (GNCLedgerDisplay *ld)
+{
+    if (!ld->query)
+        return NULL;
+
+    if (ld->live &&
+        !qof_query_equal (qof_live_query_get_query (ld->live), ld->query))
+    {
+        qof_live_query_destroy (ld->live);
+        ld->live = NULL;
+    }
+
+    if (!ld->live)
+        ld->live = qof_live_query_new (ld->query, NULL, NULL);
+
+    return qof_live_query_get_results (ld->live);
+}
+
 static void
 refresh_handler (GHashTable *changes, gpointer user_data)
 {
@@ -572,12 +641,17 @@ refresh_handler (GHashTable *changes, gpointer user_data)
         }
     }
 
-    /* Its not clear if we should re-run the query, or if we should
-     * just use qof_query_last_run().  Its possible that the dates
-     * changed, requiring a full new query.  Similar considerations
-     * needed for multi-user mode.
-     */
-    splits = qof_query_run (ld->query);
+    /* Run the query again when an account it looks at may have changed. */
+    if (changes && ld->live &&
+        gnc_ledger_display_query_uses_accounts (ld->query) &&
+        g_hash_table_find (changes, gnc_ledger_display_account_modified,
+                           NULL))
+    {
+        qof_live_query_destroy (ld->live);
+        ld->live = NULL;
+    }
+
+    splits = gnc_ledger_display_run_query (ld);
 
     gnc_ledger_display_set_watches (ld, splits);
 
@@ -602,6 +676,9 @@ close_handler (gpointer user_data)
     gnc_split_register_destroy (ld->reg);
     ld->reg = NULL;
 
+    qof_live_query_destroy (ld->live);
+    ld->live = NULL;
+
     qof_query_destroy (ld->query);
     ld->query = NULL;
 
@@ -758,6 +835,7 @@ gnc_ledger_display_internal (Account *lead_account, Query *q,
 
     ld->leader = *xaccAccountGetGUID (lead_account);
     ld->query = NULL;
+    ld->live = NULL;
     ld->ld_type = ld_type;
     ld->loading = FALSE;
     ld->destroy = NULL;
@@ -785,8 +863,10 @@ gnc_ledger_display_internal (Account *lead_account, Query *q,
                                       is_template);
 
     gnc_split_register_set_data (ld->reg, ld, gnc_ledger_display_parent);
+    gnc_table_set_window_handler (ld->reg->table, gnc_ledger_display_window_cb,
+                                  ld);
 
-    splits = qof_query_run (ld->query);
+    splits = gnc_ledger_display_run_query (ld);
 
     gnc_ledger_display_set_watches (ld, splits);
 
@@ -854,7 +934,7 @@ gnc_ledger_display_refresh (GNCLedgerDisplay *ld)
         return;
     }
 
-    gnc_ledger_display_refresh_internal (ld, qof_query_run (ld->query));
+    gnc_ledger_display_refresh_internal (ld, gnc_ledger_display_run_query (ld));
     LEAVE(" ");
 }
 
@@ -45,6 +45,9 @@
 /* This static indicates the debugging module that this .o belongs to. */
 static QofLogModule log_module = GNC_MOD_LEDGER;
 
+/* Split lists longer than this are loaded this many splits at a time. */
+#define SPLIT_REGISTER_WINDOW 500
+
 
 static void gnc_split_register_load_xfer_cells (SplitRegister *reg,
         Account *base_account);
@@ -231,6 +234,83 @@ _find_split_with_parent_txn(gconstpointer a, gconstpointer b)
     return xaccSplitGetParent(split) == txn ? 0 : 1;
 }
 
+/* Where the blank transaction goes in the split list: at the end, or
+ * before the first future transaction when it is shown there. */
+static int
+gnc_split_register_blank_offset (SRInfo *info, GList *slist, int total,
+                                 gboolean future_after_blank, time64 present)
+{
+    GList *node;
+    int i;
+
+    if (!info->show_present_divider || !future_after_blank)
+        return total;
+
+    for (node = slist, i = 0; node; node = node->next, i++)
+        if (xaccTransGetDate (xaccSplitGetParent (node->data)) > present)
+            return i;
+
+    return total;
+}
+
+/* Where the window over a long split list starts: where the GUI moved
+ * it to, else around the split it was asked to show, else where it was
+ * unless the cursor is going to a split outside it.  A new window goes
+ * to the cursor or to the blank transaction. */
+static int
+gnc_split_register_window_start (SRInfo *info, Table *table, GList *slist,
+                                 int total, Transaction *find_trans,
+                                 Split *find_trans_split,
+                                 Transaction *blank_trans, int blank_offset)
+{
+    Split *window_split = NULL;
+    int start = info->window_start;
+    int find = -1;
+    int i;
+    GList *node;
+
+    if (!guid_equal (&info->window_split_guid, guid_null ()))
+    {
+        window_split = xaccSplitLookup (&info->window_split_guid,
+                                        gnc_get_current_book ());
+        info->window_split_guid = *guid_null ();
+        if (window_split)
+        {
+            find_trans = xaccSplitGetParent (window_split);
+            find_trans_split = window_split;
+        }
+    }
+
+    if (table->window_anchor < 0 || window_split)
+    {
+        if (find_trans && find_trans == blank_trans)
+            find = blank_offset;
+        else
+            for (node = slist, i = 0; node; node = node->next, i++)
+            {
+                Split *split = node->data;
+
+                if ((find_trans_split && split == find_trans_split) ||
+                        (find_trans && xaccSplitGetParent (split) == find_trans))
+                {
+                    find = i;
+                    break;
+                }
+            }
+
+        if (find >= 0 &&
+                (window_split || start < 0 || find < start ||
+                 find >= start + SPLIT_REGISTER_WINDOW))
+            start = find - SPLIT_REGISTER_WINDOW / 2;
+        else if (start < 0)
+            start = blank_offset;
+    }
+
+    start = CLAMP (start, 0, total - SPLIT_REGISTER_WINDOW);
+    info->window_start = start;
+    return start;
+}
+
 static void add_quickfill_completions(TableLayout *layout, Transaction *trans,
                                       Split *split, gboolean has_last_num)
 {
@@ -363,6 +443,11 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
     Split *split;
     Table *table;
     GList *node;
+    GList *first_node;
+    GArray *window_rows = NULL;
+    int window_start = 0;
+    int blank_offset;
+    int total;
 
     gboolean start_primary_color = TRUE;
     gboolean found_pending = FALSE;
@@ -377,6 +462,8 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
     gboolean future_after_blank = gnc_prefs_get_bool(GNC_PREFS_GROUP_GENERAL_REGISTER,
                                                      GNC_PREF_FUTURE_AFTER_BLANK);
     gboolean added_blank_trans = FALSE;
+    gboolean blank_in_window = TRUE;
+    gboolean find_outside_window = FALSE;
 
     VirtualCellLocation vcell_loc;
     VirtualLocation save_loc;
@@ -546,12 +633,86 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
         }
     }
 
+    /* Long lists only get a window of their splits loaded; the GUI asks
+     * for another one when it is scrolled near an end. */
+    first_node = slist;
+    total = g_list_length (slist);
+    if (total > SPLIT_REGISTER_WINDOW)
+    {
+        blank_offset = gnc_split_register_blank_offset (info, slist, total,
+                                                        future_after_blank,
+                                                        present);
+        window_start = gnc_split_register_window_start (info, table, slist,
+                                                        total, find_trans,
+                                                        find_trans_split,
+                                                        blank_trans,
+                                                        blank_offset);
+        window_rows = g_array_sized_new (FALSE, FALSE, sizeof (int),
+                                         SPLIT_REGISTER_WINDOW);
+        first_node = g_list_nth (slist, window_start);
+
+        /* The blank transaction is only loaded with the splits around
+         * it. */
+        blank_in_window = (blank_offset >= window_start &&
+                           blank_offset <= window_start + SPLIT_REGISTER_WINDOW);
+
+        /* The pending transaction may be outside the window, but it is
+         * still in the account. */
+        if (pending_trans &&
+                g_list_find_custom (slist, pending_trans,
+                                    _find_split_with_parent_txn))
+            found_pending = TRUE;
+
+        /* The quickfills learn from every split, not just from those in
+         * the window, so their strings are read from the whole list once.
+         * The same splits are left out as in the loop below. */
+        if (info->first_pass)
+            for (node = slist; node; node = node->next)
+            {
+                split = node->data;
+                trans = xaccSplitGetParent (split);
+
+                if (trans == blank_trans ||
+                        !xaccTransStillHasSplit (trans, split))
+                    continue;
+                if (trans != pending_trans &&
+                        xaccTransCountSplits (trans) == 1 &&
+                        xaccSplitGetAccount (split) == NULL)
+                    continue;
+
+                add_quickfill_completions (table->layout, trans, split,
+                                           has_last_num);
+            }
+
+        /* Dividers that fall before the window are not shown. */
+        if (first_node->prev)
+        {
+            time64 before = xaccTransGetDate (xaccSplitGetParent
+                                              (first_node->prev->data));
+
+            if (before > present)
+                found_divider = TRUE;
+            if (use_autoreadonly && before >= autoreadonly_time)
+                found_divider_upper = TRUE;
+        }
+    }
+    else
+        info->window_start = -1;
+
     if (multi_line)
         trans_table = g_hash_table_new (g_direct_hash, g_direct_equal);
 
     /* populate the table */
-    for (node = slist; node; node = node->next)
+    for (node = first_node; node; node = node->next)
     {
+        if (window_rows)
+        {
+            if (window_rows->len == SPLIT_REGISTER_WINDOW)
+                break;
+            /* Splits that are skipped map to the row that follows. */
+            g_array_append_val (window_rows, vcell_loc.virt_row);
+        }
+
         split = node->data;
         trans = xaccSplitGetParent (split);
 
@@ -638,11 +799,15 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
             }
         }
 
-        /* If this is the first load of the register,
-         * fill up the quickfill cells. */
-        if (info->first_pass)
+        /* If this is the first load of the register, fill up the
+         * quickfill cells.  A windowed list has done so above. */
+        if (info->first_pass && !window_rows)
             add_quickfill_completions(reg->table->layout, trans, split, has_last_num);
 
+        if (window_rows)
+            g_array_index (window_rows, int, window_rows->len - 1) =
+                vcell_loc.virt_row;
+
         if (trans == find_trans)
             new_trans_row = vcell_loc.virt_row;
 
@@ -689,7 +854,7 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
         pending_trans = NULL;
     }
 
-    if (!added_blank_trans) {
+    if (!added_blank_trans && blank_in_window) {
         if (blank_trans == find_trans)
             new_trans_row = vcell_loc.virt_row;
 
@@ -727,8 +892,19 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
     /* resize the table to the sizes we just counted above */
     /* num_virt_cols is always one. */
     gnc_table_set_size (table, vcell_loc.virt_row, 1);
+    gnc_table_set_window (table, window_start, window_rows ? total : 0,
+                          window_rows);
+
+    /* When scrolling moved the window away from the cursor's split,
+     * the old row now holds some other transaction.  Leave the cursor
+     * unset until the split is loaded again. */
+    if (window_rows && table->window_anchor >= 0 && !info->first_pass &&
+            new_split_row <= 0 && new_trans_split_row <= 0 &&
+            new_trans_row <= 0)
+        find_outside_window = TRUE;
 
     /* restore the cursor to its rightful position */
+    if (!find_outside_window)
     {
         VirtualLocation trans_split_loc;
 
@@ -774,12 +950,37 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
 
     update_info (info, reg);
 
+    /* Keep aiming for the split the cursor was on, so the next load
+     * of its part of the list puts the cursor back on it. */
+    if (find_outside_window)
+    {
+        info->cursor_hint_trans = find_trans;
+        info->cursor_hint_split = find_split;
+        info->cursor_hint_trans_split = find_trans_split;
+        info->cursor_hint_cursor_class = find_class;
+    }
+
     gnc_split_register_set_cell_fractions(
         reg, gnc_split_register_get_current_split (reg));
 
     gnc_table_refresh_gui (table, TRUE);
 
-    gnc_split_register_show_trans (reg, table->current_cursor_loc.vcell_loc);
+    /* After moving the window, keep showing the split that was at the
+     * top of the view rather than going back to the cursor. */
+    if (table->window_anchor >= 0 &&
+            gnc_table_window_offset_to_row (table, table->window_anchor) > 0)
+    {
+        VirtualCellLocation top, bottom;
+
+        top.virt_row = gnc_table_window_offset_to_row (table,
+                                                       table->window_anchor);
+        top.virt_col = 0;
+        bottom.virt_row = table->num_virt_rows - 1;
+        bottom.virt_col = 0;
+        gnc_table_show_range (table, top, bottom);
+    }
+    else if (!find_outside_window)
+        gnc_split_register_show_trans (reg, table->current_cursor_loc.vcell_loc);
 
     /* enable callback for cursor user-driven moves */
     gnc_table_control_allow_move (table->control, TRUE);
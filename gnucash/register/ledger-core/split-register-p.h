@@ -133,6 +133,13 @@ struct sr_info
 
     /** true if the account separator has changed */
     gboolean separator_changed;
+
+    /** The offset in the split list of the first loaded split when the
+     * list is too long to load at once, otherwise -1 */
+    int window_start;
+
+    /** The split the next load places its window around, if any */
+    GncGUID window_split_guid;
 };
 
 
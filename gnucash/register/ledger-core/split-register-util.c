@@ -57,6 +57,8 @@ gnc_split_register_init_info (SplitRegister *reg)
     info->first_pass = TRUE;
     info->full_refresh = TRUE;
     info->separator_changed = TRUE;
+    info->window_start = -1;
+    info->window_split_guid = *guid_null ();
 
     reg->sr_info = info;
 }
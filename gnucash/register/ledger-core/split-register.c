@@ -2447,6 +2447,39 @@ gnc_split_register_show_present_divider (SplitRegister *reg,
     info->show_present_divider = show_present;
 }
 
+gboolean
+gnc_split_register_set_window (SplitRegister *reg, int start)
+{
+    SRInfo *info = gnc_split_register_get_info (reg);
+
+    if (!info)
+        return FALSE;
+
+    /* The transaction being edited has to stay loaded. */
+    if (!guid_equal (&info->pending_trans_guid, guid_null ()) ||
+            gnc_table_current_cursor_changed (reg->table, FALSE))
+        return FALSE;
+
+    info->window_start = start;
+    return TRUE;
+}
+
+gboolean
+gnc_split_register_window_to_split (SplitRegister *reg, Split *split)
+{
+    SRInfo *info = gnc_split_register_get_info (reg);
+
+    if (!info || !split)
+        return FALSE;
+
+    if (!guid_equal (&info->pending_trans_guid, guid_null ()) ||
+            gnc_table_current_cursor_changed (reg->table, FALSE))
+        return FALSE;
+
+    info->window_split_guid = *xaccSplitGetGUID (split);
+    return TRUE;
+}
+
 gboolean
 gnc_split_register_full_refresh_ok (SplitRegister *reg)
 {
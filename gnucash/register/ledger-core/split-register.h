@@ -523,6 +523,17 @@ gboolean gnc_split_register_changed (SplitRegister *reg);
 void gnc_split_register_show_present_divider (SplitRegister *reg,
         gboolean show_present);
 
+/** Makes the next load start its window at the given offset in the
+ * split list, for lists too long to load at once.  Returns FALSE and
+ * leaves the window alone while a transaction is being edited. */
+gboolean gnc_split_register_set_window (SplitRegister *reg, int start);
+
+/** Makes the next load place its window around the given split, so that
+ * it can be shown even if it is not loaded now.  Returns FALSE while a
+ * transaction is being edited. */
+gboolean gnc_split_register_window_to_split (SplitRegister *reg,
+                                             Split *split);
+
 /** Expand the current transaction if it is collapsed. */
 void gnc_split_register_expand_current_trans (SplitRegister *reg,
         gboolean expand);
@@ -112,6 +112,13 @@ gnc_table_init (Table * table)
 
     table->virt_cells = NULL;
     table->ui_data = NULL;
+
+    table->window_start = 0;
+    table->window_total = 0;
+    table->window_rows = NULL;
+    table->window_anchor = -1;
+    table->window_cb = NULL;
+    table->window_cb_data = NULL;
 }
 
 void
@@ -127,6 +134,9 @@ gnc_table_destroy (Table * table)
     /* free the cell tables */
     g_table_destroy (table->virt_cells);
 
+    if (table->window_rows)
+        g_array_free (table->window_rows, TRUE);
+
     gnc_table_layout_destroy (table->layout);
     table->layout = NULL;
 
@@ -600,6 +610,116 @@ gnc_table_set_size (Table * table, int virt_rows, int virt_cols)
     gnc_table_resize (table, virt_rows, virt_cols);
 }
 
+void
+gnc_table_set_window (Table *table, int start, int total, GArray *rows)
+{
+    g_return_if_fail (table != NULL);
+
+    if (table->window_rows)
+        g_array_free (table->window_rows, TRUE);
+
+    if (total <= 0 || !rows)
+    {
+        if (rows)
+            g_array_free (rows, TRUE);
+        table->window_start = 0;
+        table->window_total = 0;
+        table->window_rows = NULL;
+        return;
+    }
+
+    table->window_start = start;
+    table->window_total = total;
+    table->window_rows = rows;
+}
+
+void
+gnc_table_set_window_handler (Table *table, TableWindowCB cb,
+                              gpointer user_data)
+{
+    g_return_if_fail (table != NULL);
+
+    table->window_cb = cb;
+    table->window_cb_data = user_data;
+}
+
+gboolean
+gnc_table_is_windowed (Table *table)
+{
+    return table && table->window_total > 0;
+}
+
+gboolean
+gnc_table_window_has_more (Table *table, int dir)
+{
+    if (!gnc_table_is_windowed (table))
+        return FALSE;
+
+    if (dir < 0)
+        return table->window_start > 0;
+
+    return (table->window_start + (int) table->window_rows->len <
+            table->window_total);
+}
+
+int
+gnc_table_window_row_to_offset (Table *table, int virt_row)
+{
+    GArray *rows;
+    int lo, hi;
+
+    if (!gnc_table_is_windowed (table))
+        return -1;
+
+    /* The last item starting at or above virt_row. */
+    rows = table->window_rows;
+    lo = 0;
+    hi = rows->len;
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+
+        if (g_array_index (rows, int, mid) <= virt_row)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo > 0 ? table->window_start + lo - 1 : -1;
+}
+
+int
+gnc_table_window_offset_to_row (Table *table, int offset)
+{
+    if (!gnc_table_is_windowed (table))
+        return -1;
+
+    offset -= table->window_start;
+    if (offset < 0 || offset >= (int) table->window_rows->len)
+        return -1;
+
+    return g_array_index (table->window_rows, int, offset);
+}
+
+void
+gnc_table_move_window (Table *table, int offset)
+{
+    int count, start;
+
+    if (!gnc_table_is_windowed (table) || !table->window_cb)
+        return;
+
+    count = table->window_rows->len;
+    start = CLAMP (offset - count / 2, 0, table->window_total - count);
+    if (start == table->window_start)
+        return;
+
+    /* The callback reloads the table, which looks at the anchor. */
+    table->window_anchor = offset;
+    table->window_cb (table, start, table->window_cb_data);
+    table->window_anchor = -1;
+}
+
 static void
 gnc_table_free_data (Table * table)
 {
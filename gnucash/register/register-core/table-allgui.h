@@ -148,6 +148,10 @@ typedef void (*TableCursorRefreshCB) (Table *table,
 typedef void (*TableRedrawHelpCB) (Table *table);
 typedef void (*TableDestroyCB) (Table *table);
 
+/** Asks the owner of a windowed table to reload it with the items from
+ * start on; see gnc_table_set_window(). */
+typedef void (*TableWindowCB) (Table *table, int start, gpointer user_data);
+
 typedef struct
 {
     TableCursorRefreshCB cursor_refresh;
@@ -176,6 +180,19 @@ struct table
 
     TableGUIHandlers gui_handlers;
     gpointer ui_data;
+
+    /* Windowed mode: the rows show items window_start onwards out of
+     * window_total; window_rows holds the first row of each of them.
+     * window_total is 0 when the table shows everything. */
+    int window_start;
+    int window_total;
+    GArray *window_rows;
+    /* The item to scroll to while a window change reloads the table,
+     * otherwise -1. */
+    int window_anchor;
+
+    TableWindowCB window_cb;
+    gpointer window_cb_data;
 };
 
 /** Color definitions used for table elements */
@@ -277,6 +294,46 @@ VirtualCell *  gnc_table_get_header_cell (Table *table);
  *   indicated dimensions.  */
 void        gnc_table_set_size (Table * table, int virt_rows, int virt_cols);
 
+/** @name Windowed tables
+ * A table over a very long ordered list of items can hold just a window
+ * of them.  The loader says which part of the list it loaded, and the
+ * GUI asks for another window when it scrolls close to an edge of the
+ * loaded rows.  Items are numbered by their offset in the whole list.
+ * @{ */
+
+/** Record the window that was just loaded.
+ *
+ * @param start The offset of the first loaded item.
+ * @param total The number of items in the whole list, or 0 if the
+ *        table is not windowed.
+ * @param rows The virtual row where each loaded item starts.  The table
+ *        takes ownership; may be NULL if total is 0.
+ */
+void        gnc_table_set_window (Table *table, int start, int total,
+                                  GArray *rows);
+
+/** Set the callback that reloads the table with another window. */
+void        gnc_table_set_window_handler (Table *table, TableWindowCB cb,
+                                          gpointer user_data);
+
+gboolean    gnc_table_is_windowed (Table *table);
+
+/** TRUE if there are items before (dir < 0) or after (dir > 0) the
+ * loaded ones. */
+gboolean    gnc_table_window_has_more (Table *table, int dir);
+
+/** The offset of the item shown at virt_row, or -1. */
+int         gnc_table_window_row_to_offset (Table *table, int virt_row);
+
+/** The first virtual row of the item at offset, or -1 if it is not
+ * loaded. */
+int         gnc_table_window_offset_to_row (Table *table, int offset);
+
+/** Reload the table with a window centred on the item at offset, which
+ * the GUI then scrolls to the top. */
+void        gnc_table_move_window (Table *table, int offset);
+/** @} */
+
 /** Indicate what handler should be used for a given virtual block */
 void        gnc_table_set_vcell (Table *table, CellBlock *cursor,
                                  gconstpointer vcell_data,
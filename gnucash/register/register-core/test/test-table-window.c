@@ -0,0 +1,175 @@
+/********************************************************************\
+ * test-table-window.c -- tables holding a window of a long list    *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+#include "table-allgui.h"
+
+typedef struct
+{
+    Table *table;
+    int calls;
+    int start;
+    int anchor;
+} Fixture;
+
+/* Stands in for the register reloading the table. */
+static void
+window_cb (Table *table, int start, gpointer user_data)
+{
+    Fixture *fixture = user_data;
+
+    fixture->calls++;
+    fixture->start = start;
+    fixture->anchor = table->window_anchor;
+}
+
+/* Five items from offset 100 of 1000, the third skipped, so it maps to
+ * the row of the fourth. */
+static GArray *
+window_rows (void)
+{
+    static const int rows[] = { 1, 3, 4, 4, 6 };
+    GArray *array = g_array_sized_new (FALSE, FALSE, sizeof (int),
+                                       G_N_ELEMENTS (rows));
+
+    g_array_append_vals (array, rows, G_N_ELEMENTS (rows));
+    return array;
+}
+
+static void
+setup (Fixture *fixture, gconstpointer pData)
+{
+    fixture->table = gnc_table_new (gnc_table_layout_new (),
+                                    gnc_table_model_new (),
+                                    gnc_table_control_new ());
+    fixture->calls = 0;
+    fixture->start = -1;
+    fixture->anchor = -1;
+    gnc_table_set_window_handler (fixture->table, window_cb, fixture);
+}
+
+static void
+teardown (Fixture *fixture, gconstpointer pData)
+{
+    gnc_table_destroy (fixture->table);
+}
+
+static void
+test_not_windowed (Fixture *fixture, gconstpointer pData)
+{
+    Table *table = fixture->table;
+
+    g_assert (!gnc_table_is_windowed (table));
+    g_assert (!gnc_table_window_has_more (table, -1));
+    g_assert (!gnc_table_window_has_more (table, 1));
+    g_assert_cmpint (gnc_table_window_row_to_offset (table, 1), ==, -1);
+    g_assert_cmpint (gnc_table_window_offset_to_row (table, 0), ==, -1);
+
+    gnc_table_move_window (table, 10);
+    g_assert_cmpint (fixture->calls, ==, 0);
+
+    /* A list loaded whole isn't windowed either. */
+    gnc_table_set_window (table, 0, 0, window_rows ());
+    g_assert (!gnc_table_is_windowed (table));
+    g_assert (table->window_rows == NULL);
+}
+
+static void
+test_rows_and_offsets (Fixture *fixture, gconstpointer pData)
+{
+    Table *table = fixture->table;
+
+    gnc_table_set_window (table, 100, 1000, window_rows ());
+    g_assert (gnc_table_is_windowed (table));
+    g_assert (gnc_table_window_has_more (table, -1));
+    g_assert (gnc_table_window_has_more (table, 1));
+
+    g_assert_cmpint (gnc_table_window_row_to_offset (table, 0), ==, -1);
+    g_assert_cmpint (gnc_table_window_row_to_offset (table, 1), ==, 100);
+    g_assert_cmpint (gnc_table_window_row_to_offset (table, 2), ==, 100);
+    g_assert_cmpint (gnc_table_window_row_to_offset (table, 3), ==, 101);
+    g_assert_cmpint (gnc_table_window_row_to_offset (table, 4), ==, 103);
+    g_assert_cmpint (gnc_table_window_row_to_offset (table, 5), ==, 103);
+    g_assert_cmpint (gnc_table_window_row_to_offset (table, 9), ==, 104);
+
+    g_assert_cmpint (gnc_table_window_offset_to_row (table, 99), ==, -1);
+    g_assert_cmpint (gnc_table_window_offset_to_row (table, 100), ==, 1);
+    g_assert_cmpint (gnc_table_window_offset_to_row (table, 102), ==, 4);
+    g_assert_cmpint (gnc_table_window_offset_to_row (table, 104), ==, 6);
+    g_assert_cmpint (gnc_table_window_offset_to_row (table, 105), ==, -1);
+
+    gnc_table_set_window (table, 0, 5, window_rows ());
+    g_assert (gnc_table_is_windowed (table));
+    g_assert (!gnc_table_window_has_more (table, -1));
+    g_assert (!gnc_table_window_has_more (table, 1));
+
+    gnc_table_set_window (table, 995, 1000, window_rows ());
+    g_assert (gnc_table_window_has_more (table, -1));
+    g_assert (!gnc_table_window_has_more (table, 1));
+}
+
+static void
+test_move_window (Fixture *fixture, gconstpointer pData)
+{
+    Table *table = fixture->table;
+
+    gnc_table_set_window (table, 100, 1000, window_rows ());
+
+    /* Centred on the offset, which is the anchor while reloading. */
+    gnc_table_move_window (table, 500);
+    g_assert_cmpint (fixture->calls, ==, 1);
+    g_assert_cmpint (fixture->start, ==, 498);
+    g_assert_cmpint (fixture->anchor, ==, 500);
+    g_assert_cmpint (table->window_anchor, ==, -1);
+
+    /* Kept within the list. */
+    gnc_table_move_window (table, 1);
+    g_assert_cmpint (fixture->start, ==, 0);
+    gnc_table_move_window (table, 2000);
+    g_assert_cmpint (fixture->start, ==, 995);
+    g_assert_cmpint (fixture->calls, ==, 3);
+
+    /* Nothing to do when the window wouldn't change. */
+    gnc_table_move_window (table, 102);
+    g_assert_cmpint (fixture->calls, ==, 3);
+
+    /* Or when nobody reloads the table. */
+    gnc_table_set_window_handler (table, NULL, NULL);
+    gnc_table_move_window (table, 500);
+    g_assert_cmpint (fixture->calls, ==, 3);
+}
+
+int
+main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add ("/register/table/window/not-windowed", Fixture, NULL,
+                setup, test_not_windowed, teardown);
+    g_test_add ("/register/table/window/rows-and-offsets", Fixture, NULL,
+                setup, test_rows_and_offsets, teardown);
+    g_test_add ("/register/table/window/move", Fixture, NULL,
+                setup, test_move_window, teardown);
+
+    return g_test_run ();
+}
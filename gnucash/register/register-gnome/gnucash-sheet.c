@@ -693,11 +693,81 @@ gnucash_sheet_update_adjustments (GnucashSheet *sheet)
 }
 
 
+/* Rows from the edge of a windowed table's loaded rows at which the
+ * window is moved. */
+#define WINDOW_EDGE_ROWS 10
+
+/* The offset in a windowed table's list of the item at pixel y, which
+ * may be in the room left for the items that aren't loaded. */
+static gint
+gnucash_sheet_y_pixel_to_window_offset (GnucashSheet *sheet, gint y)
+{
+    Table *table = sheet->table;
+    gint offset;
+
+    if (sheet->window_item_height == 0 ||
+            (y >= sheet->window_top && y < sheet->window_bottom))
+        return gnc_table_window_row_to_offset
+               (table, gnucash_sheet_y_pixel_to_block (sheet, y));
+
+    if (y < sheet->window_top)
+        return y / sheet->window_item_height;
+
+    offset = table->window_start + table->window_rows->len +
+             (y - sheet->window_bottom) / sheet->window_item_height;
+    return MIN (offset, table->window_total - 1);
+}
+
+static gboolean
+gnucash_sheet_move_window_idle (gpointer data)
+{
+    GnucashSheet *sheet = data;
+    GtkAdjustment *adj;
+
+    sheet->window_idle = 0;
+
+    if (!gnc_table_is_windowed (sheet->table))
+        return FALSE;
+
+    /* Keep the item at the top of the view where it is. */
+    adj = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE(sheet));
+    gnc_table_move_window (sheet->table,
+                           gnucash_sheet_y_pixel_to_window_offset
+                           (sheet, gtk_adjustment_get_value (adj)));
+    return FALSE;
+}
+
+/* Ask for another window once the view gets near an end of the loaded
+ * rows that has more items beyond it.  The table is reloaded from an
+ * idle handler, outside of the scrolling. */
+static void
+gnucash_sheet_check_window (GnucashSheet *sheet)
+{
+    GtkAdjustment *adj;
+    gint top_row, bottom_row;
+
+    if (sheet->window_idle || !gnc_table_is_windowed (sheet->table))
+        return;
+
+    adj = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE(sheet));
+    top_row = gnucash_sheet_y_pixel_to_block (sheet,
+                                              gtk_adjustment_get_value (adj));
+    bottom_row = top_row + sheet->num_visible_blocks;
+
+    if ((top_row <= WINDOW_EDGE_ROWS &&
+            gnc_table_window_has_more (sheet->table, -1)) ||
+            (bottom_row >= sheet->num_virt_rows - WINDOW_EDGE_ROWS &&
+             gnc_table_window_has_more (sheet->table, 1)))
+        sheet->window_idle = g_idle_add (gnucash_sheet_move_window_idle,
+                                         sheet);
+}
+
 static void
 gnucash_sheet_vadjustment_value_changed (GtkAdjustment *adj,
         GnucashSheet *sheet)
 {
     gnucash_sheet_compute_visible_range (sheet);
+    gnucash_sheet_check_window (sheet);
 }
 
 
@@ -761,6 +831,9 @@ gnucash_sheet_finalize (GObject *object)
 
     sheet = GNUCASH_SHEET (object);
 
+    if (sheet->window_idle)
+        g_source_remove (sheet->window_idle);
+
     g_table_resize (sheet->blocks, 0, 0);
     g_table_destroy (sheet->blocks);
     sheet->blocks = NULL;
@@ -2397,6 +2470,35 @@ gnucash_sheet_recompute_block_offsets (GnucashSheet *sheet)
             height += block->style->dimensions->height;
     }
 
+    sheet->window_top = 0;
+    sheet->window_bottom = height;
+    sheet->window_item_height = 0;
+
+    /* Leave room for the items of a windowed table that aren't loaded,
+     * at the average height of the loaded ones, so that the scrollbar
+     * covers the whole list. */
+    if (gnc_table_is_windowed (table) && table->window_rows->len > 0)
+    {
+        gint before = table->window_start;
+        gint after = table->window_total - table->window_start -
+                     table->window_rows->len;
+
+        sheet->window_item_height = MAX (1, height / table->window_rows->len);
+        sheet->window_top = before * sheet->window_item_height;
+        sheet->window_bottom = sheet->window_top + height;
+
+        for (i = 0; i < table->num_virt_rows; i++)
+            for (j = 0; j < table->num_virt_cols; j++)
+            {
+                VirtualCellLocation vcell_loc = { i, j };
+
+                block = gnucash_sheet_get_block (sheet, vcell_loc);
+                block->origin_y += sheet->window_top;
+            }
+
+        height = sheet->window_bottom + after * sheet->window_item_height;
+    }
+
     sheet->height = height;
 }
 
@@ -94,6 +94,14 @@ struct _GnucashSheet
     GFunc moved_cb;
     gpointer moved_cb_data;
 
+    /* pending move of a windowed table's window */
+    guint window_idle;
+    /* where a windowed table's loaded rows start and end, and the
+     * height given to each item that is not loaded */
+    gint window_top;
+    gint window_bottom;
+    gint window_item_height;
+
     /* IMContext */
     GtkIMContext *im_context;
     gint preedit_length; /** num of bytes */
@@ -145,6 +145,12 @@ table_destroy_cb (Table *table)
 
     sheet = GNUCASH_SHEET (table->ui_data);
 
+    if (sheet->window_idle)
+    {
+        g_source_remove (sheet->window_idle);
+        sheet->window_idle = 0;
+    }
+
     g_object_unref (sheet);
 
     table->ui_data = NULL;
@@ -407,6 +407,13 @@ construct gnc:make-gnc-monetary and use gnc:monetary->string instead.")
      accounts)
     balance-collector))
 
+;; get the account balances at each of the specified dates, in the
+;; account's commodity and without children. This looks each date up
+;; in the account's ordered splits, so it is much cheaper than calling
+;; xaccAccountGetBalanceAsOfDate once per date.
+(define (gnc:account-get-balances-at-dates account dates)
+  (xaccAccountGetBalancesAsOfDatesList account dates))
+
 ;; Calculate the increase in the balance of the account in terms of
 ;; "value" (as opposed to "amount") between the specified dates.
 ;; If include-children? is true, the balances of all children (not
@@ -40,23 +40,53 @@ typedef struct
 {
     GHashTable * event_masks;
     GHashTable * entity_events;
-
-    gboolean match;
 } ComponentEventInfo;
 
+typedef struct EntityWatch EntityWatch;
+
 typedef struct
 {
     GNCComponentRefreshHandler refresh_handler;
     GNCComponentCloseHandler close_handler;
     gpointer user_data;
 
+    /* Only the event_masks; entity watches are in watched_entities. */
     ComponentEventInfo watch_info;
+    EntityWatch *watches;
+    /* The last two change generations with an event on a watched
+     * entity: during a refresh both the one being refreshed and the
+     * next can be pending. */
+    guint changed_generation;
+    guint prev_changed_generation;
 
     char *component_class;
     gint component_id;
     gpointer session;
 } ComponentInfo;
 
+/* A component's watch on an entity.  watched_entities maps a GncGUID to
+ * the chain of watches on it, linked by next, so an event only visits
+ * the components that watch its entity.  ci_next links the watches of
+ * one component. */
+struct EntityWatch
+{
+    GncGUID guid;
+    QofEventId event_mask;
+    ComponentInfo *ci;
+    EntityWatch *next;
+    EntityWatch *ci_next;
+};
+
+/* An entry of a changes hash, which maps &guid to it.  Refresh handlers
+ * see it as the EventInfo. */
+typedef struct ChangeEntry ChangeEntry;
+struct ChangeEntry
+{
+    EventInfo info;
+    GncGUID guid;
+    ChangeEntry *next_free;
+};
+
 
 /** Static Variables ************************************************/
 static guint  suspend_counter = 0;
@@ -64,8 +94,19 @@ static guint  suspend_counter = 0;
 static gint   next_component_id = 1;
 static GList *components = NULL;
 
-static ComponentEventInfo changes = { NULL, NULL, FALSE };
-static ComponentEventInfo changes_backup = { NULL, NULL, FALSE };
+static ComponentEventInfo changes = { NULL, NULL };
+static ComponentEventInfo changes_backup = { NULL, NULL };
+
+static GHashTable *watched_entities = NULL;
+/* Bumped at each refresh; events mark watchers with the current one. */
+static guint change_generation = 1;
+/* The generation being refreshed, or 0 outside a refresh. */
+static guint refresh_generation = 0;
+
+/* Released entries, kept for reuse so tracking a change or adding a
+ * watch does not allocate once the lists have filled up. */
+static ChangeEntry *free_changes = NULL;
+static EntityWatch *free_watches = NULL;
 
 
 /* This static indicates the debugging module that this .o belongs to.  */
@@ -140,17 +181,16 @@ destroy_mask_hash (GHashTable *hash)
 static gboolean
 destroy_event_hash_helper (gpointer key, gpointer value, gpointer user_data)
 {
-    GncGUID *guid = key;
-    EventInfo *ei = value;
+    ChangeEntry *entry = value;
 
-    guid_free (guid);
-    g_free (ei);
+    entry->next_free = free_changes;
+    free_changes = entry;
 
     return TRUE;
 }
 
-/* clear a hash table of the form GncGUID --> EventInfo, where
- * both keys and values are g_malloced */
+/* clear a hash table of the form GncGUID --> ChangeEntry, putting the
+ * entries on the free list */
 static void
 clear_event_hash (GHashTable *hash)
 {
@@ -179,53 +219,183 @@ clear_event_info (ComponentEventInfo *cei)
 
 static void
 add_event (ComponentEventInfo *cei, const GncGUID *entity,
-           QofEventId event_mask, gboolean or_in)
+           QofEventId event_mask)
+{
+    ChangeEntry *entry;
+
+    if (!cei || !cei->entity_events || !entity || event_mask == 0)
+        return;
+
+    entry = g_hash_table_lookup (cei->entity_events, entity);
+    if (entry == NULL)
+    {
+        if (free_changes)
+        {
+            entry = free_changes;
+            free_changes = entry->next_free;
+        }
+        else
+            entry = g_new (ChangeEntry, 1);
+
+        entry->guid = *entity;
+        entry->info.event_mask = 0;
+        g_hash_table_insert (cei->entity_events, &entry->guid, entry);
+    }
+
+    entry->info.event_mask |= event_mask;
+}
+
+/* take a watch out of the chain for its entity */
+static void
+unlink_watch (EntityWatch *watch)
+{
+    EntityWatch *head = g_hash_table_lookup (watched_entities, &watch->guid);
+
+    if (head == watch)
+    {
+        /* The hash key points into the head, so rekey on the next. */
+        if (watch->next)
+            g_hash_table_replace (watched_entities, &watch->next->guid,
+                                  watch->next);
+        else
+            g_hash_table_remove (watched_entities, &watch->guid);
+        return;
+    }
+
+    while (head && head->next != watch)
+        head = head->next;
+    if (head)
+        head->next = watch->next;
+}
+
+static void
+free_watch (EntityWatch *watch)
 {
-    GHashTable *hash;
+    watch->next = free_watches;
+    free_watches = watch;
+}
 
-    if (!cei || !cei->entity_events || !entity)
+static void
+mark_changed (ComponentInfo *ci, guint generation)
+{
+    if (ci->changed_generation == generation)
         return;
+    ci->prev_changed_generation = ci->changed_generation;
+    ci->changed_generation = generation;
+}
+
+/* Changes are matched when the refresh runs, so count the ones on
+ * entity that came in before it was watched, both those for the
+ * refresh that may be running and those for the next one. */
+static void
+mark_pending_changes (ComponentInfo *ci, const GncGUID *entity,
+                      QofEventId event_mask)
+{
+    ChangeEntry *entry;
+
+    entry = refresh_generation && changes_backup.entity_events ?
+            g_hash_table_lookup (changes_backup.entity_events, entity) : NULL;
+    if (entry && (entry->info.event_mask & event_mask))
+        mark_changed (ci, refresh_generation);
+    entry = changes.entity_events ?
+            g_hash_table_lookup (changes.entity_events, entity) : NULL;
+    if (entry && (entry->info.event_mask & event_mask))
+        mark_changed (ci, change_generation);
+}
 
-    hash = cei->entity_events;
+static void
+add_watch (ComponentInfo *ci, const GncGUID *entity, QofEventId event_mask)
+{
+    EntityWatch *head, *watch;
+
+    if (!watched_entities)
+        watched_entities = guid_hash_table_new ();
+
+    head = g_hash_table_lookup (watched_entities, entity);
+    for (watch = head; watch; watch = watch->next)
+        if (watch->ci == ci)
+            break;
 
     if (event_mask == 0)
     {
-        gpointer key;
-        gpointer value;
+        EntityWatch **link;
 
-        if (or_in)
+        if (!watch)
             return;
 
-        if (g_hash_table_lookup_extended (hash, entity, &key, &value))
-        {
-            g_hash_table_remove (hash, entity);
-            guid_free (key);
-            g_free (value);
-        }
+        unlink_watch (watch);
+        for (link = &ci->watches; *link != watch; link = &(*link)->ci_next)
+            ;
+        *link = watch->ci_next;
+        free_watch (watch);
+
+        /* Its changes may have been what marked the component. */
+        ci->changed_generation = 0;
+        ci->prev_changed_generation = 0;
+        for (watch = ci->watches; watch; watch = watch->ci_next)
+            mark_pending_changes (ci, &watch->guid, watch->event_mask);
+        return;
     }
-    else
-    {
-        EventInfo *ei;
 
-        ei = g_hash_table_lookup (hash, entity);
-        if (ei == NULL)
+    if (!watch)
+    {
+        if (free_watches)
         {
-            GncGUID *key;
+            watch = free_watches;
+            free_watches = watch->next;
+        }
+        else
+            watch = g_new (EntityWatch, 1);
 
-            key = guid_malloc ();
-            *key = *entity;
+        watch->guid = *entity;
+        watch->ci = ci;
+        if (head)
+        {
+            watch->next = head->next;
+            head->next = watch;
+        }
+        else
+        {
+            watch->next = NULL;
+            g_hash_table_insert (watched_entities, &watch->guid, watch);
+        }
+        watch->ci_next = ci->watches;
+        ci->watches = watch;
+    }
 
-            ei = g_new (EventInfo, 1);
-            ei->event_mask = 0;
+    watch->event_mask = event_mask;
+    mark_pending_changes (ci, entity, event_mask);
+}
 
-            g_hash_table_insert (hash, key, ei);
-        }
+static void
+clear_watches (ComponentInfo *ci)
+{
+    EntityWatch *watch, *next;
 
-        if (or_in)
-            ei->event_mask |= event_mask;
-        else
-            ei->event_mask = event_mask;
+    for (watch = ci->watches; watch; watch = next)
+    {
+        next = watch->ci_next;
+        unlink_watch (watch);
+        free_watch (watch);
     }
+    ci->watches = NULL;
+    ci->changed_generation = 0;
+    ci->prev_changed_generation = 0;
+}
+
+/* mark the components watching entity for event_type as changed */
+static void
+notify_watches (const GncGUID *entity, QofEventId event_type)
+{
+    EntityWatch *watch;
+
+    if (!watched_entities)
+        return;
+
+    watch = g_hash_table_lookup (watched_entities, entity);
+    for (; watch; watch = watch->next)
+        if (watch->event_mask & event_type)
+            mark_changed (watch->ci, change_generation);
 }
 
 static void
@@ -265,7 +435,8 @@ gnc_cm_event_handler (QofInstance *entity,
     fprintf (stderr, "event_handler: event %d, entity %p, guid %s\n", event_type,
              entity, guidstr);
 #endif
-    add_event (&changes, guid, event_type, TRUE);
+    add_event (&changes, guid, event_type);
+    notify_watches (guid, event_type);
 
     if (QOF_CHECK_TYPE(entity, GNC_ID_SPLIT))
     {
@@ -324,6 +495,20 @@ gnc_component_manager_shutdown (void)
     destroy_event_hash (changes_backup.entity_events);
     changes_backup.entity_events = NULL;
 
+    while (free_changes)
+    {
+        ChangeEntry *entry = free_changes;
+        free_changes = entry->next_free;
+        g_free (entry);
+    }
+
+    while (free_watches)
+    {
+        EntityWatch *watch = free_watches;
+        free_watches = watch->next;
+        g_free (watch);
+    }
+
     qof_event_unregister_handler (handler_id);
 }
 
@@ -403,7 +588,10 @@ gnc_register_gui_component_internal (const char * component_class)
     ci = g_new0 (ComponentInfo, 1);
 
     ci->watch_info.event_masks = g_hash_table_new (g_str_hash, g_str_equal);
-    ci->watch_info.entity_events = guid_hash_table_new ();
+    ci->watch_info.entity_events = NULL;
+    ci->watches = NULL;
+    ci->changed_generation = 0;
+    ci->prev_changed_generation = 0;
 
     ci->component_class = g_strdup (component_class);
     ci->component_id = component_id;
@@ -465,7 +653,7 @@ gnc_gui_component_watch_entity (gint component_id,
         return;
     }
 
-    add_event (&ci->watch_info, entity, event_mask, FALSE);
+    add_watch (ci, entity, event_mask);
 }
 
 void
@@ -507,6 +695,7 @@ gnc_gui_component_clear_watches (gint component_id)
     }
 
     clear_event_info (&ci->watch_info);
+    clear_watches (ci);
 }
 
 void
@@ -534,9 +723,6 @@ gnc_unregister_gui_component (gint component_id)
     destroy_mask_hash (ci->watch_info.event_masks);
     ci->watch_info.event_masks = NULL;
 
-    destroy_event_hash (ci->watch_info.entity_events);
-    ci->watch_info.entity_events = NULL;
-
     g_free (ci->component_class);
     ci->component_class = NULL;
 
@@ -596,70 +782,37 @@ gnc_resume_gui_refresh (void)
         gnc_gui_refresh_internal (FALSE);
 }
 
-static void
-match_type_helper (gpointer key, gpointer value, gpointer user_data)
+static gboolean
+types_match (ComponentEventInfo *cei, ComponentEventInfo *changes)
 {
-    ComponentEventInfo *cei = user_data;
-    QofIdType id_type = key;
-    QofEventId * et = value;
-    QofEventId * et_2;
+    GHashTableIter iter;
+    gpointer key, value;
 
-    et_2 = g_hash_table_lookup (cei->event_masks, id_type);
-    if (!et_2)
-        return;
-
-    if (*et & *et_2)
-        cei->match = TRUE;
-}
-
-static void
-match_helper (gpointer key, gpointer value, gpointer user_data)
-{
-    GncGUID *guid = key;
-    EventInfo *ei_1 = value;
-    EventInfo *ei_2;
-    ComponentEventInfo *cei = user_data;
+    g_hash_table_iter_init (&iter, changes->event_masks);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+        QofEventId *et = value;
+        QofEventId *et_2 = g_hash_table_lookup (cei->event_masks, key);
 
-    ei_2 = g_hash_table_lookup (cei->entity_events, guid);
-    if (!ei_2)
-        return;
+        if (et_2 && (*et & *et_2))
+            return TRUE;
+    }
 
-    if (ei_1->event_mask & ei_2->event_mask)
-        cei->match = TRUE;
+    return FALSE;
 }
 
 static gboolean
-changes_match (ComponentEventInfo *cei, ComponentEventInfo *changes)
+changes_match (ComponentInfo *ci, ComponentEventInfo *changes,
+               guint generation)
 {
-    ComponentEventInfo *big_cei;
-    GHashTable *smalltable;
-
-    if (cei == NULL)
-        return FALSE;
-
-    /* check types first, for efficiency */
-    cei->match = FALSE;
-    g_hash_table_foreach (changes->event_masks, match_type_helper, cei);
-    if (cei->match)
+    /* Watched entities were marked as their events came in.  Events
+     * raised by refresh handlers mark the next generation, which this
+     * refresh must not take for its own. */
+    if (ci->changed_generation == generation ||
+        ci->prev_changed_generation == generation)
         return TRUE;
 
-    if (g_hash_table_size (cei->entity_events) <=
-            g_hash_table_size (changes->entity_events))
-    {
-        smalltable = cei->entity_events;
-        big_cei = changes;
-    }
-    else
-    {
-        smalltable = changes->entity_events;
-        big_cei = cei;
-    }
-
-    big_cei->match = FALSE;
-
-    g_hash_table_foreach (smalltable, match_helper, big_cei);
-
-    return big_cei->match;
+    return types_match (&ci->watch_info, changes);
 }
 
 static void
@@ -667,6 +820,7 @@ gnc_gui_refresh_internal (gboolean force)
 {
     GList *list;
     GList *node;
+    guint generation;
 
     if (!got_events && !force)
         return;
@@ -684,6 +838,8 @@ gnc_gui_refresh_internal (gboolean force)
         changes_backup.entity_events = changes.entity_events;
         changes.entity_events = table;
     }
+    generation = change_generation++;
+    refresh_generation = generation;
 
 #if CM_DEBUG
     fprintf (stderr, "%srefresh!\n", force ? "forced " : "");
@@ -718,7 +874,7 @@ gnc_gui_refresh_internal (gboolean force)
                 ci->refresh_handler (NULL, ci->user_data);
             }
         }
-        else if (changes_match (&ci->watch_info, &changes_backup))
+        else if (changes_match (ci, &changes_backup, generation))
         {
             if (ci->refresh_handler)
             {
@@ -736,6 +892,7 @@ gnc_gui_refresh_internal (gboolean force)
         }
     }
 
+    refresh_generation = 0;
     clear_event_info (&changes_backup);
     got_events = FALSE;
 
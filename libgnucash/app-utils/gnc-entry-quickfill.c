@@ -139,8 +139,10 @@ static EntryQF* build_shared_quickfill (QofBook *book, const char * key, gboolea
     qof_query_destroy(query);
 
     result->listener =
-        qof_event_register_handler (listen_for_gncentry_events,
-                                    result);
+        qof_event_register_filtered_handler (listen_for_gncentry_events,
+                                             result, GNC_ID_ENTRY,
+                                             QOF_EVENT_MODIFY |
+                                             QOF_EVENT_DESTROY);
 
     qof_book_set_data_fin (book, key, result, shared_quickfill_destroy);
 
@@ -32,6 +32,8 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 
 /* Keys used for core preferences */
 #define GNC_PREF_FILE_COMPRESSION    "file-compression"
+#define GNC_PREF_FILE_JOURNAL        "file-journal"
+#define GNC_PREF_SQL_LAZY_LOAD       "sql-lazy-load"
 #define GNC_PREF_RETAIN_TYPE_NEVER   "retain-type-never"
 #define GNC_PREF_RETAIN_TYPE_DAYS    "retain-type-days"
 #define GNC_PREF_RETAIN_TYPE_FOREVER "retain-type-forever"
@@ -78,6 +80,26 @@ file_compression_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
     }
 }
 
+static void
+file_journal_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
+{
+    if (gnc_prefs_is_set_up())
+    {
+        gboolean file_journal = gnc_prefs_get_bool(GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_JOURNAL);
+        gnc_prefs_set_file_save_journal (file_journal);
+    }
+}
+
+static void
+sql_lazy_load_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
+{
+    if (gnc_prefs_is_set_up())
+    {
+        gboolean sql_lazy_load = gnc_prefs_get_bool(GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_LAZY_LOAD);
+        gnc_prefs_set_sql_lazy_load (sql_lazy_load);
+    }
+}
+
 
 void gnc_prefs_init (void)
 {
@@ -89,6 +111,8 @@ void gnc_prefs_init (void)
     file_retain_changed_cb (NULL, NULL, NULL);
     file_retain_type_changed_cb (NULL, NULL, NULL);
     file_compression_changed_cb (NULL, NULL, NULL);
+    file_journal_changed_cb (NULL, NULL, NULL);
+    sql_lazy_load_changed_cb (NULL, NULL, NULL);
 
     /* Check for invalid retain_type (days)/retain_days (0) combo.
      * This can happen either because a user changed the preferences
@@ -122,5 +146,9 @@ void gnc_prefs_init (void)
                            file_retain_type_changed_cb, NULL);
     gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_COMPRESSION,
                            file_compression_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_JOURNAL,
+                           file_journal_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_LAZY_LOAD,
+                           sql_lazy_load_changed_cb, NULL);
 
 }
@@ -42,6 +42,7 @@
 #include "Split.h"
 #include "Transaction.h"
 #include "gnc-commodity.h"
+#include "gnc-component-manager.h"
 #include "gnc-date.h"
 #include "gnc-event.h"
 #include "gnc-exp-parser.h"
@@ -1332,14 +1333,9 @@ create_transactions_for_instance(GncSxInstance *instance, GList **created_txn_gu
     creation_data.instance = instance;
     creation_data.created_txn_guids = created_txn_guids;
     creation_data.creation_errors = creation_errors;
-    /* Don't update the GUI for every transaction, it can really slow things
-     * down.
-     */
-    qof_event_suspend();
     xaccAccountForEachTransaction(sx_template_account,
                                   create_each_transaction_helper,
                                   &creation_data);
-    qof_event_resume();
 }
 
 void
@@ -1356,6 +1352,11 @@ gnc_sx_instance_model_effect_change(GncSxInstanceModel *model,
         return;
     }
 
+    /* Don't update the GUI for every transaction, it can really slow things
+     * down; deliver what changed once everything is created.
+     */
+    gnc_suspend_gui_refresh();
+    qof_event_begin_batch();
     for (iter = model->sx_instance_list; iter != NULL; iter = iter->next)
     {
         GList *instance_iter;
@@ -1445,6 +1446,8 @@ gnc_sx_instance_model_effect_change(GncSxInstanceModel *model,
         gnc_sx_set_instance_count(instances->sx, instance_count);
         xaccSchedXactionSetRemOccur(instances->sx, remain_occur_count);
     }
+    qof_event_end_batch();
+    gnc_resume_gui_refresh();
 }
 
 void
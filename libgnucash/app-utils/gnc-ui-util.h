@@ -52,6 +52,9 @@ gboolean gnc_reverse_balance(const Account *account);
 #define GNC_PREFS_GROUP_REPORT       "dialogs.report"
 #define GNC_PREF_AUTO_DECIMAL_POINT  "auto-decimal-point"
 #define GNC_PREF_AUTO_DECIMAL_PLACES "auto-decimal-places"
+#define GNC_PREF_REVERSED_ACCTS_NONE    "reversed-accounts-none"
+#define GNC_PREF_REVERSED_ACCTS_CREDIT  "reversed-accounts-credit"
+#define GNC_PREF_REVERSED_ACCTS_INC_EXP "reversed-accounts-incomeexpense"
 
 /* Default directories **********************************************/
 
@@ -0,0 +1,242 @@
+/********************************************************************\
+ * test-component-manager.c -- entity watches and refresh matching  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+#include <stdlib.h>
+#include <glib.h>
+#include "qof.h"
+#include "gnc-component-manager.h"
+#include "test-stuff.h"
+
+#define TEST_TYPE "TestEntity"
+
+typedef struct TestComponent TestComponent;
+struct TestComponent
+{
+    const char *name;
+    gint id;
+    /* Run from the refresh handler, once. */
+    void (*during_refresh) (TestComponent *tc);
+    gpointer data;
+};
+
+static GString *refreshed = NULL;
+static QofBook *book = NULL;
+
+static void
+refresh_handler (GHashTable *changes, gpointer user_data)
+{
+    TestComponent *tc = user_data;
+    void (*during) (TestComponent*) = tc->during_refresh;
+
+    g_string_append (refreshed, tc->name);
+    tc->during_refresh = NULL;
+    if (during)
+        during (tc);
+}
+
+static void
+register_component (TestComponent *tc, const char *name)
+{
+    tc->name = name;
+    tc->during_refresh = NULL;
+    tc->data = NULL;
+    tc->id = gnc_register_gui_component ("test-component", refresh_handler,
+                                         NULL, tc);
+}
+
+static QofInstance *
+new_entity (void)
+{
+    QofInstance *inst = g_object_new (QOF_TYPE_INSTANCE, NULL);
+    qof_instance_init_data (inst, TEST_TYPE, book);
+    return inst;
+}
+
+static void
+watch (TestComponent *tc, QofInstance *inst, QofEventId mask)
+{
+    gnc_gui_component_watch_entity (tc->id, qof_instance_get_guid (inst),
+                                    mask);
+}
+
+static void
+modify (QofInstance *inst)
+{
+    qof_event_gen (inst, QOF_EVENT_MODIFY, NULL);
+}
+
+/* Each event refreshes at once; check which components it reached. */
+static void
+check_refresh (QofInstance *inst, const char *expected, const char *msg)
+{
+    g_string_truncate (refreshed, 0);
+    modify (inst);
+    if (!do_test (g_strcmp0 (refreshed->str, expected) == 0, msg))
+        printf ("  refreshed \"%s\", expected \"%s\"\n", refreshed->str,
+                expected);
+}
+
+static void
+test_rewatch (void)
+{
+    TestComponent a, b;
+    QofInstance *inst = new_entity ();
+    QofInstance *other = new_entity ();
+
+    register_component (&a, "a");
+    register_component (&b, "b");
+
+    watch (&a, inst, QOF_EVENT_MODIFY);
+    watch (&b, inst, QOF_EVENT_MODIFY);
+    check_refresh (inst, "ba", "both watchers of an entity are refreshed");
+
+    watch (&a, inst, 0);
+    check_refresh (inst, "b", "an unwatched entity no longer refreshes");
+
+    watch (&a, inst, QOF_EVENT_MODIFY);
+    check_refresh (inst, "ba", "a watch added again refreshes");
+
+    /* Changes on an entity unwatched before the refresh don't count. */
+    gnc_suspend_gui_refresh ();
+    modify (inst);
+    watch (&a, inst, 0);
+    g_string_truncate (refreshed, 0);
+    gnc_resume_gui_refresh ();
+    do_test (g_strcmp0 (refreshed->str, "b") == 0,
+             "unwatched before the refresh, not refreshed");
+
+    /* But they do once it is watched again. */
+    gnc_suspend_gui_refresh ();
+    modify (inst);
+    watch (&a, inst, 0);
+    watch (&a, inst, QOF_EVENT_MODIFY);
+    g_string_truncate (refreshed, 0);
+    gnc_resume_gui_refresh ();
+    do_test (g_strcmp0 (refreshed->str, "ba") == 0,
+             "watched again before the refresh, refreshed");
+
+    /* Another watch still marks the component. */
+    watch (&a, other, QOF_EVENT_MODIFY);
+    gnc_suspend_gui_refresh ();
+    modify (inst);
+    modify (other);
+    watch (&a, inst, 0);
+    g_string_truncate (refreshed, 0);
+    gnc_resume_gui_refresh ();
+    do_test (g_strcmp0 (refreshed->str, "ba") == 0,
+             "unwatching one entity keeps the changes on another");
+
+    gnc_unregister_gui_component (a.id);
+    gnc_unregister_gui_component (b.id);
+    g_object_unref (inst);
+    g_object_unref (other);
+}
+
+static void
+clear_other (TestComponent *tc)
+{
+    TestComponent *other = tc->data;
+    gnc_gui_component_clear_watches (other->id);
+}
+
+static void
+rewatch_self (TestComponent *tc)
+{
+    gnc_gui_component_clear_watches (tc->id);
+    watch (tc, tc->data, QOF_EVENT_MODIFY);
+}
+
+static void
+modify_data (TestComponent *tc)
+{
+    modify (tc->data);
+}
+
+/* Components are refreshed newest first. */
+static void
+test_refresh_changes_watches (void)
+{
+    TestComponent first, second, last;
+    QofInstance *inst = new_entity ();
+    QofInstance *unwatched = new_entity ();
+    QofInstance *later = new_entity ();
+
+    register_component (&last, "l");
+    register_component (&second, "s");
+    register_component (&first, "f");
+
+    g_test_message ("clearing the watches of a component yet to refresh");
+    watch (&first, inst, QOF_EVENT_MODIFY);
+    watch (&last, inst, QOF_EVENT_MODIFY);
+    first.during_refresh = clear_other;
+    first.data = &last;
+    check_refresh (inst, "f",
+                   "a component whose watches were cleared isn't refreshed");
+    check_refresh (inst, "f", "and isn't refreshed afterwards");
+    gnc_gui_component_clear_watches (first.id);
+
+    g_test_message ("clearing and adding its own watches while refreshing");
+    watch (&second, inst, QOF_EVENT_MODIFY);
+    second.during_refresh = rewatch_self;
+    second.data = inst;
+    check_refresh (inst, "s", "the component is refreshed once");
+    check_refresh (unwatched, "", "and not again for unrelated changes");
+    check_refresh (inst, "s", "and still follows its entity");
+    gnc_gui_component_clear_watches (second.id);
+
+    g_test_message ("an event raised while refreshing");
+    watch (&first, inst, QOF_EVENT_MODIFY);
+    watch (&last, later, QOF_EVENT_MODIFY);
+    first.during_refresh = modify_data;
+    first.data = later;
+    check_refresh (inst, "f",
+                   "an event raised by a refresh waits for the next one");
+    check_refresh (unwatched, "l", "which refreshes its watchers");
+    check_refresh (unwatched, "", "only once");
+
+    gnc_unregister_gui_component (first.id);
+    gnc_unregister_gui_component (second.id);
+    gnc_unregister_gui_component (last.id);
+    g_object_unref (inst);
+    g_object_unref (unwatched);
+    g_object_unref (later);
+}
+
+int
+main (int argc, char **argv)
+{
+    qof_init ();
+    gnc_component_manager_init ();
+    book = qof_book_new ();
+    refreshed = g_string_new (NULL);
+
+    test_rewatch ();
+    test_refresh_changes_watches ();
+
+    g_string_free (refreshed, TRUE);
+    qof_book_destroy (book);
+    gnc_component_manager_shutdown ();
+    qof_close ();
+    print_test_results ();
+    exit (get_rv ());
+}
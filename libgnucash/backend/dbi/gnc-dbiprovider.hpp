@@ -47,6 +47,10 @@ public:
                                 const GncSqlColumnInfo& info) = 0;
     virtual StrVec get_index_list (dbi_conn conn) = 0;
     virtual void drop_index(dbi_conn conn, const std::string& index) = 0;
+    /** The most rows a single INSERT ... VALUES statement may carry. */
+    virtual std::size_t max_insert_rows() const noexcept = 0;
+    /** The longest single INSERT ... VALUES statement to send, in bytes. */
+    virtual std::size_t max_insert_bytes() const noexcept = 0;
 };
 
 using GncDbiProviderPtr = std::unique_ptr<GncDbiProvider>;
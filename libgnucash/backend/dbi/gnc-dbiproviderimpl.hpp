@@ -46,6 +46,8 @@ public:
     void append_col_def(std::string& ddl, const GncSqlColumnInfo& info);
     StrVec get_index_list (dbi_conn conn);
     void drop_index(dbi_conn conn, const std::string& index);
+    std::size_t max_insert_rows() const noexcept;
+    std::size_t max_insert_bytes() const noexcept;
 };
 
 template <DbType T> GncDbiProviderPtr
@@ -376,4 +378,31 @@ GncDbiProviderImpl<DbType::DBI_MYSQL>::drop_index (dbi_conn conn, const std::str
     if (result)
         dbi_result_free (result);
 }
+
+/* MySQL and PostgreSQL are limited only by the statement size, but SQLite
+ * treats a multi-row VALUES as a compound SELECT, which by default can't
+ * have more than 500 terms.
+ */
+template <DbType P> std::size_t
+GncDbiProviderImpl<P>::max_insert_rows() const noexcept
+{
+    return 1000;
+}
+
+template<> std::size_t
+GncDbiProviderImpl<DbType::DBI_SQLITE>::max_insert_rows() const noexcept
+{
+    return 500;
+}
+
+/* MySQL rejects statements longer than max_allowed_packet, which defaults to
+ * 4MB on current servers but only 1MB on older ones; SQLite's compiled-in
+ * SQLITE_MAX_SQL_LENGTH is 1000000. PostgreSQL has no practical limit, but
+ * there's nothing to gain from statements larger than this.
+ */
+template <DbType P> std::size_t
+GncDbiProviderImpl<P>::max_insert_bytes() const noexcept
+{
+    return 1000000;
+}
 #endif //__GNC_DBISQLPROVIDERIMPL_HPP__
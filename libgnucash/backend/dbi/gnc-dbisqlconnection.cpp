@@ -29,6 +29,7 @@ extern "C"
 #include <gnc-locale-utils.h>
 }
 
+#include <algorithm>
 #include <string>
 #include <regex>
 #include <sstream>
@@ -317,6 +318,28 @@ GncDbiSqlConnection::execute_nonselect_statement (const GncSqlStatementPtr& stmt
     return num_rows;
 }
 
+int
+GncDbiSqlConnection::execute_bulk_insert (const std::string& table_name,
+                                          const StrVec& columns,
+                                          const std::vector<StrVec>& rows)
+    noexcept
+{
+    auto statements = gnc_sql_bulk_insert_statements (table_name, columns,
+                                                      rows,
+                                                      m_provider->max_insert_rows(),
+                                                      m_provider->max_insert_bytes());
+    int num_rows = 0;
+    for (const auto& sql : statements)
+    {
+        auto stmt = create_statement_from_sql(sql);
+        auto result = execute_nonselect_statement(stmt);
+        if (result == -1)
+            return -1;
+        num_rows += result;
+    }
+    return num_rows;
+}
+
 GncSqlStatementPtr
 GncDbiSqlConnection::create_statement_from_sql (const std::string& sql)
     const noexcept
@@ -48,6 +48,8 @@ public:
         noexcept override;
     int execute_nonselect_statement (const GncSqlStatementPtr&)
         noexcept override;
+    int execute_bulk_insert (const std::string&, const StrVec&,
+                             const std::vector<StrVec>&) noexcept override;
     GncSqlStatementPtr create_statement_from_sql (const std::string&)
         const noexcept override;
     bool does_table_exist (const std::string&) const noexcept override;
@@ -42,8 +42,10 @@ extern "C"
     /* For setup_business */
 #include "Account.h"
 #include <TransLog.h>
+#include <qofinstance-p.h>
 #include "Transaction.h"
 #include "Split.h"
+#include "gnc-lot.h"
 #include "gnc-commodity.h"
 #include "gncAddress.h"
 #include "gncCustomer.h"
@@ -425,6 +427,190 @@ test_dbi_store_and_reload (Fixture* fixture, gconstpointer pData)
     qof_session_destroy (session_3);
 }
 
+/* Removing one GUID from a list slot edits the list in place. Check that
+ * committing the change rewrites the slot, so that a reload sees only the
+ * GUIDs that are left. */
+static void
+test_dbi_remove_guid_from_list (Fixture* fixture, gconstpointer pData)
+{
+    auto url = (const gchar*)pData;
+    auto path = "test-guid-list";
+    GncGUID guids[3];
+
+    if (fixture->filename)
+        url = fixture->filename;
+
+    auto session_1 = qof_session_new ();
+    qof_session_begin (session_1, url, FALSE, TRUE, TRUE);
+    g_assert_cmpint (qof_session_get_error (session_1), == , ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_1);
+    auto book = qof_session_get_book (session_1);
+    auto acct = gnc_account_lookup_by_name (gnc_book_get_root_account (book),
+                                            "Bank 1");
+    g_assert (acct != nullptr);
+    GncGUID acct_guid = *qof_instance_get_guid (QOF_INSTANCE (acct));
+
+    GList* list = nullptr;
+    for (auto& guid : guids)
+    {
+        guid_replace (&guid);
+        auto container = new KvpFrame;
+        container->set ({"guid"}, new KvpValue (guid_copy (&guid)));
+        list = g_list_append (list, new KvpValue (container));
+    }
+    qof_instance_get_slots (QOF_INSTANCE (acct))->set ({path},
+                                                       new KvpValue (list));
+    qof_book_mark_session_dirty (book);
+    qof_session_save (session_1, NULL);
+    g_assert_cmpint (qof_session_get_error (session_1), == , ERR_BACKEND_NO_ERR);
+
+    xaccAccountBeginEdit (acct);
+    qof_instance_kvp_remove_guid (QOF_INSTANCE (acct), path, "guid",
+                                  &guids[1]);
+    qof_instance_set_dirty (QOF_INSTANCE (acct));
+    xaccAccountCommitEdit (acct);
+    g_assert_cmpint (qof_session_get_error (session_1), == , ERR_BACKEND_NO_ERR);
+    qof_session_end (session_1);
+    qof_session_destroy (session_1);
+
+    auto session_2 = qof_session_new ();
+    qof_session_begin (session_2, url, TRUE, FALSE, FALSE);
+    qof_session_load (session_2, NULL);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    acct = xaccAccountLookup (&acct_guid, qof_session_get_book (session_2));
+    g_assert (acct != nullptr);
+    auto inst = QOF_INSTANCE (acct);
+    auto value = qof_instance_get_slots (inst)->get_slot ({path});
+    g_assert (value != nullptr);
+    g_assert_cmpint (g_list_length (value->get<GList*> ()), == , 2);
+    g_assert (qof_instance_kvp_has_guid (inst, path, "guid", &guids[0]));
+    g_assert (!qof_instance_kvp_has_guid (inst, path, "guid", &guids[1]));
+    g_assert (qof_instance_kvp_has_guid (inst, path, "guid", &guids[2]));
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+}
+
+static Transaction*
+lazy_load_add_trans (QofBook* book, gnc_commodity* currency, Account* from,
+                     Account* to, gint64 amount)
+{
+    auto tx = xaccMallocTransaction (book);
+    xaccTransBeginEdit (tx);
+    xaccTransSetCurrency (tx, currency);
+    xaccTransSetDatePostedSecsNormalized (tx, gnc_time (nullptr));
+    auto value = gnc_numeric_create (amount, 100);
+    auto spl_from = xaccMallocSplit (book);
+    xaccSplitSetParent (spl_from, tx);
+    xaccSplitSetAccount (spl_from, from);
+    xaccSplitSetAmount (spl_from, gnc_numeric_neg (value));
+    xaccSplitSetValue (spl_from, gnc_numeric_neg (value));
+    auto spl_to = xaccMallocSplit (book);
+    xaccSplitSetParent (spl_to, tx);
+    xaccSplitSetAccount (spl_to, to);
+    xaccSplitSetAmount (spl_to, value);
+    xaccSplitSetValue (spl_to, value);
+    xaccTransCommitEdit (tx);
+    return tx;
+}
+
+/* Load the same database eagerly and with GncSqlBackend's lazy
+ * transaction loading, and check that the balances agree and that a lot
+ * looked at before anything else in its account still sees its splits. */
+static void
+test_dbi_lazy_load (Fixture* fixture, gconstpointer pData)
+{
+    auto url = (const gchar*)pData;
+    if (fixture->filename)
+        url = fixture->filename;
+
+    auto session_1 = qof_session_new ();
+    qof_session_begin (session_1, url, FALSE, TRUE, TRUE);
+    g_assert_cmpint (qof_session_get_error (session_1), == , ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_1);
+    auto book = qof_session_get_book (session_1);
+    auto root = gnc_book_get_root_account (book);
+    auto bank = gnc_account_lookup_by_name (root, "Bank 1");
+    g_assert (bank != nullptr);
+    auto currency = xaccAccountGetCommodity (bank);
+    auto broker = xaccMallocAccount (book);
+    xaccAccountBeginEdit (broker);
+    xaccAccountSetType (broker, ACCT_TYPE_ASSET);
+    xaccAccountSetName (broker, "Broker");
+    xaccAccountSetCommodity (broker, currency);
+    gnc_account_append_child (root, broker);
+    xaccAccountCommitEdit (broker);
+    auto lot = gnc_lot_new (book);
+    xaccAccountInsertLot (broker, lot);
+    auto tx = lazy_load_add_trans (book, currency, bank, broker, 1000);
+    gnc_lot_add_split (lot, xaccTransFindSplitByAccount (tx, broker));
+    tx = lazy_load_add_trans (book, currency, broker, bank, 400);
+    gnc_lot_add_split (lot, xaccTransFindSplitByAccount (tx, broker));
+    lazy_load_add_trans (book, currency, bank, broker, 700);
+    GncGUID lot_guid = *qof_instance_get_guid (QOF_INSTANCE (lot));
+    GncGUID broker_guid = *qof_instance_get_guid (QOF_INSTANCE (broker));
+    GncGUID bank_guid = *qof_instance_get_guid (QOF_INSTANCE (bank));
+    qof_book_mark_session_dirty (book);
+    qof_session_save (session_1, NULL);
+    g_assert_cmpint (qof_session_get_error (session_1), == , ERR_BACKEND_NO_ERR);
+    qof_session_end (session_1);
+    qof_session_destroy (session_1);
+
+    gnc_numeric balances[2], lot_balance;
+    gint lot_splits = 0;
+    for (auto lazy : {false, true})
+    {
+        /* The backend takes its default from the preference. */
+        gnc_prefs_set_sql_lazy_load (lazy);
+        auto session = qof_session_new ();
+        qof_session_begin (session, url, TRUE, FALSE, FALSE);
+        g_assert_cmpint (qof_session_get_error (session), == , ERR_BACKEND_NO_ERR);
+        auto sql_be = reinterpret_cast<GncSqlBackend*>
+            (qof_session_get_backend (session));
+        g_assert (sql_be->lazy_tx_load () == lazy);
+        qof_session_load (session, NULL);
+        g_assert_cmpint (qof_session_get_error (session), == , ERR_BACKEND_NO_ERR);
+        book = qof_session_get_book (session);
+        broker = xaccAccountLookup (&broker_guid, book);
+        bank = xaccAccountLookup (&bank_guid, book);
+        g_assert (broker != nullptr && bank != nullptr);
+        g_assert (gnc_account_has_split_loader (broker) == lazy);
+
+        /* Look at the lot before anything else loads the account. */
+        lot = gnc_lot_lookup (&lot_guid, book);
+        g_assert (lot != nullptr);
+        auto count = gnc_lot_count_splits (lot);
+        auto balance = gnc_lot_get_balance (lot);
+        g_assert (!gnc_account_has_split_loader (broker));
+        g_assert (!gnc_lot_is_closed (lot));
+        g_assert_cmpint (g_list_length (xaccAccountFindOpenLots (broker, nullptr,
+                                                                 nullptr,
+                                                                 nullptr)),
+                         == , 1);
+        if (!lazy)
+        {
+            lot_splits = count;
+            lot_balance = balance;
+            balances[0] = xaccAccountGetBalance (bank);
+            balances[1] = xaccAccountGetBalance (broker);
+            g_assert_cmpint (lot_splits, == , 2);
+        }
+        else
+        {
+            g_assert_cmpint (count, == , lot_splits);
+            g_assert (gnc_numeric_equal (balance, lot_balance));
+            g_assert (gnc_numeric_equal (xaccAccountGetBalance (bank),
+                                         balances[0]));
+            g_assert (gnc_numeric_equal (xaccAccountGetBalance (broker),
+                                         balances[1]));
+            g_assert_cmpint (g_list_length (xaccAccountGetSplitList (broker)),
+                             == , 3);
+        }
+        qof_session_end (session);
+        qof_session_destroy (session);
+    }
+    gnc_prefs_set_sql_lazy_load (FALSE);
+}
+
 /** Test the safe_save mechanism.  Beware that this test used on its
  * own doesn't ensure that the resave is done safely, only that the
  * database is intact and unchanged after the save. To observe the
@@ -655,6 +841,10 @@ create_dbi_test_suite (const char* dbm_name, const char* url)
                   test_dbi_version_control, teardown);
     GNC_TEST_ADD (subsuite, "business_store_and_reload", Fixture, url,
                   setup_business, test_dbi_version_control, teardown);
+    GNC_TEST_ADD (subsuite, "remove_guid_from_list", Fixture, url,
+                  setup_memory, test_dbi_remove_guid_from_list, teardown);
+    GNC_TEST_ADD (subsuite, "lazy_load", Fixture, url, setup_memory,
+                  test_dbi_lazy_load, teardown);
     g_free (subsuite);
 
 }
@@ -42,6 +42,7 @@ extern "C"
 
 #include <string>
 #include <sstream>
+#include <algorithm>
 
 #include "gnc-sql-connection.hpp"
 #include "gnc-sql-backend.hpp"
@@ -646,6 +647,145 @@ save_slot (const char* key, KvpValue* value, slot_info_t & slot_info)
     }
 }
 
+/* Delete the rows stored at name under guid, along with the rows of any frame
+ * or list they hold.
+ */
+static gboolean
+slots_delete_path (GncSqlBackend* sql_be, const GncGUID* guid,
+                   const std::string& name)
+{
+    gnc::GUID obj_guid(*guid);
+    std::string where(" WHERE obj_guid='");
+    where += obj_guid.to_string() + "' AND name=" + sql_be->quote_string(name);
+
+    std::string sql("SELECT * FROM " TABLE_NAME);
+    sql += where + " AND slot_type in ('" +
+        std::to_string(static_cast<int>(KvpValue::Type::FRAME)) + "', '" +
+        std::to_string(static_cast<int>(KvpValue::Type::GLIST)) +
+        "') and not guid_val is null";
+    auto stmt = sql_be->create_statement_from_sql(sql);
+    if (stmt != nullptr)
+    {
+        auto result = sql_be->execute_select_statement(stmt);
+        for (auto row : *result)
+        {
+            try
+            {
+                GncGUID child_guid;
+                auto val = row.get_string_at_col (col_table[guid_val_col]->name());
+                if (string_to_guid (val.c_str(), &child_guid))
+                    gnc_sql_slots_delete (sql_be, &child_guid);
+            }
+            catch (std::invalid_argument&)
+            {
+                continue;
+            }
+        }
+        delete result;
+    }
+
+    stmt = sql_be->create_statement_from_sql("DELETE FROM " TABLE_NAME + where);
+    if (stmt == nullptr)
+        return FALSE;
+    return sql_be->execute_nonselect_statement(stmt) >= 0;
+}
+
+/* Find the guid under which the children of the frame stored at name under
+ * guid were saved.
+ */
+static gboolean
+slots_get_frame_guid (GncSqlBackend* sql_be, const GncGUID* guid,
+                      const std::string& name, GncGUID* frame_guid)
+{
+    gnc::GUID obj_guid(*guid);
+    std::string sql("SELECT * FROM " TABLE_NAME " WHERE obj_guid='");
+    sql += obj_guid.to_string() + "' AND name=" + sql_be->quote_string(name) +
+        " AND slot_type='" +
+        std::to_string(static_cast<int>(KvpValue::Type::FRAME)) + "'";
+    auto stmt = sql_be->create_statement_from_sql(sql);
+    if (stmt == nullptr)
+        return FALSE;
+    auto result = sql_be->execute_select_statement(stmt);
+    gboolean found = FALSE;
+    for (auto row : *result)
+    {
+        try
+        {
+            auto val = row.get_string_at_col (col_table[guid_val_col]->name());
+            found = string_to_guid (val.c_str(), frame_guid);
+        }
+        catch (std::invalid_argument&)
+        {
+            found = FALSE;
+        }
+        break;
+    }
+    delete result;
+    return found;
+}
+
+/* Rewrite only the parts of frame that changed since it was loaded or last
+ * saved. Keys that were set or removed are deleted and re-inserted; child
+ * frames that only changed inside are descended into using the guid their
+ * children were saved under.
+ */
+static void
+save_dirty_slots (KvpFrame* frame, slot_info_t& slot_info)
+{
+    if (frame->all_dirty())
+    {
+        slot_info.is_ok = gnc_sql_slots_delete (slot_info.be, slot_info.guid);
+        if (slot_info.is_ok)
+            frame->for_each_slot_temp (save_slot, slot_info);
+        return;
+    }
+
+    auto dirty = frame->get_dirty_keys();
+    for (auto const& key : dirty)
+    {
+        slot_info.is_ok = slots_delete_path (slot_info.be, slot_info.guid,
+                                             slot_info.parent_path + key);
+        if (!slot_info.is_ok)
+            return;
+        auto value = frame->get_slot ({key});
+        if (value != nullptr)
+            save_slot (key.c_str(), value, slot_info);
+        if (!slot_info.is_ok)
+            return;
+    }
+
+    for (auto const& key : frame->get_keys())
+    {
+        if (std::binary_search (dirty.begin(), dirty.end(), key))
+            continue;
+        auto value = frame->get_slot ({key});
+        if (value->get_type () != KvpValue::Type::FRAME ||
+            !value->get<KvpFrame*> ()->is_dirty ())
+            continue;
+
+        GncGUID child_guid;
+        slot_info.path = slot_info.parent_path + key;
+        if (slots_get_frame_guid (slot_info.be, slot_info.guid, slot_info.path,
+                                  &child_guid))
+        {
+            auto pNewInfo = slot_info_copy (&slot_info, &child_guid);
+            save_dirty_slots (value->get<KvpFrame*> (), *pNewInfo);
+            slot_info.is_ok = pNewInfo->is_ok;
+            delete pNewInfo;
+        }
+        else
+        {
+            /* The frame was never saved as such; write it out whole. */
+            slot_info.is_ok = slots_delete_path (slot_info.be, slot_info.guid,
+                                                 slot_info.path);
+            if (slot_info.is_ok)
+                save_slot (key.c_str(), value, slot_info);
+        }
+        if (!slot_info.is_ok)
+            return;
+    }
+}
+
 gboolean
 gnc_sql_slots_save (GncSqlBackend* sql_be, const GncGUID* guid, gboolean is_infant,
                     QofInstance* inst)
@@ -658,16 +798,21 @@ gnc_sql_slots_save (GncSqlBackend* sql_be, const GncGUID* guid, gboolean is_infa
     g_return_val_if_fail (guid != NULL, FALSE);
     g_return_val_if_fail (pFrame != NULL, FALSE);
 
-    // If this is not saving into a new db, clear out the old saved slots first
-    if (!sql_be->pristine() && !is_infant)
-    {
-        (void)gnc_sql_slots_delete (sql_be, guid);
-    }
-
     slot_info.be = sql_be;
     slot_info.guid = guid;
-    pFrame->for_each_slot_temp (save_slot, slot_info);
 
+    /* New objects and new databases have nothing to replace. Otherwise write
+     * only what changed since the frame was loaded or last saved; a frame
+     * that doesn't know (e.g. a fresh copy) has its saved slots cleared out
+     * and written again.
+     */
+    if (sql_be->pristine() || is_infant)
+        pFrame->for_each_slot_temp (save_slot, slot_info);
+    else if (pFrame->is_dirty())
+        save_dirty_slots (pFrame, slot_info);
+
+    if (slot_info.is_ok)
+        pFrame->mark_clean();
     return slot_info.is_ok;
 }
 
@@ -760,6 +905,7 @@ gnc_sql_slots_load (GncSqlBackend* sql_be, QofInstance* inst)
     info.context = NONE;
 
     slots_load_info (&info);
+    info.pKvpFrame->mark_clean ();
 }
 
 static void
@@ -816,8 +962,8 @@ load_slot_for_list_item (GncSqlBackend* sql_be, GncSqlRow& row,
     slot_info.context = NONE;
 
     gnc_sql_load_object (sql_be, row, TABLE_NAME, &slot_info, col_table);
-
-
+    if (slot_info.pKvpFrame != NULL)
+        slot_info.pKvpFrame->mark_clean ();
 }
 
 static void
@@ -842,6 +988,7 @@ load_slot_for_book_object (GncSqlBackend* sql_be, GncSqlRow& row,
     slot_info.path.clear();
 
     gnc_sql_load_object (sql_be, row, TABLE_NAME, &slot_info, col_table);
+    slot_info.pKvpFrame->mark_clean ();
 }
 
 /**
@@ -70,7 +70,6 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 #define TABLE_COL_NAME "table_name"
 #define VERSION_COL_NAME "table_version"
 
-using StrVec = std::vector<std::string>;
 
 static EntryVec version_table
 {
@@ -81,7 +80,8 @@ static EntryVec version_table
 
 GncSqlBackend::GncSqlBackend(GncSqlConnection *conn, QofBook* book) :
     QofBackend {}, m_conn{conn}, m_book{book}, m_loading{false},
-    m_in_query{false}, m_is_pristine_db{false}
+    m_in_query{false}, m_is_pristine_db{false},
+    m_lazy_tx_load{gnc_prefs_get_sql_lazy_load () != FALSE}
 {
     if (conn != nullptr)
         connect (conn);
@@ -110,6 +110,22 @@ GncSqlBackend::create_statement_from_sql(const std::string& str) const noexcept
 
 GncSqlResultPtr
 GncSqlBackend::execute_select_statement(const GncSqlStatementPtr& stmt) const noexcept
+{
+    if (!flush_pending_inserts())
+        return nullptr;
+    return run_select_statement(stmt);
+}
+
+int
+GncSqlBackend::execute_nonselect_statement(const GncSqlStatementPtr& stmt) const noexcept
+{
+    if (!flush_pending_inserts())
+        return -1;
+    return run_nonselect_statement(stmt);
+}
+
+GncSqlResultPtr
+GncSqlBackend::run_select_statement(const GncSqlStatementPtr& stmt) const noexcept
 {
     auto result = m_conn->execute_select_statement(stmt);
     if (result == nullptr)
@@ -121,7 +137,7 @@ GncSqlBackend::execute_select_statement(const GncSqlStatementPtr& stmt) const no
 }
 
 int
-GncSqlBackend::execute_nonselect_statement(const GncSqlStatementPtr& stmt) const noexcept
+GncSqlBackend::run_nonselect_statement(const GncSqlStatementPtr& stmt) const noexcept
 {
     auto result = m_conn->execute_nonselect_statement(stmt);
     if (result == -1)
@@ -314,7 +330,8 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
     }
     else if (loadType == LOAD_TYPE_LOAD_ALL)
     {
-        // Load all transactions
+        // Load all transactions; there's nothing left to load lazily.
+        m_lazy_tx_load = false;
         auto obe = m_backend_registry.get_object_backend (GNC_ID_TRANS);
         obe->load_all (this);
     }
@@ -463,6 +480,8 @@ GncSqlBackend::sync(QofBook* book)
     /* Save all contents */
     m_book = book;
     auto is_ok = m_conn->begin_transaction();
+    /* Everything is new, so collect the rows for multi-row INSERTs. */
+    m_bulk_insert = m_insert_batch_size > 1;
 
     // FIXME: should write the set of commodities that are used
     // write_commodities(sql_be, book);
@@ -493,6 +512,12 @@ GncSqlBackend::sync(QofBook* book)
             std::get<1>(entry)->write (this);
     }
     if (is_ok)
+    {
+        is_ok = flush_pending_inserts();
+    }
+    m_bulk_insert = false;
+    m_pending_inserts.clear();
+    if (is_ok)
     {
         is_ok = m_conn->commit_transaction();
     }
@@ -824,7 +849,10 @@ GncSqlBackend::object_in_db (const char* table_name, QofIdTypeConst obj_name,
     /* We want only the first item in the table, which should be the PK. */
     values.resize(1);
     stmt->add_where_cond(obj_name, values);
-    auto result = execute_select_statement (stmt);
+    /* Only rows queued for this table can change the answer. */
+    if (!flush_pending_inserts(table_name))
+        return false;
+    auto result = run_select_statement (stmt);
     return (result != nullptr && result->size() > 0);
 }
 
@@ -842,6 +870,8 @@ GncSqlBackend::do_db_operation (E_DB_OPERATION op, const char* table_name,
     switch(op)
     {
         case  OP_DB_INSERT:
+        if (m_bulk_insert)
+            return queue_insert (table_name, obj_name, pObject, table);
         stmt = build_insert_statement (table_name, obj_name, pObject, table);
         break;
         case OP_DB_UPDATE:
@@ -853,7 +883,173 @@ GncSqlBackend::do_db_operation (E_DB_OPERATION op, const char* table_name,
     }
     if (stmt == nullptr)
         return false;
-    return (execute_nonselect_statement(stmt) != -1);
+    if (!flush_pending_inserts(table_name))
+        return false;
+    return (run_nonselect_statement(stmt) != -1);
+}
+
+bool
+GncSqlBackend::update_changed_columns (const char* table_name,
+                                       QofIdTypeConst obj_name,
+                                       gpointer pObject, gpointer pOrig,
+                                       const EntryVec& table) const noexcept
+{
+    g_return_val_if_fail (table_name != nullptr, false);
+    g_return_val_if_fail (obj_name != nullptr, false);
+    g_return_val_if_fail (pObject != nullptr, false);
+    g_return_val_if_fail (pOrig != nullptr, false);
+
+    PairVec values{get_object_values (obj_name, pObject, table)};
+    PairVec orig_values{get_object_values (obj_name, pOrig, table)};
+    if (values.empty())
+        return false;
+    if (orig_values.size() != values.size())
+        return do_db_operation (OP_DB_UPDATE, table_name, obj_name, pObject,
+                                table);
+
+    /* The first column is the primary key, which the copy may not share. */
+    PairVec changed;
+    for (auto col_value = values.begin() + 1; col_value != values.end();
+         ++col_value)
+    {
+        auto orig = std::find_if(orig_values.begin() + 1, orig_values.end(),
+                                 [&col_value](const PairVec::value_type& p) {
+                                     return p.first == col_value->first; });
+        if (orig == orig_values.end() || orig->second != col_value->second)
+            changed.push_back(*col_value);
+    }
+    if (changed.empty())
+        return true;
+
+    std::ostringstream sql;
+    sql <<  "UPDATE " << table_name << " SET ";
+    for (auto const& col_value : changed)
+    {
+        if (col_value != *changed.begin())
+            sql << ",";
+        sql << col_value.first << "=" << col_value.second;
+    }
+    auto stmt = create_statement_from_sql(sql.str());
+    if (stmt == nullptr)
+        return false;
+    values.erase(values.begin() + 1, values.end());
+    stmt->add_where_cond(obj_name, values);
+    if (!flush_pending_inserts(table_name))
+        return false;
+    return (run_nonselect_statement(stmt) != -1);
+}
+
+bool
+GncSqlBackend::queue_insert (const char* table_name, QofIdTypeConst obj_name,
+                             gpointer pObject, const EntryVec& table) const noexcept
+{
+    PairVec values{get_object_values(obj_name, pObject, table)};
+    StrVec columns, row;
+    columns.reserve(values.size());
+    row.reserve(values.size());
+    for (auto& col_value : values)
+    {
+        columns.push_back(std::move(col_value.first));
+        row.push_back(std::move(col_value.second));
+    }
+
+    auto batch = std::find_if(m_pending_inserts.begin(), m_pending_inserts.end(),
+                              [table_name, &columns](const PendingInserts& p) {
+                                  return p.table == table_name &&
+                                      p.columns == columns; });
+    if (batch == m_pending_inserts.end())
+    {
+        m_pending_inserts.push_back({table_name, std::move(columns), {}});
+        batch = m_pending_inserts.end() - 1;
+        batch->rows.reserve(m_insert_batch_size);
+    }
+    batch->rows.push_back(std::move(row));
+    if (batch->rows.size() < m_insert_batch_size)
+        return true;
+    return flush_inserts(*batch);
+}
+
+bool
+GncSqlBackend::flush_inserts (PendingInserts& batch) const noexcept
+{
+    if (batch.rows.empty())
+        return true;
+    auto result = m_conn->execute_bulk_insert(batch.table, batch.columns,
+                                              batch.rows);
+    if (result == -1)
+    {
+        PERR ("SQL error inserting %zu rows into %s\n", batch.rows.size(),
+              batch.table.c_str());
+        qof_backend_set_error ((QofBackend*)this, ERR_BACKEND_SERVER_ERR);
+    }
+    batch.rows.clear();
+    return result != -1;
+}
+
+StrVec
+gnc_sql_bulk_insert_statements (const std::string& table_name,
+                                const StrVec& columns,
+                                const std::vector<StrVec>& rows,
+                                std::size_t max_rows,
+                                std::size_t max_bytes) noexcept
+{
+    std::string prefix{"INSERT INTO " + table_name + "("};
+    for (auto col = columns.begin(); col != columns.end(); ++col)
+    {
+        if (col != columns.begin())
+            prefix += ",";
+        prefix += *col;
+    }
+    prefix += ") VALUES";
+
+    StrVec statements;
+    std::string sql;
+    std::size_t num_rows = 0;
+    for (const auto& row : rows)
+    {
+        std::string values{"("};
+        for (auto value = row.begin(); value != row.end(); ++value)
+        {
+            if (value != row.begin())
+                values += ",";
+            values += *value;
+        }
+        values += ")";
+
+        if (num_rows > 0 && (num_rows >= max_rows ||
+                             sql.size() + 1 + values.size() > max_bytes))
+        {
+            statements.push_back(std::move(sql));
+            num_rows = 0;
+        }
+        if (num_rows == 0)
+            sql = prefix + values;
+        else
+            sql += "," + values;
+        ++num_rows;
+    }
+    if (num_rows > 0)
+        statements.push_back(std::move(sql));
+    return statements;
+}
+
+bool
+GncSqlBackend::flush_pending_inserts (const std::string& table_name) const noexcept
+{
+    bool is_ok = true;
+    for (auto& batch : m_pending_inserts)
+        if (batch.table == table_name)
+            is_ok = flush_inserts(batch) && is_ok;
+    return is_ok;
+}
+
+bool
+GncSqlBackend::flush_pending_inserts () const noexcept
+{
+    bool is_ok = true;
+    for (auto& batch : m_pending_inserts)
+        is_ok = flush_inserts(batch) && is_ok;
+    return is_ok;
 }
 
 bool
@@ -49,6 +49,7 @@ class GncSqlResult;
 using GncSqlResultPtr = GncSqlResult*;
 using VersionPair = std::pair<const std::string, unsigned int>;
 using VersionVec = std::vector<VersionPair>;
+using StrVec = std::vector<std::string>;
 using uint_t = unsigned int;
 
 typedef enum
@@ -226,6 +227,23 @@ public:
     bool do_db_operation (E_DB_OPERATION op, const char* table_name,
                           QofIdTypeConst obj_name, gpointer pObject,
                           const EntryVec& table) const noexcept;
+    /**
+     * Updates only the columns of an object's row whose values differ from
+     * those of a copy of the object taken before it was edited, e.g. the
+     * rollback copy of a transaction. Nothing is written if no column
+     * changed.
+     *
+     * @param table_name SQL table name
+     * @param obj_name QOF object type name
+     * @param pObject Gnucash object
+     * @param pOrig Unedited copy of pObject; its primary key is ignored.
+     * @param table DB table description
+     * @return TRUE if successful, FALSE if not
+     */
+    bool update_changed_columns (const char* table_name,
+                                 QofIdTypeConst obj_name, gpointer pObject,
+                                 gpointer pOrig,
+                                 const EntryVec& table) const noexcept;
     /**
      * Ensure that a commodity referenced in another object is in fact saved
      * in the database.
@@ -236,9 +254,30 @@ public:
     bool save_commodity(gnc_commodity* comm) noexcept;
     QofBook* book() const noexcept { return m_book; }
     void set_loading(bool loading) noexcept { m_loading = loading; }
+    bool loading() const noexcept { return m_loading; }
     bool pristine() const noexcept { return m_is_pristine_db; }
     void update_progress(double pct) const noexcept;
     void finish_progress() const noexcept;
+    /**
+     * Set the number of rows that sync() collects for each table before
+     * writing them with a single multi-row INSERT. 0 or 1 writes every row
+     * with its own statement.
+     *
+     * @param size Number of rows per batch
+     */
+    void set_insert_batch_size(uint_t size) noexcept { m_insert_batch_size = size; }
+    /**
+     * Load transactions only when they're needed instead of all of them when
+     * the book is opened. Each account gets its balances from a query and
+     * loads its transactions the first time its splits are wanted. The
+     * default comes from the general/sql-lazy-load preference, read when
+     * the backend is created. Loading everything, e.g. with
+     * qof_session_ensure_all_data_loaded(), turns it off.
+     *
+     * @param lazy Whether to defer loading transactions.
+     */
+    void set_lazy_tx_load(bool lazy) noexcept { m_lazy_tx_load = lazy; }
+    bool lazy_tx_load() const noexcept { return m_lazy_tx_load; }
 
 protected:
     GncSqlConnection* m_conn = nullptr;  /**< SQL connection */
@@ -248,7 +287,25 @@ protected:
     bool m_is_pristine_db; /**< Are we saving to a new pristine db? */
     const char* m_time_format = nullptr; /**< Server-specific date-time string format */
     VersionVec m_versions;    /**< Version number for each table */
+    uint_t m_insert_batch_size = 250; /**< Rows per multi-row INSERT in sync() */
+    bool m_bulk_insert = false; /**< Queue INSERTs rather than executing them */
+    bool m_lazy_tx_load = false; /**< Load transactions per account on demand */
 private:
+    /** Rows for one table and set of columns waiting to be inserted. */
+    struct PendingInserts
+    {
+        std::string table;
+        StrVec columns;
+        std::vector<StrVec> rows;
+    };
+    bool queue_insert (const char* table_name, QofIdTypeConst obj_name,
+                       gpointer pObject, const EntryVec& table) const noexcept;
+    bool flush_inserts (PendingInserts& batch) const noexcept;
+    /** Write any queued rows for the table, or for all tables. */
+    bool flush_pending_inserts (const std::string& table_name) const noexcept;
+    bool flush_pending_inserts () const noexcept;
+    GncSqlResultPtr run_select_statement(const GncSqlStatementPtr& stmt) const noexcept;
+    int run_nonselect_statement(const GncSqlStatementPtr& stmt) const noexcept;
     bool write_account_tree(Account*);
     bool write_accounts();
     bool write_transactions();
@@ -288,6 +345,7 @@ private:
     };
     ObjectBackendRegistry m_backend_registry;
     std::vector<gnc_commodity*> m_postload_commodities;
+    mutable std::vector<PendingInserts> m_pending_inserts;
 };
 
 #endif //__GNC_SQL_BACKEND_HPP__
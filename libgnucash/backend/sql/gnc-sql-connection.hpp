@@ -38,6 +38,7 @@ class GncSqlColumnTableEntry;
 using GncSqlColumnTableEntryPtr = std::shared_ptr<GncSqlColumnTableEntry>;
 using EntryVec = std::vector<GncSqlColumnTableEntryPtr>;
 using PairVec = std::vector<std::pair<std::string, std::string>>;
+using StrVec = std::vector<std::string>;
 struct GncSqlColumnInfo;
 using ColVec = std::vector<GncSqlColumnInfo>;
 
@@ -68,6 +69,14 @@ public:
     /** Returns false if error */
     virtual int execute_nonselect_statement (const GncSqlStatementPtr&)
         noexcept = 0;
+    /** Insert rows into a table using as few statements as the database
+     * allows. Each row holds the already-quoted values of the columns in
+     * order.
+     * Returns the number of rows inserted, -1 if error */
+    virtual int execute_bulk_insert (const std::string& table_name,
+                                     const StrVec& columns,
+                                     const std::vector<StrVec>& rows)
+        noexcept = 0;
     virtual GncSqlStatementPtr create_statement_from_sql (const std::string&)
         const noexcept = 0;
     /** Returns true if successful */
@@ -100,5 +109,16 @@ public:
 
 };
 
+/**
+ * Build the multi-row INSERT statements for a batch of rows. A statement
+ * carries at most max_rows rows and, unless a single row is longer than
+ * that by itself, at most max_bytes characters of SQL.
+ */
+StrVec gnc_sql_bulk_insert_statements (const std::string& table_name,
+                                       const StrVec& columns,
+                                       const std::vector<StrVec>& rows,
+                                       std::size_t max_rows,
+                                       std::size_t max_bytes) noexcept;
+
 
 #endif //__GNC_SQL_CONNECTION_HPP__
@@ -37,7 +37,9 @@ extern "C"
 #include "qofquerycore-p.h"
 
 #include "Account.h"
+#include "AccountP.h"
 #include "Transaction.h"
+#include "TransactionP.h"
 #include <Scrub.h>
 #include "gnc-lot.h"
 #include "engine-helpers.h"
@@ -49,6 +51,7 @@ extern "C"
 #endif
 }
 
+#include <map>
 #include <string>
 #include <sstream>
 
@@ -99,6 +102,7 @@ static const EntryVec tx_col_table
 static  gpointer get_split_reconcile_state (gpointer pObject);
 static void set_split_reconcile_state (gpointer pObject,  gpointer pValue);
 static void set_split_lot (gpointer pObject,  gpointer pLot);
+static void prepare_lazy_load (GncSqlBackend* sql_be);
 
 #define SPLIT_MAX_MEMO_LEN 2048
 #define SPLIT_MAX_ACTION_LEN 2048
@@ -324,6 +328,92 @@ typedef struct
     gnc_numeric end_reconciled_bal;
 } full_acct_balances_t;
 
+/* When transactions are loaded lazily, each account whose transactions are
+ * still in the database has a split loader and carries the balances of its
+ * splits, summed by the database, as its starting balances. Splits of those
+ * accounts that come in with other transactions are taken out of the starting
+ * balances so that the end balances stay put; once an account has loaded its
+ * own transactions it has all of its splits and starting balances of zero.
+ */
+using AcctBalanceMap = std::map<Account*, acct_balances_t>;
+
+static acct_balances_t&
+get_acct_balances (AcctBalanceMap& balances, Account* acct)
+{
+    auto bal = balances.find (acct);
+    if (bal == balances.end ())
+        bal = balances.emplace (acct, acct_balances_t{acct,
+                                                      gnc_numeric_zero (),
+                                                      gnc_numeric_zero (),
+                                                      gnc_numeric_zero ()}).first;
+    return bal->second;
+}
+
+/* Add an amount the way xaccAccountRecomputeBalance() does. */
+static void
+add_to_acct_balances (acct_balances_t& bal, gnc_numeric amount,
+                      char reconcile_state)
+{
+    bal.balance = gnc_numeric_add (bal.balance, amount, GNC_DENOM_AUTO,
+                                   GNC_HOW_DENOM_LCD);
+    if (reconcile_state != NREC)
+        bal.cleared_balance = gnc_numeric_add (bal.cleared_balance, amount,
+                                               GNC_DENOM_AUTO,
+                                               GNC_HOW_DENOM_LCD);
+    if (reconcile_state == YREC || reconcile_state == FREC)
+        bal.reconciled_balance = gnc_numeric_add (bal.reconciled_balance,
+                                                  amount, GNC_DENOM_AUTO,
+                                                  GNC_HOW_DENOM_LCD);
+}
+
+static void
+set_start_balances (const acct_balances_t& bal)
+{
+    gnc_account_set_start_balance (bal.acct, bal.balance);
+    gnc_account_set_start_cleared_balance (bal.acct, bal.cleared_balance);
+    gnc_account_set_start_reconciled_balance (bal.acct, bal.reconciled_balance);
+    xaccAccountRecomputeBalance (bal.acct);
+}
+
+/* Take the splits of newly loaded transactions out of the starting balances
+ * of the accounts that haven't loaded their own transactions yet.
+ */
+static void
+deduct_loaded_splits (const InstanceVec& instances)
+{
+    AcctBalanceMap loaded;
+    for (auto inst : instances)
+    {
+        for (auto node = xaccTransGetSplitList (GNC_TRANSACTION (inst));
+             node != nullptr; node = node->next)
+        {
+            auto split = GNC_SPLIT (node->data);
+            auto acct = xaccSplitGetAccount (split);
+            if (acct == nullptr || !gnc_account_has_split_loader (acct))
+                continue;
+            add_to_acct_balances (get_acct_balances (loaded, acct),
+                                  xaccSplitGetAmount (split),
+                                  xaccSplitGetReconcile (split));
+        }
+    }
+
+    for (auto const& entry : loaded)
+    {
+        auto acct = entry.first;
+        auto const& bal = entry.second;
+        set_start_balances ({acct,
+                gnc_numeric_sub (gnc_account_get_start_balance (acct),
+                                 bal.balance, GNC_DENOM_AUTO,
+                                 GNC_HOW_DENOM_LCD),
+                gnc_numeric_sub (gnc_account_get_start_cleared_balance (acct),
+                                 bal.cleared_balance, GNC_DENOM_AUTO,
+                                 GNC_HOW_DENOM_LCD),
+                gnc_numeric_sub (gnc_account_get_start_reconciled_balance (acct),
+                                 bal.reconciled_balance, GNC_DENOM_AUTO,
+                                 GNC_HOW_DENOM_LCD)});
+    }
+}
+
 /**
  * Executes a transaction query statement and loads the transactions and all
  * of the splits.
@@ -392,6 +482,8 @@ query_transactions (GncSqlBackend* sql_be, std::string selector)
     for (auto instance : instances)
          xaccTransCommitEdit(GNC_TRANSACTION(instance));
 
+    if (sql_be->lazy_tx_load())
+        deduct_loaded_splits (instances);
 }
 
 
@@ -525,6 +617,30 @@ delete_splits (GncSqlBackend* sql_be, Transaction* pTx)
     return split_info.is_ok;
 }
 
+/**
+ * Finds the rollback copy of a split in its transaction's rollback copy, i.e.
+ * the split as it was when the transaction was opened for editing and so as
+ * it was last saved.
+ *
+ * @param pSplit Split
+ * @return The copy, or nullptr if the transaction isn't being edited or the
+ * split wasn't in it when the edit began.
+ */
+static Split*
+get_orig_split (Split* pSplit)
+{
+    auto pTx = xaccSplitGetParent (pSplit);
+    if (pTx == nullptr || pTx->orig == nullptr)
+        return nullptr;
+    for (auto node = pTx->orig->splits; node != nullptr; node = node->next)
+    {
+        auto orig = GNC_SPLIT (node->data);
+        if (qof_instance_guid_compare (orig, pSplit) == 0)
+            return orig;
+    }
+    return nullptr;
+}
+
 /**
  * Commits a split to the database
  *
@@ -563,8 +679,18 @@ GncSqlSplitBackend::commit (GncSqlBackend* sql_be, QofInstance* inst)
         qof_instance_set_guid (inst, guid);
     }
 
-    is_ok = sql_be->do_db_operation(op, SPLIT_TABLE, GNC_ID_SPLIT,
-                                    inst, split_col_table);
+    /* An edit usually touches one or two columns of one split, e.g. its
+     * amount or reconcile flag, and the other splits are only committed
+     * because the transaction marked them dirty, so write just what differs
+     * from the rollback copy.
+     */
+    auto orig = op == OP_DB_UPDATE ? get_orig_split (GNC_SPLIT (inst)) : nullptr;
+    if (orig != nullptr)
+        is_ok = sql_be->update_changed_columns (SPLIT_TABLE, GNC_ID_SPLIT, inst,
+                                                orig, split_col_table);
+    else
+        is_ok = sql_be->do_db_operation(op, SPLIT_TABLE, GNC_ID_SPLIT,
+                                        inst, split_col_table);
 
     if (is_ok && !qof_instance_get_destroying (inst))
     {
@@ -614,8 +740,13 @@ GncSqlTransBackend::commit (GncSqlBackend* sql_be, QofInstance* inst)
 
     if (is_ok)
     {
-        is_ok = sql_be->do_db_operation(op, TRANSACTION_TABLE, GNC_ID_TRANS,
-                                        pTx, tx_col_table);
+        if (op == OP_DB_UPDATE && pTx->orig != nullptr)
+            is_ok = sql_be->update_changed_columns (TRANSACTION_TABLE,
+                                                    GNC_ID_TRANS, pTx,
+                                                    pTx->orig, tx_col_table);
+        else
+            is_ok = sql_be->do_db_operation(op, TRANSACTION_TABLE, GNC_ID_TRANS,
+                                            pTx, tx_col_table);
         if (! is_ok)
         {
             err = "Transaction header save failed. Check trace log for SQL errors";
@@ -706,7 +837,8 @@ void gnc_sql_transaction_load_tx_for_account (GncSqlBackend* sql_be,
 
 /**
  * Loads all transactions.  This might be used during a save-as operation to ensure that
- * all data is in memory and ready to be saved.
+ * all data is in memory and ready to be saved.  If the backend loads
+ * transactions lazily this only sets that up; see prepare_lazy_load().
  *
  * @param sql_be SQL backend
  */
@@ -715,12 +847,31 @@ GncSqlTransBackend::load_all (GncSqlBackend* sql_be)
 {
     g_return_if_fail (sql_be != NULL);
 
+    if (sql_be->lazy_tx_load())
+    {
+        prepare_lazy_load (sql_be);
+        return;
+    }
+
     auto root = gnc_book_get_root_account (sql_be->book());;
     gnc_account_foreach_descendant(root, (AccountCb)xaccAccountBeginEdit,
                                    nullptr);
     query_transactions (sql_be, "");
     gnc_account_foreach_descendant(root, (AccountCb)xaccAccountCommitEdit,
                                    nullptr);
+
+    /* Accounts left over from lazy loading have all their splits now. */
+    auto descendants = gnc_account_get_descendants (root);
+    for (auto node = descendants; node != nullptr; node = node->next)
+    {
+        auto acct = GNC_ACCOUNT (node->data);
+        if (!gnc_account_has_split_loader (acct))
+            continue;
+        gnc_account_set_split_loader (acct, nullptr, nullptr);
+        set_start_balances ({acct, gnc_numeric_zero (), gnc_numeric_zero (),
+                             gnc_numeric_zero ()});
+    }
+    g_list_free (descendants);
 }
 
 static void
@@ -944,6 +1095,67 @@ static const EntryVec acct_balances_col_table
                                          (QofSetterFunc)set_acct_bal_balance),
 };
 
+/* The split loader for lazy loading. */
+static void
+load_account_transactions (Account* acct, gpointer data)
+{
+    auto sql_be = static_cast<GncSqlBackend*>(data);
+    auto loading = sql_be->loading();
+
+    sql_be->set_loading (true);
+    gnc_sql_transaction_load_tx_for_account (sql_be, acct);
+    sql_be->set_loading (loading);
+    set_start_balances ({acct, gnc_numeric_zero (), gnc_numeric_zero (),
+                         gnc_numeric_zero ()});
+}
+
+/**
+ * Sets up lazy loading: gives every account a split loader and its balances,
+ * summed per reconcile state in the database, as starting balances. Splits
+ * are grouped by denominator as well because only the numerators can be
+ * summed.
+ *
+ * @param sql_be SQL backend
+ */
+static void
+prepare_lazy_load (GncSqlBackend* sql_be)
+{
+    auto root = gnc_book_get_root_account (sql_be->book());
+    auto descendants = gnc_account_get_descendants (root);
+    for (auto node = descendants; node != nullptr; node = node->next)
+        gnc_account_set_split_loader (GNC_ACCOUNT (node->data),
+                                      load_account_transactions, sql_be);
+    g_list_free (descendants);
+
+    const std::string sakey(acct_balances_col_table[0]->name());
+    const std::string srkey(acct_balances_col_table[1]->name());
+    const std::string sqkey(acct_balances_col_table[2]->name());
+    std::string sql("SELECT ");
+    sql += sakey + ", " + srkey + ", SUM(" + sqkey + "_num) AS " + sqkey +
+        "_num, " + sqkey + "_denom FROM " SPLIT_TABLE " GROUP BY " + sakey +
+        ", " + srkey + ", " + sqkey + "_denom";
+    auto stmt = sql_be->create_statement_from_sql(sql);
+    auto result = sql_be->execute_select_statement(stmt);
+    if (result == nullptr)
+        return;
+
+    AcctBalanceMap balances;
+    for (auto row : *result)
+    {
+        single_acct_balance_t bal{sql_be, nullptr, NREC, gnc_numeric_zero ()};
+        gnc_sql_load_object (sql_be, row, nullptr, &bal,
+                             acct_balances_col_table);
+        if (bal.acct == nullptr || !gnc_account_has_split_loader (bal.acct))
+            continue;
+        add_to_acct_balances (get_acct_balances (balances, bal.acct),
+                              bal.balance, bal.reconcile_state);
+    }
+    delete result;
+
+    for (auto const& entry : balances)
+        set_start_balances (entry.second);
+}
+
 /* ----------------------------------------------------------------- */
 template<> void
 GncSqlColumnTableEntryImpl<CT_TXREF>::load (const GncSqlBackend* sql_be,
@@ -26,11 +26,17 @@ extern "C"
 #include <string.h>
 #include <glib.h>
 #include <unittest-support.h>
+#include <Account.h>
+#include <Transaction.h>
+#include <gnc-commodity.h>
 }
 /* Add specific headers for this class */
 #include "../gnc-sql-connection.hpp"
 #include "../gnc-sql-backend.hpp"
 #include "../gnc-sql-result.hpp"
+#include "../gnc-sql-column-table-entry.hpp"
+#include "../gnc-sql-object-backend.hpp"
+#include "../gnc-transaction-sql.h"
 
 static const gchar* suitename = "/backend/sql/gnc-backend-sql";
 void test_suite_gnc_backend_sql (void);
@@ -43,6 +49,7 @@ public:
     void session_begin(QofSession*, const char*, bool, bool, bool) override {}
     void session_end() override {}
     void safe_sync(QofBook* book) override { sync(book); }
+    void set_bulk_insert(bool bulk) noexcept { m_bulk_insert = bulk; }
 };
 
 class GncMockSqlConnection;
@@ -101,6 +108,9 @@ public:
         noexcept override { return &m_result; }
     int execute_nonselect_statement (const GncSqlStatementPtr&)
         noexcept override { return 1; }
+    int execute_bulk_insert (const std::string&, const StrVec&,
+                             const std::vector<StrVec>& rows)
+        noexcept override { return rows.size(); }
     GncSqlStatementPtr create_statement_from_sql (const std::string&)
         const noexcept override {
         return std::unique_ptr<GncMockSqlStatement>(new GncMockSqlStatement); }
@@ -125,6 +135,37 @@ private:
     GncMockSqlResult m_result;
 };
 
+/* Records the SQL it's asked to prepare and the batches it's asked to
+ * insert instead of executing them. */
+class GncRecordingSqlConnection : public GncMockSqlConnection
+{
+public:
+    GncSqlStatementPtr create_statement_from_sql (const std::string& sql)
+        const noexcept override {
+        m_sql.push_back(sql);
+        return GncMockSqlConnection::create_statement_from_sql(sql); }
+    StrVec updates(const std::string& table) const {
+        StrVec retval;
+        auto prefix = "UPDATE " + table + " ";
+        for (auto& sql : m_sql)
+            if (sql.compare(0, prefix.size(), prefix) == 0)
+                retval.push_back(sql);
+        return retval; }
+    struct BulkInsert
+    {
+        std::string table;
+        StrVec columns;
+        std::vector<StrVec> rows;
+    };
+    int execute_bulk_insert (const std::string& table, const StrVec& columns,
+                             const std::vector<StrVec>& rows)
+        noexcept override {
+        m_inserts.push_back({table, columns, rows});
+        return rows.size(); }
+    std::vector<BulkInsert> m_inserts;
+    mutable StrVec m_sql;
+};
+
 /* gnc_sql_init
 void
 gnc_sql_init (GncSqlBackend* sql_be)// C: 1 */
@@ -337,6 +378,209 @@ test_gnc_sql_commit_edit (void)
     g_object_unref (book);
     delete sql_be;
 }
+
+static void
+test_gnc_sql_bulk_insert (void)
+{
+    GncRecordingSqlConnection conn;
+    const EntryVec table
+    {
+        gnc_sql_make_table_entry<CT_STRING>("name", 2048, COL_NNUL, "name"),
+        gnc_sql_make_table_entry<CT_STRING>("description", 2048, 0,
+                                            "description"),
+    };
+
+    qof_object_initialize ();
+    auto book = qof_book_new();
+    auto sql_be = new GncMockSqlBackend (&conn, book);
+    Account* accts[3];
+    const char* names[] = {"Assets", "Bob's", "Cash"};
+    for (int i = 0; i < 3; ++i)
+    {
+        accts[i] = xaccMallocAccount (book);
+        xaccAccountBeginEdit (accts[i]);
+        xaccAccountSetName (accts[i], names[i]);
+        xaccAccountSetDescription (accts[i], "desc");
+        xaccAccountCommitEdit (accts[i]);
+    }
+
+    sql_be->set_insert_batch_size (2);
+    sql_be->set_bulk_insert (true);
+    g_assert (sql_be->do_db_operation (OP_DB_INSERT, "accounts",
+                                       GNC_ID_ACCOUNT, accts[0], table));
+    g_assert_cmpint (conn.m_inserts.size(), ==, 0);
+    g_assert (sql_be->do_db_operation (OP_DB_INSERT, "accounts",
+                                       GNC_ID_ACCOUNT, accts[1], table));
+    /* A full batch is flushed at once. */
+    g_assert_cmpint (conn.m_inserts.size(), ==, 1);
+    g_assert (sql_be->do_db_operation (OP_DB_INSERT, "accounts",
+                                       GNC_ID_ACCOUNT, accts[2], table));
+    g_assert_cmpint (conn.m_inserts.size(), ==, 1);
+    /* Any other statement on the table flushes what's pending first. */
+    g_assert (sql_be->do_db_operation (OP_DB_UPDATE, "accounts",
+                                       GNC_ID_ACCOUNT, accts[0], table));
+    g_assert_cmpint (conn.m_inserts.size(), ==, 2);
+    g_assert_cmpint (conn.m_inserts[1].rows.size(), ==, 1);
+
+    auto& batch = conn.m_inserts[0];
+    g_assert_cmpstr (batch.table.c_str(), ==, "accounts");
+    g_assert_cmpint (batch.rows.size(), ==, 2);
+    auto statements = gnc_sql_bulk_insert_statements (batch.table,
+                                                      batch.columns,
+                                                      batch.rows, 1000,
+                                                      1000000);
+    g_assert_cmpint (statements.size(), ==, 1);
+    g_assert_cmpstr (statements[0].c_str(), ==,
+                     "INSERT INTO accounts(name,description) VALUES"
+                     "('Assets','desc'),('Bob''s','desc')");
+
+    /* Both limits start a new statement, and a row too long for the byte
+     * limit still goes out, by itself. */
+    std::vector<StrVec> rows{{"'a'"}, {"'b'"}, {"'c'"},
+                             {"'" + std::string(40, 'x') + "'"}, {"'d'"}};
+    StrVec columns{"name"};
+    statements = gnc_sql_bulk_insert_statements ("t", columns, rows, 2,
+                                                 1000000);
+    g_assert_cmpint (statements.size(), ==, 3);
+    g_assert_cmpstr (statements[0].c_str(), ==,
+                     "INSERT INTO t(name) VALUES('a'),('b')");
+    g_assert_cmpstr (statements[2].c_str(), ==,
+                     "INSERT INTO t(name) VALUES('d')");
+    statements = gnc_sql_bulk_insert_statements ("t", columns, rows, 1000,
+                                                 43);
+    g_assert_cmpint (statements.size(), ==, 3);
+    g_assert_cmpstr (statements[0].c_str(), ==,
+                     "INSERT INTO t(name) VALUES('a'),('b'),('c')");
+    g_assert_cmpint (statements[1].size(), >, 43);
+    g_assert_cmpstr (statements[2].c_str(), ==,
+                     "INSERT INTO t(name) VALUES('d')");
+    for (auto& sql : statements)
+        if (sql != statements[1])
+            g_assert_cmpint (sql.size(), <=, 43);
+    g_assert (gnc_sql_bulk_insert_statements ("t", columns, {}, 2, 43).empty());
+
+    for (auto acct : accts)
+    {
+        xaccAccountBeginEdit (acct);
+        xaccAccountDestroy (acct);
+    }
+    delete sql_be;
+    qof_book_destroy (book);
+}
+static void
+test_gnc_sql_update_changed_columns (void)
+{
+    GncRecordingSqlConnection conn;
+    const EntryVec table
+    {
+        gnc_sql_make_table_entry<CT_GUID>("guid", 0, COL_NNUL | COL_PKEY,
+                                          "guid"),
+        gnc_sql_make_table_entry<CT_STRING>("name", 2048, COL_NNUL, "name"),
+        gnc_sql_make_table_entry<CT_STRING>("description", 2048, 0,
+                                            "description"),
+    };
+
+    qof_object_initialize ();
+    auto book = qof_book_new();
+    auto sql_be = new GncMockSqlBackend (&conn, book);
+    auto acct = xaccMallocAccount (book);
+    auto orig = xaccMallocAccount (book);
+    for (auto a : {acct, orig})
+    {
+        xaccAccountBeginEdit (a);
+        xaccAccountSetName (a, "Checking");
+        xaccAccountSetDescription (a, "Old");
+        xaccAccountCommitEdit (a);
+    }
+
+    /* Nothing differs, so nothing is written. */
+    g_assert (sql_be->update_changed_columns ("accounts", GNC_ID_ACCOUNT,
+                                              acct, orig, table));
+    g_assert_cmpint (conn.m_sql.size(), ==, 0);
+
+    /* Only the changed column is written; the primary key, which the copy
+     * doesn't share, is never compared. */
+    xaccAccountBeginEdit (acct);
+    xaccAccountSetDescription (acct, "New");
+    xaccAccountCommitEdit (acct);
+    g_assert (sql_be->update_changed_columns ("accounts", GNC_ID_ACCOUNT,
+                                              acct, orig, table));
+    g_assert_cmpint (conn.m_sql.size(), ==, 1);
+    g_assert_cmpstr (conn.m_sql[0].c_str(), ==,
+                     "UPDATE accounts SET description='New'");
+
+    for (auto a : {acct, orig})
+    {
+        xaccAccountBeginEdit (a);
+        xaccAccountDestroy (a);
+    }
+    delete sql_be;
+    qof_book_destroy (book);
+}
+
+static void
+test_gnc_sql_split_commit_changed_columns (void)
+{
+    GncRecordingSqlConnection conn;
+    GncSqlSplitBackend split_be;
+
+    qof_object_initialize ();
+    auto book = qof_book_new();
+    auto sql_be = new GncMockSqlBackend (&conn, book);
+    auto currency = gnc_commodity_new (book, "Canadian Dollar", "CURRENCY",
+                                       "CAD", "124", 100);
+    auto acct = xaccMallocAccount (book);
+    xaccAccountBeginEdit (acct);
+    xaccAccountSetCommodity (acct, currency);
+    xaccAccountCommitEdit (acct);
+
+    auto trans = xaccMallocTransaction (book);
+    auto split = xaccMallocSplit (book);
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, currency);
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetAccount (split, acct);
+    xaccSplitSetMemo (split, "Old memo");
+    xaccTransCommitEdit (trans);
+
+    /* Outside an edit the split has no rollback copy to compare with, so
+     * the whole row is written. */
+    g_assert (split_be.commit (sql_be, QOF_INSTANCE (split)));
+    auto updates = conn.updates ("splits");
+    g_assert_cmpint (updates.size(), ==, 1);
+    g_assert (updates[0].find ("tx_guid=") != std::string::npos);
+    g_assert (updates[0].find ("memo='Old memo'") != std::string::npos);
+    g_assert (updates[0].find ("action=") != std::string::npos);
+    g_assert (updates[0].find ("quantity_num=") != std::string::npos);
+
+    /* Inside an edit only the columns that differ from the transaction's
+     * copy of the split are written. */
+    conn.m_sql.clear();
+    xaccTransBeginEdit (trans);
+    xaccSplitSetMemo (split, "New memo");
+    g_assert (split_be.commit (sql_be, QOF_INSTANCE (split)));
+    updates = conn.updates ("splits");
+    g_assert_cmpint (updates.size(), ==, 1);
+    g_assert_cmpstr (updates[0].c_str(), ==,
+                     "UPDATE splits SET memo='New memo'");
+
+    /* A split the transaction left alone writes nothing. */
+    conn.m_sql.clear();
+    xaccSplitSetMemo (split, "Old memo");
+    g_assert (split_be.commit (sql_be, QOF_INSTANCE (split)));
+    g_assert_cmpint (conn.updates ("splits").size(), ==, 0);
+    xaccTransCommitEdit (trans);
+
+    xaccTransBeginEdit (trans);
+    xaccTransDestroy (trans);
+    xaccTransCommitEdit (trans);
+    xaccAccountBeginEdit (acct);
+    xaccAccountDestroy (acct);
+    gnc_commodity_destroy (currency);
+    delete sql_be;
+    qof_book_destroy (book);
+}
+
 /* handle_and_term
 static void
 handle_and_term (QofQueryTerm* pTerm, GString* sql)// 2
@@ -857,6 +1101,9 @@ test_suite_gnc_backend_sql (void)
 // GNC_TEST_ADD (suitename, "gnc sql rollback edit", Fixture, nullptr, test_gnc_sql_rollback_edit,  teardown);
 // GNC_TEST_ADD (suitename, "commit cb", Fixture, nullptr, test_commit_cb,  teardown);
     GNC_TEST_ADD_FUNC (suitename, "gnc sql commit edit", test_gnc_sql_commit_edit);
+    GNC_TEST_ADD_FUNC (suitename, "gnc sql bulk insert", test_gnc_sql_bulk_insert);
+    GNC_TEST_ADD_FUNC (suitename, "gnc sql update changed columns", test_gnc_sql_update_changed_columns);
+    GNC_TEST_ADD_FUNC (suitename, "gnc sql split commit changed columns", test_gnc_sql_split_commit_changed_columns);
 // GNC_TEST_ADD (suitename, "handle and term", Fixture, nullptr, test_handle_and_term,  teardown);
 // GNC_TEST_ADD (suitename, "compile query cb", Fixture, nullptr, test_compile_query_cb,  teardown);
 // GNC_TEST_ADD (suitename, "gnc sql compile query", Fixture, nullptr, test_gnc_sql_compile_query,  teardown);
@@ -302,3 +302,74 @@ gnc_commodity_sixtp_parser_create (void)
 {
     return sixtp_dom_parser_new (gnc_commodity_end_handler, NULL, NULL);
 }
+
+/* <trn:currency>, <price:commodity> and friends: a reference to a
+   commodity that is already in the book's commodity table.
+
+     <price:commodity>
+       <cmdty:space>NASDAQ</cmdty:space>
+       <cmdty:id>RHAT</cmdty:id>
+     </price:commodity>
+
+   Returns the table's gnc_commodity* as the result.  The table owns
+   it, so there is no cleanup.  If the commodity isn't in the table
+   there's no result and it's up to the parent whether that matters.
+*/
+static gboolean
+gnc_commodity_ref_end_handler (gpointer data_for_children,
+                               GSList* data_from_children, GSList* sibling_data,
+                               gpointer parent_data, gpointer global_data,
+                               gpointer* result, const gchar* tag)
+{
+    gxpf_data* gdata = (gxpf_data*)global_data;
+    QofBook* book = static_cast<decltype (book)> (gdata->bookdata);
+    const gchar* space_str = NULL;
+    const gchar* id_str = NULL;
+    GSList* lp;
+
+    for (lp = data_from_children; lp; lp = lp->next)
+    {
+        sixtp_child_result* cr = static_cast<decltype (cr)> (lp->data);
+
+        if (is_child_result_from_node_named (cr, cmdty_namespace))
+            space_str = static_cast<const gchar*> (cr->data);
+        else if (is_child_result_from_node_named (cr, cmdty_id))
+            id_str = static_cast<const gchar*> (cr->data);
+    }
+
+    *result = gnc_commodity_table_lookup (gnc_commodity_table_get_table (book),
+                                          space_str, id_str);
+    if (!*result)
+        PERR ("Unknown commodity %s:%s in <%s>",
+              space_str ? space_str : "(null)",
+              id_str ? id_str : "(null)", tag);
+
+    return TRUE;
+}
+
+sixtp*
+gnc_commodity_ref_sixtp_parser_create (void)
+{
+    sixtp* top_level;
+
+    if (! (top_level =
+               sixtp_set_any (sixtp_new (), FALSE,
+                              SIXTP_CHARACTERS_HANDLER_ID,
+                              allow_and_ignore_only_whitespace,
+                              SIXTP_END_HANDLER_ID, gnc_commodity_ref_end_handler,
+                              SIXTP_NO_MORE_HANDLERS)))
+    {
+        return NULL;
+    }
+
+    if (!sixtp_add_some_sub_parsers (
+            top_level, TRUE,
+            cmdty_namespace, simple_chars_only_parser_new (NULL),
+            cmdty_id, simple_chars_only_parser_new (NULL),
+            NULL, NULL))
+    {
+        return NULL;
+    }
+
+    return top_level;
+}
@@ -78,152 +78,152 @@ static QofLogModule log_module = GNC_MOD_IO;
 /****************************************************************************/
 /* <price>
 
-  restores a price.  Does so via a walk of the XML tree in memory.
-  Returns a GNCPrice * in result.
+  restores a price straight from the SAX stream.  Each field parser
+  hands its value up as a child result and price_after_child_handler
+  sets it on the GNCPrice.  Returns a GNCPrice * in result.
 
   Right now, a price is legitimate even if all of it's fields are not
   set.  We may need to change that later, but at the moment.
 
+  Unknown sub-nodes are ignored.
+
+  for children: struct price_pdata*
+  result: GNCPrice*
+
 */
 
+struct price_pdata
+{
+    GNCPrice* price;
+    gboolean ok;
+};
+
 static gboolean
-price_parse_xml_sub_node (GNCPrice* p, xmlNodePtr sub_node, QofBook* book)
+price_start_handler (GSList* sibling_data,
+                     gpointer parent_data,
+                     gpointer global_data,
+                     gpointer* data_for_children,
+                     gpointer* result,
+                     const gchar* tag,
+                     gchar** attrs)
 {
-    if (!p || !sub_node) return FALSE;
+    gxpf_data* gdata = static_cast<decltype (gdata)> (global_data);
+    QofBook* book = static_cast<decltype (book)> (gdata->bookdata);
+    struct price_pdata* pdata;
+    GNCPrice* p = gnc_price_create (book);
+
+    g_return_val_if_fail (p, FALSE);
 
     gnc_price_begin_edit (p);
-    if (g_strcmp0 ("price:id", (char*)sub_node->name) == 0)
+    pdata = g_new0 (struct price_pdata, 1);
+    pdata->price = p;
+    pdata->ok = TRUE;
+    *data_for_children = pdata;
+    return TRUE;
+}
+
+static gboolean
+price_after_child_handler (gpointer data_for_children,
+                           GSList* data_from_children,
+                           GSList* sibling_data,
+                           gpointer parent_data,
+                           gpointer global_data,
+                           gpointer* result,
+                           const gchar* tag,
+                           const gchar* child_tag,
+                           sixtp_child_result* child_result)
+{
+    struct price_pdata* pdata = static_cast<decltype (pdata)> (data_for_children);
+    GNCPrice* p;
+    gpointer data;
+
+    g_return_val_if_fail (pdata, FALSE);
+
+    p = pdata->price;
+    data = child_result ? child_result->data : NULL;
+
+    if (g_strcmp0 ("price:id", child_tag) == 0)
     {
-        GncGUID* c = dom_tree_to_guid (sub_node);
-        if (!c) return FALSE;
-        gnc_price_set_guid (p, c);
-        g_free (c);
+        if (!data) pdata->ok = FALSE;
+        else gnc_price_set_guid (p, static_cast<GncGUID*> (data));
     }
-    else if (g_strcmp0 ("price:commodity", (char*)sub_node->name) == 0)
+    else if (g_strcmp0 ("price:commodity", child_tag) == 0)
     {
-        gnc_commodity* c = dom_tree_to_commodity_ref (sub_node, book);
-        if (!c) return FALSE;
-        gnc_price_set_commodity (p, c);
+        if (!data) pdata->ok = FALSE;
+        else gnc_price_set_commodity (p, static_cast<gnc_commodity*> (data));
     }
-    else if (g_strcmp0 ("price:currency", (char*)sub_node->name) == 0)
+    else if (g_strcmp0 ("price:currency", child_tag) == 0)
     {
-        gnc_commodity* c = dom_tree_to_commodity_ref (sub_node, book);
-        if (!c) return FALSE;
-        gnc_price_set_currency (p, c);
+        if (!data) pdata->ok = FALSE;
+        else gnc_price_set_currency (p, static_cast<gnc_commodity*> (data));
     }
-    else if (g_strcmp0 ("price:time", (char*)sub_node->name) == 0)
+    else if (g_strcmp0 ("price:time", child_tag) == 0)
     {
-        time64 time = dom_tree_to_time64 (sub_node);
-        if (!dom_tree_valid_time64 (time, sub_node->name)) time = 0;
+        time64 time = data ? *static_cast<time64*> (data) : INT64_MAX;
+        if (!dom_tree_valid_time64 (time, BAD_CAST child_tag)) time = 0;
         gnc_price_set_time64 (p, time);
     }
-    else if (g_strcmp0 ("price:source", (char*)sub_node->name) == 0)
+    else if (g_strcmp0 ("price:source", child_tag) == 0)
     {
-        char* text = dom_tree_to_text (sub_node);
-        if (!text) return FALSE;
-        gnc_price_set_source_string (p, text);
-        g_free (text);
+        if (!data) pdata->ok = FALSE;
+        else gnc_price_set_source_string (p, static_cast<gchar*> (data));
     }
-    else if (g_strcmp0 ("price:type", (char*)sub_node->name) == 0)
+    else if (g_strcmp0 ("price:type", child_tag) == 0)
     {
-        char* text = dom_tree_to_text (sub_node);
-        if (!text) return FALSE;
-        gnc_price_set_typestr (p, text);
-        g_free (text);
+        if (!data) pdata->ok = FALSE;
+        else gnc_price_set_typestr (p, static_cast<gchar*> (data));
     }
-    else if (g_strcmp0 ("price:value", (char*)sub_node->name) == 0)
+    else if (g_strcmp0 ("price:value", child_tag) == 0)
     {
-        gnc_numeric* value = dom_tree_to_gnc_numeric (sub_node);
-        if (!value) return FALSE;
-        gnc_price_set_value (p, *value);
-        g_free (value);
+        if (!data) pdata->ok = FALSE;
+        else gnc_price_set_value (p, *static_cast<gnc_numeric*> (data));
     }
-    gnc_price_commit_edit (p);
+
     return TRUE;
 }
 
 static gboolean
-price_parse_xml_end_handler (gpointer data_for_children,
-                             GSList* data_from_children,
-                             GSList* sibling_data,
-                             gpointer parent_data,
-                             gpointer global_data,
-                             gpointer* result,
-                             const gchar* tag)
+price_end_handler (gpointer data_for_children,
+                   GSList* data_from_children,
+                   GSList* sibling_data,
+                   gpointer parent_data,
+                   gpointer global_data,
+                   gpointer* result,
+                   const gchar* tag)
 {
-    gboolean ok = TRUE;
-    xmlNodePtr price_xml = (xmlNodePtr) data_for_children;
-    xmlNodePtr child;
-    GNCPrice* p = NULL;
-    gxpf_data* gdata = static_cast<decltype (gdata)> (global_data);
-    QofBook* book = static_cast<decltype (book)> (gdata->bookdata);
+    struct price_pdata* pdata = static_cast<decltype (pdata)> (data_for_children);
+    gboolean ok;
 
-    /* we haven't been handed the *top* level node yet... */
-    if (parent_data) return TRUE;
+    g_return_val_if_fail (pdata, FALSE);
 
-    *result = NULL;
-
-    if (!price_xml) return FALSE;
-    if (price_xml->next)
-    {
-        ok = FALSE;
-        goto cleanup_and_exit;
-    }
-    if (price_xml->prev)
-    {
-        ok = FALSE;
-        goto cleanup_and_exit;
-    }
-    if (!price_xml->xmlChildrenNode)
-    {
-        ok = FALSE;
-        goto cleanup_and_exit;
-    }
-
-    p = gnc_price_create (book);
-    if (!p)
-    {
-        ok = FALSE;
-        goto cleanup_and_exit;
-    }
-
-    for (child = price_xml->xmlChildrenNode; child; child = child->next)
-    {
-        switch (child->type)
-        {
-        case XML_COMMENT_NODE:
-        case XML_TEXT_NODE:
-            break;
-        case XML_ELEMENT_NODE:
-            if (!price_parse_xml_sub_node (p, child, book))
-            {
-                ok = FALSE;
-                goto cleanup_and_exit;
-            }
-            break;
-        default:
-            PERR ("Unknown node type (%d) while parsing gnc-price xml.", child->type);
-            child = NULL;
-            ok = FALSE;
-            goto cleanup_and_exit;
-            break;
-        }
-    }
-
-cleanup_and_exit:
+    ok = pdata->ok;
+    gnc_price_commit_edit (pdata->price);
     if (ok)
-    {
-        *result = p;
-    }
+        *result = pdata->price;
     else
-    {
-        *result = NULL;
-        gnc_price_unref (p);
-    }
-    xmlFreeNode (price_xml);
+        gnc_price_unref (pdata->price);
+
+    g_free (pdata);
     return ok;
 }
 
+static void
+price_fail_handler (gpointer data_for_children,
+                    GSList* data_from_children,
+                    GSList* sibling_data,
+                    gpointer parent_data,
+                    gpointer global_data,
+                    gpointer* result,
+                    const gchar* tag)
+{
+    struct price_pdata* pdata = static_cast<decltype (pdata)> (data_for_children);
+
+    if (!pdata) return;
+    gnc_price_commit_edit (pdata->price);
+    gnc_price_unref (pdata->price);
+    g_free (pdata);
+}
+
 static void
 cleanup_gnc_price (sixtp_child_result* result)
 {
@@ -233,9 +233,40 @@ cleanup_gnc_price (sixtp_child_result* result)
 static sixtp*
 gnc_price_parser_new (void)
 {
-    return sixtp_dom_parser_new (price_parse_xml_end_handler,
-                                 cleanup_gnc_price,
-                                 cleanup_gnc_price);
+    sixtp* top_level;
+
+    if (! (top_level =
+               sixtp_set_any (sixtp_new (), FALSE,
+                              SIXTP_START_HANDLER_ID, price_start_handler,
+                              SIXTP_CHARACTERS_HANDLER_ID,
+                              allow_and_ignore_only_whitespace,
+                              SIXTP_AFTER_CHILD_HANDLER_ID,
+                              price_after_child_handler,
+                              SIXTP_END_HANDLER_ID, price_end_handler,
+                              SIXTP_FAIL_HANDLER_ID, price_fail_handler,
+                              SIXTP_CLEANUP_RESULT_ID, cleanup_gnc_price,
+                              SIXTP_RESULT_FAIL_ID, cleanup_gnc_price,
+                              SIXTP_NO_MORE_HANDLERS)))
+    {
+        return NULL;
+    }
+
+    if (!sixtp_add_some_sub_parsers (
+            top_level, TRUE,
+            "price:id", generic_guid_parser_new (),
+            "price:commodity", gnc_commodity_ref_sixtp_parser_create (),
+            "price:currency", gnc_commodity_ref_sixtp_parser_create (),
+            "price:time", generic_time64_parser_new (),
+            "price:source", simple_chars_only_parser_new (NULL),
+            "price:type", simple_chars_only_parser_new (NULL),
+            "price:value", generic_gnc_numeric_parser_new (),
+            SIXTP_MAGIC_CATCHER, sixtp_dom_subtree_parser_new (),
+            NULL, NULL))
+    {
+        return NULL;
+    }
+
+    return top_level;
 }
 
 
@@ -462,6 +493,53 @@ gnc_price_to_dom_tree (const xmlChar* tag, GNCPrice* price)
     return price_xml;
 }
 
+/* The streaming counterpart of gnc_price_to_dom_tree.  Where that
+   returns NULL this returns FALSE, possibly having written part of
+   the price; roll the writer back to a mark taken beforehand. */
+gboolean
+gnc_price_write_xml (GncXmlWriter& writer, GNCPrice* price)
+{
+    const gchar* typestr, *sourcestr;
+    gnc_commodity* commodity;
+    gnc_commodity* currency;
+    time64 time;
+
+    if (!price) return FALSE;
+
+    commodity = gnc_price_get_commodity (price);
+    currency = gnc_price_get_currency (price);
+
+    if (! (commodity && currency)) return FALSE;
+
+    writer.start_element ("price");
+
+    if (!writer.guid_element ("price:id", gnc_price_get_guid (price)))
+        return FALSE;
+
+    if (!writer.commodity_ref_element ("price:commodity", commodity))
+        return FALSE;
+
+    if (!writer.commodity_ref_element ("price:currency", currency))
+        return FALSE;
+
+    time = gnc_price_get_time64 (price);
+    if (!writer.time64_element ("price:time", time))
+        return FALSE;
+
+    sourcestr = gnc_price_get_source_string (price);
+    if (sourcestr && (strlen (sourcestr) != 0))
+        writer.text_element ("price:source", sourcestr);
+
+    typestr = gnc_price_get_typestr (price);
+    if (typestr && (strlen (typestr) != 0))
+        writer.text_element ("price:type", typestr);
+
+    writer.numeric_element ("price:value", gnc_price_get_value (price));
+
+    writer.end_element ("price");
+    return TRUE;
+}
+
 static gboolean
 xml_add_gnc_price_adapter (GNCPrice* p, gpointer data)
 {
@@ -48,6 +48,8 @@ extern "C"
 
 #include "sixtp-dom-parsers.h"
 
+static QofLogModule log_module = GNC_MOD_IO;
+
 const gchar* transaction_version_string = "2.0.0";
 
 static void
@@ -192,6 +194,96 @@ gnc_transaction_dom_tree_create (Transaction* trn)
     return ret;
 }
 
+/* The streaming counterparts of split_to_dom_tree and
+   gnc_transaction_dom_tree_create; keep the two in step. */
+static void
+split_write_xml (GncXmlWriter& writer, const gchar* tag, Split* spl)
+{
+    writer.start_element (tag);
+
+    writer.guid_element ("split:id", xaccSplitGetGUID (spl));
+
+    {
+        const char* memo = xaccSplitGetMemo (spl);
+
+        if (memo && g_strcmp0 (memo, "") != 0)
+            writer.text_element ("split:memo", memo);
+    }
+
+    {
+        const char* action = xaccSplitGetAction (spl);
+
+        if (action && g_strcmp0 (action, "") != 0)
+            writer.text_element ("split:action", action);
+    }
+
+    {
+        char tmp[2];
+
+        tmp[0] = xaccSplitGetReconcile (spl);
+        tmp[1] = '\0';
+
+        writer.text_element ("split:reconciled-state", tmp);
+    }
+
+    {
+        time64 time = xaccSplitGetDateReconciled (spl);
+
+        if (time)
+            writer.time64_element ("split:reconcile-date", time);
+    }
+
+    writer.numeric_element ("split:value", xaccSplitGetValue (spl));
+
+    writer.numeric_element ("split:quantity", xaccSplitGetAmount (spl));
+
+    writer.guid_element ("split:account",
+                         xaccAccountGetGUID (xaccSplitGetAccount (spl)));
+    {
+        GNCLot* lot = xaccSplitGetLot (spl);
+
+        if (lot)
+            writer.guid_element ("split:lot", gnc_lot_get_guid (lot));
+    }
+    writer.slots_element ("split:slots", QOF_INSTANCE (spl));
+
+    writer.end_element (tag);
+}
+
+void
+gnc_transaction_write_xml (GncXmlWriter& writer, Transaction* trn)
+{
+    const char* str;
+
+    writer.start_element ("gnc:transaction", "version",
+                          transaction_version_string);
+
+    writer.guid_element ("trn:id", xaccTransGetGUID (trn));
+
+    writer.commodity_ref_element ("trn:currency", xaccTransGetCurrency (trn));
+
+    str = xaccTransGetNum (trn);
+    if (str && (g_strcmp0 (str, "") != 0))
+        writer.text_element ("trn:num", str);
+
+    writer.time64_element ("trn:date-posted", xaccTransRetDatePosted (trn));
+
+    writer.time64_element ("trn:date-entered", xaccTransRetDateEntered (trn));
+
+    str = xaccTransGetDescription (trn);
+    if (str)
+        writer.text_element ("trn:description", str);
+
+    writer.slots_element ("trn:slots", QOF_INSTANCE (trn));
+
+    writer.start_element ("trn:splits");
+    for (GList* n = xaccTransGetSplitList (trn); n; n = n->next)
+        split_write_xml (writer, "trn:split", static_cast<Split*> (n->data));
+    writer.end_element ("trn:splits");
+
+    writer.end_element ("gnc:transaction");
+}
+
 /***********************************************************************/
 
 struct split_pdata
@@ -572,77 +664,663 @@ struct dom_tree_handler trn_dom_handlers[] =
     { NULL, NULL, 0, 0 },
 };
 
+Transaction*
+dom_tree_to_transaction (xmlNodePtr node, QofBook* book)
+{
+    Transaction* trn;
+    gboolean successful;
+    struct trans_pdata pdata;
+
+    g_return_val_if_fail (node, NULL);
+    g_return_val_if_fail (book, NULL);
+
+    trn = xaccMallocTransaction (book);
+    g_return_val_if_fail (trn, NULL);
+    xaccTransBeginEdit (trn);
+
+    pdata.trans = trn;
+    pdata.book = book;
+
+    successful = dom_tree_generic_parse (node, trn_dom_handlers, &pdata);
+
+    xaccTransCommitEdit (trn);
+
+    if (!successful)
+    {
+        xmlElemDump (stdout, NULL, node);
+        xaccTransBeginEdit (trn);
+        xaccTransDestroy (trn);
+        xaccTransCommitEdit (trn);
+        trn = NULL;
+    }
+
+    return trn;
+}
+
+/***********************************************************************/
+/* <gnc:transaction> read straight off the SAX stream.
+
+   Instead of building a DOM tree for every transaction and walking it
+   with dom_tree_to_transaction, each field parser hands its value up
+   as a child result and the after_child handlers set it on the
+   Transaction or Split as soon as it arrives.  Only <trn:slots> and
+   <split:slots> are still collected as (small) DOM trees so they can
+   go through dom_tree_create_instance_slots.
+
+   The checks match dom_tree_to_transaction: a field that can't be
+   read is logged and skipped, while unknown tags or missing required
+   ones make the transaction (or just the split) fail, which destroys
+   it.
+
+   for children: struct trn_sax_pdata* (struct spl_sax_pdata* below
+   <trn:split>)
+   result: NA, the finished transaction is passed to gdata->cb.
+*/
+
+enum
+{
+    TRN_SAX_ID           = 1 << 0,
+    TRN_SAX_DATE_POSTED  = 1 << 1,
+    TRN_SAX_DATE_ENTERED = 1 << 2,
+    TRN_SAX_SPLITS       = 1 << 3,
+    TRN_SAX_REQUIRED     = TRN_SAX_ID | TRN_SAX_DATE_POSTED |
+                           TRN_SAX_DATE_ENTERED | TRN_SAX_SPLITS
+};
+
+enum
+{
+    SPL_SAX_ID              = 1 << 0,
+    SPL_SAX_RECONCILE_STATE = 1 << 1,
+    SPL_SAX_VALUE           = 1 << 2,
+    SPL_SAX_QUANTITY        = 1 << 3,
+    SPL_SAX_ACCOUNT         = 1 << 4,
+    SPL_SAX_REQUIRED        = SPL_SAX_ID | SPL_SAX_RECONCILE_STATE |
+                              SPL_SAX_VALUE | SPL_SAX_QUANTITY |
+                              SPL_SAX_ACCOUNT
+};
+
+struct trn_sax_pdata
+{
+    Transaction* trans;
+    QofBook* book;
+    guint seen;
+    gboolean ok;
+};
+
+struct spl_sax_pdata
+{
+    Split* split;
+    QofBook* book;
+    guint seen;
+    gboolean ok;
+};
+
+static time64
+sax_result_to_time64 (sixtp_child_result* cr)
+{
+    time64 time = *static_cast<time64*> (cr->data);
+    if (!dom_tree_valid_time64 (time, BAD_CAST cr->tag)) time = 0;
+    return time;
+}
+
+static gboolean
+sax_result_to_slots (sixtp_child_result* cr, QofInstance* inst)
+{
+    xmlNodePtr tree = static_cast<xmlNodePtr> (cr->data);
+    gboolean successful = dom_tree_create_instance_slots (tree, inst);
+
+    /* No need to keep the tree around until the transaction ends. */
+    xmlFreeNode (tree);
+    cr->data = NULL;
+    return successful;
+}
+
+/* The generic GncGUID and gnc_numeric parsers fail the whole file on
+   bad text.  These leave the field without a result instead, so the
+   after_child handlers can skip it the way the DOM handlers did. */
+static gboolean
+sax_field_guid_end_handler (gpointer data_for_children,
+                            GSList* data_from_children, GSList* sibling_data,
+                            gpointer parent_data, gpointer global_data,
+                            gpointer* result, const gchar* tag)
+{
+    generic_guid_end_handler (data_for_children, data_from_children,
+                              sibling_data, parent_data, global_data,
+                              result, tag);
+    return TRUE;
+}
+
+static gboolean
+sax_field_numeric_end_handler (gpointer data_for_children,
+                               GSList* data_from_children,
+                               GSList* sibling_data, gpointer parent_data,
+                               gpointer global_data, gpointer* result,
+                               const gchar* tag)
+{
+    generic_gnc_numeric_end_handler (data_for_children, data_from_children,
+                                     sibling_data, parent_data, global_data,
+                                     result, tag);
+    return TRUE;
+}
+
+static sixtp*
+sax_field_guid_parser_new (void)
+{
+    sixtp* parser = generic_guid_parser_new ();
+    if (parser)
+        sixtp_set_end (parser, sax_field_guid_end_handler);
+    return parser;
+}
+
+static sixtp*
+sax_field_numeric_parser_new (void)
+{
+    sixtp* parser = generic_gnc_numeric_parser_new ();
+    if (parser)
+        sixtp_set_end (parser, sax_field_numeric_end_handler);
+    return parser;
+}
+
+static guint
+spl_sax_required_bit (const gchar* child_tag)
+{
+    if (g_strcmp0 (child_tag, "split:id") == 0)
+        return SPL_SAX_ID;
+    if (g_strcmp0 (child_tag, "split:reconciled-state") == 0)
+        return SPL_SAX_RECONCILE_STATE;
+    if (g_strcmp0 (child_tag, "split:value") == 0)
+        return SPL_SAX_VALUE;
+    if (g_strcmp0 (child_tag, "split:quantity") == 0)
+        return SPL_SAX_QUANTITY;
+    if (g_strcmp0 (child_tag, "split:account") == 0)
+        return SPL_SAX_ACCOUNT;
+    return 0;
+}
+
+static guint
+trn_sax_required_bit (const gchar* child_tag)
+{
+    if (g_strcmp0 (child_tag, "trn:id") == 0)
+        return TRN_SAX_ID;
+    if (g_strcmp0 (child_tag, "trn:date-posted") == 0)
+        return TRN_SAX_DATE_POSTED;
+    if (g_strcmp0 (child_tag, "trn:date-entered") == 0)
+        return TRN_SAX_DATE_ENTERED;
+    return 0;
+}
+
+static void
+spl_sax_set_account (struct spl_sax_pdata* pdata, const GncGUID* id)
+{
+    Account* account = xaccAccountLookup (id, pdata->book);
+
+    if (!account && gnc_transaction_xml_v2_testing &&
+        !guid_equal (id, guid_null ()))
+    {
+        account = xaccMallocAccount (pdata->book);
+        xaccAccountSetGUID (account, id);
+        xaccAccountSetCommoditySCU (account,
+                                    xaccSplitGetAmount (pdata->split).denom);
+    }
+
+    xaccAccountInsertSplit (account, pdata->split);
+}
+
+static void
+spl_sax_set_lot (struct spl_sax_pdata* pdata, const GncGUID* id)
+{
+    GNCLot* lot = gnc_lot_lookup (id, pdata->book);
+
+    if (!lot && gnc_transaction_xml_v2_testing &&
+        !guid_equal (id, guid_null ()))
+    {
+        lot = gnc_lot_new (pdata->book);
+        gnc_lot_set_guid (lot, *id);
+    }
+
+    gnc_lot_add_split (lot, pdata->split);
+}
+
 static gboolean
-gnc_transaction_end_handler (gpointer data_for_children,
+spl_sax_start_handler (GSList* sibling_data, gpointer parent_data,
+                       gpointer global_data, gpointer* data_for_children,
+                       gpointer* result, const gchar* tag, gchar** attrs)
+{
+    struct trn_sax_pdata* tdata = static_cast<decltype (tdata)> (parent_data);
+    struct spl_sax_pdata* pdata;
+
+    g_return_val_if_fail (tdata, FALSE);
+
+    pdata = g_new0 (struct spl_sax_pdata, 1);
+    pdata->split = xaccMallocSplit (tdata->book);
+    pdata->book = tdata->book;
+    pdata->ok = TRUE;
+    *data_for_children = pdata;
+
+    return TRUE;
+}
+
+static gboolean
+spl_sax_after_child_handler (gpointer data_for_children,
                              GSList* data_from_children, GSList* sibling_data,
                              gpointer parent_data, gpointer global_data,
-                             gpointer* result, const gchar* tag)
+                             gpointer* result, const gchar* tag,
+                             const gchar* child_tag,
+                             sixtp_child_result* child_result)
 {
-    Transaction* trn = NULL;
-    xmlNodePtr tree = (xmlNodePtr)data_for_children;
-    gxpf_data* gdata = (gxpf_data*)global_data;
+    struct spl_sax_pdata* pdata = static_cast<decltype (pdata)> (data_for_children);
+    Split* spl;
+    gpointer data;
+
+    g_return_val_if_fail (pdata, FALSE);
 
-    if (parent_data)
+    /* No result means the field couldn't be read.  Like the DOM
+       handlers, skip it but count it as found. */
+    if (!child_result || child_result->type != SIXTP_CHILD_RESULT_NODE)
     {
+        PERR ("couldn't read <%s>, skipping it", child_tag);
+        pdata->seen |= spl_sax_required_bit (child_tag);
         return TRUE;
     }
 
-    /* OK.  For some messed up reason this is getting called again with a
-       NULL tag.  So we ignore those cases */
+    spl = pdata->split;
+    data = child_result->data;
+
+    if (g_strcmp0 (child_tag, "split:id") == 0)
+    {
+        xaccSplitSetGUID (spl, static_cast<GncGUID*> (data));
+        pdata->seen |= SPL_SAX_ID;
+    }
+    else if (g_strcmp0 (child_tag, "split:memo") == 0)
+    {
+        xaccSplitSetMemo (spl, static_cast<gchar*> (data));
+    }
+    else if (g_strcmp0 (child_tag, "split:action") == 0)
+    {
+        xaccSplitSetAction (spl, static_cast<gchar*> (data));
+    }
+    else if (g_strcmp0 (child_tag, "split:reconciled-state") == 0)
+    {
+        xaccSplitSetReconcile (spl, static_cast<gchar*> (data)[0]);
+        pdata->seen |= SPL_SAX_RECONCILE_STATE;
+    }
+    else if (g_strcmp0 (child_tag, "split:reconcile-date") == 0)
+    {
+        xaccSplitSetDateReconciledSecs (spl,
+                                        sax_result_to_time64 (child_result));
+    }
+    else if (g_strcmp0 (child_tag, "split:value") == 0)
+    {
+        xaccSplitSetValue (spl, *static_cast<gnc_numeric*> (data));
+        pdata->seen |= SPL_SAX_VALUE;
+    }
+    else if (g_strcmp0 (child_tag, "split:quantity") == 0)
+    {
+        xaccSplitSetAmount (spl, *static_cast<gnc_numeric*> (data));
+        pdata->seen |= SPL_SAX_QUANTITY;
+    }
+    else if (g_strcmp0 (child_tag, "split:account") == 0)
+    {
+        spl_sax_set_account (pdata, static_cast<GncGUID*> (data));
+        pdata->seen |= SPL_SAX_ACCOUNT;
+    }
+    else if (g_strcmp0 (child_tag, "split:lot") == 0)
+    {
+        spl_sax_set_lot (pdata, static_cast<GncGUID*> (data));
+    }
+    else if (g_strcmp0 (child_tag, "split:slots") == 0)
+    {
+        if (!sax_result_to_slots (child_result, QOF_INSTANCE (spl)))
+            PERR ("couldn't read <%s>, skipping it", child_tag);
+    }
+    else
+    {
+        PERR ("Unhandled tag: %s", child_tag ? child_tag : "(null)");
+        pdata->ok = FALSE;
+    }
+
+    return TRUE;
+}
+
+static gboolean
+spl_sax_end_handler (gpointer data_for_children,
+                     GSList* data_from_children, GSList* sibling_data,
+                     gpointer parent_data, gpointer global_data,
+                     gpointer* result, const gchar* tag)
+{
+    struct spl_sax_pdata* pdata = static_cast<decltype (pdata)> (data_for_children);
+    struct trn_sax_pdata* tdata = static_cast<decltype (tdata)> (parent_data);
+
+    g_return_val_if_fail (pdata, FALSE);
+    g_return_val_if_fail (tdata, FALSE);
+
+    if (pdata->ok && (pdata->seen & SPL_SAX_REQUIRED) != SPL_SAX_REQUIRED)
+    {
+        PERR ("didn't find all of the expected tags in <%s>", tag);
+        pdata->ok = FALSE;
+    }
+
+    /* A bad split is dropped on its own; the transaction keeps the
+       others, as it did when dom_tree_to_transaction read the splits. */
+    if (pdata->ok)
+        xaccTransAppendSplit (tdata->trans, pdata->split);
+    else
+        xaccSplitDestroy (pdata->split);
+
+    g_free (pdata);
+    return TRUE;
+}
+
+static void
+spl_sax_fail_handler (gpointer data_for_children,
+                      GSList* data_from_children, GSList* sibling_data,
+                      gpointer parent_data, gpointer global_data,
+                      gpointer* result, const gchar* tag)
+{
+    struct spl_sax_pdata* pdata = static_cast<decltype (pdata)> (data_for_children);
+
+    if (!pdata) return;
+    xaccSplitDestroy (pdata->split);
+    g_free (pdata);
+}
+
+static sixtp*
+gnc_split_sax_parser_new (void)
+{
+    sixtp* top_level;
+
+    if (! (top_level =
+               sixtp_set_any (sixtp_new (), FALSE,
+                              SIXTP_START_HANDLER_ID, spl_sax_start_handler,
+                              SIXTP_CHARACTERS_HANDLER_ID,
+                              allow_and_ignore_only_whitespace,
+                              SIXTP_AFTER_CHILD_HANDLER_ID,
+                              spl_sax_after_child_handler,
+                              SIXTP_END_HANDLER_ID, spl_sax_end_handler,
+                              SIXTP_FAIL_HANDLER_ID, spl_sax_fail_handler,
+                              SIXTP_NO_MORE_HANDLERS)))
+    {
+        return NULL;
+    }
+
+    if (!sixtp_add_some_sub_parsers (
+            top_level, TRUE,
+            "split:id", sax_field_guid_parser_new (),
+            "split:memo", simple_chars_only_parser_new (NULL),
+            "split:action", simple_chars_only_parser_new (NULL),
+            "split:reconciled-state", simple_chars_only_parser_new (NULL),
+            "split:reconcile-date", generic_time64_parser_new (),
+            "split:value", sax_field_numeric_parser_new (),
+            "split:quantity", sax_field_numeric_parser_new (),
+            "split:account", sax_field_guid_parser_new (),
+            "split:lot", sax_field_guid_parser_new (),
+            "split:slots", sixtp_dom_subtree_parser_new (),
+            SIXTP_MAGIC_CATCHER, sixtp_dom_subtree_parser_new (),
+            NULL, NULL))
+    {
+        return NULL;
+    }
+
+    return top_level;
+}
+
+static gboolean
+trn_splits_sax_start_handler (GSList* sibling_data, gpointer parent_data,
+                              gpointer global_data,
+                              gpointer* data_for_children, gpointer* result,
+                              const gchar* tag, gchar** attrs)
+{
+    /* The splits go straight into the transaction. */
+    *data_for_children = parent_data;
+    return TRUE;
+}
+
+static gboolean
+trn_splits_sax_after_child_handler (gpointer data_for_children,
+                                    GSList* data_from_children,
+                                    GSList* sibling_data,
+                                    gpointer parent_data, gpointer global_data,
+                                    gpointer* result, const gchar* tag,
+                                    const gchar* child_tag,
+                                    sixtp_child_result* child_result)
+{
+    struct trn_sax_pdata* pdata = static_cast<decltype (pdata)> (data_for_children);
+
+    /* <trn:split> appends itself and returns nothing, so a result here
+       comes from something that isn't a split.  The DOM reader skipped
+       those too. */
+    if (pdata && child_result)
+        PERR ("Unhandled tag: %s", child_tag ? child_tag : "(null)");
+    return TRUE;
+}
+
+static gboolean
+trn_sax_start_handler (GSList* sibling_data, gpointer parent_data,
+                       gpointer global_data, gpointer* data_for_children,
+                       gpointer* result, const gchar* tag, gchar** attrs)
+{
+    gxpf_data* gdata = static_cast<decltype (gdata)> (global_data);
+    struct trn_sax_pdata* pdata;
+
+    /* The top level frame, when we're used as the top level parser. */
     if (!tag)
     {
         return TRUE;
     }
 
-    g_return_val_if_fail (tree, FALSE);
+    pdata = g_new0 (struct trn_sax_pdata, 1);
+    pdata->book = static_cast<QofBook*> (gdata->bookdata);
+    pdata->trans = xaccMallocTransaction (pdata->book);
+    pdata->ok = TRUE;
+    xaccTransBeginEdit (pdata->trans);
+    *data_for_children = pdata;
 
-    trn = dom_tree_to_transaction (tree,
-                                   static_cast<QofBook*> (gdata->bookdata));
-    if (trn != NULL)
+    return TRUE;
+}
+
+static gboolean
+trn_sax_after_child_handler (gpointer data_for_children,
+                             GSList* data_from_children, GSList* sibling_data,
+                             gpointer parent_data, gpointer global_data,
+                             gpointer* result, const gchar* tag,
+                             const gchar* child_tag,
+                             sixtp_child_result* child_result)
+{
+    struct trn_sax_pdata* pdata = static_cast<decltype (pdata)> (data_for_children);
+    Transaction* trn;
+    gpointer data;
+
+    /* A <gnc:transaction> finished under the top level frame. */
+    if (!pdata)
     {
-        gdata->cb (tag, gdata->parsedata, trn);
+        return TRUE;
     }
 
-    xmlFreeNode (tree);
+    trn = pdata->trans;
 
-    return trn != NULL;
+    if (g_strcmp0 (child_tag, "trn:splits") == 0)
+    {
+        pdata->seen |= TRN_SAX_SPLITS;
+        return TRUE;
+    }
+
+    /* An unknown currency just leaves the transaction without one. */
+    if (g_strcmp0 (child_tag, "trn:currency") == 0)
+    {
+        if (child_result)
+            xaccTransSetCurrency (trn,
+                                  static_cast<gnc_commodity*> (child_result->data));
+        return TRUE;
+    }
+
+    /* No result means the field couldn't be read.  Like the DOM
+       handlers, skip it but count it as found. */
+    if (!child_result || child_result->type != SIXTP_CHILD_RESULT_NODE)
+    {
+        PERR ("couldn't read <%s>, skipping it", child_tag);
+        pdata->seen |= trn_sax_required_bit (child_tag);
+        return TRUE;
+    }
+
+    data = child_result->data;
+
+    if (g_strcmp0 (child_tag, "trn:id") == 0)
+    {
+        xaccTransSetGUID (trn, static_cast<GncGUID*> (data));
+        pdata->seen |= TRN_SAX_ID;
+    }
+    else if (g_strcmp0 (child_tag, "trn:num") == 0)
+    {
+        xaccTransSetNum (trn, static_cast<gchar*> (data));
+    }
+    else if (g_strcmp0 (child_tag, "trn:date-posted") == 0)
+    {
+        xaccTransSetDatePostedSecs (trn, sax_result_to_time64 (child_result));
+        pdata->seen |= TRN_SAX_DATE_POSTED;
+    }
+    else if (g_strcmp0 (child_tag, "trn:date-entered") == 0)
+    {
+        xaccTransSetDateEnteredSecs (trn, sax_result_to_time64 (child_result));
+        pdata->seen |= TRN_SAX_DATE_ENTERED;
+    }
+    else if (g_strcmp0 (child_tag, "trn:description") == 0)
+    {
+        xaccTransSetDescription (trn, static_cast<gchar*> (data));
+    }
+    else if (g_strcmp0 (child_tag, "trn:slots") == 0)
+    {
+        if (!sax_result_to_slots (child_result, QOF_INSTANCE (trn)))
+            PERR ("couldn't read <%s>, skipping it", child_tag);
+    }
+    else
+    {
+        PERR ("Unhandled tag: %s", child_tag ? child_tag : "(null)");
+        pdata->ok = FALSE;
+    }
+
+    return TRUE;
 }
 
-Transaction*
-dom_tree_to_transaction (xmlNodePtr node, QofBook* book)
+static gboolean
+trn_sax_end_handler (gpointer data_for_children,
+                     GSList* data_from_children, GSList* sibling_data,
+                     gpointer parent_data, gpointer global_data,
+                     gpointer* result, const gchar* tag)
 {
+    struct trn_sax_pdata* pdata = static_cast<decltype (pdata)> (data_for_children);
+    gxpf_data* gdata = static_cast<decltype (gdata)> (global_data);
     Transaction* trn;
-    gboolean successful;
-    struct trans_pdata pdata;
 
-    g_return_val_if_fail (node, NULL);
-    g_return_val_if_fail (book, NULL);
-
-    trn = xaccMallocTransaction (book);
-    g_return_val_if_fail (trn, NULL);
-    xaccTransBeginEdit (trn);
+    /* The top level frame is ended with a NULL tag. */
+    if (!tag)
+    {
+        return TRUE;
+    }
 
-    pdata.trans = trn;
-    pdata.book = book;
+    g_return_val_if_fail (pdata, FALSE);
 
-    successful = dom_tree_generic_parse (node, trn_dom_handlers, &pdata);
+    if (pdata->ok && (pdata->seen & TRN_SAX_REQUIRED) != TRN_SAX_REQUIRED)
+    {
+        PERR ("didn't find all of the expected tags in <%s>", tag);
+        pdata->ok = FALSE;
+    }
 
+    trn = pdata->trans;
     xaccTransCommitEdit (trn);
 
-    if (!successful)
+    if (!pdata->ok)
     {
-        xmlElemDump (stdout, NULL, node);
         xaccTransBeginEdit (trn);
         xaccTransDestroy (trn);
         xaccTransCommitEdit (trn);
         trn = NULL;
     }
 
-    return trn;
+    g_free (pdata);
+
+    if (trn != NULL)
+    {
+        gdata->cb (tag, gdata->parsedata, trn);
+    }
+
+    return trn != NULL;
+}
+
+static void
+trn_sax_fail_handler (gpointer data_for_children,
+                      GSList* data_from_children, GSList* sibling_data,
+                      gpointer parent_data, gpointer global_data,
+                      gpointer* result, const gchar* tag)
+{
+    struct trn_sax_pdata* pdata = static_cast<decltype (pdata)> (data_for_children);
+
+    if (!pdata) return;
+    xaccTransDestroy (pdata->trans);
+    xaccTransCommitEdit (pdata->trans);
+    g_free (pdata);
 }
 
 sixtp*
 gnc_transaction_sixtp_parser_create (void)
 {
-    return sixtp_dom_parser_new (gnc_transaction_end_handler, NULL, NULL);
+    sixtp* top_level;
+    sixtp* splits_pr;
+
+    if (! (top_level =
+               sixtp_set_any (sixtp_new (), FALSE,
+                              SIXTP_START_HANDLER_ID, trn_sax_start_handler,
+                              SIXTP_CHARACTERS_HANDLER_ID,
+                              allow_and_ignore_only_whitespace,
+                              SIXTP_AFTER_CHILD_HANDLER_ID,
+                              trn_sax_after_child_handler,
+                              SIXTP_END_HANDLER_ID, trn_sax_end_handler,
+                              SIXTP_FAIL_HANDLER_ID, trn_sax_fail_handler,
+                              SIXTP_NO_MORE_HANDLERS)))
+    {
+        return NULL;
+    }
+
+    if (! (splits_pr =
+               sixtp_set_any (sixtp_new (), FALSE,
+                              SIXTP_START_HANDLER_ID, trn_splits_sax_start_handler,
+                              SIXTP_CHARACTERS_HANDLER_ID,
+                              allow_and_ignore_only_whitespace,
+                              SIXTP_AFTER_CHILD_HANDLER_ID,
+                              trn_splits_sax_after_child_handler,
+                              SIXTP_NO_MORE_HANDLERS)))
+    {
+        sixtp_destroy (top_level);
+        return NULL;
+    }
+
+    if (!sixtp_add_some_sub_parsers (
+            splits_pr, TRUE,
+            "trn:split", gnc_split_sax_parser_new (),
+            SIXTP_MAGIC_CATCHER, sixtp_dom_subtree_parser_new (),
+            NULL, NULL))
+    {
+        sixtp_destroy (top_level);
+        return NULL;
+    }
+
+    /* "gnc:transaction" maps back to ourselves so that the parser also
+       works as the top level parser, the way the tests use it. */
+    if (!sixtp_add_some_sub_parsers (
+            top_level, TRUE,
+            "trn:id", sax_field_guid_parser_new (),
+            "trn:currency", gnc_commodity_ref_sixtp_parser_create (),
+            "trn:num", simple_chars_only_parser_new (NULL),
+            "trn:date-posted", generic_time64_parser_new (),
+            "trn:date-entered", generic_time64_parser_new (),
+            "trn:description", simple_chars_only_parser_new (NULL),
+            "trn:slots", sixtp_dom_subtree_parser_new (),
+            "trn:splits", splits_pr,
+            "gnc:transaction", top_level,
+            SIXTP_MAGIC_CATCHER, sixtp_dom_subtree_parser_new (),
+            NULL, NULL))
+    {
+        return NULL;
+    }
+
+    return top_level;
 }
@@ -32,7 +32,10 @@ extern "C"
 #include <regex.h>
 
 #include <gnc-engine.h> //for GNC_MOD_BACKEND
+#include <gnc-pricedb.h>
 #include <gnc-uri-utils.h>
+#include <Transaction.h>
+#include <cap-gains.h>
 #include <TransLog.h>
 #include <gnc-prefs.h>
 
@@ -47,8 +50,13 @@ extern "C"
 
 #define XML_URI_PREFIX "xml://"
 #define FILE_URI_PREFIX "file://"
+#define JOURNAL_EXT ".journal"
 static QofLogModule log_module = GNC_MOD_BACKEND;
 
+/* A journal save with this many records already in the journal rewrites
+ * the whole file instead, so that replaying it stays cheap. */
+static const size_t journal_compact_records = 1000;
+
 bool
 GncXmlBackend::check_path (const char* fullpath, bool create)
 {
@@ -128,7 +136,7 @@ GncXmlBackend::session_begin(QofSession* session, const char* book_id,
     if (!check_path(m_fullpath.c_str(), create))
         return;
     m_dirname = g_path_get_dirname (m_fullpath.c_str());
-
+    m_journal = m_fullpath + JOURNAL_EXT;
 
 
     /* ---------------------------------------------------- */
@@ -140,7 +148,10 @@ GncXmlBackend::session_begin(QofSession* session, const char* book_id,
     /* And let's see if we can get a lock on it. */
     m_lockfile = m_fullpath + ".LCK";
 
-    if (!ignore_lock && !get_file_lock())
+    m_have_lock = false;
+    if (!ignore_lock)
+        m_have_lock = get_file_lock();
+    if (!ignore_lock && !m_have_lock)
     {
         // We should not ignore the lock, but couldn't get it. The
         // be_get_file_lock() already set the appropriate backend_error in this
@@ -176,6 +187,17 @@ GncXmlBackend::session_end()
         return;
     }
 
+    /* Fold the journal into the data file, but only if this session
+     * wrote to the journal and holds the lock, so that a session that
+     * merely replayed it doesn't rewrite the file under its owner, and
+     * only if the book holds nothing that the user chose not to save. */
+    if (m_book && m_have_lock && m_journal_records > 0 &&
+        !qof_book_session_not_saved (m_book))
+    {
+        if (write_to_file (true))
+            clear_journal ();
+    }
+
     if (!m_linkfile.empty())
         g_unlink (m_linkfile.c_str());
 
@@ -202,6 +224,14 @@ GncXmlBackend::session_end()
     m_fullpath.clear();
     m_lockfile.clear();
     m_linkfile.clear();
+    m_journal.clear();
+    m_journal_trans.clear();
+    m_journal_prices.clear();
+    m_journal_base.clear();
+    m_journal_replayed = 0;
+    m_journal_records = 0;
+    m_needs_rewrite = false;
+    m_have_lock = false;
 }
 
 static QofBookFileType
@@ -243,6 +273,7 @@ GncXmlBackend::load(QofBook* book, QofBackendLoadType loadType)
 
     error = ERR_BACKEND_NO_ERR;
     m_book = book;
+    m_loading = true;
 
     int rc;
     switch (determine_file_type (m_fullpath))
@@ -255,6 +286,8 @@ GncXmlBackend::load(QofBook* book, QofBackendLoadType loadType)
             PWARN ("Syntax error in Xml File %s", m_fullpath.c_str());
             error = ERR_FILEIO_PARSE_ERROR;
         }
+        else
+            replay_journal();
         break;
 
     case GNC_BOOK_XML2_FILE_NO_ENCODING:
@@ -296,6 +329,7 @@ GncXmlBackend::load(QofBook* book, QofBackendLoadType loadType)
         break;
     }
 
+    m_loading = false;
     if (error != ERR_BACKEND_NO_ERR)
     {
         set_error(error);
@@ -305,6 +339,138 @@ GncXmlBackend::load(QofBook* book, QofBackendLoadType loadType)
     qof_book_mark_session_saved (book);
 }
 
+/* A journal starts with the identity of the data file it was written
+ * against, so that one left behind by an interrupted rewrite is never
+ * replayed over the newer file.  Every rewrite replaces the file (and so
+ * its inode) and a journal save never touches it.
+ */
+static std::string
+journal_base_id (const std::string& path)
+{
+    GStatBuf statbuf;
+    if (g_stat (path.c_str(), &statbuf) != 0)
+        return {};
+
+    std::ostringstream id;
+    id << statbuf.st_size << ' ' << statbuf.st_mtime << ' ' << statbuf.st_ino;
+    return id.str();
+}
+
+/* Loading replays the journal on top of the data file: each record first
+ * drops the transaction or price it names, then reads it back if it still
+ * existed when the record was written.
+ */
+void
+GncXmlBackend::replay_journal()
+{
+    m_journal_base = journal_base_id (m_fullpath);
+    if (!g_file_test (m_journal.c_str(), G_FILE_TEST_EXISTS))
+        return;
+
+    if (!gnc_book_replay_journal_v2 (m_book, m_journal.c_str(),
+                                     m_journal_base.c_str(),
+                                     &m_journal_replayed))
+    {
+        /* Nothing after a bad record would be replayed either, so don't
+         * append to this journal any more. */
+        PWARN ("Error replaying journal %s", m_journal.c_str());
+        m_needs_rewrite = true;
+    }
+}
+
+/* Replaying a record destroys the transaction it replaces, which would
+ * also take apart its lots and capital gains, so transactions that have
+ * any are left to a full rewrite. */
+static bool
+journal_can_replace (Transaction* trans)
+{
+    for (auto node = xaccTransGetSplitList (trans); node; node = node->next)
+    {
+        auto split = GNC_SPLIT (node->data);
+        if (xaccSplitGetLot (split) || xaccSplitGetGainsSourceSplit (split))
+            return false;
+    }
+    return true;
+}
+
+void
+GncXmlBackend::commit(QofInstance* inst)
+{
+    if (m_loading)
+        return;
+
+    Transaction* trans = nullptr;
+    if (GNC_IS_SPLIT (inst))
+        trans = xaccSplitGetParent (GNC_SPLIT (inst));
+    else if (GNC_IS_TRANSACTION (inst))
+        trans = GNC_TRANSACTION (inst);
+
+    if (trans)
+    {
+        if (journal_can_replace (trans))
+            m_journal_trans.insert (*xaccTransGetGUID (trans));
+        else
+            m_needs_rewrite = true;
+    }
+    else if (GNC_IS_SPLIT (inst) || GNC_IS_TRANSACTION (inst))
+        return; /* A split that has left its transaction. */
+    else if (GNC_IS_PRICE (inst))
+        m_journal_prices.insert (*qof_instance_get_guid (inst));
+    else if (GNC_IS_PRICEDB (inst))
+        return; /* Its prices are committed one by one. */
+    else if (qof_instance_get_dirty_flag (inst))
+        m_needs_rewrite = true;
+}
+
+bool
+GncXmlBackend::append_to_journal()
+{
+    if (m_journal_base.empty() || m_needs_rewrite ||
+        m_journal_replayed + m_journal_records >= journal_compact_records)
+        return false;
+    if (m_journal_trans.empty() && m_journal_prices.empty())
+        return false;
+
+    std::vector<GncGUID> trans {m_journal_trans.begin(), m_journal_trans.end()};
+    std::vector<GncGUID> prices {m_journal_prices.begin(),
+                                 m_journal_prices.end()};
+    if (!gnc_book_append_journal_v2 (m_book, m_journal.c_str(),
+                                     m_journal_base.c_str(), trans, prices))
+    {
+        PWARN ("Unable to append to journal %s", m_journal.c_str());
+        return false;
+    }
+
+    m_journal_records += trans.size() + prices.size();
+    m_journal_trans.clear();
+    m_journal_prices.clear();
+    qof_book_mark_session_saved (m_book);
+    return true;
+}
+
+/* Called once the data file holds everything, which makes the journal
+ * redundant. */
+void
+GncXmlBackend::clear_journal()
+{
+    if (g_unlink (m_journal.c_str()) != 0 && errno != ENOENT)
+    {
+        /* Its base no longer matches, so it won't be replayed, but it
+         * mustn't be appended to either. */
+        PWARN ("unable to unlink journal %s: %s", m_journal.c_str(),
+               g_strerror (errno) ? g_strerror (errno) : "");
+        m_journal_base.clear();
+    }
+    else
+        m_journal_base = journal_base_id (m_fullpath);
+
+    m_journal_trans.clear();
+    m_journal_prices.clear();
+    m_journal_replayed = 0;
+    m_journal_records = 0;
+    m_needs_rewrite = false;
+}
+
 void
 GncXmlBackend::sync(QofBook* book)
 {
@@ -324,7 +490,11 @@ GncXmlBackend::sync(QofBook* book)
         return;
     }
 
-    write_to_file (true);
+    if (gnc_prefs_get_file_save_journal () && append_to_journal ())
+        return;
+
+    if (write_to_file (true))
+        clear_journal ();
     remove_old_files();
 }
 
@@ -23,6 +23,7 @@ extern "C"
 #include <qof.h>
 }
 
+#include <set>
 #include <string>
 #include <qof-backend.hpp>
 
@@ -39,7 +40,10 @@ public:
                        bool ignore_lock, bool create, bool force) override;
     void session_end() override;
     void load(QofBook* book, QofBackendLoadType loadType) override;
-    /* The XML backend isn't able to do anything with individual instances. */
+    /* The XML backend can't store individual instances, but it notes the
+     * transactions and prices that change so that a save in journal mode
+     * only has to append those. */
+    void commit(QofInstance* inst) override;
     void export_coa(QofBook*) override;
     void sync(QofBook* book) override;
     void safe_sync(QofBook* book) override { sync(book); } // XML sync is inherently safe.
@@ -55,12 +59,40 @@ private:
     void remove_old_files();
     void write_accounts(QofBook* book);
     bool check_path(const char* fullpath, bool create);
+    bool append_to_journal();
+    void replay_journal();
+    void clear_journal();
+
+    struct GUIDLess
+    {
+        bool operator()(const GncGUID& a, const GncGUID& b) const
+        {
+            return guid_compare(&a, &b) < 0;
+        }
+    };
+    using GUIDSet = std::set<GncGUID, GUIDLess>;
 
     std::string m_dirname;
     std::string m_lockfile;
     std::string m_linkfile;
+    std::string m_journal;
     int m_lockfd;
+    bool m_have_lock = false;
 
     QofBook* m_book = nullptr;  /* The primary, main open book */
+
+    /* Journal mode: while m_journal_base is set the data file it
+     * identifies plus the journal hold the book as last saved, and the
+     * changes since then are either all in the two sets or
+     * m_needs_rewrite is set. m_journal_replayed counts the records
+     * that were already there when the book was loaded and
+     * m_journal_records those this session appended. */
+    std::string m_journal_base;
+    GUIDSet m_journal_trans;
+    GUIDSet m_journal_prices;
+    size_t m_journal_replayed = 0;
+    size_t m_journal_records = 0;
+    bool m_needs_rewrite = false;
+    bool m_loading = false;
 };
 #endif // __GNC_XML_BACKEND_HPP__
@@ -0,0 +1,362 @@
+/********************************************************************
+ * gnc-xml-writer.cpp: Stream XML elements without building a DOM. *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+extern "C"
+{
+#include <config.h>
+#include <glib.h>
+
+#include <gnc-date.h>
+}
+
+#include "gnc-xml-helper.h"
+#include "sixtp-dom-generators.h"
+#include "gnc-xml-writer.hpp"
+
+#include <kvp-frame.hpp>
+#include <algorithm>
+
+/* libxml2 stops indenting past this depth (MAX_INDENT / 2). */
+static const int max_indent_depth = 30;
+/* flush_if_full() writes the buffer out once it holds this much. */
+static const size_t flush_threshold = 1 << 20;
+
+void
+GncXmlWriter::indent ()
+{
+    m_buf.append (2 * std::min (m_depth, max_indent_depth), ' ');
+}
+
+void
+GncXmlWriter::close_start_tag ()
+{
+    /* The first child of a formatted element starts on a new line. */
+    if (m_open)
+    {
+        m_buf += ">\n";
+        m_open = false;
+    }
+}
+
+void
+GncXmlWriter::open_tag (const char* tag, const char* attr, const char* value)
+{
+    close_start_tag ();
+    indent ();
+    m_buf += '<';
+    m_buf += tag;
+    if (attr && value)
+    {
+        m_buf += ' ';
+        m_buf += attr;
+        m_buf += "=\"";
+        m_buf += value;
+        m_buf += '"';
+    }
+}
+
+void
+GncXmlWriter::start_element (const char* tag, const char* attr,
+                             const char* value)
+{
+    open_tag (tag, attr, value);
+    m_open = true;
+    ++m_depth;
+}
+
+void
+GncXmlWriter::end_element (const char* tag)
+{
+    --m_depth;
+    if (m_open)
+    {
+        m_buf += "/>\n";
+        m_open = false;
+        return;
+    }
+    indent ();
+    m_buf += "</";
+    m_buf += tag;
+    m_buf += ">\n";
+}
+
+void
+GncXmlWriter::text_element (const char* tag, const char* str,
+                            const char* attr, const char* value)
+{
+    open_tag (tag, attr, value);
+    if (!str)
+    {
+        m_buf += "/>\n";
+        return;
+    }
+    m_buf += '>';
+    append_text (str);
+    m_buf += "</";
+    m_buf += tag;
+    m_buf += ">\n";
+}
+
+/* Same as xmlEscapeContent, which xmlElemDump uses for text nodes. */
+void
+GncXmlWriter::append_escaped (const char* str)
+{
+    const char* run = str;
+    const char* p;
+
+    for (p = str; *p; ++p)
+    {
+        const char* entity;
+        switch (*p)
+        {
+        case '<':
+            entity = "&lt;";
+            break;
+        case '>':
+            entity = "&gt;";
+            break;
+        case '&':
+            entity = "&amp;";
+            break;
+        case '\r':
+            entity = "&#13;";
+            break;
+        default:
+            continue;
+        }
+        m_buf.append (run, p - run);
+        m_buf += entity;
+        run = p + 1;
+    }
+    m_buf.append (run, p - run);
+}
+
+void
+GncXmlWriter::append_text (const char* str)
+{
+    const gchar* p;
+
+    for (p = str; *p; ++p)
+        if (*p > 0 && *p < 0x20 && *p != 0x09 && *p != 0x0a && *p != 0x0d)
+            break;
+
+    if (!*p && g_utf8_validate (str, -1, NULL))
+    {
+        append_escaped (str);
+        return;
+    }
+
+    auto copy = g_strdup (str);
+    append_escaped (reinterpret_cast<const char*> (checked_char_cast (copy)));
+    g_free (copy);
+}
+
+bool
+GncXmlWriter::guid_element (const char* tag, const GncGUID* guid)
+{
+    char guid_str[GUID_ENCODING_LENGTH + 1];
+
+    if (!guid_to_string_buff (guid, guid_str))
+        return false;
+    text_element (tag, guid_str, "type", "guid");
+    return true;
+}
+
+bool
+GncXmlWriter::commodity_ref_element (const char* tag, const gnc_commodity* c)
+{
+    g_return_val_if_fail (c, false);
+
+    auto name_space = gnc_commodity_get_namespace (c);
+    auto mnemonic = gnc_commodity_get_mnemonic (c);
+    if (!name_space || !mnemonic)
+        return false;
+
+    start_element (tag);
+    text_element ("cmdty:space", name_space);
+    text_element ("cmdty:id", mnemonic);
+    end_element (tag);
+    return true;
+}
+
+bool
+GncXmlWriter::time64_element (const char* tag, time64 time,
+                              const char* attr, const char* value)
+{
+    g_return_val_if_fail (time != INT64_MAX, false);
+
+    auto date_str = gnc_print_time64 (time, "%Y-%m-%d %H:%M:%S %q");
+    if (!date_str)
+        return false;
+
+    start_element (tag, attr, value);
+    text_element ("ts:date", date_str);
+    end_element (tag);
+    g_free (date_str);
+    return true;
+}
+
+void
+GncXmlWriter::numeric_element (const char* tag, gnc_numeric num)
+{
+    char numstr[48];
+
+    /* The format gnc_numeric_to_string uses. */
+    g_snprintf (numstr, sizeof (numstr), "%" G_GINT64_FORMAT "/%"
+                G_GINT64_FORMAT, num.num, num.denom);
+    text_element (tag, numstr);
+}
+
+/* Follows add_kvp_value_node in sixtp-dom-generators.cpp. */
+void
+GncXmlWriter::kvp_value_element (const char* tag, KvpValue* val)
+{
+    switch (val->get_type ())
+    {
+    case KvpValue::Type::INT64:
+    {
+        char numstr[24];
+        g_snprintf (numstr, sizeof (numstr), "%" G_GINT64_FORMAT,
+                    val->get<int64_t> ());
+        text_element (tag, numstr, "type", "integer");
+        break;
+    }
+    case KvpValue::Type::DOUBLE:
+    {
+        auto numstr = double_to_string (val->get<double> ());
+        text_element (tag, numstr, "type", "double");
+        g_free (numstr);
+        break;
+    }
+    case KvpValue::Type::NUMERIC:
+    {
+        auto num = val->get<gnc_numeric> ();
+        char numstr[48];
+        g_snprintf (numstr, sizeof (numstr), "%" G_GINT64_FORMAT "/%"
+                    G_GINT64_FORMAT, num.num, num.denom);
+        text_element (tag, numstr, "type", "numeric");
+        break;
+    }
+    case KvpValue::Type::STRING:
+        text_element (tag, val->get<const char*> (), "type", "string");
+        break;
+    case KvpValue::Type::GUID:
+    {
+        gchar guidstr[GUID_ENCODING_LENGTH + 1];
+        if (guid_to_string_buff (val->get<GncGUID*> (), guidstr))
+            text_element (tag, guidstr, "type", "guid");
+        else
+            text_element (tag, nullptr, "type", "guid");
+        break;
+    }
+    /* Note: The type attribute must remain 'timespec' to maintain
+     * compatibility.
+     */
+    case KvpValue::Type::TIME64:
+        time64_element (tag, val->get<Time64> ().t, "type", "timespec");
+        break;
+    case KvpValue::Type::GDATE:
+    {
+        auto d = val->get<GDate> ();
+        gchar date_str[512] = "";
+        g_date_strftime (date_str, sizeof (date_str), "%Y-%m-%d", &d);
+        start_element (tag, "type", "gdate");
+        text_element ("gdate", date_str);
+        end_element (tag);
+        break;
+    }
+    case KvpValue::Type::GLIST:
+        start_element (tag, "type", "list");
+        for (auto cursor = val->get<GList*> (); cursor; cursor = cursor->next)
+            kvp_value_element ("slot:value",
+                               static_cast<KvpValue*> (cursor->data));
+        end_element (tag);
+        break;
+    case KvpValue::Type::FRAME:
+    {
+        start_element (tag, "type", "frame");
+        auto frame = val->get<KvpFrame*> ();
+        if (frame)
+            frame->for_each_slot_temp ([this] (const char* key, KvpValue* v)
+                                       {
+                                           slot_element (key, v);
+                                       });
+        end_element (tag);
+        break;
+    }
+    default:
+        text_element (tag, nullptr);
+        break;
+    }
+}
+
+void
+GncXmlWriter::slot_element (const char* key, KvpValue* val)
+{
+    start_element ("slot");
+    text_element ("slot:key", key);
+    kvp_value_element ("slot:value", val);
+    end_element ("slot");
+}
+
+void
+GncXmlWriter::slots_element (const char* tag, const QofInstance* inst)
+{
+    KvpFrame* frame = qof_instance_get_slots (inst);
+    if (!frame || frame->empty ())
+        return;
+
+    start_element (tag);
+    frame->for_each_slot_temp ([this] (const char* key, KvpValue* v)
+                               {
+                                   slot_element (key, v);
+                               });
+    end_element (tag);
+}
+
+void
+GncXmlWriter::rollback (const Mark& mark)
+{
+    g_return_if_fail (mark.size <= m_buf.size ());
+    m_buf.resize (mark.size);
+    m_depth = mark.depth;
+    m_open = mark.open;
+}
+
+bool
+GncXmlWriter::flush_if_full ()
+{
+    if (m_buf.size () < flush_threshold)
+        return true;
+    return flush ();
+}
+
+bool
+GncXmlWriter::flush ()
+{
+    if (!m_out)
+        return true;
+    if (!m_buf.empty ())
+    {
+        fwrite (m_buf.data (), 1, m_buf.size (), m_out);
+        m_buf.clear ();
+    }
+    return !ferror (m_out);
+}
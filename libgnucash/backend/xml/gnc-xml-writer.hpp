@@ -0,0 +1,115 @@
+/********************************************************************
+ * gnc-xml-writer.hpp: Stream XML elements without building a DOM.  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#ifndef __GNC_XML_WRITER_HPP__
+#define __GNC_XML_WRITER_HPP__
+
+extern "C"
+{
+#include <stdio.h>
+#include <glib.h>
+
+#include "gnc-commodity.h"
+#include "qof.h"
+}
+
+#include <string>
+
+/** Serializes elements straight into a buffer, producing exactly the
+ * bytes that building the equivalent tree with the *_to_dom_tree
+ * generators and dumping it with xmlElemDump would.  Elements are
+ * indented by depth and each is followed by a newline, so a top-level
+ * element comes out as xmlElemDump's output plus the "\n" the file
+ * writer appends.
+ *
+ * Attribute values are written verbatim and must be plain ASCII
+ * without markup characters; they are all constants in the file
+ * format.  Element text is sanitized with checked_char_cast and
+ * escaped the way libxml2 escapes text content.
+ *
+ * Nothing reaches the FILE until flush() or a flush_if_full() that
+ * finds the buffer full, so a caller can rollback() to a mark() to
+ * drop an object that turns out to be unwritable.
+ */
+class GncXmlWriter
+{
+public:
+    struct Mark
+    {
+        size_t size;
+        int depth;
+        bool open;
+    };
+
+    /** @param out The file to flush to; nullptr to only fill str(). */
+    explicit GncXmlWriter (FILE* out) : m_out{out} {}
+    GncXmlWriter (const GncXmlWriter&) = delete;
+    GncXmlWriter& operator= (const GncXmlWriter&) = delete;
+    ~GncXmlWriter () = default;
+
+    /** Open an element that will have element children.  If none are
+     * added before end_element() it is written as an empty tag. */
+    void start_element (const char* tag, const char* attr = nullptr,
+                        const char* value = nullptr);
+    void end_element (const char* tag);
+    /** Like xmlNewTextChild: a NULL str makes an empty tag, an empty
+     * one a start and end tag with nothing between them. */
+    void text_element (const char* tag, const char* str,
+                       const char* attr = nullptr,
+                       const char* value = nullptr);
+
+    /* These mirror the generators in sixtp-dom-generators.h and
+     * write nothing where those return NULL. */
+    bool guid_element (const char* tag, const GncGUID* guid);
+    bool commodity_ref_element (const char* tag, const gnc_commodity* c);
+    bool time64_element (const char* tag, time64 time,
+                         const char* attr = nullptr,
+                         const char* value = nullptr);
+    void numeric_element (const char* tag, gnc_numeric num);
+    void slots_element (const char* tag, const QofInstance* inst);
+
+    Mark mark () const noexcept { return {m_buf.size (), m_depth, m_open}; }
+    void rollback (const Mark& mark);
+
+    /** Write the buffer to the file if it has grown past a threshold.
+     * @return false if the file reports an error. */
+    bool flush_if_full ();
+    /** Write the whole buffer to the file.
+     * @return false if the file reports an error. */
+    bool flush ();
+    const std::string& str () const noexcept { return m_buf; }
+
+private:
+    void indent ();
+    void open_tag (const char* tag, const char* attr, const char* value);
+    void close_start_tag ();
+    void append_text (const char* str);
+    void append_escaped (const char* str);
+    void kvp_value_element (const char* tag, KvpValue* val);
+    void slot_element (const char* key, KvpValue* val);
+
+    FILE* m_out;
+    std::string m_buf;
+    int m_depth = 0;
+    bool m_open = false;
+};
+
+#endif /* __GNC_XML_WRITER_HPP__ */
@@ -34,6 +34,7 @@ extern "C"
 }
 
 #include "gnc-xml-helper.h"
+#include "gnc-xml-writer.hpp"
 #include "sixtp.h"
 
 xmlNodePtr gnc_account_dom_tree_create (Account* act, gboolean exporting,
@@ -47,6 +48,7 @@ sixtp* gnc_book_slots_sixtp_parser_create (void);
 
 xmlNodePtr gnc_commodity_dom_tree_create (const gnc_commodity* com);
 sixtp* gnc_commodity_sixtp_parser_create (void);
+sixtp* gnc_commodity_ref_sixtp_parser_create (void);
 
 sixtp* gnc_freqSpec_sixtp_parser_create (void);
 
@@ -54,6 +56,7 @@ xmlNodePtr gnc_lot_dom_tree_create (GNCLot*);
 sixtp* gnc_lot_sixtp_parser_create (void);
 
 xmlNodePtr gnc_pricedb_dom_tree_create (GNCPriceDB* db);
+gboolean gnc_price_write_xml (GncXmlWriter& writer, GNCPrice* price);
 sixtp* gnc_pricedb_sixtp_parser_create (void);
 
 xmlNodePtr gnc_schedXaction_dom_tree_create (SchedXaction* sx);
@@ -63,6 +66,7 @@ xmlNodePtr gnc_budget_dom_tree_create (GncBudget* bgt);
 sixtp* gnc_budget_sixtp_parser_create (void);
 
 xmlNodePtr gnc_transaction_dom_tree_create (Transaction* txn);
+void gnc_transaction_write_xml (GncXmlWriter& writer, Transaction* txn);
 sixtp* gnc_transaction_sixtp_parser_create (void);
 
 sixtp* gnc_template_transaction_sixtp_parser_create (void);
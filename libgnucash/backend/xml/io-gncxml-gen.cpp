@@ -56,6 +56,6 @@ gnc_xml_parse_fd (sixtp* top_parser, FILE* fd,
     gpdata.parsedata = parsedata;
     gpdata.bookdata = bookdata;
 
-    return sixtp_parse_fd (top_parser, fd,
-                           NULL, &gpdata, &parse_result);
+    return sixtp_parse_fd_pipelined (top_parser, fd,
+                                     NULL, &gpdata, &parse_result);
 }
@@ -107,6 +107,7 @@ struct file_backend
     sixtp*          parser;
     FILE*           out;
     QofBook*        book;
+    GncXmlWriter*   writer;
 };
 
 static std::vector<GncXmlDataType_t> backend_registry;
@@ -1115,74 +1116,56 @@ write_commodities (FILE* out, QofBook* book, sixtp_gdv2* gd)
     return success;
 }
 
-static gboolean
-write_pricedb (FILE* out, QofBook* book, sixtp_gdv2* gd)
+struct pricedb_write_data
 {
-    xmlNodePtr node;
-    xmlNodePtr parent;
-    xmlOutputBufferPtr outbuf;
+    GncXmlWriter* writer;
+    sixtp_gdv2* gd;
+    gint n_prices;
+};
 
-    parent = gnc_pricedb_dom_tree_create (gnc_pricedb_get_db (book));
+static gboolean
+xml_add_price_data (GNCPrice* p, gpointer data)
+{
+    auto pw = static_cast<pricedb_write_data*> (data);
 
-    if (!parent)
-    {
+    if (!p)
         return TRUE;
-    }
-
-    /* Write out the parent pricedb tag then loop to write out each price.
-       We do it this way instead of just calling xmlElemDump so that we can
-       increment the progress bar as we go. */
-
-    if (fprintf (out, "<%s version=\"%s\">\n", parent->name,
-                 xmlGetProp (parent, BAD_CAST "version")) < 0)
+    if (!gnc_price_write_xml (*pw->writer, p))
         return FALSE;
+    pw->n_prices++;
+    pw->gd->counter.prices_loaded += 1;
+    sixtp_run_callback (pw->gd, "prices");
+    return TRUE;
+}
 
-    /* We create our own output buffer so we can call xmlNodeDumpOutput to get
-       the indentation correct. */
-    outbuf = xmlOutputBufferCreateFile (out, NULL);
-    if (outbuf == NULL)
-    {
-        xmlFreeNode (parent);
-        return FALSE;
-    }
-
-    for (node = parent->children; node; node = node->next)
-    {
-        /* Write two spaces since xmlNodeDumpOutput doesn't indent the first line */
-        xmlOutputBufferWrite (outbuf, 2, "  ");
-        xmlNodeDumpOutput (outbuf, NULL, node, 1, 1, NULL);
-        /* It also doesn't terminate the last line */
-        xmlOutputBufferWrite (outbuf, 1, "\n");
-        if (ferror (out))
-            break;
-        gd->counter.prices_loaded += 1;
-        sixtp_run_callback (gd, "prices");
-    }
-
-    xmlOutputBufferClose (outbuf);
-
-    if (ferror (out) || fprintf (out, "</%s>\n", parent->name) < 0)
-    {
-        xmlFreeNode (parent);
-        return FALSE;
-    }
+static gboolean
+write_pricedb (FILE* out, QofBook* book, sixtp_gdv2* gd)
+{
+    GncXmlWriter writer (out);
+    pricedb_write_data pw {&writer, gd, 0};
+
+    /* The prices are written straight into the writer's buffer, which is
+       only flushed once the whole pricedb is known to be writable: like
+       gnc_pricedb_dom_tree_create, a price that can't be written or an
+       empty pricedb means no pricedb element at all. */
+    writer.start_element ("gnc:pricedb", "version", "1");
+    if (!gnc_pricedb_foreach_price (gnc_pricedb_get_db (book),
+                                    xml_add_price_data, &pw, TRUE) ||
+        pw.n_prices == 0)
+        return TRUE;
+    writer.end_element ("gnc:pricedb");
 
-    xmlFreeNode (parent);
-    return TRUE;
+    return writer.flush ();
 }
 
 static int
 xml_add_trn_data (Transaction* t, gpointer data)
 {
     struct file_backend* be_data = static_cast<decltype (be_data)> (data);
-    xmlNodePtr node;
-
-    node = gnc_transaction_dom_tree_create (t);
 
-    xmlElemDump (be_data->out, NULL, node);
-    xmlFreeNode (node);
+    gnc_transaction_write_xml (*be_data->writer, t);
 
-    if (ferror (be_data->out) || fprintf (be_data->out, "\n") < 0)
+    if (!be_data->writer->flush_if_full ())
         return -1;
 
     be_data->gd->counter.transactions_loaded++;
@@ -1194,13 +1177,16 @@ static gboolean
 write_transactions (FILE* out, QofBook* book, sixtp_gdv2* gd)
 {
     struct file_backend be_data;
+    GncXmlWriter writer (out);
 
     be_data.out = out;
     be_data.gd = gd;
+    be_data.writer = &writer;
     return 0 ==
            xaccAccountTreeForEachTransaction (gnc_book_get_root_account (book),
                                               xml_add_trn_data,
-                                              (gpointer) &be_data);
+                                              (gpointer) &be_data)
+           && writer.flush ();
 }
 
 static gboolean
@@ -1215,9 +1201,13 @@ write_template_transaction_data (FILE* out, QofBook* book, sixtp_gdv2* gd)
     ra = gnc_book_get_template_root (book);
     if (gnc_account_n_descendants (ra) > 0)
     {
+        GncXmlWriter writer (out);
+        be_data.writer = &writer;
+
         if (fprintf (out, "<%s>\n", TEMPLATE_TRANSACTION_TAG) < 0
             || !write_account_tree (out, ra, gd)
             || xaccAccountTreeForEachTransaction (ra, xml_add_trn_data, (gpointer)&be_data)
+            || !writer.flush ()
             || fprintf (out, "</%s>\n", TEMPLATE_TRANSACTION_TAG) < 0)
 
             return FALSE;
@@ -1403,6 +1393,242 @@ gnc_book_write_accounts_to_xml_filehandle_v2 (QofBackend* qof_be, QofBook* book,
 
 #define BUFLEN 4096
 
+/* Parallel compression, after pigz: the data is cut into blocks that
+ * are deflated independently on a thread pool, each primed with the
+ * last 32k of the block before it.  Every block but the last ends with
+ * a sync flush, so the raw deflate streams concatenate into one, which
+ * is wrapped in an ordinary gzip header and trailer.  The CRCs of the
+ * blocks are combined as they are written out in order. */
+#define GZ_BLOCK_SIZE (128 * 1024)
+#define GZ_DICT_SIZE (32 * 1024)
+
+typedef struct
+{
+    guchar* in;
+    gsize in_len;
+    guchar dict[GZ_DICT_SIZE];
+    gsize dict_len;
+    gboolean last;
+    guchar* out;
+    gsize out_len;
+    guint32 crc;
+    gboolean done;
+    gboolean ok;
+} gz_block_t;
+
+typedef struct
+{
+    GMutex mutex;
+    GCond cond;
+} gz_pool_data_t;
+
+static void
+gz_deflate_block (gpointer data, gpointer user_data)
+{
+    gz_block_t* block = static_cast<decltype (block)> (data);
+    gz_pool_data_t* pool_data = static_cast<decltype (pool_data)> (user_data);
+    gint flush = block->last ? Z_FINISH : Z_SYNC_FLUSH;
+    gboolean ok = FALSE;
+    z_stream strm;
+    gsize out_size;
+
+    block->crc = crc32 (crc32 (0L, Z_NULL, 0), block->in, block->in_len);
+
+    memset (&strm, 0, sizeof (strm));
+    if (deflateInit2 (&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS,
+                      8, Z_DEFAULT_STRATEGY) == Z_OK)
+    {
+        if (block->dict_len)
+            deflateSetDictionary (&strm, block->dict, block->dict_len);
+
+        /* Leave room for the sync flush marker. */
+        out_size = deflateBound (&strm, block->in_len) + 16;
+        block->out = g_new (guchar, out_size);
+        strm.next_in = block->in;
+        strm.avail_in = block->in_len;
+        strm.next_out = block->out;
+        strm.avail_out = out_size;
+
+        while (TRUE)
+        {
+            gint ret = deflate (&strm, flush);
+            if (ret == Z_STREAM_ERROR)
+                break;
+            if (flush == Z_FINISH ? ret == Z_STREAM_END : strm.avail_out != 0)
+            {
+                ok = TRUE;
+                break;
+            }
+            out_size *= 2;
+            block->out = g_renew (guchar, block->out, out_size);
+            strm.next_out = block->out + strm.total_out;
+            strm.avail_out = out_size - strm.total_out;
+        }
+        block->out_len = strm.total_out;
+        deflateEnd (&strm);
+    }
+
+    g_mutex_lock (&pool_data->mutex);
+    block->ok = ok;
+    block->done = TRUE;
+    g_cond_broadcast (&pool_data->cond);
+    g_mutex_unlock (&pool_data->mutex);
+}
+
+static void
+gz_block_free (gz_block_t* block)
+{
+    g_free (block->in);
+    g_free (block->out);
+    g_free (block);
+}
+
+/* Wait for the oldest pending block if block is TRUE, then write it
+ * out.  Returns FALSE if there was nothing to write. */
+static gboolean
+gz_write_next_block (GQueue* pending, gz_pool_data_t* pool_data,
+                     gboolean block, FILE* file, const gchar* filename,
+                     guint32* crc, guint32* isize, gint* success)
+{
+    gz_block_t* head = static_cast<decltype (head)> (g_queue_peek_head (pending));
+    gboolean done;
+
+    if (!head)
+        return FALSE;
+
+    g_mutex_lock (&pool_data->mutex);
+    while (block && !head->done)
+        g_cond_wait (&pool_data->cond, &pool_data->mutex);
+    done = head->done;
+    g_mutex_unlock (&pool_data->mutex);
+
+    if (!done)
+        return FALSE;
+
+    g_queue_pop_head (pending);
+    if (*success)
+    {
+        if (!head->ok)
+        {
+            g_warning ("Could not compress the data for '%s'", filename);
+            *success = 0;
+        }
+        else if (fwrite (head->out, 1, head->out_len, file) != head->out_len)
+        {
+            g_warning ("Could not write the compressed file '%s'. The error is: '%s' (%d)",
+                       filename, g_strerror (errno) ? g_strerror (errno) : "", errno);
+            *success = 0;
+        }
+        *crc = crc32_combine (*crc, head->crc, head->in_len);
+        *isize += head->in_len;
+    }
+    gz_block_free (head);
+    return TRUE;
+}
+
+static gint
+gz_compress_parallel (gz_thread_params_t* params, GThreadPool* pool,
+                      gz_pool_data_t* pool_data)
+{
+    static const guchar header[10] =
+    { 0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 0xff };
+    guint max_pending = 2 * g_thread_pool_get_max_threads (pool);
+    GQueue pending = G_QUEUE_INIT;
+    guchar dict[GZ_DICT_SIZE];
+    gsize dict_len = 0;
+    guint32 crc = crc32 (0L, Z_NULL, 0);
+    guint32 isize = 0;
+    gboolean eof = FALSE;
+    gint success = 1;
+    guchar trailer[8];
+    gchar* perms;
+    FILE* file;
+
+    /* Open the file the way gzopen would have, but always in binary mode. */
+    if (strchr (params->perms, 'b'))
+        perms = g_strdup (params->perms);
+    else
+        perms = g_strdup_printf ("%cb%s", *params->perms, params->perms + 1);
+    file = g_fopen (params->filename, perms);
+    g_free (perms);
+    if (file == NULL)
+    {
+        g_warning ("Could not open '%s' for compressed output", params->filename);
+        return 0;
+    }
+
+    if (fwrite (header, 1, sizeof (header), file) != sizeof (header))
+        success = 0;
+
+    while (success && !eof)
+    {
+        gz_block_t* block = g_new0 (gz_block_t, 1);
+
+        block->in = g_new (guchar, GZ_BLOCK_SIZE);
+        while (block->in_len < GZ_BLOCK_SIZE)
+        {
+            gssize bytes = read (params->fd, block->in + block->in_len,
+                                 GZ_BLOCK_SIZE - block->in_len);
+            if (bytes > 0)
+                block->in_len += bytes;
+            else if (bytes == 0)
+            {
+                eof = TRUE;
+                break;
+            }
+            else if (errno != EINTR)
+            {
+                g_warning ("Could not read from pipe. The error is '%s' (errno %d)",
+                           g_strerror (errno) ? g_strerror (errno) : "", errno);
+                success = 0;
+                break;
+            }
+        }
+        if (!success)
+        {
+            gz_block_free (block);
+            break;
+        }
+
+        block->last = eof;
+        memcpy (block->dict, dict, dict_len);
+        block->dict_len = dict_len;
+        dict_len = MIN (block->in_len, GZ_DICT_SIZE);
+        memcpy (dict, block->in + block->in_len - dict_len, dict_len);
+
+        g_queue_push_tail (&pending, block);
+        g_thread_pool_push (pool, block, NULL);
+
+        /* Write whatever is finished, and wait when too much is queued. */
+        while (gz_write_next_block (&pending, pool_data,
+                                    g_queue_get_length (&pending) > max_pending,
+                                    file, params->filename, &crc, &isize,
+                                    &success))
+            ;
+    }
+
+    /* Drain the queue even after an error; the pool still owns the blocks. */
+    while (gz_write_next_block (&pending, pool_data, TRUE, file,
+                                params->filename, &crc, &isize, &success))
+        ;
+
+    for (int i = 0; i < 4; i++)
+    {
+        trailer[i] = (crc >> (8 * i)) & 0xff;
+        trailer[i + 4] = (isize >> (8 * i)) & 0xff;
+    }
+    if (success && fwrite (trailer, 1, sizeof (trailer), file) != sizeof (trailer))
+        success = 0;
+
+    if (fclose (file) != 0)
+    {
+        g_warning ("Could not close the compressed file '%s'", params->filename);
+        success = 0;
+    }
+
+    return success;
+}
+
 /* Compress or decompress function that is to be run in a separate thread.
  * Returns 1 on success or 0 otherwise, stuffed into a pointer type. */
 static gpointer
@@ -1414,6 +1640,27 @@ gz_thread_func (gz_thread_params_t* params)
     gzFile file;
     gint success = 1;
 
+    if (params->compress && g_get_num_processors () > 1)
+    {
+        gz_pool_data_t pool_data;
+        GThreadPool* pool;
+
+        g_mutex_init (&pool_data.mutex);
+        g_cond_init (&pool_data.cond);
+        pool = g_thread_pool_new (gz_deflate_block, &pool_data,
+                                  g_get_num_processors (), FALSE, NULL);
+        if (pool)
+        {
+            success = gz_compress_parallel (params, pool, &pool_data);
+            g_thread_pool_free (pool, FALSE, TRUE);
+        }
+        g_mutex_clear (&pool_data.mutex);
+        g_cond_clear (&pool_data.cond);
+        if (pool)
+            goto cleanup_gz_thread_func;
+        g_warning ("Could not create threads for compression, using one.");
+    }
+
 #ifdef G_OS_WIN32
     {
         gchar* conv_name = g_win32_locale_filename_from_utf8 (params->filename);
@@ -1676,6 +1923,257 @@ gnc_book_write_accounts_to_xml_file_v2 (QofBackend* qof_be, QofBook* book,
     return success;
 }
 
+/***********************************************************************/
+/* A journal holds the changes saved since the data file was last
+ * written.  It starts with a comment naming the data file it applies to,
+ * followed by records, each a top level element:
+ *
+ *   <gnc:journal-delete type="transaction|price">guid</gnc:journal-delete>
+ *     drops that object if the book has it;
+ *   <gnc:transaction> and <gnc:pricedb>, as in the data file, add objects.
+ *
+ * A save appends a delete for each changed object followed by the ones
+ * that still exist, so replaying it replaces or removes each of them.
+ */
+
+static const char* JOURNAL_TAG = "gnc-journal";
+static const char* JOURNAL_DELETE_TAG = "gnc:journal-delete";
+static const char* JOURNAL_TRANSACTION = "transaction";
+static const char* JOURNAL_PRICE = "price";
+
+static std::string
+journal_header (const char* base)
+{
+    return std::string {"<!-- "} + JOURNAL_TAG + " base=\"" + base + "\" -->\n";
+}
+
+static void
+write_journal_delete (GncXmlWriter& writer, const char* type,
+                      const GncGUID* guid)
+{
+    char guid_str[GUID_ENCODING_LENGTH + 1];
+
+    guid_to_string_buff (guid, guid_str);
+    writer.text_element (JOURNAL_DELETE_TAG, guid_str, "type", type);
+}
+
+static gboolean
+journal_has_header (const char* filename, const std::string& header)
+{
+    std::string start (header.size (), '\0');
+    auto in = g_fopen (filename, "rb");
+
+    if (!in)
+        return FALSE;
+    auto n_read = fread (&start[0], 1, start.size (), in);
+    fclose (in);
+    return n_read == start.size () && start == header;
+}
+
+gboolean
+gnc_book_append_journal_v2 (QofBook* book, const char* filename,
+                            const char* base,
+                            const std::vector<GncGUID>& transactions,
+                            const std::vector<GncGUID>& prices)
+{
+    GncXmlWriter writer (nullptr);
+    GStatBuf statbuf;
+    auto header = journal_header (base);
+    gboolean is_new = g_stat (filename, &statbuf) != 0 || statbuf.st_size == 0;
+    gboolean success = TRUE;
+
+    if (!is_new && !journal_has_header (filename, header))
+    {
+        PWARN ("Journal %s was written against another data file", filename);
+        return FALSE;
+    }
+
+    for (auto& guid : transactions)
+    {
+        write_journal_delete (writer, JOURNAL_TRANSACTION, &guid);
+        auto trans = xaccTransLookup (&guid, book);
+        if (trans)
+            gnc_transaction_write_xml (writer, trans);
+    }
+
+    for (auto& guid : prices)
+        write_journal_delete (writer, JOURNAL_PRICE, &guid);
+
+    /* A price that can't be written is left out on its own rather than
+       taking the others with it as it does in the data file. */
+    auto db_mark = writer.mark ();
+    gint n_prices = 0;
+    writer.start_element (PRICEDB_TAG, "version", "1");
+    for (auto& guid : prices)
+    {
+        auto price = gnc_price_lookup (&guid, book);
+        if (!price || !price->db)
+            continue;
+
+        auto mark = writer.mark ();
+        if (gnc_price_write_xml (writer, price))
+            n_prices++;
+        else
+            writer.rollback (mark);
+    }
+    if (n_prices)
+        writer.end_element (PRICEDB_TAG);
+    else
+        writer.rollback (db_mark);
+
+    /* The records go out in one write so that a failed save is unlikely
+       to leave half of them behind. */
+    auto out = g_fopen (filename, "ab");
+    if (!out)
+        return FALSE;
+    if (is_new && fputs (header.c_str (), out) == EOF)
+        success = FALSE;
+    auto& records = writer.str ();
+    if (success &&
+        fwrite (records.data (), 1, records.size (), out) != records.size ())
+        success = FALSE;
+    if (fclose (out))
+        success = FALSE;
+
+    return success;
+}
+
+static gboolean
+journal_delete (xmlNodePtr node, QofBook* book)
+{
+    auto type = reinterpret_cast<char*> (xmlGetProp (node, BAD_CAST "type"));
+    auto text = dom_tree_to_text (node);
+    GncGUID guid;
+    gboolean ok = type && text && string_to_guid (text, &guid);
+
+    if (ok && g_strcmp0 (type, JOURNAL_TRANSACTION) == 0)
+    {
+        auto trans = xaccTransLookup (&guid, book);
+        if (trans)
+        {
+            /* Not xaccTransDestroy, which refuses read-only ones. */
+            xaccTransBeginEdit (trans);
+            qof_instance_set_destroying (trans, TRUE);
+            xaccTransCommitEdit (trans);
+        }
+    }
+    else if (ok && g_strcmp0 (type, JOURNAL_PRICE) == 0)
+    {
+        auto price = gnc_price_lookup (&guid, book);
+        if (price && price->db)
+            gnc_pricedb_remove_price (price->db, price);
+    }
+    else
+    {
+        PWARN ("bad %s record", JOURNAL_DELETE_TAG);
+        ok = FALSE;
+    }
+
+    xmlFree (type);
+    g_free (text);
+    return ok;
+}
+
+static gboolean
+journal_delete_end_handler (gpointer data_for_children,
+                            GSList* data_from_children, GSList* sibling_data,
+                            gpointer parent_data, gpointer global_data,
+                            gpointer* result, const gchar* tag)
+{
+    gboolean successful;
+    xmlNodePtr tree = (xmlNodePtr)data_for_children;
+    gxpf_data* gdata = (gxpf_data*)global_data;
+    sixtp_gdv2* gd = (sixtp_gdv2*)gdata->parsedata;
+
+    if (parent_data) return TRUE;
+    if (!tag) return TRUE;
+
+    g_return_val_if_fail (tree, FALSE);
+
+    successful = journal_delete (tree, gd->book);
+    xmlFreeNode (tree);
+
+    return successful;
+}
+
+static gboolean
+journal_callback (const char* tag, gpointer globaldata, gpointer data)
+{
+    sixtp_gdv2* gd = (sixtp_gdv2*)globaldata;
+
+    /* Prices went into the book's pricedb as they were read. */
+    if (g_strcmp0 (tag, TRANSACTION_TAG) == 0)
+        add_transaction_local (gd, (Transaction*)data);
+    return TRUE;
+}
+
+gboolean
+gnc_book_replay_journal_v2 (QofBook* book, const char* filename,
+                            const char* base, size_t* n_records)
+{
+    gchar* contents;
+    gsize length;
+    gpointer parse_result = NULL;
+    gxpf_data gpdata;
+    sixtp* top_parser;
+    sixtp* journal_parser;
+    gboolean retval;
+
+    if (!g_file_get_contents (filename, &contents, &length, NULL))
+    {
+        PWARN ("Unable to read journal %s", filename);
+        return FALSE;
+    }
+
+    auto header = journal_header (base);
+    if (length < header.size () ||
+        strncmp (contents, header.c_str (), header.size ()) != 0)
+    {
+        PWARN ("Journal %s was written against another data file", filename);
+        g_free (contents);
+        return FALSE;
+    }
+
+    /* The records are a sequence of fragments; give them a root. */
+    std::string buf {"<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n<"};
+    buf = buf + JOURNAL_TAG + ">\n";
+    buf.append (contents + header.size (), length - header.size ());
+    buf = buf + "</" + JOURNAL_TAG + ">\n";
+    g_free (contents);
+
+    top_parser = sixtp_new ();
+    journal_parser = sixtp_new ();
+    if (!sixtp_add_some_sub_parsers (
+            top_parser, TRUE,
+            JOURNAL_TAG, journal_parser,
+            NULL, NULL)
+        || !sixtp_add_some_sub_parsers (
+            journal_parser, TRUE,
+            JOURNAL_DELETE_TAG,
+            sixtp_dom_parser_new (journal_delete_end_handler, NULL, NULL),
+            TRANSACTION_TAG, gnc_transaction_sixtp_parser_create (),
+            PRICEDB_TAG, gnc_pricedb_sixtp_parser_create (),
+            NULL, NULL))
+        return FALSE;
+
+    auto gd = gnc_sixtp_gdv2_new (book, FALSE, NULL, NULL);
+    gpdata.cb = journal_callback;
+    gpdata.parsedata = gd;
+    gpdata.bookdata = book;
+
+    /* Like the data file, the journal's transactions are already in the
+       log. */
+    xaccLogDisable ();
+    retval = sixtp_parse_buffer (top_parser, &buf[0], buf.size (), NULL,
+                                 &gpdata, &parse_result);
+    xaccLogEnable ();
+
+    *n_records += gd->counter.transactions_loaded + gd->counter.prices_loaded;
+    sixtp_destroy (top_parser);
+    g_free (gd);
+    return retval;
+}
+
 /***********************************************************************/
 static gboolean
 is_gzipped_file (const gchar* name)
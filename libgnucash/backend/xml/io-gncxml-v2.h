@@ -93,6 +93,21 @@ gboolean gnc_book_write_to_xml_filehandle_v2 (QofBook* book, FILE* fh);
 gboolean gnc_book_write_to_xml_file_v2 (QofBook* book, const char* filename,
                                         gboolean compress);
 
+/** Append a record for each of the given transactions and prices to a
+ * journal, starting it with the base line if it is new.  A record
+ * replaces the object when replayed, or deletes it if it no longer
+ * exists in the book. */
+gboolean gnc_book_append_journal_v2 (QofBook* book, const char* filename,
+                                     const char* base,
+                                     const std::vector<GncGUID>& transactions,
+                                     const std::vector<GncGUID>& prices);
+/** Replay a journal onto a book just loaded from its data file.  Returns
+ * FALSE, having replayed nothing, if the journal was written against a
+ * different base, or having replayed the records before it if one is
+ * damaged.  The number replayed is added to *n_records. */
+gboolean gnc_book_replay_journal_v2 (QofBook* book, const char* filename,
+                                     const char* base, size_t* n_records);
+
 /** write just the commodities and accounts to a file */
 gboolean gnc_book_write_accounts_to_xml_filehandle_v2 (QofBackend* be,
                                                        QofBook* book, FILE* fh);
@@ -520,7 +520,7 @@ dom_tree_to_gnc_numeric (xmlNodePtr node)
 
     gnc_numeric *ret = g_new (gnc_numeric, 1);
 
-    if (!string_to_gnc_numeric (content, ret))
+    if (!string_to_numeric (content, ret))
 	*ret = gnc_numeric_zero ();
     g_free (content);
     return ret;
@@ -567,7 +567,7 @@ dom_tree_to_time64 (xmlNodePtr node)
                         return INT64_MAX;
                     }
 
-                    ret = gnc_iso8601_to_time64_gmt (content);
+                    ret = string_to_time64 (content);
                     g_free (content);
                     seen = TRUE;
                 }
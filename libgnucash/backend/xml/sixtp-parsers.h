@@ -35,4 +35,12 @@ sixtp* sixtp_dom_parser_new (sixtp_end_handler ender,
                              sixtp_result_handler cleanup_result_by_default_func,
                              sixtp_result_handler cleanup_result_on_fail_func);
 
+/* Create a parser that turns just the element it is registered for
+   into a DOM tree, independently of parent_data, and hands it to the
+   parent's after_child handler as the xmlNodePtr child result.  The
+   tree is freed with the child result unless the parent clears
+   should_cleanup.
+*/
+sixtp* sixtp_dom_subtree_parser_new (void);
+
 #endif /* _SIXTP_PARSERS_H_ */
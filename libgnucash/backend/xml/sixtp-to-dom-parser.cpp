@@ -141,3 +141,69 @@ sixtp_dom_parser_new (sixtp_end_handler ender,
 
     return top_level;
 }
+
+static gboolean
+dom_subtree_start_handler (
+    GSList* sibling_data, gpointer parent_data, gpointer global_data,
+    gpointer* data_for_children, gpointer* result, const gchar* tag,
+    gchar** attrs)
+{
+    /* Always start a fresh tree; parent_data belongs to whatever
+       non-DOM parser we're embedded in. */
+    return dom_start_handler (sibling_data, NULL, global_data,
+                              data_for_children, result, tag, attrs);
+}
+
+static gboolean
+dom_subtree_end_handler (gpointer data_for_children,
+                         GSList* data_from_children, GSList* sibling_data,
+                         gpointer parent_data, gpointer global_data,
+                         gpointer* result, const gchar* tag)
+{
+    /* *result was set to the root node by the start handler. */
+    return TRUE;
+}
+
+static void
+dom_subtree_cleanup_result (sixtp_child_result* result)
+{
+    if (result->data) xmlFreeNode (static_cast<xmlNodePtr> (result->data));
+    result->data = NULL;
+}
+
+sixtp*
+sixtp_dom_subtree_parser_new (void)
+{
+    sixtp* top_level;
+    sixtp* children;
+
+    if (! (top_level =
+               sixtp_set_any (sixtp_new (), FALSE,
+                              SIXTP_START_HANDLER_ID, dom_subtree_start_handler,
+                              SIXTP_CHARACTERS_HANDLER_ID, dom_chars_handler,
+                              SIXTP_END_HANDLER_ID, dom_subtree_end_handler,
+                              SIXTP_FAIL_HANDLER_ID, dom_fail_handler,
+                              SIXTP_CLEANUP_RESULT_ID, dom_subtree_cleanup_result,
+                              SIXTP_RESULT_FAIL_ID, dom_subtree_cleanup_result,
+                              SIXTP_NO_MORE_HANDLERS)))
+    {
+        return NULL;
+    }
+
+    /* Descendants hang off the root built above, so the plain DOM
+       parser's end handler never sees a NULL parent_data. */
+    if (! (children = sixtp_dom_parser_new (dom_subtree_end_handler,
+                                            NULL, NULL)))
+    {
+        sixtp_destroy (top_level);
+        return NULL;
+    }
+
+    if (!sixtp_add_sub_parser (top_level, SIXTP_MAGIC_CATCHER, children))
+    {
+        sixtp_destroy (top_level);
+        return NULL;
+    }
+
+    return top_level;
+}
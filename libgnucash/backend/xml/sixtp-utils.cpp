@@ -224,6 +224,143 @@ string_to_gint32 (const gchar* str, gint32* v)
     return (TRUE);
 }
 
+/*********/
+/* time64
+ */
+
+static inline gboolean
+fixed_digits_to_int (const gchar* str, int n, int* v)
+{
+    int val = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (str[i] < '0' || str[i] > '9') return FALSE;
+        val = val * 10 + (str[i] - '0');
+    }
+    *v = val;
+    return TRUE;
+}
+
+/* Days from 1970-01-01 to y-m-d in the proleptic Gregorian calendar. */
+static inline gint64
+days_from_civil (int y, int m, int d)
+{
+    y -= m <= 2;
+    gint64 era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+/* Decodes exactly "YYYY-MM-DD HH:MM:SS +HHMM", which is what
+   time64_to_dom_tree writes.  Returns FALSE for anything else,
+   including dates GncDateTime would reject, so that the caller can
+   fall back to the general parser. */
+static gboolean
+fixed_iso8601_to_time64 (const gchar* str, time64* v)
+{
+    static const int month_days[] =
+    { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    int year, month, day, hour, min, sec, off_hour, off_min;
+    gboolean leap;
+    gint64 offset;
+
+    /* Checked left to right, so a short string stops at its NUL. */
+    if (!fixed_digits_to_int (str, 4, &year) || str[4] != '-' ||
+        !fixed_digits_to_int (str + 5, 2, &month) || str[7] != '-' ||
+        !fixed_digits_to_int (str + 8, 2, &day) || str[10] != ' ' ||
+        !fixed_digits_to_int (str + 11, 2, &hour) || str[13] != ':' ||
+        !fixed_digits_to_int (str + 14, 2, &min) || str[16] != ':' ||
+        !fixed_digits_to_int (str + 17, 2, &sec) || str[19] != ' ' ||
+        (str[20] != '+' && str[20] != '-') ||
+        !fixed_digits_to_int (str + 21, 2, &off_hour) ||
+        !fixed_digits_to_int (str + 23, 2, &off_min) || str[25] != '\0')
+        return FALSE;
+
+    if (year < 1400 || month < 1 || month > 12 || day < 1 ||
+        hour > 23 || min > 59 || sec > 59 || off_hour > 23 || off_min > 59)
+        return FALSE;
+
+    leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    if (day > month_days[month - 1] + (month == 2 && leap ? 1 : 0))
+        return FALSE;
+
+    /* Boost's posix_time_zone only takes offsets from -12:00 to +14:00,
+       and GncDateTime treats ones of less than an hour as UTC. */
+    offset = off_hour * 3600 + off_min * 60;
+    if (str[20] == '-') offset = -offset;
+    if (offset < -12 * 3600 || offset > 14 * 3600)
+        return FALSE;
+    if (off_hour == 0)
+        offset = 0;
+
+    *v = days_from_civil (year, month, day) * 86400 +
+         hour * 3600 + min * 60 + sec - offset;
+    return TRUE;
+}
+
+time64
+string_to_time64 (const gchar* str)
+{
+    time64 t;
+
+    if (str && fixed_iso8601_to_time64 (str, &t))
+        return t;
+    return gnc_iso8601_to_time64_gmt (str);
+}
+
+/*********/
+/* gnc_numeric
+ */
+
+/* Decodes exactly "-?[0-9]+/[0-9]+" with a non-zero denominator, which
+   is what gnc_numeric_to_dom_tree writes.  Returns FALSE for anything
+   else, and for numbers too long to be sure they fit in a gint64. */
+static gboolean
+fixed_rational_to_numeric (const gchar* str, gnc_numeric* n)
+{
+    const gchar* p = str;
+    gboolean negative = FALSE;
+    gint64 num = 0, denom = 0;
+    int digits;
+
+    if (*p == '-')
+    {
+        negative = TRUE;
+        p++;
+    }
+
+    for (digits = 0; *p >= '0' && *p <= '9'; p++)
+    {
+        if (++digits > 18) return FALSE;
+        num = num * 10 + (*p - '0');
+    }
+    if (digits == 0 || *p++ != '/') return FALSE;
+
+    for (digits = 0; *p >= '0' && *p <= '9'; p++)
+    {
+        if (++digits > 18) return FALSE;
+        denom = denom * 10 + (*p - '0');
+    }
+    if (digits == 0 || *p != '\0' || denom == 0) return FALSE;
+
+    n->num = negative ? -num : num;
+    n->denom = denom;
+    return TRUE;
+}
+
+gboolean
+string_to_numeric (const gchar* str, gnc_numeric* n)
+{
+    g_return_val_if_fail (str, FALSE);
+    g_return_val_if_fail (n, FALSE);
+
+    if (fixed_rational_to_numeric (str, n))
+        return TRUE;
+    return string_to_gnc_numeric (str, n);
+}
+
 /************/
 /* hex string
  */
@@ -435,10 +572,10 @@ generic_timespec_secs_end_handler (gpointer data_for_children,
     txt = concatenate_child_result_chars (data_from_children);
     g_return_val_if_fail (txt, FALSE);
 
-    info->time = gnc_iso8601_to_time64_gmt (txt);
+    info->time = string_to_time64 (txt);
     g_free (txt);
 
-// gnc_iso8601_to_time64_gmt returns INT64_MAX on failure.
+// string_to_time64 returns INT64_MAX on failure.
     g_return_val_if_fail (info->time < INT64_MAX, FALSE);
 
     info->s_block_count++;
@@ -509,6 +646,116 @@ generic_timespec_parser_new (sixtp_end_handler end_handler)
     return (top_level);
 }
 
+/****************************************************************************/
+/* generic time64 handler for XML Version 2 files.
+
+   Parses a sub-node set that looks like this:
+
+     <trn:date-posted>
+       <ts:date>2000-06-05 23:16:19 -0500</ts:date>
+     </trn:date-posted>
+
+   and returns a time64* as the result.  As with dom_tree_to_time64, a
+   missing, repeated or unparsable <ts:date> yields INT64_MAX rather
+   than a parse failure, so the caller can check it with
+   dom_tree_valid_time64.  <ts:ns> is ignored.
+
+   input: NA
+   returns: time64*
+
+   start: Allocates Time64ParseInfo* for data_for_children.
+   characters: none (whitespace only).
+   end: g_free Time64ParseInfo and return the time64*.
+
+   cleanup-result: g_free the time64*
+   cleanup-chars: NA
+   fail: g_free data_for_children.
+   result-fail: g_free the time64*
+   chars-fail: NA
+
+ */
+
+static gboolean
+generic_time64_start_handler (GSList* sibling_data, gpointer parent_data,
+                              gpointer global_data,
+                              gpointer* data_for_children, gpointer* result,
+                              const gchar* tag, gchar** attrs)
+{
+    Time64ParseInfo* info = g_new0 (Time64ParseInfo, 1);
+    g_return_val_if_fail (info, FALSE);
+    info->time = INT64_MAX;
+    *data_for_children = info;
+    return (TRUE);
+}
+
+static gboolean
+generic_time64_date_end_handler (gpointer data_for_children,
+                                 GSList*  data_from_children, GSList* sibling_data,
+                                 gpointer parent_data, gpointer global_data,
+                                 gpointer* result, const gchar* tag)
+{
+    Time64ParseInfo* info = (Time64ParseInfo*) parent_data;
+    gchar* txt = NULL;
+
+    g_return_val_if_fail (info, FALSE);
+
+    txt = concatenate_child_result_chars (data_from_children);
+    g_return_val_if_fail (txt, FALSE);
+
+    info->time = string_to_time64 (txt);
+    g_free (txt);
+
+    info->s_block_count++;
+    return (TRUE);
+}
+
+static gboolean
+generic_time64_end_handler (gpointer data_for_children,
+                            GSList*  data_from_children, GSList* sibling_data,
+                            gpointer parent_data, gpointer global_data,
+                            gpointer* result, const gchar* tag)
+{
+    Time64ParseInfo* info = (Time64ParseInfo*) data_for_children;
+    time64* t;
+
+    g_return_val_if_fail (info, FALSE);
+
+    t = g_new (time64, 1);
+    *t = info->s_block_count == 1 ? info->time : INT64_MAX;
+    if (info->s_block_count == 0)
+        PERR ("no ts:date node found.");
+
+    g_free (info);
+    *result = t;
+    return (TRUE);
+}
+
+sixtp*
+generic_time64_parser_new (void)
+{
+    sixtp* top_level =
+        sixtp_set_any (sixtp_new (), FALSE,
+                       SIXTP_START_HANDLER_ID, generic_time64_start_handler,
+                       SIXTP_CHARACTERS_HANDLER_ID, allow_and_ignore_only_whitespace,
+                       SIXTP_END_HANDLER_ID, generic_time64_end_handler,
+                       SIXTP_CLEANUP_RESULT_ID, sixtp_child_free_data,
+                       SIXTP_FAIL_HANDLER_ID, generic_free_data_for_children,
+                       SIXTP_RESULT_FAIL_ID, sixtp_child_free_data,
+                       SIXTP_NO_MORE_HANDLERS);
+    g_return_val_if_fail (top_level, NULL);
+
+    if (!sixtp_add_some_sub_parsers (
+            top_level, TRUE,
+            "ts:date", timespec_sixtp_new (generic_time64_date_end_handler),
+            "ts:ns", timespec_sixtp_new (generic_timespec_nsecs_end_handler),
+            NULL, NULL))
+    {
+        return NULL;
+    }
+
+    return (top_level);
+}
+
 /****************************************************************************/
 /* <?> generic guid handler...
 
@@ -616,7 +863,7 @@ generic_gnc_numeric_end_handler (gpointer data_for_children,
         num = g_new (gnc_numeric, 1);
         if (num)
         {
-            if (string_to_gnc_numeric (txt, num))
+            if (string_to_numeric (txt, num))
             {
                 ok = TRUE;
                 *result = num;
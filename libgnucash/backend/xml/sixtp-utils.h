@@ -68,6 +68,15 @@ gboolean string_to_gint64 (const gchar* str, gint64* v);
 
 gboolean string_to_gint32 (const gchar* str, gint32* v);
 
+/* Like gnc_iso8601_to_time64_gmt, including returning INT64_MAX on
+   failure, but the "%Y-%m-%d %H:%M:%S %q" form the v2 writer emits is
+   decoded directly instead of through GncDateTime. */
+time64 string_to_time64 (const gchar* str);
+
+/* Like string_to_gnc_numeric, but the "num/denom" form the v2 writer
+   emits is decoded directly instead of through GncNumeric. */
+gboolean string_to_numeric (const gchar* str, gnc_numeric* n);
+
 gboolean hex_string_to_binary (const gchar* str,  void** v, guint64* data_len);
 
 gboolean generic_return_chars_end_handler (gpointer data_for_children,
@@ -104,6 +113,8 @@ gboolean generic_timespec_nsecs_end_handler (
 
 sixtp* generic_timespec_parser_new (sixtp_end_handler end_handler);
 
+sixtp* generic_time64_parser_new (void);
+
 gboolean generic_guid_end_handler (
     gpointer data_for_children,
     GSList*  data_from_children, GSList* sibling_data,
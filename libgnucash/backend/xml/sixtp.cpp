@@ -794,6 +794,310 @@ sixtp_parse_fd (sixtp* sixtp,
     return ret;
 }
 
+/* Pipelined parsing.
+
+   libxml2 tokenizes the document on a thread of its own and records
+   the SAX events into batches; the calling thread replays each batch
+   through the usual sixtp_sax_* handlers.  The engine isn't thread
+   safe, so all of the sixtp handlers, and with them all object
+   construction, stay on the calling thread and run in exactly the
+   same order as they would with sixtp_parse_fd.  Strings are copied
+   into a per-batch buffer, and a fixed number of batches are recycled
+   so the tokenizer can't run arbitrarily far ahead.
+*/
+
+#define SIXTP_PIPELINE_BATCH_EVENTS 4096
+#define SIXTP_PIPELINE_BATCHES 8
+
+typedef enum
+{
+    SIXTP_PIPELINE_START,
+    SIXTP_PIPELINE_CHARS,
+    SIXTP_PIPELINE_END,
+} sixtp_pipeline_event_type;
+
+typedef struct
+{
+    sixtp_pipeline_event_type type;
+    guint text;     /* offset into strings of the tag name or the chars */
+    guint len;      /* length of the chars, or number of attributes */
+    guint attrs;    /* first attribute offset in attr_offsets */
+    int line;
+    int col;
+} sixtp_pipeline_event;
+
+typedef struct
+{
+    GArray* events;
+    GArray* attr_offsets;
+    GByteArray* strings;
+    gboolean last;
+} sixtp_pipeline_batch;
+
+typedef struct
+{
+    xmlSAXHandler handler;
+    xmlParserCtxtPtr xml_context;
+    GAsyncQueue* full;
+    GAsyncQueue* empty;
+    sixtp_pipeline_batch* current;
+    int parse_ret;
+} sixtp_pipeline;
+
+static sixtp_pipeline_batch*
+sixtp_pipeline_batch_new (void)
+{
+    sixtp_pipeline_batch* batch = g_new0 (sixtp_pipeline_batch, 1);
+    batch->events = g_array_sized_new (FALSE, FALSE,
+                                       sizeof (sixtp_pipeline_event),
+                                       SIXTP_PIPELINE_BATCH_EVENTS);
+    batch->attr_offsets = g_array_new (FALSE, FALSE, sizeof (guint));
+    batch->strings = g_byte_array_sized_new (64 * SIXTP_PIPELINE_BATCH_EVENTS);
+    return batch;
+}
+
+static void
+sixtp_pipeline_batch_destroy (gpointer data)
+{
+    sixtp_pipeline_batch* batch = static_cast<sixtp_pipeline_batch*> (data);
+    g_array_free (batch->events, TRUE);
+    g_array_free (batch->attr_offsets, TRUE);
+    g_byte_array_free (batch->strings, TRUE);
+    g_free (batch);
+}
+
+/* Copies len bytes of str, plus a terminating NUL, and returns the offset. */
+static guint
+sixtp_pipeline_add_string (sixtp_pipeline_batch* batch, const xmlChar* str,
+                           guint len)
+{
+    guint offset = batch->strings->len;
+    const guint8 nul = 0;
+    g_byte_array_append (batch->strings, str, len);
+    g_byte_array_append (batch->strings, &nul, 1);
+    return offset;
+}
+
+static void
+sixtp_pipeline_add_event (sixtp_pipeline* pl, sixtp_pipeline_event* ev)
+{
+    ev->line = xmlSAX2GetLineNumber (pl->xml_context);
+    ev->col  = xmlSAX2GetColumnNumber (pl->xml_context);
+    g_array_append_val (pl->current->events, *ev);
+
+    if (pl->current->events->len >= SIXTP_PIPELINE_BATCH_EVENTS)
+    {
+        g_async_queue_push (pl->full, pl->current);
+        pl->current = static_cast<sixtp_pipeline_batch*> (
+                          g_async_queue_pop (pl->empty));
+    }
+}
+
+static void
+sixtp_pipeline_start_handler (void* user_data, const xmlChar* name,
+                              const xmlChar** attrs)
+{
+    sixtp_pipeline* pl = static_cast<sixtp_pipeline*> (user_data);
+    sixtp_pipeline_batch* batch = pl->current;
+    sixtp_pipeline_event ev = { SIXTP_PIPELINE_START, 0, 0, 0, 0, 0 };
+
+    ev.text = sixtp_pipeline_add_string (batch, name,
+                                         strlen ((const char*) name));
+    ev.attrs = batch->attr_offsets->len;
+    for (; attrs && *attrs; attrs++, ev.len++)
+    {
+        guint offset = sixtp_pipeline_add_string (batch, *attrs,
+                                                  strlen ((const char*) *attrs));
+        g_array_append_val (batch->attr_offsets, offset);
+    }
+    sixtp_pipeline_add_event (pl, &ev);
+}
+
+static void
+sixtp_pipeline_characters_handler (void* user_data, const xmlChar* text,
+                                   int len)
+{
+    sixtp_pipeline* pl = static_cast<sixtp_pipeline*> (user_data);
+    sixtp_pipeline_event ev = { SIXTP_PIPELINE_CHARS, 0, 0, 0, 0, 0 };
+
+    ev.text = sixtp_pipeline_add_string (pl->current, text, len);
+    ev.len = len;
+    sixtp_pipeline_add_event (pl, &ev);
+}
+
+static void
+sixtp_pipeline_end_handler (void* user_data, const xmlChar* name)
+{
+    sixtp_pipeline* pl = static_cast<sixtp_pipeline*> (user_data);
+    sixtp_pipeline_event ev = { SIXTP_PIPELINE_END, 0, 0, 0, 0, 0 };
+
+    ev.text = sixtp_pipeline_add_string (pl->current, name,
+                                         strlen ((const char*) name));
+    sixtp_pipeline_add_event (pl, &ev);
+}
+
+static gpointer
+sixtp_pipeline_thread_func (gpointer user_data)
+{
+    sixtp_pipeline* pl = static_cast<sixtp_pipeline*> (user_data);
+
+    pl->parse_ret = xmlParseDocument (pl->xml_context);
+
+    pl->current->last = TRUE;
+    g_async_queue_push (pl->full, pl->current);
+    pl->current = NULL;
+    return NULL;
+}
+
+static void
+sixtp_pipeline_replay (sixtp_parser_context* ctxt, sixtp_pipeline_batch* batch)
+{
+    const xmlChar* strings = batch->strings->data;
+    GPtrArray* attrs = g_ptr_array_new ();
+
+    for (guint i = 0; i < batch->events->len; i++)
+    {
+        sixtp_pipeline_event* ev = &g_array_index (batch->events,
+                                                   sixtp_pipeline_event, i);
+        const xmlChar* text = strings + ev->text;
+        sixtp_stack_frame* frame;
+
+        switch (ev->type)
+        {
+        case SIXTP_PIPELINE_START:
+            g_ptr_array_set_size (attrs, 0);
+            for (guint j = 0; j < ev->len; j++)
+                g_ptr_array_add (attrs, (gpointer) (strings +
+                                 g_array_index (batch->attr_offsets, guint,
+                                                ev->attrs + j)));
+            g_ptr_array_add (attrs, NULL);
+            sixtp_sax_start_handler (&ctxt->data, text,
+                                     ev->len ? (const xmlChar**) attrs->pdata
+                                     : NULL);
+            /* There's no parser context on this thread to ask. */
+            frame = static_cast<sixtp_stack_frame*> (ctxt->data.stack->data);
+            frame->line = ev->line;
+            frame->col = ev->col;
+            break;
+        case SIXTP_PIPELINE_CHARS:
+            sixtp_sax_characters_handler (&ctxt->data, text, ev->len);
+            break;
+        case SIXTP_PIPELINE_END:
+            sixtp_sax_end_handler (&ctxt->data, text);
+            break;
+        }
+    }
+
+    g_ptr_array_free (attrs, TRUE);
+}
+
+static gboolean
+sixtp_parse_pipelined_common (sixtp* sixtp,
+                              xmlParserCtxtPtr xml_context,
+                              gpointer data_for_top_level,
+                              gpointer global_data,
+                              gpointer* parse_result)
+{
+    sixtp_parser_context* ctxt;
+    sixtp_pipeline pl;
+    GThread* thread;
+    gboolean done = FALSE;
+
+    if (! (ctxt = sixtp_context_new (sixtp, global_data, data_for_top_level)))
+    {
+        g_critical ("sixtp_context_new returned null");
+        xmlFreeParserCtxt (xml_context);
+        return FALSE;
+    }
+
+    memset (&pl, 0, sizeof (pl));
+    pl.handler.startElement = sixtp_pipeline_start_handler;
+    pl.handler.endElement = sixtp_pipeline_end_handler;
+    pl.handler.characters = sixtp_pipeline_characters_handler;
+    pl.handler.getEntity = sixtp_sax_get_entity_handler;
+    pl.xml_context = xml_context;
+    pl.full = g_async_queue_new ();
+    pl.empty = g_async_queue_new_full (sixtp_pipeline_batch_destroy);
+    for (int i = 0; i < SIXTP_PIPELINE_BATCHES - 1; i++)
+        g_async_queue_push (pl.empty, sixtp_pipeline_batch_new ());
+    pl.current = sixtp_pipeline_batch_new ();
+
+    xml_context->sax = &pl.handler;
+    xml_context->userData = &pl;
+
+    /* Replayed events are not tied to a live libxml2 parser. */
+    ctxt->data.saxParserCtxt = NULL;
+    ctxt->data.bad_xml_parser = sixtp_dom_parser_new (gnc_bad_xml_end_handler,
+                                                      NULL, NULL);
+
+    thread = g_thread_try_new ("sixtp_parser", sixtp_pipeline_thread_func,
+                               &pl, NULL);
+    if (thread)
+    {
+        while (!done)
+        {
+            sixtp_pipeline_batch* batch = static_cast<sixtp_pipeline_batch*> (
+                                              g_async_queue_pop (pl.full));
+            sixtp_pipeline_replay (ctxt, batch);
+            done = batch->last;
+
+            g_array_set_size (batch->events, 0);
+            g_array_set_size (batch->attr_offsets, 0);
+            g_byte_array_set_size (batch->strings, 0);
+            batch->last = FALSE;
+            g_async_queue_push (pl.empty, batch);
+        }
+        g_thread_join (thread);
+    }
+    else
+    {
+        /* Just parse in this thread, the way sixtp_parse_fd does. */
+        g_warning ("Could not create the parser thread, parsing serially.");
+        sixtp_pipeline_batch_destroy (pl.current);
+        xml_context->sax = &ctxt->handler;
+        xml_context->userData = &ctxt->data;
+        ctxt->data.saxParserCtxt = xml_context;
+        pl.parse_ret = xmlParseDocument (xml_context);
+    }
+
+    g_async_queue_unref (pl.full);
+    g_async_queue_unref (pl.empty);
+
+    ctxt->data.saxParserCtxt = xml_context;
+    sixtp_context_run_end_handler (ctxt);
+
+    if (pl.parse_ret == 0 && ctxt->data.parsing_ok)
+    {
+        if (parse_result)
+            *parse_result = ctxt->top_frame->frame_data;
+        sixtp_context_destroy (ctxt);
+        return TRUE;
+    }
+    else
+    {
+        if (parse_result)
+            *parse_result = NULL;
+        if (g_slist_length (ctxt->data.stack) > 1)
+            sixtp_handle_catastrophe (&ctxt->data);
+        sixtp_context_destroy (ctxt);
+        return FALSE;
+    }
+}
+
+gboolean
+sixtp_parse_fd_pipelined (sixtp* sixtp,
+                          FILE* fd,
+                          gpointer data_for_top_level,
+                          gpointer global_data,
+                          gpointer* parse_result)
+{
+    xmlParserCtxtPtr context = xmlCreateIOParserCtxt (NULL, NULL,
+                                                      sixtp_parser_read, NULL /*no close */, fd,
+                                                      XML_CHAR_ENCODING_NONE);
+    return sixtp_parse_pipelined_common (sixtp, context, data_for_top_level,
+                                         global_data, parse_result);
+}
+
 gboolean
 sixtp_parse_buffer (sixtp* sixtp,
                     char* bufp,
@@ -224,6 +224,12 @@ gboolean sixtp_parse_file (sixtp* sixtp, const char* filename,
 gboolean sixtp_parse_fd (sixtp* sixtp, FILE* fd,
                          gpointer data_for_top_level, gpointer global_data,
                          gpointer* parse_result);
+/** Like sixtp_parse_fd, but libxml2 tokenizes fd on a separate thread
+ * while the sixtp handlers run on the calling thread, in the same order. */
+gboolean sixtp_parse_fd_pipelined (sixtp* sixtp, FILE* fd,
+                                   gpointer data_for_top_level,
+                                   gpointer global_data,
+                                   gpointer* parse_result);
 gboolean sixtp_parse_buffer (sixtp* sixtp, char* bufp, int bufsz,
                              gpointer data_for_top_level, gpointer global_data,
                              gpointer* parse_result);
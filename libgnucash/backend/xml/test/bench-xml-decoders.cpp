@@ -0,0 +1,127 @@
+/********************************************************************\
+ * bench-xml-decoders.cpp -- time the XML backend's value decoders  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/* Not a test: compares string_to_time64 and string_to_numeric with
+ * the general GncDateTime and GncNumeric parsers they fall back to.
+ * Build it with "make bench-xml-decoders" and pass the number of
+ * values to decode, 100000 by default.
+ */
+extern "C"
+{
+#include <config.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "gnc-engine.h"
+
+#include "test-engine-stuff.h"
+}
+
+#include "sixtp-utils.h"
+
+#define GNC_V2_STRING "gnc-v2"
+const gchar* gnc_v2_xml_version_string = GNC_V2_STRING;
+
+static void
+report (const char* what, gint64 fast, gint64 slow, int count)
+{
+    printf ("%-8s fast %8.3f s  general %8.3f s  speedup %5.1fx (%d values)\n",
+            what, fast / 1e6, slow / 1e6,
+            fast ? (double) slow / fast : 0.0, count);
+}
+
+static void
+bench_time64 (int count)
+{
+    GPtrArray* strs = g_ptr_array_new_with_free_func (g_free);
+    time64 sum_fast = 0, sum_slow = 0;
+    gint64 start, fast, slow;
+
+    for (int i = 0; i < count; ++i)
+        g_ptr_array_add (strs, gnc_print_time64 (get_random_time (),
+                                                 "%Y-%m-%d %H:%M:%S %q"));
+
+    start = g_get_monotonic_time ();
+    for (guint i = 0; i < strs->len; ++i)
+        sum_fast += string_to_time64 ((const gchar*) strs->pdata[i]);
+    fast = g_get_monotonic_time () - start;
+
+    start = g_get_monotonic_time ();
+    for (guint i = 0; i < strs->len; ++i)
+        sum_slow += gnc_iso8601_to_time64_gmt ((const gchar*) strs->pdata[i]);
+    slow = g_get_monotonic_time () - start;
+
+    if (sum_fast != sum_slow)
+        printf ("time64: decoders disagree!\n");
+    report ("time64", fast, slow, count);
+    g_ptr_array_free (strs, TRUE);
+}
+
+static void
+bench_numeric (int count)
+{
+    GPtrArray* strs = g_ptr_array_new_with_free_func (g_free);
+    gint64 sum_fast = 0, sum_slow = 0;
+    gint64 start, fast, slow;
+    gnc_numeric n;
+
+    for (int i = 0; i < count; ++i)
+    {
+        n = get_random_gnc_numeric (GNC_DENOM_AUTO);
+        g_ptr_array_add (strs, g_strdup_printf ("%" G_GINT64_FORMAT "/%"
+                                                G_GINT64_FORMAT,
+                                                n.num, n.denom));
+    }
+
+    start = g_get_monotonic_time ();
+    for (guint i = 0; i < strs->len; ++i)
+        if (string_to_numeric ((const gchar*) strs->pdata[i], &n))
+            sum_fast += n.num ^ n.denom;
+    fast = g_get_monotonic_time () - start;
+
+    start = g_get_monotonic_time ();
+    for (guint i = 0; i < strs->len; ++i)
+        if (string_to_gnc_numeric ((const gchar*) strs->pdata[i], &n))
+            sum_slow += n.num ^ n.denom;
+    slow = g_get_monotonic_time () - start;
+
+    if (sum_fast != sum_slow)
+        printf ("numeric: decoders disagree!\n");
+    report ("numeric", fast, slow, count);
+    g_ptr_array_free (strs, TRUE);
+}
+
+int
+main (int argc, char** argv)
+{
+    int count = argc > 1 ? atoi (argv[1]) : 100000;
+
+    if (count <= 0)
+    {
+        fprintf (stderr, "usage: %s [count]\n", argv[0]);
+        return 1;
+    }
+    qof_init ();
+    bench_time64 (count);
+    bench_numeric (count);
+    qof_close ();
+    return 0;
+}
@@ -105,6 +105,33 @@ write_dom_node_to_file (xmlNodePtr node, int fd)
     fclose (out);
 }
 
+/* What write_dom_node_to_file would put in the file, as a string. */
+gchar*
+dom_node_to_string (xmlNodePtr node)
+{
+    FILE* out;
+    long len;
+    gchar* str;
+
+    out = tmpfile ();
+    if (!out)
+        return NULL;
+
+    xmlElemDump (out, NULL, node);
+    fflush (out);
+    len = ftell (out);
+    rewind (out);
+
+    str = g_new0 (gchar, len + 1);
+    if (fread (str, 1, len, out) != (size_t) len)
+    {
+        g_free (str);
+        str = NULL;
+    }
+    fclose (out);
+    return str;
+}
+
 gboolean
 print_dom_tree (gpointer data_for_children, GSList* data_from_children,
                 GSList* sibling_data, gpointer parent_data,
@@ -41,6 +41,7 @@ typedef struct KvpFrameImpl KvpFrame;
 #endif
 
 void write_dom_node_to_file (xmlNodePtr node, int fd);
+gchar* dom_node_to_string (xmlNodePtr node);
 
 int files_compare (const gchar* f1, const gchar* f2);
 
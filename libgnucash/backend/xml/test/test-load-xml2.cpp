@@ -42,6 +42,8 @@ extern "C"
 
 #include <cashobjects.h>
 #include <TransLog.h>
+#include <Account.h>
+#include <Transaction.h>
 #include <gnc-engine.h>
 #include <gnc-prefs.h>
 
@@ -118,6 +120,206 @@ test_load_file (const char* filename)
     qof_session_end (session);
 }
 
+static int
+collect_transaction (Transaction* trans, void* data)
+{
+    auto found = static_cast<Transaction**> (data);
+    if (!found[0])
+        found[0] = trans;
+    else
+        found[1] = trans;
+    return found[1] != NULL;
+}
+
+static void
+remove_dir (const char* dirname)
+{
+    GDir* dir = g_dir_open (dirname, 0, NULL);
+    const gchar* entry;
+
+    if (!dir)
+        return;
+    while ((entry = g_dir_read_name (dir)) != NULL)
+    {
+        gchar* name = g_build_filename (dirname, entry, (gchar*)NULL);
+        g_unlink (name);
+        g_free (name);
+    }
+    g_dir_close (dir);
+    g_rmdir (dirname);
+}
+
+/* Save a change and a deletion in journal mode, check that the data file
+ * was left alone, and that another session loading it sees both. */
+static void
+test_journal (const char* filename)
+{
+    gchar* contents;
+    gsize length;
+    GStatBuf before, after;
+    Transaction* trans[2] = {NULL, NULL};
+    GncGUID changed, deleted;
+
+    gchar* dirname = g_dir_make_tmp ("test-journal-XXXXXX", NULL);
+    gchar* tmpname = g_build_filename (dirname, "journal.gml2", (gchar*)NULL);
+    gchar* journal = g_strconcat (tmpname, ".journal", NULL);
+    do_test (g_file_get_contents (filename, &contents, &length, NULL) &&
+             g_file_set_contents (tmpname, contents, length, NULL),
+             "copy data file for journal test");
+    g_free (contents);
+
+    gnc_prefs_set_file_save_journal (TRUE);
+    QofSession* session = qof_session_new ();
+    qof_session_begin (session, tmpname, FALSE, FALSE, FALSE);
+    qof_session_load (session, NULL);
+    QofBook* book = qof_session_get_book (session);
+    xaccAccountTreeForEachTransaction (gnc_book_get_root_account (book),
+                                       collect_transaction, trans);
+    do_test (trans[0] && trans[1], "journal test file has transactions");
+    if (!trans[0] || !trans[1])
+        return;
+
+    changed = *xaccTransGetGUID (trans[0]);
+    deleted = *xaccTransGetGUID (trans[1]);
+    xaccTransBeginEdit (trans[0]);
+    xaccTransSetDescription (trans[0], "changed in the journal");
+    xaccTransCommitEdit (trans[0]);
+    xaccTransBeginEdit (trans[1]);
+    xaccTransDestroy (trans[1]);
+    xaccTransCommitEdit (trans[1]);
+
+    g_stat (tmpname, &before);
+    qof_session_save (session, NULL);
+    g_stat (tmpname, &after);
+    do_test (qof_session_get_error (session) == ERR_BACKEND_NO_ERR,
+             "journal save");
+    do_test (g_file_test (journal, G_FILE_TEST_EXISTS), "journal written");
+    do_test (before.st_size == after.st_size &&
+             before.st_mtime == after.st_mtime,
+             "journal save leaves the data file alone");
+
+    QofSession* reader = qof_session_new ();
+    qof_session_begin (reader, tmpname, TRUE, FALSE, FALSE);
+    qof_session_load (reader, NULL);
+    QofBook* reader_book = qof_session_get_book (reader);
+    Transaction* replayed = xaccTransLookup (&changed, reader_book);
+    do_test (replayed &&
+             g_strcmp0 (xaccTransGetDescription (replayed),
+                        "changed in the journal") == 0,
+             "journal replays a changed transaction");
+    do_test (xaccTransLookup (&deleted, reader_book) == NULL,
+             "journal replays a deleted transaction");
+
+    /* The reader only replayed the journal and never held the lock, so
+     * closing it must leave both files alone. */
+    g_stat (tmpname, &before);
+    qof_session_end (reader);
+    qof_session_destroy (reader);
+    g_stat (tmpname, &after);
+    do_test (g_file_test (journal, G_FILE_TEST_EXISTS),
+             "closing a reader keeps the journal");
+    do_test (before.st_size == after.st_size &&
+             before.st_mtime == after.st_mtime,
+             "closing a reader leaves the data file alone");
+
+    /* Closing the session that wrote it folds the journal back into the
+     * data file. */
+    qof_session_end (session);
+    qof_session_destroy (session);
+    do_test (!g_file_test (journal, G_FILE_TEST_EXISTS),
+             "journal compacted on close");
+
+    gnc_prefs_set_file_save_journal (FALSE);
+    reader = qof_session_new ();
+    qof_session_begin (reader, tmpname, TRUE, FALSE, FALSE);
+    qof_session_load (reader, NULL);
+    reader_book = qof_session_get_book (reader);
+    replayed = xaccTransLookup (&changed, reader_book);
+    do_test (replayed &&
+             g_strcmp0 (xaccTransGetDescription (replayed),
+                        "changed in the journal") == 0 &&
+             xaccTransLookup (&deleted, reader_book) == NULL,
+             "compacted data file holds the journal's changes");
+    qof_session_end (reader);
+    qof_session_destroy (reader);
+
+    remove_dir (dirname);
+    g_free (journal);
+    g_free (tmpname);
+    g_free (dirname);
+}
+
+static int
+count_transaction (Transaction* trans, void* data)
+{
+    ++*static_cast<int*> (data);
+    return 0;
+}
+
+/* Save a book large enough to take several compression blocks with
+ * compression on, and check that it reads back the same. */
+static void
+test_compressed_save (const char* filename)
+{
+    int orig_count = 0, reloaded_count = 0;
+    gchar* dirname = g_dir_make_tmp ("test-compressed-XXXXXX", NULL);
+    gchar* tmpname = g_build_filename (dirname, "compressed.gnucash",
+                                       (gchar*)NULL);
+
+    QofSession* session = qof_session_new ();
+    qof_session_begin (session, filename, TRUE, FALSE, FALSE);
+    qof_session_load (session, NULL);
+    QofSession* saver = qof_session_new ();
+    qof_session_begin (saver, tmpname, FALSE, TRUE, TRUE);
+    qof_session_swap_data (session, saver);
+    QofBook* book = qof_session_get_book (saver);
+    Account* root = gnc_book_get_root_account (book);
+    xaccAccountTreeForEachTransaction (root, count_transaction, &orig_count);
+
+    gnc_prefs_set_file_save_compressed (TRUE);
+    qof_book_mark_session_dirty (book);
+    qof_session_save (saver, NULL);
+    gnc_prefs_set_file_save_compressed (FALSE);
+    do_test (qof_session_get_error (saver) == ERR_BACKEND_NO_ERR,
+             "compressed save");
+
+    gchar* contents;
+    gsize length;
+    GStatBuf orig_stat;
+    g_stat (filename, &orig_stat);
+    do_test (g_file_get_contents (tmpname, &contents, &length, NULL) &&
+             length > 2 && (guchar)contents[0] == 0x1f &&
+             (guchar)contents[1] == 0x8b, "compressed save writes gzip");
+    do_test ((goffset)length < orig_stat.st_size,
+             "compressed file is smaller");
+    g_free (contents);
+
+    QofSession* reader = qof_session_new ();
+    qof_session_begin (reader, tmpname, TRUE, FALSE, FALSE);
+    qof_session_load (reader, NULL);
+    do_test (qof_session_get_error (reader) == ERR_BACKEND_NO_ERR,
+             "compressed reload");
+    QofBook* reader_book = qof_session_get_book (reader);
+    Account* reader_root = gnc_book_get_root_account (reader_book);
+    xaccAccountTreeForEachTransaction (reader_root, count_transaction,
+                                       &reloaded_count);
+    do_test (orig_count > 0 && reloaded_count == orig_count,
+             "compressed reload has every transaction");
+    do_test (gnc_account_n_descendants (reader_root) ==
+             gnc_account_n_descendants (root),
+             "compressed reload has every account");
+
+    qof_session_end (reader);
+    qof_session_destroy (reader);
+    qof_session_end (saver);
+    qof_session_destroy (saver);
+    qof_session_end (session);
+    qof_session_destroy (session);
+    remove_dir (dirname);
+    g_free (tmpname);
+    g_free (dirname);
+}
+
 int
 main (int argc, char** argv)
 {
@@ -163,6 +365,20 @@ main (int argc, char** argv)
 
     g_dir_close (xml2_dir);
 
+    {
+        gchar* to_open = g_build_filename (location, "abc.gml2", (gchar*)NULL);
+        test_journal (to_open);
+        g_free (to_open);
+    }
+
+    {
+        /* Big enough to take several blocks when compressed in parallel. */
+        gchar* to_open = g_build_filename (location, "ms-money.gml2",
+                                           (gchar*)NULL);
+        test_compressed_save (to_open);
+        g_free (to_open);
+    }
+
     if (files_tested == 0)
     {
         failure ("handled 0 files in test-load-xml2");
@@ -0,0 +1,221 @@
+/********************************************************************\
+ * test-sixtp-pipeline.cpp -- compare pipelined and serial parsing  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+extern "C"
+{
+#include <config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "test-stuff.h"
+}
+
+#include "gnc-xml-helper.h"
+#include "sixtp.h"
+#include "sixtp-parsers.h"
+#include "sixtp-utils.h"
+
+#define GNC_V2_STRING "gnc-v2"
+const gchar* gnc_v2_xml_version_string = GNC_V2_STRING;
+
+/* Each item is at least four SAX events, so this is many batches of
+ * SIXTP_PIPELINE_BATCH_EVENTS, and more than the pipeline keeps around. */
+#define NUM_ITEMS 20000
+
+/* Append each top level item's attribute and text to the GString passed as
+ * global data, so that two parses can be compared. */
+static gboolean
+record_item (gpointer data_for_children, GSList* data_from_children,
+             GSList* sibling_data, gpointer parent_data, gpointer global_data,
+             gpointer* result, const gchar* tag)
+{
+    xmlNodePtr tree = (xmlNodePtr)data_for_children;
+    GString* record = static_cast<GString*> (global_data);
+
+    if (parent_data || !tag)
+        return TRUE;
+
+    auto n = xmlGetProp (tree, BAD_CAST "n");
+    auto text = xmlNodeGetContent (tree);
+    g_string_append_printf (record, "%s=%s;", (char*)n, (char*)text);
+    xmlFree (n);
+    xmlFree (text);
+    xmlFreeNode (tree);
+    return TRUE;
+}
+
+static sixtp*
+make_parser (void)
+{
+    auto top = sixtp_new ();
+    auto root = sixtp_new ();
+    sixtp_set_chars (top, allow_and_ignore_only_whitespace);
+    sixtp_set_chars (root, allow_and_ignore_only_whitespace);
+    sixtp_add_sub_parser (top, "root", root);
+    sixtp_add_sub_parser (root, "item",
+                          sixtp_dom_parser_new (record_item, NULL, NULL));
+    return top;
+}
+
+static gchar*
+write_file (const gchar* contents)
+{
+    gchar* filename = NULL;
+    GError* error = NULL;
+    auto fd = g_file_open_tmp ("test-sixtp-pipeline-XXXXXX.xml", &filename,
+                               &error);
+    if (fd < 0)
+    {
+        failure_args ("write_file", __FILE__, __LINE__, "%s", error->message);
+        g_error_free (error);
+        return NULL;
+    }
+    close (fd);
+    g_file_set_contents (filename, contents, -1, NULL);
+    return filename;
+}
+
+/* Parse filename serially or pipelined, collecting the recorded items in
+ * record and anything written to stderr, where the frame stack is printed
+ * if the parse fails, in errors. */
+static gboolean
+parse (const gchar* filename, gboolean pipelined, GString* record,
+       gchar** errors)
+{
+    auto parser = make_parser ();
+    auto capture = tmpfile ();
+    auto saved_stderr = dup (fileno (stderr));
+    gboolean ok;
+
+    fflush (stderr);
+    dup2 (fileno (capture), fileno (stderr));
+    if (pipelined)
+    {
+        auto fd = g_fopen (filename, "rb");
+        ok = sixtp_parse_fd_pipelined (parser, fd, NULL, record, NULL);
+        fclose (fd);
+    }
+    else
+        ok = sixtp_parse_file (parser, filename, NULL, record, NULL);
+    fflush (stderr);
+    dup2 (saved_stderr, fileno (stderr));
+    close (saved_stderr);
+
+    GString* frames = g_string_new (NULL);
+    char line[1024];
+    rewind (capture);
+    while (fgets (line, sizeof (line), capture))
+        if (strstr (line, "(line "))
+            g_string_append (frames, line);
+    fclose (capture);
+    *errors = g_string_free (frames, FALSE);
+    sixtp_destroy (parser);
+    return ok;
+}
+
+static void
+test_large_file (void)
+{
+    GString* xml = g_string_new ("<?xml version=\"1.0\"?>\n<root>\n");
+    for (int i = 0; i < NUM_ITEMS; i++)
+        g_string_append_printf (xml, "  <item n=\"%d\">text &amp; %d</item>\n",
+                                i, i);
+    g_string_append (xml, "</root>\n");
+    auto filename = write_file (xml->str);
+    g_string_free (xml, TRUE);
+    if (!filename)
+        return;
+
+    GString* serial = g_string_new (NULL);
+    GString* pipelined = g_string_new (NULL);
+    gchar* serial_errors;
+    gchar* pipelined_errors;
+    do_test (parse (filename, FALSE, serial, &serial_errors),
+             "serial parse of a large file");
+    do_test (parse (filename, TRUE, pipelined, &pipelined_errors),
+             "pipelined parse of a large file");
+    do_test (strstr (serial->str, "19999=text & 19999;") != NULL,
+             "every item is parsed");
+    do_test (g_strcmp0 (serial->str, pipelined->str) == 0,
+             "pipelined parse matches serial parse");
+
+    g_string_free (serial, TRUE);
+    g_string_free (pipelined, TRUE);
+    g_free (serial_errors);
+    g_free (pipelined_errors);
+    g_unlink (filename);
+    g_free (filename);
+}
+
+static void
+test_malformed_file (void)
+{
+    /* Item i is on line i + 3. The mismatched end tag comes well after the
+     * first batch, so the frames reported come from replayed events. */
+    GString* xml = g_string_new ("<?xml version=\"1.0\"?>\n<root>\n");
+    for (int i = 0; i < NUM_ITEMS; i++)
+        g_string_append_printf (xml, "  <item n=\"%d\">%d</%s>\n", i, i,
+                                i == 3000 ? "itme" : "item");
+    g_string_append (xml, "</root>\n");
+    auto filename = write_file (xml->str);
+    g_string_free (xml, TRUE);
+    if (!filename)
+        return;
+
+    GString* serial = g_string_new (NULL);
+    GString* pipelined = g_string_new (NULL);
+    gchar* serial_errors;
+    gchar* pipelined_errors;
+    do_test (!parse (filename, FALSE, serial, &serial_errors),
+             "serial parse of a malformed file fails");
+    do_test (!parse (filename, TRUE, pipelined, &pipelined_errors),
+             "pipelined parse of a malformed file fails");
+    do_test (strstr (serial_errors, "(line 3003)") != NULL,
+             "the failing element's line is reported");
+    if (!do_test (g_strcmp0 (serial_errors, pipelined_errors) == 0,
+                  "pipelined parse reports the same lines and columns"))
+        printf ("  serial:\n%s  pipelined:\n%s", serial_errors,
+                pipelined_errors);
+    do_test (g_strcmp0 (serial->str, pipelined->str) == 0,
+             "pipelined parse handles the same items before the error");
+
+    g_string_free (serial, TRUE);
+    g_string_free (pipelined, TRUE);
+    g_free (serial_errors);
+    g_free (pipelined_errors);
+    g_unlink (filename);
+    g_free (filename);
+}
+
+int
+main (int argc, char** argv)
+{
+    test_large_file ();
+    test_malformed_file ();
+    print_test_results ();
+    exit (get_rv ());
+}
@@ -30,6 +30,7 @@ extern "C"
 #include "test-file-stuff.h"
 #include "sixtp-dom-parsers.h"
 #include "sixtp-dom-generators.h"
+#include "sixtp-utils.h"
 #include "test-stuff.h"
 
 
@@ -76,6 +77,104 @@ test_bad_string (void)
                   "with string %s", badstr);
 }
 
+static const char* test_times[] =
+{
+    "2018-01-01 10:59:00 +0000",
+    "2018-01-01 10:59:00 +0530",
+    "2018-01-01 10:59:00 -0800",
+    "2018-01-01 10:59:00 -0030",
+    "2018-01-01 10:59:00 -1300",
+    "2000-02-29 23:59:59 -1100",
+    "1400-01-01 00:00:00 +0000",
+    "9999-12-31 23:59:59 +1345",
+    /* Not the writer's format, or out of range: must still agree. */
+    "2018-01-01 10:59:00",
+    "2018-01-01T10:59:00Z",
+    "2018-01-01 10:59:00 +0000 ",
+    "2018-02-29 10:59:00 +0000",
+    "1399-12-31 23:59:59 +0000",
+    "2018-13-01 10:59:00 +0000",
+    "",
+    NULL
+};
+
+static void
+test_time64_converters (void)
+{
+    int i;
+
+    for (i = 0; test_times[i]; ++i)
+    {
+        const char* str = test_times[i];
+        do_test_args (string_to_time64 (str) == gnc_iso8601_to_time64_gmt (str),
+                      "time64 decoding", __FILE__, __LINE__,
+                      "with string '%s'", str);
+    }
+
+    for (i = 0; i < 1000; ++i)
+    {
+        char* str = gnc_print_time64 (get_random_time (),
+                                      "%Y-%m-%d %H:%M:%S %q");
+        do_test_args (string_to_time64 (str) == gnc_iso8601_to_time64_gmt (str),
+                      "time64 decoding", __FILE__, __LINE__,
+                      "with string '%s'", str);
+        g_free (str);
+    }
+}
+
+static const char* test_numerics[] =
+{
+    "0/1",
+    "-1/100",
+    "123456789012345678/1",
+    /* Handed to the general parser. */
+    "1234567890123456789/10",
+    "1/0",
+    "1/",
+    "/1",
+    "-/1",
+    "1/2 ",
+    " 1/2",
+    "12",
+    "1.5",
+    NULL
+};
+
+static void
+test_numeric_converters (void)
+{
+    int i;
+
+    for (i = 0; test_numerics[i]; ++i)
+    {
+        const char* str = test_numerics[i];
+        gnc_numeric fast = gnc_numeric_zero ();
+        gnc_numeric slow = gnc_numeric_zero ();
+        gboolean fast_ok = string_to_numeric (str, &fast);
+        gboolean slow_ok = string_to_gnc_numeric (str, &slow);
+
+        do_test_args (fast_ok == slow_ok &&
+                      (!fast_ok || (fast.num == slow.num &&
+                                    fast.denom == slow.denom)),
+                      "numeric decoding", __FILE__, __LINE__,
+                      "with string '%s'", str);
+    }
+
+    for (i = 0; i < 1000; ++i)
+    {
+        gnc_numeric num = get_random_gnc_numeric (GNC_DENOM_AUTO);
+        gnc_numeric fast = gnc_numeric_zero ();
+        gchar* str = g_strdup_printf ("%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT,
+                                      num.num, num.denom);
+
+        do_test_args (string_to_numeric (str, &fast) &&
+                      fast.num == num.num && fast.denom == num.denom,
+                      "numeric decoding", __FILE__, __LINE__,
+                      "with string '%s'", str);
+        g_free (str);
+    }
+}
+
 int
 main (int argc, char** argv)
 {
@@ -83,6 +182,8 @@ main (int argc, char** argv)
     fflush (stdout);
     test_string_converters ();
     test_bad_string ();
+    test_time64_converters ();
+    test_numeric_converters ();
     fflush (stdout);
     print_test_results ();
     exit (get_rv ());
@@ -83,6 +83,25 @@ test_db (GNCPriceDB* db)
     if (!db)
         return;
 
+    {
+        /* The streaming writer must match the DOM byte for byte. */
+        GncXmlWriter writer (nullptr);
+        gchar* dom_str = dom_node_to_string (test_node);
+        gchar* expected = g_strconcat (dom_str, "\n", NULL);
+
+        writer.start_element ("gnc:pricedb", "version", "1");
+        gnc_pricedb_foreach_price (db, [] (GNCPrice* p, gpointer data)
+                                   {
+                                       auto w = static_cast<GncXmlWriter*> (data);
+                                       return gnc_price_write_xml (*w, p);
+                                   }, &writer, TRUE);
+        writer.end_element ("gnc:pricedb");
+        do_test_args (writer.str () == expected, "gnc_price_write_xml",
+                      __FILE__, __LINE__, "%d", iter);
+        g_free (expected);
+        g_free (dom_str);
+    }
+
     filename1 = g_strdup_printf ("test_file_XXXXXX");
 
     fd = g_mkstemp (filename1);
@@ -28,6 +28,7 @@ extern "C"
 #include <glib.h>
 #include <glib/gstdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include <sys/types.h>
@@ -441,6 +442,20 @@ test_transaction (void)
             success_args ("transaction_xml", __FILE__, __LINE__, "%d", i);
         }
 
+        {
+            /* The streaming writer must match the DOM byte for byte. */
+            GncXmlWriter writer (nullptr);
+            gchar* dom_str = dom_node_to_string (test_node);
+            gchar* expected = g_strconcat (dom_str, "\n", NULL);
+
+            gnc_transaction_write_xml (writer, ran_trn);
+            do_test_args (writer.str () == expected,
+                          "gnc_transaction_write_xml", __FILE__, __LINE__,
+                          "%d", i);
+            g_free (expected);
+            g_free (dom_str);
+        }
+
         filename1 = g_strdup_printf ("test_file_XXXXXX");
 
         fd = g_mkstemp (filename1);
@@ -516,6 +531,92 @@ test_real_transaction (const char* tag, gpointer global_data, gpointer data)
     return TRUE;
 }
 
+/* A transaction whose fields can't all be read still loads: the bad
+ * fields are skipped, and a split missing a required tag is dropped
+ * on its own. */
+static const char* bad_fields_transaction =
+    "<gnc:transaction version=\"2.0.0\">\n"
+    "  <trn:id type=\"guid\">0123456789abcdef0123456789abcdef</trn:id>\n"
+    "  <trn:date-posted><ts:date>2018-01-02 10:59:00 +0000</ts:date></trn:date-posted>\n"
+    "  <trn:date-entered><ts:date>2018-01-02 10:59:00 +0000</ts:date></trn:date-entered>\n"
+    "  <trn:description>Bad fields</trn:description>\n"
+    "  <trn:slots><slot><slot:key>notes</slot:key>"
+    "<slot:value type=\"bogus\">x</slot:value></slot></trn:slots>\n"
+    "  <trn:splits>\n"
+    "    <trn:split>\n"
+    "      <split:id type=\"guid\">11111111111111111111111111111111</split:id>\n"
+    "      <split:reconciled-state>y</split:reconciled-state>\n"
+    "      <split:reconcile-date><ts:date>not a date</ts:date></split:reconcile-date>\n"
+    "      <split:value>100/1</split:value>\n"
+    "      <split:quantity>100/1</split:quantity>\n"
+    "      <split:account type=\"guid\">22222222222222222222222222222222</split:account>\n"
+    "      <split:lot type=\"guid\">not a guid</split:lot>\n"
+    "    </trn:split>\n"
+    "    <trn:split>\n"
+    "      <split:id type=\"guid\">33333333333333333333333333333333</split:id>\n"
+    "      <split:reconciled-state>n</split:reconciled-state>\n"
+    "      <split:value>-100/1</split:value>\n"
+    "      <split:quantity>-100/1</split:quantity>\n"
+    "    </trn:split>\n"
+    "  </trn:splits>\n"
+    "</gnc:transaction>\n";
+
+static gboolean
+test_add_bad_fields_transaction (const char* tag, gpointer globaldata,
+                                 gpointer data)
+{
+    Transaction** trans = static_cast<decltype (trans)> (globaldata);
+    *trans = static_cast<Transaction*> (data);
+    return TRUE;
+}
+
+static void
+test_transaction_bad_fields (void)
+{
+    Transaction* trans = NULL;
+    Split* split;
+    GncGUID guid;
+    gchar* filename = g_strdup ("test_file_XXXXXX");
+    int fd = g_mkstemp (filename);
+
+    if (write (fd, bad_fields_transaction, strlen (bad_fields_transaction)) < 0)
+        failure_args ("transaction_xml", __FILE__, __LINE__,
+                      "couldn't write %s", filename);
+    close (fd);
+
+    do_test (gnc_xml_parse_file (gnc_transaction_sixtp_parser_create (),
+                                 filename, test_add_bad_fields_transaction,
+                                 &trans, book),
+             "bad fields don't fail the file");
+    g_unlink (filename);
+    g_free (filename);
+
+    do_test (trans != NULL, "transaction with bad fields is loaded");
+    if (!trans)
+        return;
+
+    do_test (g_strcmp0 (xaccTransGetDescription (trans), "Bad fields") == 0,
+             "good fields are still set");
+    /* Committing may scrub in an imbalance split, so look the splits up
+     * rather than counting them. */
+    string_to_guid ("33333333333333333333333333333333", &guid);
+    do_test (xaccSplitLookup (&guid, book) == NULL,
+             "split without an account is dropped on its own");
+
+    string_to_guid ("11111111111111111111111111111111", &guid);
+    split = xaccSplitLookup (&guid, book);
+    do_test (split && xaccSplitGetParent (split) == trans,
+             "good split is kept");
+    do_test (split && xaccSplitGetReconcile (split) == YREC,
+             "rest of the split is read");
+    do_test (split && xaccSplitGetDateReconciled (split) == 0,
+             "unreadable reconcile date is left unset");
+    do_test (split && xaccSplitGetLot (split) == NULL,
+             "unreadable lot is skipped");
+
+    really_get_rid_of_transaction (trans);
+}
+
 int
 main (int argc, char** argv)
 {
@@ -536,6 +637,7 @@ main (int argc, char** argv)
     else
     {
         test_transaction ();
+        test_transaction_bad_fields ();
     }
 
     print_test_results ();
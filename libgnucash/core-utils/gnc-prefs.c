@@ -32,6 +32,8 @@ static gchar *namespace_regexp    = NULL;
 static gboolean is_debugging      = FALSE;
 static gboolean extras_enabled    = FALSE;
 static gboolean use_compression   = TRUE; // This is also the default in the prefs backend
+static gboolean use_journal       = FALSE; // This is also the default in the prefs backend
+static gboolean use_sql_lazy_load = FALSE; // This is also the default in the prefs backend
 static gint file_retention_policy = 1;    // 1 = "days", the default in the prefs backend
 static gint file_retention_days   = 30;   // This is also the default in the prefs backend
 
@@ -89,6 +91,30 @@ gnc_prefs_set_file_save_compressed(gboolean compressed)
     use_compression = compressed;
 }
 
+gboolean
+gnc_prefs_get_file_save_journal(void)
+{
+    return use_journal;
+}
+
+void
+gnc_prefs_set_file_save_journal(gboolean journal)
+{
+    use_journal = journal;
+}
+
+gboolean
+gnc_prefs_get_sql_lazy_load(void)
+{
+    return use_sql_lazy_load;
+}
+
+void
+gnc_prefs_set_sql_lazy_load(gboolean lazy)
+{
+    use_sql_lazy_load = lazy;
+}
+
 gint
 gnc_prefs_get_file_retention_policy(void)
 {
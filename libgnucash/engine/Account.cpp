@@ -40,6 +40,7 @@
 #include "gnc-lot.h"
 #include "gnc-pricedb.h"
 #include "qofinstance-p.h"
+#include "qofquerycore-p.h"
 #include "gnc-features.h"
 #include "guid.hpp"
 
@@ -285,9 +286,15 @@ gnc_account_init(Account* acc)
     priv->starting_cleared_balance = gnc_numeric_zero();
     priv->starting_reconciled_balance = gnc_numeric_zero();
     priv->balance_dirty = FALSE;
+    priv->balance_dirty_from = 0;
 
     priv->splits = NULL;
+    priv->split_index = g_sequence_new (NULL);
+    priv->splits_hash = g_hash_table_new (g_direct_hash, g_direct_equal);
+    priv->unsorted_splits = g_hash_table_new (g_direct_hash, g_direct_equal);
     priv->sort_dirty = FALSE;
+    priv->split_loader = NULL;
+    priv->split_loader_data = NULL;
 }
 
 static void
@@ -299,9 +306,35 @@ gnc_account_dispose (GObject *acctp)
 static void
 gnc_account_finalize(GObject* acctp)
 {
+    AccountPrivate *priv = GET_PRIVATE(acctp);
+
+    g_sequence_free (priv->split_index);
+    g_hash_table_destroy (priv->splits_hash);
+    g_hash_table_destroy (priv->unsorted_splits);
+    g_list_free (priv->splits);
+    priv->split_index = NULL;
+    priv->splits_hash = NULL;
+    priv->unsorted_splits = NULL;
+    priv->splits = NULL;
+
     G_OBJECT_CLASS(gnc_account_parent_class)->finalize(acctp);
 }
 
+/* Have the backend load the account's splits if it hasn't yet. */
+static void
+account_load_splits (const Account *acc)
+{
+    AccountPrivate *priv = GET_PRIVATE(acc);
+    AccountSplitLoader loader = priv->split_loader;
+
+    if (!loader || qof_book_shutting_down (qof_instance_get_book (acc)))
+        return;
+    /* Clear it first: committing the loaded transactions comes back
+     * through here. */
+    priv->split_loader = NULL;
+    loader ((Account*)acc, priv->split_loader_data);
+}
+
 /* Note that g_value_set_object() refs the object, as does
  * g_object_get(). But g_object_get() only unrefs once when it disgorges
  * the object, leaving an unbalanced ref, which leaks. So instead of
@@ -1361,6 +1394,7 @@ xaccAccountCommitEdit (Account *acc)
            themselves will be destroyed by the transaction code */
         if (!qof_book_shutting_down(book))
         {
+            account_load_splits (acc);
             slist = g_list_copy(priv->splits);
             for (lp = slist; lp; lp = lp->next)
             {
@@ -1371,6 +1405,10 @@ xaccAccountCommitEdit (Account *acc)
         }
         else
         {
+            g_sequence_remove_range (g_sequence_get_begin_iter (priv->split_index),
+                                     g_sequence_get_end_iter (priv->split_index));
+            g_hash_table_remove_all (priv->splits_hash);
+            g_hash_table_remove_all (priv->unsorted_splits);
             g_list_free(priv->splits);
             priv->splits = NULL;
         }
@@ -1698,6 +1736,17 @@ xaccAccountEqual(const Account *aa, const Account *ab, gboolean check_guids)
 
 /********************************************************************\
 \********************************************************************/
+
+/* The running balances of the splits before position pos are still
+ * correct; keep the lowest such position until the next recompute. */
+static void
+mark_balance_dirty_from (AccountPrivate *priv, gint pos)
+{
+    if (!priv->balance_dirty || pos < priv->balance_dirty_from)
+        priv->balance_dirty_from = pos;
+    priv->balance_dirty = TRUE;
+}
+
 void
 gnc_account_set_sort_dirty (Account *acc)
 {
@@ -1710,6 +1759,9 @@ gnc_account_set_sort_dirty (Account *acc)
 
     priv = GET_PRIVATE(acc);
     priv->sort_dirty = TRUE;
+    /* Splits queued by gnc_account_split_changed() are only put back in
+     * place by the full sort, which can move any of them. */
+    mark_balance_dirty_from (priv, 0);
 }
 
 void
@@ -1723,43 +1775,161 @@ gnc_account_set_balance_dirty (Account *acc)
         return;
 
     priv = GET_PRIVATE(acc);
-    priv->balance_dirty = TRUE;
+    mark_balance_dirty_from (priv, 0);
+}
+
+void
+gnc_account_split_changed (Account *acc, Split *s)
+{
+    AccountPrivate *priv;
+
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+    g_return_if_fail(GNC_IS_SPLIT(s));
+
+    if (qof_instance_get_destroying(acc))
+        return;
+
+    priv = GET_PRIVATE(acc);
+    if (priv->sort_dirty || !g_hash_table_contains (priv->splits_hash, s))
+    {
+        priv->sort_dirty = TRUE;
+        mark_balance_dirty_from (priv, 0);
+        return;
+    }
+    /* The position is only known once the split is resorted. */
+    g_hash_table_add (priv->unsorted_splits, s);
+    mark_balance_dirty_from (priv, G_MAXINT);
+}
+
+void
+gnc_account_set_split_loader (Account *acc, AccountSplitLoader loader,
+                              gpointer user_data)
+{
+    AccountPrivate *priv;
+
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+
+    priv = GET_PRIVATE(acc);
+    priv->split_loader = loader;
+    priv->split_loader_data = loader ? user_data : NULL;
+}
+
+gboolean
+gnc_account_has_split_loader (const Account *acc)
+{
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
+    return GET_PRIVATE(acc)->split_loader != NULL;
+}
+
+void
+gnc_account_load_splits (const Account *acc)
+{
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+    account_load_splits (acc);
 }
 
 /********************************************************************\
 \********************************************************************/
 
+/* The elements of split_index are links of priv->splits, so compare
+ * the splits they hold. */
+static gint
+split_link_order (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    auto link_a = static_cast<const GList*>(a);
+    auto link_b = static_cast<const GList*>(b);
+    return xaccSplitOrder (static_cast<const Split*>(link_a->data),
+                           static_cast<const Split*>(link_b->data));
+}
+
+/* Put the links of priv->splits back into the order of split_index. */
+static void
+relink_split_list (AccountPrivate *priv)
+{
+    GSequenceIter *iter;
+    GList *prev = NULL;
+
+    priv->splits = NULL;
+    for (iter = g_sequence_get_begin_iter (priv->split_index);
+         !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter))
+    {
+        auto link = static_cast<GList*>(g_sequence_get (iter));
+        link->prev = prev;
+        link->next = NULL;
+        if (prev)
+            prev->next = link;
+        else
+            priv->splits = link;
+        prev = link;
+    }
+}
+
+/* Link a detached link of priv->splits back in at the place
+ * xaccSplitOrder puts its split and return its iterator in
+ * split_index. */
+static GSequenceIter*
+insert_link_sorted (AccountPrivate *priv, GList *link)
+{
+    GSequenceIter *next_iter;
+    GList *prev = NULL, *next = NULL;
+
+    next_iter = g_sequence_search (priv->split_index, link,
+                                   split_link_order, NULL);
+    if (!g_sequence_iter_is_end (next_iter))
+    {
+        next = static_cast<GList*>(g_sequence_get (next_iter));
+        prev = next->prev;
+    }
+    else if (!g_sequence_iter_is_begin (next_iter))
+    {
+        prev = static_cast<GList*>
+            (g_sequence_get (g_sequence_iter_prev (next_iter)));
+    }
+
+    link->prev = prev;
+    link->next = next;
+    if (prev)
+        prev->next = link;
+    else
+        priv->splits = link;
+    if (next)
+        next->prev = link;
+    return g_sequence_insert_before (next_iter, link);
+}
+
 gboolean
 gnc_account_insert_split (Account *acc, Split *s)
 {
     AccountPrivate *priv;
-    GList *node;
+    GSequenceIter *iter;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
     g_return_val_if_fail(GNC_IS_SPLIT(s), FALSE);
 
     priv = GET_PRIVATE(acc);
-    node = g_list_find(priv->splits, s);
-    if (node)
+    if (g_hash_table_contains (priv->splits_hash, s))
         return FALSE;
 
     if (qof_instance_get_editlevel(acc) == 0)
     {
-        priv->splits = g_list_insert_sorted(priv->splits, s,
-                                            (GCompareFunc)xaccSplitOrder);
+        GList *link = g_list_alloc ();
+        link->data = s;
+        iter = insert_link_sorted (priv, link);
     }
     else
     {
         priv->splits = g_list_prepend(priv->splits, s);
+        iter = g_sequence_prepend (priv->split_index, priv->splits);
         priv->sort_dirty = TRUE;
     }
+    g_hash_table_insert (priv->splits_hash, s, iter);
 
     //FIXME: find better event
     qof_event_gen (&acc->inst, QOF_EVENT_MODIFY, NULL);
     /* Also send an event based on the account */
     qof_event_gen(&acc->inst, GNC_EVENT_ITEM_ADDED, s);
 
-    priv->balance_dirty = TRUE;
+    mark_balance_dirty_from (priv, g_sequence_iter_get_position (iter));
 //  DRH: Should the below be added? It is present in the delete path.
 //  xaccAccountRecomputeBalance(acc);
     return TRUE;
@@ -1769,27 +1939,73 @@ gboolean
 gnc_account_remove_split (Account *acc, Split *s)
 {
     AccountPrivate *priv;
+    GSequenceIter *iter;
     GList *node;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
     g_return_val_if_fail(GNC_IS_SPLIT(s), FALSE);
 
     priv = GET_PRIVATE(acc);
-    node = g_list_find(priv->splits, s);
-    if (NULL == node)
+    iter = static_cast<GSequenceIter*>(g_hash_table_lookup (priv->splits_hash, s));
+    if (NULL == iter)
         return FALSE;
 
+    mark_balance_dirty_from (priv, g_sequence_iter_get_position (iter));
+    node = static_cast<GList*>(g_sequence_get (iter));
+    g_sequence_remove (iter);
+    g_hash_table_remove (priv->splits_hash, s);
+    g_hash_table_remove (priv->unsorted_splits, s);
     priv->splits = g_list_delete_link(priv->splits, node);
     //FIXME: find better event type
     qof_event_gen(&acc->inst, QOF_EVENT_MODIFY, NULL);
     // And send the account-based event, too
     qof_event_gen(&acc->inst, GNC_EVENT_ITEM_REMOVED, s);
 
-    priv->balance_dirty = TRUE;
     xaccAccountRecomputeBalance(acc);
     return TRUE;
 }
 
+/* Put the splits passed to gnc_account_split_changed() back in
+ * order.  All of them are taken out before any is reinserted so that
+ * every search runs over correctly ordered splits.  The list links
+ * are moved rather than freed, as g_list_sort() would, so that a
+ * caller walking the split list doesn't end up on freed memory. */
+static void
+resort_changed_splits (AccountPrivate *priv)
+{
+    GHashTableIter hiter;
+    gpointer key;
+    GList *links = NULL;
+    gint first_pos = G_MAXINT;
+
+    if (g_hash_table_size (priv->unsorted_splits) == 0)
+        return;
+
+    g_hash_table_iter_init (&hiter, priv->unsorted_splits);
+    while (g_hash_table_iter_next (&hiter, &key, NULL))
+    {
+        auto iter = static_cast<GSequenceIter*>
+            (g_hash_table_lookup (priv->splits_hash, key));
+        auto link = static_cast<GList*>(g_sequence_get (iter));
+        first_pos = MIN (first_pos, g_sequence_iter_get_position (iter));
+        g_sequence_remove (iter);
+        priv->splits = g_list_remove_link (priv->splits, link);
+        links = g_list_concat (link, links);
+    }
+    g_hash_table_remove_all (priv->unsorted_splits);
+
+    while (links)
+    {
+        GList *link = links;
+        links = g_list_remove_link (links, link);
+        auto iter = insert_link_sorted (priv, link);
+        g_hash_table_insert (priv->splits_hash, link->data, iter);
+        first_pos = MIN (first_pos, g_sequence_iter_get_position (iter));
+    }
+
+    mark_balance_dirty_from (priv, first_pos);
+}
+
 void
 xaccAccountSortSplits (Account *acc, gboolean force)
 {
@@ -1798,11 +2014,18 @@ xaccAccountSortSplits (Account *acc, gboolean force)
     g_return_if_fail(GNC_IS_ACCOUNT(acc));
 
     priv = GET_PRIVATE(acc);
-    if (!priv->sort_dirty || (!force && qof_instance_get_editlevel(acc) > 0))
+    if (!force && qof_instance_get_editlevel(acc) > 0)
         return;
-    priv->splits = g_list_sort(priv->splits, (GCompareFunc)xaccSplitOrder);
+    if (!priv->sort_dirty)
+    {
+        resort_changed_splits (priv);
+        return;
+    }
+    g_sequence_sort (priv->split_index, split_link_order, NULL);
+    relink_split_list (priv);
+    g_hash_table_remove_all (priv->unsorted_splits);
     priv->sort_dirty = FALSE;
-    priv->balance_dirty = TRUE;
+    mark_balance_dirty_from (priv, 0);
 }
 
 static void
@@ -2000,6 +2223,7 @@ xaccAccountMoveAllSplits (Account *accfrom, Account *accto)
 
     /* optimizations */
     from_priv = GET_PRIVATE(accfrom);
+    account_load_splits (accfrom);
     if (!from_priv->splits || accfrom == accto)
         return;
 
@@ -2075,6 +2299,7 @@ xaccAccountRecomputeBalance (Account * acc)
     gnc_numeric  cleared_balance;
     gnc_numeric  reconciled_balance;
     GList *lp;
+    gint n_splits;
 
     if (NULL == acc) return;
 
@@ -2084,13 +2309,36 @@ xaccAccountRecomputeBalance (Account * acc)
     if (qof_instance_get_destroying(acc)) return;
     if (qof_book_shutting_down(qof_instance_get_book(acc))) return;
 
+    if (!priv->sort_dirty)
+        resort_changed_splits (priv);
+
     balance            = priv->starting_balance;
     cleared_balance    = priv->starting_cleared_balance;
     reconciled_balance = priv->starting_reconciled_balance;
+    lp = priv->splits;
 
-    PINFO ("acct=%s starting baln=%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT,
-           priv->accountName, balance.num, balance.denom);
-    for (lp = priv->splits; lp; lp = lp->next)
+    /* The running balances before balance_dirty_from are still good,
+     * so pick up from the last of them instead of the beginning. */
+    n_splits = g_sequence_get_length (priv->split_index);
+    if (priv->balance_dirty_from > 0 && n_splits > 0)
+    {
+        gint pos = MIN (priv->balance_dirty_from, n_splits);
+        GSequenceIter *iter =
+            g_sequence_get_iter_at_pos (priv->split_index, pos - 1);
+        GList *prev = static_cast<GList*>(g_sequence_get (iter));
+        Split *split = static_cast<Split*>(prev->data);
+
+        balance            = split->balance;
+        cleared_balance    = split->cleared_balance;
+        reconciled_balance = split->reconciled_balance;
+        lp = prev->next;
+    }
+
+    PINFO ("acct=%s starting baln=%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT
+           " from split %d",
+           priv->accountName, balance.num, balance.denom,
+           priv->balance_dirty_from);
+    for (; lp; lp = lp->next)
     {
         Split *split = (Split *) lp->data;
         gnc_numeric amt = xaccSplitGetAmount (split);
@@ -2119,6 +2367,7 @@ xaccAccountRecomputeBalance (Account * acc)
     priv->cleared_balance = cleared_balance;
     priv->reconciled_balance = reconciled_balance;
     priv->balance_dirty = FALSE;
+    priv->balance_dirty_from = 0;
 }
 
 /********************************************************************\
@@ -2233,7 +2482,7 @@ xaccAccountSetType (Account *acc, GNCAccountType tip)
 
     xaccAccountBeginEdit(acc);
     priv->type = tip;
-    priv->balance_dirty = TRUE; /* new type may affect balance computation */
+    mark_balance_dirty_from (priv, 0); /* new type may affect balance computation */
     mark_account(acc);
     xaccAccountCommitEdit(acc);
 }
@@ -2404,6 +2653,7 @@ xaccAccountSetCommodity (Account * acc, gnc_commodity * com)
     priv->non_standard_scu = FALSE;
 
     /* iterate over splits */
+    account_load_splits (acc);
     for (lp = priv->splits; lp; lp = lp->next)
     {
         Split *s = (Split *) lp->data;
@@ -2415,7 +2665,7 @@ xaccAccountSetCommodity (Account * acc, gnc_commodity * com)
     }
 
     priv->sort_dirty = TRUE;  /* Not needed. */
-    priv->balance_dirty = TRUE;
+    mark_balance_dirty_from (priv, 0);
     mark_account (acc);
 
     xaccAccountCommitEdit(acc);
@@ -3201,7 +3451,7 @@ gnc_account_set_start_balance (Account *acc, const gnc_numeric start_baln)
 
     priv = GET_PRIVATE(acc);
     priv->starting_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    mark_balance_dirty_from (priv, 0);
 }
 
 void
@@ -3214,7 +3464,7 @@ gnc_account_set_start_cleared_balance (Account *acc,
 
     priv = GET_PRIVATE(acc);
     priv->starting_cleared_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    mark_balance_dirty_from (priv, 0);
 }
 
 void
@@ -3227,7 +3477,28 @@ gnc_account_set_start_reconciled_balance (Account *acc,
 
     priv = GET_PRIVATE(acc);
     priv->starting_reconciled_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    mark_balance_dirty_from (priv, 0);
+}
+
+gnc_numeric
+gnc_account_get_start_balance (const Account *acc)
+{
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
+    return GET_PRIVATE(acc)->starting_balance;
+}
+
+gnc_numeric
+gnc_account_get_start_cleared_balance (const Account *acc)
+{
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
+    return GET_PRIVATE(acc)->starting_cleared_balance;
+}
+
+gnc_numeric
+gnc_account_get_start_reconciled_balance (const Account *acc)
+{
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
+    return GET_PRIVATE(acc)->starting_reconciled_balance;
 }
 
 gnc_numeric
@@ -3262,6 +3533,7 @@ xaccAccountGetProjectedMinimumBalance (const Account *acc)
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
 
+    account_load_splits (acc);
     priv = GET_PRIVATE(acc);
     today = gnc_time64_get_today_end();
     for (node = g_list_last(priv->splits); node; node = node->prev)
@@ -3289,59 +3561,80 @@ xaccAccountGetProjectedMinimumBalance (const Account *acc)
 /********************************************************************\
 \********************************************************************/
 
+/* Orders the probe link, whose data is NULL, just before the first
+ * split posted on or after the date in user_data.  Splits without a
+ * transaction sort last, as they do in xaccSplitOrder(). */
+static gint
+split_link_date_probe (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    auto link_a = static_cast<const GList*>(a);
+    auto link_b = static_cast<const GList*>(b);
+    auto date = *static_cast<time64*>(user_data);
+    gboolean a_is_probe = (link_a->data == NULL);
+    auto link = a_is_probe ? link_b : link_a;
+    auto trans = xaccSplitGetParent (static_cast<Split*>(link->data));
+    gboolean before = trans && xaccTransRetDatePosted (trans) < date;
+
+    if (a_is_probe)
+        return before ? 1 : -1;
+    return before ? -1 : 1;
+}
+
+/* The running balance just before the first split posted on or after
+ * date, found by binary search over the ordered splits.  The splits
+ * must be sorted and their balances up to date. */
+static gnc_numeric
+balance_before_date (AccountPrivate *priv, time64 date)
+{
+    GList probe = { NULL, NULL, NULL };
+    GSequenceIter *iter;
+
+    iter = g_sequence_search (priv->split_index, &probe,
+                              split_link_date_probe, &date);
+
+    /* No splits posted after the given date, so the latest account
+     * balance is good enough. */
+    if (g_sequence_iter_is_end (iter))
+        return priv->balance;
+
+    /* AsOf date must be before any entries, return zero. */
+    if (g_sequence_iter_is_begin (iter))
+        return gnc_numeric_zero ();
+
+    /* iter points to a split past the date, so get the running
+     * balance of the previous split. */
+    auto link = static_cast<GList*>(g_sequence_get (g_sequence_iter_prev (iter)));
+    return xaccSplitGetBalance (static_cast<Split*>(link->data));
+}
+
 gnc_numeric
 xaccAccountGetBalanceAsOfDate (Account *acc, time64 date)
 {
-    /* Ideally this could use xaccAccountForEachSplit, but
-     * it doesn't exist yet and I'm uncertain of exactly how
-     * it would work at this time, since it differs from
-     * xaccAccountForEachTransaction by using gpointer return
-     * values rather than gints.
-     */
-    AccountPrivate *priv;
-    GList   *lp;
-    gboolean found = FALSE;
     gnc_numeric balance;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
 
-    xaccAccountSortSplits (acc, TRUE); /* just in case, normally a noop */
-    xaccAccountRecomputeBalance (acc); /* just in case, normally a noop */
-
-    priv = GET_PRIVATE(acc);
-    balance = priv->balance;
+    xaccAccountGetBalancesAsOfDates (acc, &date, 1, &balance);
+    return balance;
+}
 
-    lp = priv->splits;
-    while ( lp && !found )
-    {
-        time64 trans_time = xaccTransRetDatePosted( xaccSplitGetParent( (Split *)lp->data ));
-        if ( trans_time >= date )
-            found = TRUE;
-        else
-            lp = lp->next;
-    }
+void
+xaccAccountGetBalancesAsOfDates (Account *acc, const time64 *dates,
+                                 gsize n_dates, gnc_numeric *balances)
+{
+    AccountPrivate *priv;
+    gsize i;
 
-    if ( lp )
-    {
-        if ( lp->prev )
-        {
-            /* Since lp is now pointing to a split which was past the reconcile
-             * date, get the running balance of the previous split.
-             */
-            balance = xaccSplitGetBalance( (Split *)lp->prev->data );
-        }
-        else
-        {
-            /* AsOf date must be before any entries, return zero. */
-            balance = gnc_numeric_zero();
-        }
-    }
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+    g_return_if_fail(n_dates == 0 || (dates && balances));
 
-    /* Otherwise there were no splits posted after the given date,
-     * so the latest account balance should be good enough.
-     */
+    account_load_splits (acc);
+    xaccAccountSortSplits (acc, TRUE); /* just in case, normally a noop */
+    xaccAccountRecomputeBalance (acc); /* just in case, normally a noop */
 
-    return( balance );
+    priv = GET_PRIVATE(acc);
+    for (i = 0; i < n_dates; i++)
+        balances[i] = balance_before_date (priv, dates[i]);
 }
 
 /*
@@ -3361,6 +3654,7 @@ xaccAccountGetPresentBalance (const Account *acc)
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
 
+    account_load_splits (acc);
     priv = GET_PRIVATE(acc);
     today = gnc_time64_get_today_end();
     for (node = g_list_last(priv->splits); node; node = node->prev)
@@ -3671,15 +3965,88 @@ xaccAccountGetBalanceAsOfDateInCurrency(
                include_children);
 }
 
+/* Data passed to xaccAccountBalancesAsOfDatesHelper. */
+typedef struct
+{
+    const gnc_commodity *currency;
+    const time64 *dates;
+    gsize n_dates;
+    gnc_numeric *balances;
+} CurrencyBalances;
+
+/* Get acc's balances at cb->dates and add them, converted to
+ * cb->currency, to cb->balances. */
+static void
+xaccAccountBalancesAsOfDatesHelper (Account *acc, gpointer data)
+{
+    auto cb = static_cast<CurrencyBalances*>(data);
+    auto commodity = GET_PRIVATE(acc)->commodity;
+    std::vector<gnc_numeric> balances (cb->n_dates);
+    gsize i;
+
+    xaccAccountGetBalancesAsOfDates (acc, cb->dates, cb->n_dates,
+                                     balances.data());
+    for (i = 0; i < cb->n_dates; i++)
+    {
+        gnc_numeric balance = xaccAccountConvertBalanceToCurrency
+            (acc, balances[i], commodity, cb->currency);
+        cb->balances[i] = gnc_numeric_add (cb->balances[i], balance,
+                                           gnc_commodity_get_fraction (cb->currency),
+                                           GNC_HOW_RND_ROUND_HALF_UP);
+    }
+}
+
+void
+xaccAccountGetBalancesAsOfDatesInCurrency (Account *acc, const time64 *dates,
+                                           gsize n_dates,
+                                           gnc_commodity *report_commodity,
+                                           gboolean include_children,
+                                           gnc_numeric *balances)
+{
+    CurrencyBalances cb;
+    gsize i;
+
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+    g_return_if_fail(n_dates == 0 || (dates && balances));
+
+    if (!report_commodity)
+        report_commodity = xaccAccountGetCommodity (acc);
+    if (!report_commodity)
+    {
+        for (i = 0; i < n_dates; i++)
+            balances[i] = gnc_numeric_zero ();
+        return;
+    }
+
+    xaccAccountGetBalancesAsOfDates (acc, dates, n_dates, balances);
+    for (i = 0; i < n_dates; i++)
+        balances[i] = xaccAccountConvertBalanceToCurrency
+            (acc, balances[i], GET_PRIVATE(acc)->commodity, report_commodity);
+
+    /* If needed, sum up the children converting to the *requested*
+       commodity. */
+    if (include_children)
+    {
+        cb.currency = report_commodity;
+        cb.dates = dates;
+        cb.n_dates = n_dates;
+        cb.balances = balances;
+        gnc_account_foreach_descendant (acc, xaccAccountBalancesAsOfDatesHelper,
+                                        &cb);
+    }
+}
+
 gnc_numeric
 xaccAccountGetBalanceChangeForPeriod (Account *acc, time64 t1, time64 t2,
                                       gboolean recurse)
 {
-    gnc_numeric b1, b2;
+    time64 dates[2] = { t1, t2 };
+    gnc_numeric balances[2];
 
-    b1 = xaccAccountGetBalanceAsOfDateInCurrency(acc, t1, NULL, recurse);
-    b2 = xaccAccountGetBalanceAsOfDateInCurrency(acc, t2, NULL, recurse);
-    return gnc_numeric_sub(b2, b1, GNC_DENOM_AUTO, GNC_HOW_DENOM_FIXED);
+    xaccAccountGetBalancesAsOfDatesInCurrency (acc, dates, 2, NULL, recurse,
+                                               balances);
+    return gnc_numeric_sub(balances[1], balances[0], GNC_DENOM_AUTO,
+                           GNC_HOW_DENOM_FIXED);
 }
 
 
@@ -3701,6 +4068,7 @@ SplitList *
 xaccAccountGetSplitList (const Account *acc)
 {
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
+    account_load_splits (acc);
     xaccAccountSortSplits((Account*)acc, FALSE);  // normally a noop
     return GET_PRIVATE(acc)->splits;
 }
@@ -3713,7 +4081,8 @@ xaccAccountCountSplits (const Account *acc, gboolean include_children)
     nr = 0;
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), 0);
 
-    nr = g_list_length(xaccAccountGetSplitList(acc));
+    account_load_splits (acc);
+    nr = g_sequence_get_length (GET_PRIVATE(acc)->split_index);
     if (include_children && (gnc_account_n_children(acc) != 0))
     {
         for (i=0; i < gnc_account_n_children(acc); i++)
@@ -3728,6 +4097,7 @@ LotList *
 xaccAccountGetLotList (const Account *acc)
 {
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
+    account_load_splits (acc);
     return g_list_copy(GET_PRIVATE(acc)->lots);
 }
 
@@ -3743,6 +4113,7 @@ xaccAccountFindOpenLots (const Account *acc,
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
 
+    account_load_splits (acc);
     priv = GET_PRIVATE(acc);
     for (lot_list = priv->lots; lot_list; lot_list = lot_list->next)
     {
@@ -3776,6 +4147,7 @@ xaccAccountForEachLot(const Account *acc,
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
     g_return_val_if_fail(proc, NULL);
 
+    account_load_splits (acc);
     priv = GET_PRIVATE(acc);
     for (node = priv->lots; node; node = node->next)
         if ((result = proc((GNCLot *)node->data, data)))
@@ -4735,6 +5107,7 @@ finder_help_function(const Account *acc, const char *description,
     /* Why is this loop iterated backwards ?? Presumably because the split
      * list is in date order, and the most recent matches should be
      * returned!?  */
+    account_load_splits (acc);
     priv = GET_PRIVATE(acc);
     for (slp = g_list_last(priv->splits); slp; slp = slp->prev)
     {
@@ -4897,6 +5270,7 @@ xaccAccountBeginStagedTransactionTraversals (const Account *account)
 
     if (!account)
         return;
+    account_load_splits (account);
     priv = GET_PRIVATE(account);
     xaccSplitsBeginStagedTransactionTraversals(priv->splits);
 }
@@ -4924,6 +5298,7 @@ static void do_one_split (Split *s, gpointer data)
 static void do_one_account (Account *account, gpointer data)
 {
     AccountPrivate *priv = GET_PRIVATE(account);
+    account_load_splits (account);
     g_list_foreach(priv->splits, (GFunc)do_one_split, NULL);
 }
 
@@ -4953,6 +5328,7 @@ xaccAccountStagedTransactionTraversal (const Account *acc,
 
     if (!acc) return 0;
 
+    account_load_splits (acc);
     priv = GET_PRIVATE(acc);
     for (split_p = priv->splits; split_p; split_p = next)
     {
@@ -5002,6 +5378,7 @@ gnc_account_tree_staged_transaction_traversal (const Account *acc,
     }
 
     /* Now this account */
+    account_load_splits (acc);
     for (split_p = priv->splits; split_p; split_p = g_list_next(split_p))
     {
         s = static_cast <Split*> (split_p->data);
@@ -5708,6 +6085,277 @@ gnc_account_book_end(QofBook* book)
     xaccAccountDestroy(root_account);
 }
 
+/* Split query indexes, see qof_query_register_index().  Both find
+ * splits through the account split lists, which only catch up with a
+ * split's account, parent and posted date when its transaction is
+ * committed, so both decline while any transaction is open and the
+ * query falls back to a scan.  A split without an account isn't found
+ * by the date index at all. */
+
+/* The accounts named by a lone match-any term on the split's account
+ * GUID.  Returns FALSE for any other predicates. */
+static gboolean
+split_query_accounts (QofBook *book, GSList *pred_data, GList **accounts)
+{
+    QofQueryPredData *pd;
+    query_guid_t pdata;
+    GList *node;
+
+    *accounts = NULL;
+    if (!pred_data || pred_data->next)
+        return FALSE;
+
+    pd = static_cast<QofQueryPredData*>(pred_data->data);
+    if (g_strcmp0 (pd->type_name, QOF_TYPE_GUID))
+        return FALSE;
+    pdata = reinterpret_cast<query_guid_t>(pd);
+    if (pdata->options != QOF_GUID_MATCH_ANY)
+        return FALSE;
+
+    for (node = pdata->guids; node; node = node->next)
+    {
+        auto acc = xaccAccountLookup (static_cast<GncGUID*>(node->data), book);
+        if (acc && !g_list_find (*accounts, acc))
+            *accounts = g_list_prepend (*accounts, acc);
+    }
+    return TRUE;
+}
+
+static gint64
+split_account_index_estimate (QofBook *book, GSList *pred_data)
+{
+    GList *accounts, *node;
+    gint64 count = 0;
+
+    if (xaccTransAnyOpen () ||
+        !split_query_accounts (book, pred_data, &accounts))
+        return -1;
+
+    for (node = accounts; node; node = node->next)
+    {
+        auto acc = static_cast<Account*>(node->data);
+        account_load_splits (acc);
+        count += g_sequence_get_length (GET_PRIVATE(acc)->split_index);
+    }
+    g_list_free (accounts);
+    return count;
+}
+
+static void
+split_account_index_foreach (QofBook *book, GSList *pred_data,
+                             QofInstanceForeachCB cb, gpointer user_data)
+{
+    GList *accounts, *node, *lp;
+
+    if (!split_query_accounts (book, pred_data, &accounts))
+        return;
+
+    for (node = accounts; node; node = node->next)
+    {
+        auto acc = static_cast<Account*>(node->data);
+        account_load_splits (acc);
+        for (lp = GET_PRIVATE(acc)->splits; lp; lp = lp->next)
+            cb (QOF_INSTANCE (lp->data), user_data);
+    }
+    g_list_free (accounts);
+}
+
+static const QofQueryIndex split_account_index =
+{
+    split_account_index_estimate,
+    split_account_index_foreach,
+};
+
+/* Intersects posted-date terms into the inclusive range [lo, hi],
+ * which is empty if lo > hi.  Returns FALSE for predicates other
+ * than plain comparisons. */
+static gboolean
+split_query_date_range (GSList *pred_data, time64 *lo, time64 *hi)
+{
+    GSList *node;
+
+    *lo = G_MININT64;
+    *hi = G_MAXINT64;
+    for (node = pred_data; node; node = node->next)
+    {
+        auto pd = static_cast<QofQueryPredData*>(node->data);
+        query_date_t pdata;
+
+        if (g_strcmp0 (pd->type_name, QOF_TYPE_DATE))
+            return FALSE;
+        pdata = reinterpret_cast<query_date_t>(pd);
+        if (pdata->options != QOF_DATE_MATCH_NORMAL)
+            return FALSE;
+
+        switch (pd->how)
+        {
+        case QOF_COMPARE_GT:
+            if (pdata->date == G_MAXINT64)
+                *hi = G_MININT64;
+            else
+                *lo = MAX (*lo, pdata->date + 1);
+            break;
+        case QOF_COMPARE_GTE:
+            *lo = MAX (*lo, pdata->date);
+            break;
+        case QOF_COMPARE_LT:
+            if (pdata->date == G_MININT64)
+                *lo = G_MAXINT64;
+            else
+                *hi = MIN (*hi, pdata->date - 1);
+            break;
+        case QOF_COMPARE_LTE:
+            *hi = MIN (*hi, pdata->date);
+            break;
+        case QOF_COMPARE_EQUAL:
+            *lo = MAX (*lo, pdata->date);
+            *hi = MIN (*hi, pdata->date);
+            break;
+        default:
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+typedef struct
+{
+    time64 lo;
+    time64 hi;
+    gint64 count;
+    gboolean unloaded;
+    QofInstanceForeachCB cb;
+    gpointer user_data;
+} SplitDateIndexData;
+
+/* The ordered splits of acc posted in [lo, hi] lie between the two
+ * iters.  Returns FALSE if the splits can't be put in order now. */
+static gboolean
+split_index_date_bounds (Account *acc, time64 lo, time64 hi,
+                         GSequenceIter **begin, GSequenceIter **end)
+{
+    AccountPrivate *priv = GET_PRIVATE(acc);
+    GList probe = { NULL, NULL, NULL };
+    time64 after;
+
+    xaccAccountSortSplits (acc, FALSE);
+    if (priv->sort_dirty || g_hash_table_size (priv->unsorted_splits))
+        return FALSE;
+
+    *begin = g_sequence_search (priv->split_index, &probe,
+                                split_link_date_probe, &lo);
+    if (hi == G_MAXINT64)
+        *end = g_sequence_get_end_iter (priv->split_index);
+    else
+    {
+        after = hi + 1;
+        *end = g_sequence_search (priv->split_index, &probe,
+                                  split_link_date_probe, &after);
+    }
+    return TRUE;
+}
+
+static void
+split_date_index_count_cb (QofInstance *inst, gpointer user_data)
+{
+    auto acc = GNC_ACCOUNT (inst);
+    auto data = static_cast<SplitDateIndexData*>(user_data);
+    GSequenceIter *begin, *end;
+
+    if (GET_PRIVATE(acc)->split_loader)
+        data->unloaded = TRUE;
+    if (data->unloaded)
+        return;
+
+    if (split_index_date_bounds (acc, data->lo, data->hi, &begin, &end))
+        data->count += g_sequence_iter_get_position (end) -
+                       g_sequence_iter_get_position (begin);
+    else
+        data->count += g_sequence_get_length (GET_PRIVATE(acc)->split_index);
+}
+
+static void
+split_date_index_visit (Split *split, SplitDateIndexData *data)
+{
+    time64 date = xaccTransRetDatePosted (xaccSplitGetParent (split));
+
+    if (date < data->lo || date > data->hi)
+        return;
+    data->cb (QOF_INSTANCE (split), data->user_data);
+}
+
+static void
+split_date_index_foreach_cb (QofInstance *inst, gpointer user_data)
+{
+    auto acc = GNC_ACCOUNT (inst);
+    auto data = static_cast<SplitDateIndexData*>(user_data);
+    GSequenceIter *iter, *end;
+
+    if (!split_index_date_bounds (acc, data->lo, data->hi, &iter, &end))
+    {
+        for (auto lp = GET_PRIVATE(acc)->splits; lp; lp = lp->next)
+            split_date_index_visit (static_cast<Split*>(lp->data), data);
+        return;
+    }
+
+    for (; iter != end; iter = g_sequence_iter_next (iter))
+    {
+        auto link = static_cast<GList*>(g_sequence_get (iter));
+        split_date_index_visit (static_cast<Split*>(link->data), data);
+    }
+}
+
+static gint64
+split_date_index_estimate (QofBook *book, GSList *pred_data)
+{
+    SplitDateIndexData data = { 0, 0, 0, FALSE, NULL, NULL };
+
+    if (xaccTransAnyOpen () ||
+        !split_query_date_range (pred_data, &data.lo, &data.hi))
+        return -1;
+    if (data.lo > data.hi)
+        return 0;
+
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_ACCOUNT),
+                            split_date_index_count_cb, &data);
+    /* Counting would mean loading every account's splits. */
+    return data.unloaded ? -1 : data.count;
+}
+
+static void
+split_date_index_foreach (QofBook *book, GSList *pred_data,
+                          QofInstanceForeachCB cb, gpointer user_data)
+{
+    SplitDateIndexData data = { 0, 0, 0, FALSE, cb, user_data };
+
+    if (!split_query_date_range (pred_data, &data.lo, &data.hi) ||
+        data.lo > data.hi)
+        return;
+
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_ACCOUNT),
+                            split_date_index_foreach_cb, &data);
+}
+
+static const QofQueryIndex split_date_index =
+{
+    split_date_index_estimate,
+    split_date_index_foreach,
+};
+
+static void
+register_split_indexes (void)
+{
+    QofQueryParamList *path;
+
+    path = qof_query_build_param_list (SPLIT_ACCOUNT, QOF_PARAM_GUID, NULL);
+    qof_query_register_index (GNC_ID_SPLIT, path, &split_account_index);
+    g_slist_free (path);
+
+    path = qof_query_build_param_list (SPLIT_TRANS, TRANS_DATE_POSTED, NULL);
+    qof_query_register_index (GNC_ID_SPLIT, path, &split_date_index);
+    g_slist_free (path);
+}
+
 #ifdef _MSC_VER
 /* MSVC compiler doesn't have C99 "designated initializers"
  * so we wrap them in a macro that is empty on MSVC. */
@@ -5831,6 +6479,15 @@ gboolean xaccAccountRegister (void)
     };
 
     qof_class_register (GNC_ID_ACCOUNT, (QofSortFunc) qof_xaccAccountOrder, params);
+    register_split_indexes ();
+
+    /* The split added to, removed from or changed in the account, and
+     * the parent an account was removed from. */
+    qof_event_register_batch_data (GNC_ID_ACCOUNT, GNC_EVENT_ITEM_ADDED, 0);
+    qof_event_register_batch_data (GNC_ID_ACCOUNT, GNC_EVENT_ITEM_REMOVED, 0);
+    qof_event_register_batch_data (GNC_ID_ACCOUNT, GNC_EVENT_ITEM_CHANGED, 0);
+    qof_event_register_batch_data (GNC_ID_ACCOUNT, QOF_EVENT_REMOVE,
+                                   sizeof (GncEventData));
 
     return qof_object_register (&account_object_def);
 }
@@ -349,6 +349,13 @@ void gnc_account_set_start_cleared_balance (Account *acc,
 void gnc_account_set_start_reconciled_balance (Account *acc,
         const gnc_numeric start_baln);
 
+/** Get the starting commodity balances set with
+ *  gnc_account_set_start_balance() and friends.  They are zero unless a
+ *  backend has returned only part of the account's splits. */
+gnc_numeric gnc_account_get_start_balance (const Account *acc);
+gnc_numeric gnc_account_get_start_cleared_balance (const Account *acc);
+gnc_numeric gnc_account_get_start_reconciled_balance (const Account *acc);
+
 /** Tell the account that the running balances may be incorrect and
  *  need to be recomputed.
  *
@@ -558,6 +565,22 @@ gnc_numeric xaccAccountGetProjectedMinimumBalance (const Account *account);
 gnc_numeric xaccAccountGetBalanceAsOfDate (Account *account,
         time64 date);
 
+/** Get the balance of the account as of each of the dates specified.
+ *  The account is brought up to date once and each date is then found
+ *  by a binary search over the splits, so this is cheaper than calling
+ *  xaccAccountGetBalanceAsOfDate() for every date.
+ *
+ *  @param account The account.
+ *
+ *  @param dates The dates, in any order.
+ *
+ *  @param n_dates The number of dates.
+ *
+ *  @param balances Array of n_dates elements that receives the balance
+ *  as of each date, in the account's commodity. */
+void xaccAccountGetBalancesAsOfDates (Account *account, const time64 *dates,
+                                      gsize n_dates, gnc_numeric *balances);
+
 /* These two functions convert a given balance from one commodity to
    another.  The account argument is only used to get the Book, and
    may have nothing to do with the supplied balance.  Likewise, the
@@ -601,6 +624,14 @@ gnc_numeric xaccAccountGetBalanceAsOfDateInCurrency(
     Account *account, time64 date, gnc_commodity *report_commodity,
     gboolean include_children);
 
+/* This function gets the balances as of each of the n_dates dates in
+   the desired commodity, see xaccAccountGetBalancesAsOfDates(). Each
+   account in the tree is visited only once. */
+void xaccAccountGetBalancesAsOfDatesInCurrency(
+    Account *account, const time64 *dates, gsize n_dates,
+    gnc_commodity *report_commodity, gboolean include_children,
+    gnc_numeric *balances);
+
 gnc_numeric xaccAccountGetBalanceChangeForPeriod (
     Account *acc, time64 date1, time64 date2, gboolean recurse);
 
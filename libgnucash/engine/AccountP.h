@@ -47,6 +47,8 @@ extern "C" {
 
 #define GNC_ID_ROOT_ACCOUNT        "RootAccount"
 
+typedef void (*AccountSplitLoader) (Account *acc, gpointer user_data);
+
 /** STRUCTS *********************************************************/
 
 /** This is the data that describes an account.
@@ -113,13 +115,29 @@ typedef struct AccountPrivate
     gnc_numeric reconciled_balance;
 
     gboolean balance_dirty;     /* balances in splits incorrect */
-
+    gint balance_dirty_from;    /* position of first incorrect balance */
+
+    /* The splits are kept in split_index, a balanced tree ordered by
+     * xaccSplitOrder(), so that finding the place for a new split and
+     * removing one are O(log n).  Each element of split_index is the
+     * GList link in 'splits' that holds the split, and splits_hash
+     * maps a Split* to its GSequenceIter.  'splits' is kept in the
+     * same order as split_index and is what xaccAccountGetSplitList()
+     * hands out. */
     GList *splits;              /* list of split pointers */
+    GSequence *split_index;     /* ordered index of links in splits */
+    GHashTable *splits_hash;    /* Split* -> GSequenceIter* */
+    GHashTable *unsorted_splits; /* splits whose sort key has changed */
     gboolean sort_dirty;        /* sort order of splits is bad */
 
     LotList   *lots;		/* list of lot pointers */
     GNCPolicy *policy;		/* Cached pointer to policy method */
 
+    /* Set by a backend that hasn't loaded the account's splits yet;
+     * called, and cleared, the first time they are needed. */
+    AccountSplitLoader split_loader;
+    gpointer split_loader_data;
+
     /* The "mark" flag can be used by the user to mark this account
      * in any way desired.  Handy for specialty traversals of the
      * account tree. */
@@ -139,6 +157,30 @@ void xaccAccountSetGUID (Account *account, const GncGUID *guid);
 /* Register Accounts with the engine */
 gboolean xaccAccountRegister (void);
 
+/* Tell the account that something about the split that affects its
+ * sort order or running balance (date, amount, reconcile state, ...)
+ * has changed.  The split is put back in order the next time the
+ * splits are sorted or the balance is recomputed, and only the
+ * running balances from its old or new position onward are
+ * recomputed.  If the split isn't in the account's index yet this
+ * falls back to marking the whole account sort and balance dirty. */
+void gnc_account_split_changed (Account *acc, Split *s);
+
+/* Backends that don't load every transaction up front register a
+ * loader on each account whose splits are still in the database.  The
+ * account calls it once, the first time something needs the complete
+ * list of splits: the split list itself, a split count, a dated or
+ * present balance, a search or a traversal.  The current balances
+ * don't need the splits, so the backend should seed them with
+ * gnc_account_set_start_balance() and friends.  Pass a NULL loader to
+ * clear it once the splits have been loaded some other way. */
+void gnc_account_set_split_loader (Account *acc, AccountSplitLoader loader,
+                                   gpointer user_data);
+gboolean gnc_account_has_split_loader (const Account *acc);
+/* Run the account's split loader now if it still has one.  Lots hold
+ * the account's splits, so code that walks them calls this first. */
+void gnc_account_load_splits (const Account *acc);
+
 /* Structure for accessing static functions for testing */
 typedef struct
 {
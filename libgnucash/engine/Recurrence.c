@@ -422,6 +422,31 @@ recurrenceGetAccountPeriodValue(const Recurrence *r, Account *acc, guint n)
     return xaccAccountGetBalanceChangeForPeriod (acc, t1, t2, TRUE);
 }
 
+void
+recurrenceGetAccountPeriodValues(const Recurrence *r, Account *acc,
+                                 guint n_periods, gnc_numeric *values)
+{
+    time64 *dates;
+    gnc_numeric *balances;
+    guint i;
+
+    g_return_if_fail(r && acc && values);
+    dates = g_new (time64, 2 * n_periods);
+    balances = g_new (gnc_numeric, 2 * n_periods);
+    for (i = 0; i < n_periods; i++)
+    {
+        dates[2 * i] = recurrenceGetPeriodTime(r, i, FALSE);
+        dates[2 * i + 1] = recurrenceGetPeriodTime(r, i, TRUE);
+    }
+    xaccAccountGetBalancesAsOfDatesInCurrency (acc, dates, 2 * n_periods,
+                                               NULL, TRUE, balances);
+    for (i = 0; i < n_periods; i++)
+        values[i] = gnc_numeric_sub (balances[2 * i + 1], balances[2 * i],
+                                     GNC_DENOM_AUTO, GNC_HOW_DENOM_FIXED);
+    g_free (balances);
+    g_free (dates);
+}
+
 void
 recurrenceListNextInstance(const GList *rlist, const GDate *ref, GDate *next)
 {
@@ -145,6 +145,14 @@ time64 recurrenceGetPeriodTime(const Recurrence *r, guint n, gboolean end);
 gnc_numeric recurrenceGetAccountPeriodValue(const Recurrence *r,
         Account *acct, guint n);
 
+/**
+ * Fill values[0 .. n_periods-1] with the amounts that an Account's value
+ * changed in each of the first n_periods instances of the Recurrence,
+ * visiting the account tree only once.
+ **/
+void recurrenceGetAccountPeriodValues(const Recurrence *r, Account *acct,
+                                      guint n_periods, gnc_numeric *values);
+
 /** @return the earliest of the next occurrences -- a "composite" recurrence **/
 void recurrenceListNextInstance(const GList *r, const GDate *refDate,
                                 GDate *nextDate);
@@ -723,7 +723,7 @@ void mark_split (Split *s)
 {
     if (s->acc)
     {
-        g_object_set(s->acc, "sort-dirty", TRUE, "balance-dirty", TRUE, NULL);
+        gnc_account_split_changed (s->acc, s);
     }
 
     /* set dirty flag on lot too. */
@@ -1010,7 +1010,7 @@ xaccSplitCommitEdit(Split *s)
 
     if (acc)
     {
-        g_object_set(acc, "sort-dirty", TRUE, "balance-dirty", TRUE, NULL);
+        gnc_account_split_changed (acc, s);
         xaccAccountRecomputeBalance(acc);
     }
 }
@@ -2320,6 +2320,9 @@ gboolean xaccSplitRegister (void)
                         NULL);
     qof_class_register (SPLIT_CORR_ACCT_CODE,
                         (QofSortFunc)xaccSplitCompareOtherAccountCodes, NULL);
+    /* The transaction a split was removed from. */
+    qof_event_register_batch_data (GNC_ID_SPLIT, QOF_EVENT_REMOVE,
+                                   sizeof (GncEventData));
 
     return qof_object_register (&split_object_def);
 }
@@ -199,6 +199,11 @@ const char *assoc_uri_str = "assoc_uri";
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = GNC_MOD_ENGINE;
 
+/* The number of transactions, in any book, between xaccTransBeginEdit()
+ * and the end of their commit or rollback: those holding a rollback
+ * copy in trans->orig. */
+static guint open_trans_count = 0;
+
 enum
 {
     PROP_0,
@@ -826,6 +831,7 @@ xaccFreeTransaction (Transaction *trans)
     {
         xaccFreeTransaction (trans->orig);
         trans->orig = NULL;
+        open_trans_count--;
     }
 
     /* qof_instance_release (&trans->inst); */
@@ -1454,6 +1460,7 @@ xaccTransBeginEdit (Transaction *trans)
     /* Make a clone of the transaction; we will use this
      * in case we need to roll-back the edit. */
     trans->orig = dupe_trans (trans);
+    open_trans_count++;
 }
 
 /********************************************************************\
@@ -1621,6 +1628,8 @@ static void trans_cleanup_commit(Transaction *trans)
     /* Get rid of the copy we made. We won't be rolling back,
      * so we don't need it any more.  */
     PINFO ("get rid of rollback trans=%p", trans->orig);
+    if (trans->orig)
+        open_trans_count--;
     xaccFreeTransaction (trans->orig);
     trans->orig = NULL;
 
@@ -1692,6 +1701,23 @@ xaccTransCommitEdit (Transaction *trans)
         qof_instance_set_dirty(QOF_INSTANCE(trans));
     }
 
+    /* The transaction's own fields order its splits too, so put the
+     * ones that aren't committed as changed back in place as well. */
+    if (qof_instance_is_dirty (QOF_INSTANCE(trans)) &&
+            !qof_instance_get_destroying (trans))
+    {
+        GList *node;
+
+        for (node = trans->splits; node; node = node->next)
+        {
+            Split *s = node->data;
+
+            if (s->acc && s->parent == trans &&
+                    !qof_instance_is_dirty (QOF_INSTANCE(s)))
+                gnc_account_split_changed (s->acc, s);
+        }
+    }
+
     qof_commit_edit_part2(QOF_INSTANCE(trans),
                           (void (*) (QofInstance *, QofBackendError))
                           trans_on_error,
@@ -1853,6 +1879,8 @@ xaccTransRollbackEdit (Transaction *trans)
     if (!qof_book_is_readonly(qof_instance_get_book(trans)))
         xaccTransWriteLog (trans, 'R');
 
+    if (trans->orig)
+        open_trans_count--;
     xaccFreeTransaction (trans->orig);
 
     trans->orig = NULL;
@@ -1874,6 +1902,12 @@ xaccTransIsOpen (const Transaction *trans)
     return trans ? (0 < qof_instance_get_editlevel(trans)) : FALSE;
 }
 
+gboolean
+xaccTransAnyOpen (void)
+{
+    return open_trans_count > 0;
+}
+
 #define SECS_PER_DAY 86400
 
 int
@@ -2966,6 +3000,14 @@ trans_is_balanced_p (const Transaction *trans)
     return trans ? xaccTransIsBalanced(trans) : FALSE;
 }
 
+/* A live split query tests the splits of a changed transaction again,
+ * as its terms may look at the transaction's fields. */
+static GList *
+trans_related_splits (QofInstance *inst)
+{
+    return xaccTransGetSplitList (GNC_TRANSACTION (inst));
+}
+
 gboolean xaccTransRegister (void)
 {
     static QofParam params[] =
@@ -3050,6 +3092,12 @@ gboolean xaccTransRegister (void)
         };
 
     qof_class_register (GNC_ID_TRANS, (QofSortFunc)xaccTransOrder, params);
+    qof_query_register_related (GNC_ID_SPLIT, GNC_ID_TRANS,
+                                trans_related_splits);
+    qof_event_register_batch_data (GNC_ID_TRANS, GNC_EVENT_ITEM_ADDED,
+                                   sizeof (GncEventData));
+    qof_event_register_batch_data (GNC_ID_TRANS, GNC_EVENT_ITEM_REMOVED,
+                                   sizeof (GncEventData));
 
     return qof_object_register (&trans_object_def);
 }
@@ -176,6 +176,13 @@ void xaccDisableDataScrubbing(void);
 void xaccTransRemoveSplit (Transaction *trans, const Split *split);
 void check_open (const Transaction *trans);
 
+/* xaccTransAnyOpen() returns TRUE while any transaction is between
+ *    xaccTransBeginEdit() and the end of its commit or rollback, that
+ *    is while some split may have an account, parent or posted date
+ *    that its account's split list doesn't reflect yet.
+ */
+gboolean xaccTransAnyOpen (void);
+
 /* Structure for accessing static functions for testing */
 typedef struct
 {
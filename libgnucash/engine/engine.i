@@ -83,6 +83,28 @@ engine-common.i */
 %include "engine-common.i"
 %include "engine-deprecated.h"
 
+%inline %{
+/* Takes a list of dates and returns the list of the account's balances
+ * as of those dates, see xaccAccountGetBalancesAsOfDates. */
+static SCM xaccAccountGetBalancesAsOfDatesList(Account *acc, SCM dates_scm)
+{
+    gsize n_dates = scm_to_size_t (scm_length (dates_scm));
+    time64 *dates = g_new (time64, n_dates);
+    gnc_numeric *balances = g_new (gnc_numeric, n_dates);
+    SCM result = SCM_EOL;
+    gsize i;
+
+    for (i = 0; i < n_dates; i++, dates_scm = SCM_CDR (dates_scm))
+        dates[i] = scm_to_int64 (SCM_CAR (dates_scm));
+    xaccAccountGetBalancesAsOfDates (acc, dates, n_dates, balances);
+    for (i = n_dates; i > 0; i--)
+        result = scm_cons (gnc_numeric_to_scm (balances[i - 1]), result);
+    g_free (balances);
+    g_free (dates);
+    return result;
+}
+%}
+
 %inline %{
 static const GncGUID * gncPriceGetGUID(GNCPrice *x)
 { return qof_instance_get_guid(QOF_INSTANCE(x)); }
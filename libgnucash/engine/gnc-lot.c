@@ -361,11 +361,22 @@ gnc_lot_get_book (GNCLot *lot)
 
 /* ============================================================= */
 
+/* A lot's splits arrive with its account's, so make sure a backend that
+ * loads accounts lazily has loaded them before looking at the lot. */
+static void
+lot_load_splits (const GNCLot *lot)
+{
+    LotPrivate* priv = GET_PRIVATE(lot);
+    if (priv->account)
+        gnc_account_load_splits (priv->account);
+}
+
 gboolean
 gnc_lot_is_closed (GNCLot *lot)
 {
     LotPrivate* priv;
     if (!lot) return TRUE;
+    lot_load_splits (lot);
     priv = GET_PRIVATE(lot);
     if (0 > priv->is_closed) gnc_lot_get_balance (lot);
     return priv->is_closed;
@@ -407,6 +418,7 @@ gnc_lot_get_split_list (const GNCLot *lot)
 {
     LotPrivate* priv;
     if (!lot) return NULL;
+    lot_load_splits (lot);
     priv = GET_PRIVATE(lot);
     return priv->splits;
 }
@@ -415,6 +427,7 @@ gint gnc_lot_count_splits (const GNCLot *lot)
 {
     LotPrivate* priv;
     if (!lot) return 0;
+    lot_load_splits (lot);
     priv = GET_PRIVATE(lot);
     return g_list_length (priv->splits);
 }
@@ -481,6 +494,7 @@ gnc_lot_get_balance (GNCLot *lot)
     gnc_numeric baln = zero;
     if (!lot) return zero;
 
+    lot_load_splits (lot);
     priv = GET_PRIVATE(lot);
     if (!priv->splits)
     {
@@ -528,6 +542,7 @@ gnc_lot_get_balance_before (const GNCLot *lot, const Split *split,
     *value = val;
     if (lot == NULL) return;
 
+    lot_load_splits (lot);
     priv = GET_PRIVATE(lot);
     if (priv->splits)
     {
@@ -648,6 +663,7 @@ gnc_lot_get_earliest_split (GNCLot *lot)
 {
     LotPrivate* priv;
     if (!lot) return NULL;
+    lot_load_splits (lot);
     priv = GET_PRIVATE(lot);
     if (! priv->splits) return NULL;
     priv->splits = g_list_sort (priv->splits, (GCompareFunc) xaccSplitOrderDateOnly);
@@ -662,6 +678,7 @@ gnc_lot_get_latest_split (GNCLot *lot)
     SplitList *node;
 
     if (!lot) return NULL;
+    lot_load_splits (lot);
     priv = GET_PRIVATE(lot);
     if (! priv->splits) return NULL;
     priv->splits = g_list_sort (priv->splits, (GCompareFunc) xaccSplitOrderDateOnly);
@@ -52,10 +52,34 @@ struct _GncPriceClass
     QofInstanceClass parent_class;
 };
 
+/* The number of conversions a pricedb remembers. */
+#define CONVERSION_CACHE_SIZE 1024
+
 struct gnc_price_db_s
 {
     QofInstance inst;              /* globally unique object identifier */
     GHashTable *commodity_hash;
+    /* Secondary indexes over the price lists in commodity_hash, both
+     * keyed by a PriceKey.  pair_index maps (commodity, currency) to a
+     * GPtrArray of the GList links of that pair's price list, in the same
+     * newest-first order, so that lookups by time can bisect instead of
+     * walking the list.  day_index maps (commodity, currency, canonical
+     * day) to a GList of the prices on that day for the duplicate check.
+     */
+    GHashTable *pair_index;
+    GHashTable *day_index;
+    /* Maps (from, to, time) to the list of prices that
+     * gnc_pricedb_convert_balance_* use for that conversion.  Only the
+     * CONVERSION_CACHE_SIZE most recently used are kept; conversion_lru
+     * holds them most recent first. */
+    GHashTable *conversion_cache;
+    GQueue conversion_lru;
+    /* Maps each commodity to a GPtrArray of the commodities it has
+     * prices with, for conversions through several prices.  Built on
+     * first use and dropped along with the conversion cache. */
+    GHashTable *conversion_graph;
+    guint conversion_hits;
+    guint conversion_misses;
     gboolean bulk_update;		 /* TRUE while reading XML file, etc. */
 };
 
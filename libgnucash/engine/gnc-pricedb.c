@@ -821,6 +821,294 @@ gnc_price_list_equal(PriceList *prices1, PriceList *prices2)
     return TRUE;
 }
 
+/* ==================================================================== */
+/* price index functions
+
+   Each price list in the commodity hash is shadowed by two indexes,
+   keyed by PriceKey.  The pair index holds, for each (commodity,
+   currency) pair, a GPtrArray of the links of the price list in the
+   same newest-first order.  Lookups by time bisect it instead of walking
+   the list, and add_price() and remove_price() use it to splice links in
+   and out without searching.  The day index collects the prices of a
+   pair by canonical day so that the duplicate check is a hash lookup
+   rather than a scan of the whole list.
+ */
+
+typedef struct
+{
+    const gnc_commodity *commodity;
+    const gnc_commodity *currency;
+    /* Canonical day in the day index, 0 in the pair index and the time of
+     * the conversion in the conversion cache. */
+    time64 t;
+} PriceKey;
+
+static guint
+price_key_hash (gconstpointer key)
+{
+    const PriceKey *k = key;
+    guint hash = g_direct_hash (k->commodity);
+    hash = hash * 31 + g_direct_hash (k->currency);
+    return hash * 31 + g_int64_hash (&k->t);
+}
+
+static gboolean
+price_key_equal (gconstpointer a, gconstpointer b)
+{
+    const PriceKey *ka = a;
+    const PriceKey *kb = b;
+    return ka->commodity == kb->commodity && ka->currency == kb->currency &&
+        ka->t == kb->t;
+}
+
+static void
+price_key_free (gpointer key)
+{
+    g_slice_free (PriceKey, key);
+}
+
+static void
+price_index_free (gpointer data)
+{
+    g_ptr_array_free ((GPtrArray *) data, TRUE);
+}
+
+static void
+price_day_key (PriceKey *key, const GNCPrice *p)
+{
+    key->commodity = p->commodity;
+    key->currency = p->currency;
+    key->t = time64CanonicalDayTime (p->tmspec);
+}
+
+/* An entry of db->conversion_cache, which is keyed by its key. */
+typedef struct
+{
+    PriceKey key;
+    GList *path;
+    GList lru_link;
+} ConversionEntry;
+
+static void
+conversion_entry_free (gpointer data)
+{
+    ConversionEntry *entry = data;
+    gnc_price_list_destroy (entry->path);
+    g_slice_free (ConversionEntry, entry);
+}
+
+/* The cached conversion paths may go through any price, so any change to
+ * the price lists makes them suspect. */
+static void
+conversion_cache_flush (GNCPriceDB *db)
+{
+    if (g_hash_table_size (db->conversion_cache) > 0)
+        g_hash_table_remove_all (db->conversion_cache);
+    g_queue_init (&db->conversion_lru);
+    if (db->conversion_graph)
+    {
+        g_hash_table_destroy (db->conversion_graph);
+        db->conversion_graph = NULL;
+    }
+}
+
+static GPtrArray *
+price_index_lookup (GNCPriceDB *db, const gnc_commodity *commodity,
+                    const gnc_commodity *currency)
+{
+    PriceKey key = {commodity, currency, 0};
+    return g_hash_table_lookup (db->pair_index, &key);
+}
+
+#define PRICE_INDEX_PRICE(links, i) \
+    ((GNCPrice *) ((GList *) g_ptr_array_index ((links), (i)))->data)
+
+/* Returns the position of the first entry of links that doesn't sort
+ * before p, which is where p is or would be. */
+static guint
+price_index_bisect (GPtrArray *links, const GNCPrice *p)
+{
+    guint lo = 0, hi = links->len;
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        if (compare_prices_by_date (PRICE_INDEX_PRICE (links, mid), p) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Returns the position of the first price in links that isn't newer than
+ * t, or links->len if all of them are. */
+static guint
+price_index_bisect_time (GPtrArray *links, time64 t)
+{
+    guint lo = 0, hi = links->len;
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        if (gnc_price_get_time64 (PRICE_INDEX_PRICE (links, mid)) > t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* A price is a duplicate if its pair already has a price with the same
+ * value on the same day. */
+static gboolean
+price_index_is_duplicate (GNCPriceDB *db, const GNCPrice *p)
+{
+    PriceKey key;
+    GList *node;
+
+    price_day_key (&key, p);
+    for (node = g_hash_table_lookup (db->day_index, &key); node;
+         node = node->next)
+        if (gnc_numeric_equal (gnc_price_get_value (node->data), p->value))
+            return TRUE;
+    return FALSE;
+}
+
+/* Links p into price_list, the list of its pair, at its sorted position
+ * and records it in both indexes.  The list takes over the caller's
+ * reference to p.  Returns the new head of the list. */
+static GList *
+price_index_insert (GNCPriceDB *db, GList *price_list, GNCPrice *p)
+{
+    PriceKey key = {p->commodity, p->currency, 0};
+    GPtrArray *links = g_hash_table_lookup (db->pair_index, &key);
+    GList *link = g_list_alloc ();
+    GList *days;
+    guint pos;
+
+    if (!links)
+    {
+        links = g_ptr_array_new ();
+        g_hash_table_insert (db->pair_index, g_slice_dup (PriceKey, &key),
+                             links);
+    }
+
+    link->data = p;
+    pos = price_index_bisect (links, p);
+    if (pos < links->len)
+    {
+        GList *next = g_ptr_array_index (links, pos);
+        link->prev = next->prev;
+        link->next = next;
+        if (next->prev)
+            next->prev->next = link;
+        next->prev = link;
+    }
+    else if (links->len > 0)
+    {
+        GList *last = g_ptr_array_index (links, links->len - 1);
+        last->next = link;
+        link->prev = last;
+    }
+    g_ptr_array_insert (links, pos, link);
+    conversion_cache_flush (db);
+
+    price_day_key (&key, p);
+    days = g_hash_table_lookup (db->day_index, &key);
+    if (days)
+        g_list_append (days, p); /* Doesn't change the head. */
+    else
+        g_hash_table_insert (db->day_index, g_slice_dup (PriceKey, &key),
+                             g_list_prepend (NULL, p));
+
+    return pos == 0 ? link : price_list;
+}
+
+/* Unlinks p from price_list, the list of its pair, removes it from both
+ * indexes and drops the list's reference to it.  Returns the new head of
+ * the list. */
+static GList *
+price_index_remove (GNCPriceDB *db, GList *price_list, GNCPrice *p)
+{
+    PriceKey key = {p->commodity, p->currency, 0};
+    GPtrArray *links = g_hash_table_lookup (db->pair_index, &key);
+    gpointer day_key, days;
+    GList *link;
+    guint pos;
+
+    if (!links) return price_list;
+
+    pos = price_index_bisect (links, p);
+    if (pos >= links->len || PRICE_INDEX_PRICE (links, pos) != p)
+    {
+        /* Something p sorts on was changed behind our back. */
+        for (pos = 0; pos < links->len; ++pos)
+            if (PRICE_INDEX_PRICE (links, pos) == p)
+                break;
+        if (pos == links->len) return price_list;
+    }
+
+    link = g_ptr_array_remove_index (links, pos);
+    price_list = g_list_remove_link (price_list, link);
+    g_list_free_1 (link);
+    if (links->len == 0)
+        g_hash_table_remove (db->pair_index, &key);
+    conversion_cache_flush (db);
+
+    price_day_key (&key, p);
+    if (g_hash_table_lookup_extended (db->day_index, &key, &day_key, &days))
+    {
+        g_hash_table_steal (db->day_index, &key);
+        days = g_list_remove (days, p);
+        if (days)
+            g_hash_table_insert (db->day_index, day_key, days);
+        else
+            price_key_free (day_key);
+    }
+
+    gnc_price_unref (p);
+    return price_list;
+}
+
+/* Finds, among the prices for commodity in currency and for currency in
+ * commodity taken together in newest-first order, the first price that
+ * isn't newer than t and the last one that is.  Either may come back
+ * NULL.  Returns FALSE if there are no prices between the two at all. */
+static gboolean
+price_index_find_time (GNCPriceDB *db, const gnc_commodity *commodity,
+                       const gnc_commodity *currency, time64 t,
+                       GNCPrice **not_after, GNCPrice **after)
+{
+    GPtrArray *lists[2];
+    gboolean found = FALSE;
+    guint i;
+
+    lists[0] = price_index_lookup (db, commodity, currency);
+    lists[1] = price_index_lookup (db, currency, commodity);
+    *not_after = *after = NULL;
+    for (i = 0; i < G_N_ELEMENTS (lists); ++i)
+    {
+        GPtrArray *links = lists[i];
+        guint pos;
+
+        if (!links) continue;
+        found = TRUE;
+        pos = price_index_bisect_time (links, t);
+        if (pos < links->len)
+        {
+            GNCPrice *p = PRICE_INDEX_PRICE (links, pos);
+            if (!*not_after || compare_prices_by_date (p, *not_after) < 0)
+                *not_after = p;
+        }
+        if (pos > 0)
+        {
+            GNCPrice *p = PRICE_INDEX_PRICE (links, pos - 1);
+            if (!*after || compare_prices_by_date (p, *after) > 0)
+                *after = p;
+        }
+    }
+    return found;
+}
+
 /* ==================================================================== */
 /* GNCPriceDB functions
 
@@ -880,6 +1168,15 @@ gnc_pricedb_create(QofBook * book)
 
     result->commodity_hash = g_hash_table_new(NULL, NULL);
     g_return_val_if_fail (result->commodity_hash, NULL);
+    result->pair_index = g_hash_table_new_full (price_key_hash, price_key_equal,
+                                                price_key_free,
+                                                price_index_free);
+    result->day_index = g_hash_table_new_full (price_key_hash, price_key_equal,
+                                               price_key_free,
+                                               (GDestroyNotify)g_list_free);
+    result->conversion_cache =
+        g_hash_table_new_full (price_key_hash, price_key_equal, NULL,
+                               conversion_entry_free);
     return result;
 }
 
@@ -927,6 +1224,13 @@ gnc_pricedb_destroy(GNCPriceDB *db)
     }
     g_hash_table_destroy (db->commodity_hash);
     db->commodity_hash = NULL;
+    g_hash_table_destroy (db->pair_index);
+    db->pair_index = NULL;
+    g_hash_table_destroy (db->day_index);
+    db->day_index = NULL;
+    conversion_cache_flush (db);
+    g_hash_table_destroy (db->conversion_cache);
+    db->conversion_cache = NULL;
     /* qof_instance_release (&db->inst); */
     g_object_unref(db);
 }
@@ -1130,11 +1434,9 @@ add_price(GNCPriceDB *db, GNCPrice *p)
     }
 
     price_list = g_hash_table_lookup(currency_hash, currency);
-    if (!gnc_price_list_insert(&price_list, p, !db->bulk_update))
-    {
-        LEAVE ("gnc_price_list_insert failed");
-        return FALSE;
-    }
+    gnc_price_ref(p);
+    if (db->bulk_update || !price_index_is_duplicate(db, p))
+        price_list = price_index_insert(db, price_list, p);
 
     if (!price_list)
     {
@@ -1231,12 +1533,7 @@ remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup)
     qof_event_gen (&p->inst, QOF_EVENT_REMOVE, NULL);
     price_list = g_hash_table_lookup(currency_hash, currency);
     gnc_price_ref(p);
-    if (!gnc_price_list_remove(&price_list, p))
-    {
-        gnc_price_unref(p);
-        LEAVE (" cannot remove price list");
-        return FALSE;
-    }
+    price_list = price_index_remove(db, price_list, p);
 
     /* if the price list is empty, then remove this currency from the
        commodity hash */
@@ -1789,20 +2086,17 @@ GNCPrice *gnc_pricedb_lookup_latest(GNCPriceDB *db,
                           const gnc_commodity *commodity,
                           const gnc_commodity *currency)
 {
-    GList *price_list;
-    GNCPrice *result;
+    GNCPrice *result, *newer;
 
     if (!db || !commodity || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, commodity, currency);
 
-    price_list = pricedb_get_prices_internal(db, commodity, currency, TRUE);
-    if (!price_list) return NULL;
-    /* This works magically because prices are inserted in date-sorted
-     * order, and the latest date always comes first. So return the
-     * first in the list.  */
-    result = price_list->data;
+    /* Nothing is newer than INT64_MAX, so this finds the first price in
+     * either direction. */
+    if (!price_index_find_time(db, commodity, currency, INT64_MAX,
+                               &result, &newer))
+        return NULL;
     gnc_price_ref(result);
-    g_list_free (price_list);
     LEAVE(" ");
     return result;
 }
@@ -2133,20 +2427,28 @@ gnc_pricedb_get_prices(GNCPriceDB *db,
 
 /* Return the number of prices in the data base for the given commodity
  */
+typedef struct
+{
+    GNCPriceDB *db;
+    const gnc_commodity *commodity;
+    int count;
+} PriceCount;
+
 static void
 price_count_helper(gpointer key, gpointer value, gpointer data)
 {
-    int *result = data;
-    GList *price_list = value;
+    PriceCount *count = data;
+    GPtrArray *links = price_index_lookup(count->db, count->commodity, key);
 
-    *result += g_list_length(price_list);
+    if (links)
+        count->count += links->len;
 }
 
 int
 gnc_pricedb_num_prices(GNCPriceDB *db,
                        const gnc_commodity *c)
 {
-    int result = 0;
+    PriceCount result = {db, c, 0};
     GHashTable *currency_hash;
 
     if (!db || !c) return 0;
@@ -2158,8 +2460,8 @@ gnc_pricedb_num_prices(GNCPriceDB *db,
         g_hash_table_foreach(currency_hash, price_count_helper,  (gpointer)&result);
     }
 
-    LEAVE ("count=%d", result);
-    return result;
+    LEAVE ("count=%d", result.count);
+    return result.count;
 }
 
 /* Return the nth price for the given commodity
@@ -2188,8 +2490,9 @@ gnc_pricedb_nth_price (GNCPriceDB *db,
             g_hash_table_iter_init(&iter, currency_hash);
             if (g_hash_table_iter_next(&iter, &key, &value))
             {
-                PriceList *prices = value;
-                result = g_list_nth_data(prices, n);
+                GPtrArray *links = price_index_lookup(db, c, key);
+                if (links && (guint)n < links->len)
+                    result = PRICE_INDEX_PRICE(links, n);
             }
         }
         else if (num_currencies > 1)
@@ -2264,26 +2567,16 @@ gnc_pricedb_lookup_at_time64(GNCPriceDB *db,
                              const gnc_commodity *currency,
                              time64 t)
 {
-    GList *price_list;
-    GList *item = NULL;
+    GNCPrice *price, *newer;
 
     if (!db || !c || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    item = price_list;
-    while (item)
+    price_index_find_time (db, c, currency, t, &price, &newer);
+    if (price && gnc_price_get_time64(price) == t)
     {
-        GNCPrice *p = item->data;
-        time64 price_time = gnc_price_get_time64(p);
-        if (price_time == t)
-        {
-            gnc_price_ref(p);
-            g_list_free (price_list);
-            return p;
-        }
-        item = item->next;
+        gnc_price_ref(price);
+        return price;
     }
-    g_list_free (price_list);
     LEAVE (" ");
     return NULL;
 }
@@ -2295,36 +2588,24 @@ lookup_nearest_in_time(GNCPriceDB *db,
                        time64 t,
                        gboolean sameday)
 {
-    GList *price_list;
     GNCPrice *current_price = NULL;
     GNCPrice *next_price = NULL;
     GNCPrice *result = NULL;
-    GList *item = NULL;
 
     if (!db || !c || !currency) return NULL;
     if (t == INT64_MAX) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    if (!price_list) return NULL;
-    item = price_list;
 
-    /* default answer */
-    current_price = item->data;
+    /* next_price is the first candidate past the one we want and
+       current_price the one just before it.  Remember that prices are in
+       most-recent-first order. */
+    if (!price_index_find_time (db, c, currency, t,
+                                &next_price, &current_price))
+        return NULL;
 
-    /* find the first candidate past the one we want.  Remember that
-       prices are in most-recent-first order. */
-    while (!next_price && item)
-    {
-        GNCPrice *p = item->data;
-        time64 price_time = gnc_price_get_time64(p);
-        if (price_time <= t)
-        {
-            next_price = item->data;
-            break;
-        }
-        current_price = item->data;
-        item = item->next;
-    }
+    /* default answer */
+    if (!current_price)
+        current_price = next_price;
 
     if (current_price)      /* How can this be null??? */
     {
@@ -2396,7 +2677,6 @@ lookup_nearest_in_time(GNCPriceDB *db,
     }
 
     gnc_price_ref(result);
-    g_list_free (price_list);
     LEAVE (" ");
     return result;
 }
@@ -2417,62 +2697,19 @@ gnc_pricedb_lookup_latest_before_t64 (GNCPriceDB *db,
                                       gnc_commodity *currency,
                                       time64 t)
 {
-    GList *price_list;
     GNCPrice *current_price = NULL;
-    /*  GNCPrice *next_price = NULL;
-        GNCPrice *result = NULL;*/
-    GList *item = NULL;
-    time64 price_time;
+    GNCPrice *next_price = NULL;
 
     if (!db || !c || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    if (!price_list) return NULL;
-    item = price_list;
-    do
-    {
-        price_time = gnc_price_get_time64 (item->data);
-        if (price_time <= t)
-            current_price = item->data;
-        item = item->next;
-    }
-    while (price_time > t && item);
+    if (!price_index_find_time (db, c, currency, t,
+                                &current_price, &next_price))
+        return NULL;
     gnc_price_ref(current_price);
-    g_list_free (price_list);
     LEAVE (" ");
     return current_price;
 }
 
-static gnc_numeric
-direct_balance_conversion (GNCPriceDB *db, gnc_numeric bal,
-                           const gnc_commodity *from, const gnc_commodity *to,
-                           time64 t)
-{
-    GNCPrice *price;
-    gnc_numeric retval = gnc_numeric_zero();
-    if (from == NULL || to == NULL)
-        return retval;
-    if (gnc_numeric_zero_p(bal))
-        return retval;
-    if (t != INT64_MAX)
-        price = gnc_pricedb_lookup_nearest_in_time64(db, from, to, t);
-    else
-        price = gnc_pricedb_lookup_latest(db, from, to);
-    if (price == NULL)
-        return retval;
-    if (gnc_price_get_commodity(price) == from)
-        retval = gnc_numeric_mul (bal, gnc_price_get_value (price),
-                                  gnc_commodity_get_fraction (to),
-                                  GNC_HOW_RND_ROUND);
-    else
-        retval = gnc_numeric_div (bal, gnc_price_get_value (price),
-                                  gnc_commodity_get_fraction (to),
-                                  GNC_HOW_RND_ROUND);
-    gnc_price_unref (price);
-    return retval;
-
-}
-
 typedef struct
 {
     GNCPrice *from;
@@ -2548,18 +2785,131 @@ convert_balance(gnc_numeric bal, const gnc_commodity *from,
                            fraction, GNC_HOW_RND_ROUND);
 
 }
-static gnc_numeric
-indirect_balance_conversion (GNCPriceDB *db, gnc_numeric bal,
-                             const gnc_commodity *from, const gnc_commodity *to,
-                             time64 t )
+/* The conversion cache
+
+   gnc_pricedb_convert_balance_*() remember the prices they used to get
+   from one commodity to another at a given time in db->conversion_cache,
+   keyed by (from, to, time) with INT64_MAX standing for the latest price.
+   Reports converting many balances at the same dates thus search the
+   price lists once per pair and date.  Only the path is cached, not the
+   rate, so editing the value of a price takes effect immediately; adding
+   or removing a price flushes the whole cache.  The key is the exact
+   time because the nearest price can change within a day, so a report
+   converting at the time of every split would keep adding entries; the
+   least recently used ones are dropped past CONVERSION_CACHE_SIZE.
+ */
+
+/* The graph whose edges are the commodity pairs that have prices. */
+static GHashTable *
+conversion_graph (GNCPriceDB *db)
+{
+    GHashTable *graph = db->conversion_graph;
+    GHashTableIter iter;
+    gpointer key;
+
+    if (graph)
+        return graph;
+
+    graph = g_hash_table_new_full (NULL, NULL, NULL, price_index_free);
+    g_hash_table_iter_init (&iter, db->pair_index);
+    while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+        const PriceKey *pair = key;
+        const gnc_commodity *ends[2] = {pair->commodity, pair->currency};
+        int i;
+        for (i = 0; i < 2; ++i)
+        {
+            GPtrArray *edges = g_hash_table_lookup (graph, ends[i]);
+            if (!edges)
+            {
+                edges = g_ptr_array_new ();
+                g_hash_table_insert (graph, (gpointer)ends[i], edges);
+            }
+            g_ptr_array_add (edges, (gpointer)ends[1 - i]);
+        }
+    }
+    db->conversion_graph = graph;
+    return graph;
+}
+
+/* Chains of more than two prices are found by a breadth-first search of
+ * the conversion graph, so the chain found has the fewest hops. */
+static GList *
+conversion_path_multi_hop (GNCPriceDB *db, const gnc_commodity *from,
+                           const gnc_commodity *to, time64 t)
+{
+    GHashTable *graph = conversion_graph (db);
+    GHashTable *came_from = g_hash_table_new (NULL, NULL);
+    GQueue queue = G_QUEUE_INIT;
+    GList *path = NULL;
+
+    g_hash_table_insert (came_from, (gpointer)from, (gpointer)from);
+    g_queue_push_tail (&queue, (gpointer)from);
+    while (!g_queue_is_empty (&queue) &&
+           !g_hash_table_contains (came_from, to))
+    {
+        gpointer com = g_queue_pop_head (&queue);
+        GPtrArray *edges = g_hash_table_lookup (graph, com);
+        guint i;
+
+        for (i = 0; edges && i < edges->len; ++i)
+        {
+            gpointer next = g_ptr_array_index (edges, i);
+            if (g_hash_table_contains (came_from, next))
+                continue;
+            g_hash_table_insert (came_from, next, com);
+            g_queue_push_tail (&queue, next);
+        }
+    }
+
+    if (g_hash_table_contains (came_from, to))
+    {
+        const gnc_commodity *com = to;
+        while (com != from)
+        {
+            const gnc_commodity *prev = g_hash_table_lookup (came_from, com);
+            GNCPrice *price = t == INT64_MAX ?
+                gnc_pricedb_lookup_latest (db, prev, com) :
+                gnc_pricedb_lookup_nearest_in_time64 (db, prev, com, t);
+            if (!price)
+            {
+                gnc_price_list_destroy (path);
+                path = NULL;
+                break;
+            }
+            path = g_list_prepend (path, price);
+            com = prev;
+        }
+    }
+
+    g_queue_clear (&queue);
+    g_hash_table_destroy (came_from);
+    return path;
+}
+
+/* Returns the reffed prices leading from "from" to "to" at t, in order,
+ * or NULL if there's no way to get there. */
+static GList *
+conversion_path (GNCPriceDB *db, const gnc_commodity *from,
+                 const gnc_commodity *to, time64 t)
 {
     GList *from_prices = NULL, *to_prices = NULL;
-    PriceTuple tuple;
-    gnc_numeric zero = gnc_numeric_zero();
-    if (from == NULL || to == NULL)
-        return zero;
-    if (gnc_numeric_zero_p(bal))
-        return zero;
+    PriceTuple tuple = {NULL, NULL};
+    GNCPrice *price;
+
+    /* Look for a direct price. */
+    if (t != INT64_MAX)
+        price = gnc_pricedb_lookup_nearest_in_time64(db, from, to, t);
+    else
+        price = gnc_pricedb_lookup_latest(db, from, to);
+    if (price && !gnc_numeric_zero_p (gnc_price_get_value (price)))
+        return g_list_prepend (NULL, price);
+    gnc_price_unref (price);
+
+    /*
+     * no direct price found, try if we find a price in another currency
+     * and convert in two stages
+     */
     if (t == INT64_MAX)
     {
         from_prices = gnc_pricedb_lookup_latest_any_currency(db, from);
@@ -2576,16 +2926,107 @@ indirect_balance_conversion (GNCPriceDB *db, gnc_numeric bal,
             to_prices = gnc_pricedb_lookup_nearest_in_time_any_currency_t64(db,
                                                                     to, t);
     }
-    if (from_prices == NULL || to_prices == NULL)
-        return zero;
-    tuple = extract_common_prices(from_prices, to_prices);
+    if (from_prices && to_prices)
+        tuple = extract_common_prices(from_prices, to_prices);
     gnc_price_list_destroy(from_prices);
     gnc_price_list_destroy(to_prices);
     if (tuple.from)
+        return g_list_prepend (g_list_prepend (NULL, tuple.to), tuple.from);
+
+    /* Finally try to get there through more than one other commodity. */
+    return conversion_path_multi_hop (db, from, to, t);
+}
+
+static gnc_numeric
+convert_balance_along_path (gnc_numeric bal, const gnc_commodity *from,
+                            const gnc_commodity *to, GList *path)
+{
+    /* Long chains of exact products overflow, so let the rate be rounded
+     * to whatever still fits. */
+    int round_to_fit = GNC_HOW_DENOM_EXACT | GNC_HOW_RND_ROUND;
+    gnc_numeric rate = gnc_numeric_create (1, 1);
+    const gnc_commodity *com = from;
+    GList *node;
+
+    if (!path)
+        return gnc_numeric_zero();
+
+    if (!path->next)
+    {
+        GNCPrice *price = path->data;
+        if (gnc_price_get_commodity(price) == from)
+            return gnc_numeric_mul (bal, gnc_price_get_value (price),
+                                    gnc_commodity_get_fraction (to),
+                                    GNC_HOW_RND_ROUND);
+        return gnc_numeric_div (bal, gnc_price_get_value (price),
+                                gnc_commodity_get_fraction (to),
+                                GNC_HOW_RND_ROUND);
+    }
+
+    if (!path->next->next)
+    {
+        PriceTuple tuple = {path->data, path->next->data};
         return convert_balance(bal, from, to, tuple);
-    return zero;
+    }
+
+    for (node = path; node; node = node->next)
+    {
+        GNCPrice *price = node->data;
+        if (gnc_price_get_commodity(price) == com)
+        {
+            rate = gnc_numeric_mul (rate, gnc_price_get_value (price),
+                                    GNC_DENOM_AUTO, round_to_fit);
+            com = gnc_price_get_currency(price);
+        }
+        else
+        {
+            rate = gnc_numeric_div (rate, gnc_price_get_value (price),
+                                    GNC_DENOM_AUTO, round_to_fit);
+            com = gnc_price_get_commodity(price);
+        }
+    }
+    if (gnc_numeric_check (rate))
+        return gnc_numeric_zero();
+    return gnc_numeric_mul (bal, rate, gnc_commodity_get_fraction (to),
+                            GNC_HOW_RND_ROUND);
 }
 
+static gnc_numeric
+convert_balance_cached (GNCPriceDB *db, gnc_numeric bal,
+                        const gnc_commodity *from, const gnc_commodity *to,
+                        time64 t)
+{
+    PriceKey key = {from, to, t};
+    ConversionEntry *entry;
+
+    if (!db || !from || !to)
+        return gnc_numeric_zero();
+
+    entry = g_hash_table_lookup (db->conversion_cache, &key);
+    if (entry)
+    {
+        ++db->conversion_hits;
+        g_queue_unlink (&db->conversion_lru, &entry->lru_link);
+        g_queue_push_head_link (&db->conversion_lru, &entry->lru_link);
+    }
+    else
+    {
+        ++db->conversion_misses;
+        entry = g_slice_new0 (ConversionEntry);
+        entry->key = key;
+        entry->path = conversion_path (db, from, to, t);
+        entry->lru_link.data = entry;
+        g_hash_table_insert (db->conversion_cache, &entry->key, entry);
+        g_queue_push_head_link (&db->conversion_lru, &entry->lru_link);
+        if (db->conversion_lru.length > CONVERSION_CACHE_SIZE)
+        {
+            GList *oldest = g_queue_pop_tail_link (&db->conversion_lru);
+            g_hash_table_remove (db->conversion_cache,
+                                 &((ConversionEntry *)oldest->data)->key);
+        }
+    }
+    return convert_balance_along_path (bal, from, to, entry->path);
+}
 
 /*
  * Convert a balance from one currency to another.
@@ -2596,24 +3037,12 @@ gnc_pricedb_convert_balance_latest_price(GNCPriceDB *pdb,
         const gnc_commodity *balance_currency,
         const gnc_commodity *new_currency)
 {
-    gnc_numeric new_value;
-
     if (gnc_numeric_zero_p (balance) ||
             gnc_commodity_equiv (balance_currency, new_currency))
         return balance;
 
-    /* Look for a direct price. */
-    new_value = direct_balance_conversion(pdb, balance, balance_currency,
-                                          new_currency, INT64_MAX);
-    if (!gnc_numeric_zero_p(new_value))
-        return new_value;
-
-    /*
-     * no direct price found, try if we find a price in another currency
-     * and convert in two stages
-     */
-    return indirect_balance_conversion(pdb, balance, balance_currency,
-                                       new_currency, INT64_MAX);
+    return convert_balance_cached(pdb, balance, balance_currency,
+                                  new_currency, INT64_MAX);
 }
 
 gnc_numeric
@@ -2623,24 +3052,24 @@ gnc_pricedb_convert_balance_nearest_price_t64(GNCPriceDB *pdb,
                                               const gnc_commodity *new_currency,
                                               time64 t)
 {
-    gnc_numeric new_value;
-
     if (gnc_numeric_zero_p (balance) ||
         gnc_commodity_equiv (balance_currency, new_currency))
         return balance;
 
-    /* Look for a direct price. */
-    new_value = direct_balance_conversion(pdb, balance, balance_currency,
-                                          new_currency, t);
-    if (!gnc_numeric_zero_p(new_value))
-        return new_value;
+    return convert_balance_cached(pdb, balance, balance_currency,
+                                  new_currency, t);
+}
 
-    /*
-     * no direct price found, try if we find a price in another currency
-     * and convert in two stages
-     */
-    return indirect_balance_conversion(pdb, balance, balance_currency,
-                                       new_currency, t);
+guint
+gnc_pricedb_get_conversion_cache_hits(GNCPriceDB *db)
+{
+    return db ? db->conversion_hits : 0;
+}
+
+guint
+gnc_pricedb_get_conversion_cache_misses(GNCPriceDB *db)
+{
+    return db ? db->conversion_misses : 0;
 }
 
 
@@ -591,6 +591,25 @@ gnc_pricedb_convert_balance_nearest_price_t64(GNCPriceDB *pdb,
                                               const gnc_commodity *new_currency,
                                               time64 t);
 
+/** @brief Return the number of balance conversions that found the prices to
+ * use in the conversion cache.
+ *
+ * gnc_pricedb_convert_balance_latest_price() and
+ * gnc_pricedb_convert_balance_nearest_price_t64() remember the prices they
+ * used for each combination of commodities and time until a price is added
+ * to or removed from the pricedb.
+ * @param db The pricedb
+ * @return The number of cache hits since the pricedb was created.
+ */
+guint gnc_pricedb_get_conversion_cache_hits(GNCPriceDB *db);
+
+/** @brief Return the number of balance conversions that had to search the
+ * pricedb for the prices to use.
+ * @param db The pricedb
+ * @return The number of cache misses since the pricedb was created.
+ */
+guint gnc_pricedb_get_conversion_cache_misses(GNCPriceDB *db);
+
 typedef gboolean (*GncPriceForeachFunc)(GNCPrice *p, gpointer user_data);
 
 /** @brief Call a GncPriceForeachFunction once for each price in db, until the
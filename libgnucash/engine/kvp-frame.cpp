@@ -115,9 +115,40 @@ KvpFrame::set_impl (std::string const & key, KvpValue * value) noexcept
         auto cachedkey = static_cast <char const *> (qof_string_cache_insert (key.c_str ()));
         m_valuemap.emplace (cachedkey, value);
     }
+    if (!m_all_dirty)
+        m_dirty_keys.insert (key);
     return ret;
 }
 
+bool
+KvpFrameImpl::is_dirty () const noexcept
+{
+    if (m_all_dirty || !m_dirty_keys.empty ())
+        return true;
+    return std::any_of (m_valuemap.begin (), m_valuemap.end (),
+        [](const map_type::value_type & a)
+        {
+            return a.second->get_type () == KvpValue::Type::FRAME &&
+                a.second->get <KvpFrame *> ()->is_dirty ();
+        });
+}
+
+std::vector<std::string>
+KvpFrameImpl::get_dirty_keys () const noexcept
+{
+    return {m_dirty_keys.begin (), m_dirty_keys.end ()};
+}
+
+void
+KvpFrameImpl::mark_clean () noexcept
+{
+    m_all_dirty = false;
+    m_dirty_keys.clear ();
+    for (auto const & a : m_valuemap)
+        if (a.second->get_type () == KvpValue::Type::FRAME)
+            a.second->get <KvpFrame *> ()->mark_clean ();
+}
+
 KvpValue *
 KvpFrameImpl::set (Path path, KvpValue* value) noexcept
 {
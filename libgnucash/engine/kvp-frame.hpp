@@ -86,6 +86,7 @@
 
 #include "kvp-value.hpp"
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 #include <cstring>
@@ -224,10 +225,36 @@ struct KvpFrameImpl
      * @return true if the frame contains nothing.
      */
     bool empty() const noexcept { return m_valuemap.empty(); }
+
+    /**
+     * Dirty tracking for backends that store slots row by row. Every key
+     * passed to set_impl since the last mark_clean() is remembered so that
+     * the backend can rewrite only those paths. A frame that has never been
+     * marked clean (a new or copied frame) is wholly dirty, as is one
+     * passed to mark_dirty(); the backend must rewrite all of it.
+     * @return true if the whole frame must be treated as changed.
+     */
+    bool all_dirty() const noexcept { return m_all_dirty; }
+    /** @return true if this frame or any child frame has changed. */
+    bool is_dirty() const noexcept;
+    /**
+     * Report the keys in the immediate frame that were set, replaced or
+     * removed since the last mark_clean(). Keys whose value is a child frame
+     * that changed internally are not included; use is_dirty() on the child.
+     */
+    std::vector<std::string> get_dirty_keys() const noexcept;
+    /** Forget all changes in this frame and its child frames. */
+    void mark_clean() noexcept;
+    /** Mark the whole frame changed, for callers that modify a value in
+     * place instead of setting it.
+     */
+    void mark_dirty() noexcept { m_all_dirty = true; }
     friend int compare(const KvpFrameImpl&, const KvpFrameImpl&) noexcept;
 
     private:
     map_type m_valuemap;
+    std::set<std::string> m_dirty_keys;
+    bool m_all_dirty = true;
 
     KvpFrame * get_child_frame_or_nullptr (Path const &) noexcept;
     KvpFrame * get_child_frame_or_create (Path const &) noexcept;
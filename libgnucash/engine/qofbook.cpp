@@ -1069,6 +1069,29 @@ qof_book_use_split_action_for_num_field (const QofBook *book)
     return book->cached_num_field_source;
 }
 
+static void
+mark_account_sort_dirty (QofInstance *inst, gpointer user_data)
+{
+    gnc_account_set_sort_dirty (GNC_ACCOUNT (inst));
+}
+
+// Forget the cached num field source.  Splits are ordered by it, so if
+// it changes every account has to sort its splits again.
+static void
+qof_book_num_field_source_changed (QofBook *book)
+{
+    gboolean was_valid = book->cached_num_field_source_isvalid;
+    gboolean old_value = book->cached_num_field_source;
+
+    book->cached_num_field_source_isvalid = FALSE;
+    if (was_valid &&
+        old_value == qof_book_use_split_action_for_num_field (book))
+        return;
+
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_ACCOUNT),
+                            mark_account_sort_dirty, NULL);
+}
+
 // The callback that is called when the KVP option value of
 // "split-action-num-field" changes, so that we mark the cached value as
 // invalid.
@@ -1079,7 +1102,7 @@ qof_book_option_num_field_source_changed_cb (GObject *gobject,
 {
     QofBook *book = reinterpret_cast<QofBook*>(user_data);
     g_return_if_fail(QOF_IS_BOOK(book));
-    book->cached_num_field_source_isvalid = FALSE;
+    qof_book_num_field_source_changed (book);
 }
 
 gboolean qof_book_uses_autoreadonly (const QofBook *book)
@@ -1283,7 +1306,7 @@ qof_book_set_option (QofBook *book, KvpValue *value, GSList *path)
     qof_book_commit_edit (book);
 
     // Also, mark any cached value as invalid
-    book->cached_num_field_source_isvalid = FALSE;
+    qof_book_num_field_source_changed (book);
 }
 
 KvpValue*
@@ -146,6 +146,13 @@ typedef struct _QofParam QofParam;
  * identify the expected getter_func return type at runtime.  It
  * also provides a place for the user to hang additional user-defined
  * data.
+ *
+ * A query set with qof_query_set_parallel() calls the getters of its
+ * terms from several threads at once, on different objects.  A getter
+ * used by such a query must only read: it must not cache, load data,
+ * begin or commit an edit, generate events, or touch any other object
+ * state, and whatever it returns must stay valid without help from the
+ * calling thread.
  */
 typedef gpointer (*QofAccessFunc)(gpointer object, /*@ null @*/ const QofParam *param);
 
@@ -34,9 +34,24 @@ typedef struct
     gpointer user_data;
 
     gint handler_id;
+
+    /* NULL for every type, otherwise the key of the dispatch table
+     * entry the handler is listed in. */
+    const gchar *entity_type;
+    QofEventId event_mask;
+    /* Registration order; dispatch runs the highest first. */
+    guint serial;
+
+    guint64 delivered;
+    gint64 usecs;
 } HandlerInfo;
 
 /* generates an event even when events are suspended! */
 void qof_event_force (QofInstance *entity, QofEventId event_id, gpointer event_data);
 
+/* The number of events dropped so far because events were suspended.
+ * A handler that keeps state derived from events can compare it with
+ * an earlier value to learn that it missed some. */
+guint qof_event_get_dropped_count (void);
+
 #endif
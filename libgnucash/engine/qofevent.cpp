@@ -26,6 +26,7 @@ extern "C"
 {
 #include <config.h>
 #include <glib.h>
+#include <string.h>
 }
 
 #include "qof.h"
@@ -36,8 +37,57 @@ static guint   suspend_counter   = 0;
 static gint    next_handler_id   = 1;
 static guint   handler_run_level = 0;
 static guint   pending_deletes   = 0;
+static guint   dropped_events    = 0;
+static guint   next_serial       = 0;
+static gboolean profiling        = FALSE;
 static GList   *handlers  =   NULL;
 
+/* The dispatch table: handlers for every entity type, and for each type
+ * that some handler asked for, the handlers for that type.  Both are
+ * newest first, like handlers, which holds all of them. */
+static GList      *any_type_handlers = NULL;
+static GHashTable *typed_handlers    = NULL;
+
+/* Event data that may be held in a batch, see
+ * qof_event_register_batch_data. */
+typedef struct
+{
+    const gchar *entity_type;
+    QofEventId   event_id;
+    gsize        size;
+} BatchDataDef;
+
+static GList *batch_data_defs = NULL;
+
+/* One held event.  data is what the handlers will be passed: NULL, a
+ * copy of size bytes, or, if size is 0, an instance that is watched
+ * so that the event is dropped if it goes away first. */
+typedef struct
+{
+    QofEventId     event_id;
+    gpointer       data;
+    gsize          size;
+} HeldEvent;
+
+/* The events raised on one entity inside a batch, each once, in the
+ * order they were first raised.  The entity is watched rather than
+ * referenced, so that one freed in the batch isn't kept alive to be
+ * told about it afterwards. */
+typedef struct
+{
+    QofInstance *entity;
+    GPtrArray *events;
+    GList *data_link;           /* In data_queue, if it holds event data. */
+} EntityChanges;
+
+/* The open batches' changes, in the order the entities were first
+ * touched, and the same indexed by entity.  data_queue has just those
+ * holding events with data, which are all drop_changes has to send. */
+static guint       batch_depth   = 0;
+static GQueue      batch_queue   = G_QUEUE_INIT;
+static GQueue      data_queue    = G_QUEUE_INIT;
+static GHashTable *batch_changes = NULL;
+
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = QOF_MOD_ENGINE;
 
@@ -72,13 +122,55 @@ find_next_handler_id(void)
     return handler_id;
 }
 
+/* The dispatch list a handler belongs in, created if need be. */
+static GList **
+dispatch_list (QofIdTypeConst entity_type, const gchar **key)
+{
+    gpointer orig_key, value;
+
+    *key = NULL;
+    if (!entity_type)
+        return &any_type_handlers;
+
+    if (!typed_handlers)
+        typed_handlers = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                g_free, g_free);
+
+    if (!g_hash_table_lookup_extended (typed_handlers, entity_type,
+                                       &orig_key, &value))
+    {
+        orig_key = g_strdup (entity_type);
+        value = g_new0 (GList*, 1);
+        g_hash_table_insert (typed_handlers, orig_key, value);
+    }
+    *key = static_cast<const gchar*>(orig_key);
+    return static_cast<GList**>(value);
+}
+
+static void
+remove_handler (GList *node)
+{
+    HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
+    const gchar *key;
+    GList **list = dispatch_list (hi->entity_type, &key);
+
+    *list = g_list_remove (*list, hi);
+    handlers = g_list_delete_link (handlers, node);
+    g_free (hi);
+}
+
 gint
-qof_event_register_handler (QofEventHandler handler, gpointer user_data)
+qof_event_register_filtered_handler (QofEventHandler handler,
+                                     gpointer user_data,
+                                     QofIdTypeConst entity_type,
+                                     QofEventId event_mask)
 {
     HandlerInfo *hi;
     gint handler_id;
+    GList **list;
 
-    ENTER ("(handler=%p, data=%p)", handler, user_data);
+    ENTER ("(handler=%p, data=%p, type=%s, mask=%x)", handler, user_data,
+           entity_type ? entity_type : "(any)", event_mask);
 
     /* sanity check */
     if (!handler)
@@ -96,12 +188,24 @@ qof_event_register_handler (QofEventHandler handler, gpointer user_data)
     hi->handler = handler;
     hi->user_data = user_data;
     hi->handler_id = handler_id;
+    hi->event_mask = event_mask;
+    hi->serial = next_serial++;
 
+    list = dispatch_list (entity_type, &hi->entity_type);
+    *list = g_list_prepend (*list, hi);
     handlers = g_list_prepend (handlers, hi);
     LEAVE ("(handler=%p, data=%p) handler_id=%d", handler, user_data, handler_id);
     return handler_id;
 }
 
+gint
+qof_event_register_handler (QofEventHandler handler, gpointer user_data)
+{
+    /* Every bit, so application events beyond QOF_EVENT_ALL get through. */
+    return qof_event_register_filtered_handler (handler, user_data, NULL,
+                                                ~QOF_EVENT_NONE);
+}
+
 void
 qof_event_unregister_handler (gint handler_id)
 {
@@ -128,15 +232,9 @@ qof_event_unregister_handler (gint handler_id)
         hi->handler = NULL;
 
         if (handler_run_level == 0)
-        {
-            handlers = g_list_remove_link (handlers, node);
-            g_list_free_1 (node);
-            g_free (hi);
-        }
+            remove_handler (node);
         else
-        {
             pending_deletes++;
-        }
 
         return;
     }
@@ -167,12 +265,35 @@ qof_event_resume (void)
     suspend_counter--;
 }
 
+static void
+run_handler (HandlerInfo *hi, QofInstance *entity, QofEventId event_id,
+             gpointer event_data)
+{
+    gboolean timed = profiling;
+    gint64 start = 0;
+
+    if (!hi->handler || !(hi->event_mask & event_id))
+        return;
+
+    PINFO("id=%d hi=%p han=%p data=%p", hi->handler_id, hi,
+          hi->handler, event_data);
+    hi->delivered++;
+    if (timed)
+        start = g_get_monotonic_time ();
+    hi->handler (entity, event_id, hi->user_data, event_data);
+    /* An unregistered handler is only freed once dispatch is over. */
+    if (timed)
+        hi->usecs += g_get_monotonic_time () - start;
+}
+
 static void
 qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
                              gpointer event_data)
 {
     GList *node;
     GList *next_node = NULL;
+    GList *any_node = any_type_handlers;
+    GList *typed_node = NULL;
 
     g_return_if_fail(entity);
 
@@ -185,18 +306,35 @@ qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
     }
     }
 
+    if (typed_handlers && entity->e_type)
+    {
+        auto list = static_cast<GList**>(g_hash_table_lookup (typed_handlers,
+                                                              entity->e_type));
+        if (list)
+            typed_node = *list;
+    }
+
+    /* Merge the two lists by serial so handlers run newest first, as
+     * they would from the single list.  Handlers registered from inside
+     * a handler are prepended and so are not reached by this event. */
     handler_run_level++;
-    for (node = handlers; node; node = next_node)
+    while (any_node || typed_node)
     {
-        HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
+        HandlerInfo *hi;
 
-        next_node = node->next;
-        if (hi->handler)
+        if (!typed_node ||
+            (any_node && static_cast<HandlerInfo*>(any_node->data)->serial >
+                         static_cast<HandlerInfo*>(typed_node->data)->serial))
+        {
+            hi = static_cast<HandlerInfo*>(any_node->data);
+            any_node = any_node->next;
+        }
+        else
         {
-            PINFO("id=%d hi=%p han=%p data=%p", hi->handler_id, hi,
-                  hi->handler, event_data);
-            hi->handler (entity, event_id, hi->user_data, event_data);
+            hi = static_cast<HandlerInfo*>(typed_node->data);
+            typed_node = typed_node->next;
         }
+        run_handler (hi, entity, event_id, event_data);
     }
     handler_run_level--;
 
@@ -210,17 +348,290 @@ qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
             HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
             next_node = node->next;
             if (hi->handler == NULL)
-            {
-                /* remove this node from the list, then free this node */
-                handlers = g_list_remove_link (handlers, node);
-                g_list_free_1 (node);
-                g_free (hi);
-            }
+                remove_handler (node);
         }
         pending_deletes = 0;
     }
 }
 
+static void
+held_data_gone (gpointer data, GObject *where_the_object_was)
+{
+    auto held = static_cast<HeldEvent*>(data);
+
+    held->data = NULL;
+    held->event_id = QOF_EVENT_NONE;
+}
+
+static void
+free_held_event (gpointer data)
+{
+    auto held = static_cast<HeldEvent*>(data);
+
+    if (!held)
+        return;
+    if (held->size)
+        g_free (held->data);
+    else if (held->data)
+        g_object_weak_unref (G_OBJECT (held->data), held_data_gone, held);
+    g_free (held);
+}
+
+static void entity_gone (gpointer data, GObject *where_the_object_was);
+
+static void
+unqueue_data (EntityChanges *changes)
+{
+    if (!changes->data_link)
+        return;
+    g_queue_delete_link (&data_queue, changes->data_link);
+    changes->data_link = NULL;
+}
+
+/* Stop watching the entity and forget its held events. */
+static void
+release_changes (EntityChanges *changes)
+{
+    unqueue_data (changes);
+    g_hash_table_remove (batch_changes, changes->entity);
+    g_object_weak_unref (G_OBJECT (changes->entity), entity_gone, changes);
+    changes->entity = NULL;
+    g_ptr_array_set_size (changes->events, 0);
+}
+
+static void
+entity_gone (gpointer data, GObject *where_the_object_was)
+{
+    auto changes = static_cast<EntityChanges*>(data);
+
+    unqueue_data (changes);
+    g_hash_table_remove (batch_changes, where_the_object_was);
+    changes->entity = NULL;
+    g_ptr_array_set_size (changes->events, 0);
+}
+
+/* Deliver the entity's held events, or if with_data_only just those
+ * that carry event data, keeping the rest held. */
+static void
+deliver_changes (EntityChanges *changes, gboolean with_data_only)
+{
+    GPtrArray *events = changes->events;
+    guint i;
+
+    /* Every event with data goes out.  Handlers may raise more events
+     * on the entity; start a new set. */
+    unqueue_data (changes);
+    changes->events = g_ptr_array_new_with_free_func (free_held_event);
+    for (i = 0; i < events->len && changes->entity; i++)
+    {
+        auto held = static_cast<HeldEvent*>(g_ptr_array_index (events, i));
+
+        /* QOF_EVENT_NONE if its instance went away. */
+        if (held->event_id == QOF_EVENT_NONE)
+            continue;
+        if (with_data_only && !held->data)
+        {
+            g_ptr_array_add (changes->events, held);
+            events->pdata[i] = NULL;
+            continue;
+        }
+        if (suspend_counter)
+            dropped_events++;
+        else
+            qof_event_generate_internal (changes->entity, held->event_id,
+                                         held->data);
+    }
+    g_ptr_array_free (events, TRUE);
+}
+
+static void
+free_changes (EntityChanges *changes)
+{
+    unqueue_data (changes);
+    if (changes->entity)
+        g_object_weak_unref (G_OBJECT (changes->entity), entity_gone, changes);
+    g_ptr_array_free (changes->events, TRUE);
+    g_free (changes);
+}
+
+/* Nothing more is to be told about an entity that is being destroyed.
+ * Held event data may name it, though, as the parent in a GncEventData
+ * does, so every held event with data, including any it would have
+ * been told about at once outside a batch such as being removed from
+ * its parent, goes out first. */
+static void
+drop_changes (QofInstance *entity)
+{
+    EntityChanges *changes;
+
+    if (!batch_changes)
+        return;
+
+    /* deliver_changes takes each off data_queue; one a handler holds
+     * more data on goes back on the end. */
+    while ((changes = static_cast<EntityChanges*>(g_queue_peek_head (&data_queue))))
+        deliver_changes (changes, TRUE);
+
+    changes = static_cast<EntityChanges*>(g_hash_table_lookup (batch_changes,
+                                                               entity));
+    if (changes && changes->entity)
+        release_changes (changes);
+}
+
+/* The size of event_id's data on entity, 0 if the data is an instance,
+ * or -1 if it can't be held. */
+static gssize
+batch_data_size (QofInstance *entity, QofEventId event_id)
+{
+    GList *node;
+
+    for (node = batch_data_defs; node; node = node->next)
+    {
+        auto def = static_cast<BatchDataDef*>(node->data);
+        if (def->event_id == event_id &&
+            (!def->entity_type || !g_strcmp0 (def->entity_type, entity->e_type)))
+            return def->size;
+    }
+    return -1;
+}
+
+static gboolean
+held_event_equal (const HeldEvent *held, QofEventId event_id,
+                  gpointer event_data, gsize size)
+{
+    if (held->event_id != event_id)
+        return FALSE;
+    if (!held->data || !event_data)
+        return held->data == event_data;
+    if (size)
+        return held->size == size && !memcmp (held->data, event_data, size);
+    return held->data == event_data;
+}
+
+/* Record an event in the open batch.  Returns FALSE if it must be
+ * delivered now: a destroyed entity will not be around when the batch
+ * closes, and the event data of events that weren't registered with
+ * qof_event_register_batch_data may be gone too. */
+static gboolean
+batch_event (QofInstance *entity, QofEventId event_id, gpointer event_data)
+{
+    EntityChanges *changes;
+    HeldEvent *held;
+    gssize size = 0;
+    guint i;
+
+    changes = static_cast<EntityChanges*>(g_hash_table_lookup (batch_changes,
+                                                               entity));
+    if (event_data)
+        size = batch_data_size (entity, event_id);
+    if (size < 0 || event_id == QOF_EVENT_DESTROY)
+    {
+        /* Keep the entity's events in order. */
+        if (changes)
+            deliver_changes (changes, FALSE);
+        return FALSE;
+    }
+
+    if (!changes)
+    {
+        changes = g_new0 (EntityChanges, 1);
+        changes->entity = entity;
+        changes->events = g_ptr_array_new_with_free_func (free_held_event);
+        g_object_weak_ref (G_OBJECT (entity), entity_gone, changes);
+        g_hash_table_insert (batch_changes, entity, changes);
+        g_queue_push_tail (&batch_queue, changes);
+    }
+
+    for (i = 0; i < changes->events->len; i++)
+        if (held_event_equal (static_cast<HeldEvent*>
+                              (g_ptr_array_index (changes->events, i)),
+                              event_id, event_data, size))
+            return TRUE;
+
+    held = g_new0 (HeldEvent, 1);
+    held->event_id = event_id;
+    held->size = size;
+    if (size)
+        held->data = g_memdup (event_data, size);
+    else if (event_data)
+    {
+        held->data = event_data;
+        g_object_weak_ref (G_OBJECT (event_data), held_data_gone, held);
+    }
+    g_ptr_array_add (changes->events, held);
+    if (held->data && !changes->data_link)
+    {
+        g_queue_push_tail (&data_queue, changes);
+        changes->data_link = data_queue.tail;
+    }
+    return TRUE;
+}
+
+void
+qof_event_register_batch_data (QofIdTypeConst entity_type,
+                               QofEventId event_id, gsize size)
+{
+    BatchDataDef *def;
+    GList *node;
+
+    for (node = batch_data_defs; node; node = node->next)
+    {
+        def = static_cast<BatchDataDef*>(node->data);
+        if (def->event_id == event_id &&
+            !g_strcmp0 (def->entity_type, entity_type))
+        {
+            def->size = size;
+            return;
+        }
+    }
+
+    def = g_new0 (BatchDataDef, 1);
+    def->entity_type = entity_type;
+    def->event_id = event_id;
+    def->size = size;
+    /* Registrations for one type are looked at before those for any. */
+    if (entity_type)
+        batch_data_defs = g_list_prepend (batch_data_defs, def);
+    else
+        batch_data_defs = g_list_append (batch_data_defs, def);
+}
+
+void
+qof_event_begin_batch (void)
+{
+    if (!batch_changes)
+        batch_changes = g_hash_table_new (g_direct_hash, g_direct_equal);
+    batch_depth++;
+}
+
+void
+qof_event_end_batch (void)
+{
+    EntityChanges *changes;
+
+    if (batch_depth == 0)
+    {
+        PERR ("batch depth underflow");
+        return;
+    }
+
+    if (--batch_depth)
+        return;
+
+    /* An entity stays in the table while its changes are delivered so
+     * that destroying it from a handler drops the rest of them. */
+    while (batch_depth == 0 &&
+           (changes = static_cast<EntityChanges*>(g_queue_pop_head (&batch_queue))))
+    {
+        /* A handler may have batched more events on the entity. */
+        while (changes->entity && changes->events->len)
+            deliver_changes (changes, FALSE);
+        if (changes->entity)
+            g_hash_table_remove (batch_changes, changes->entity);
+        free_changes (changes);
+    }
+}
+
 void
 qof_event_force (QofInstance *entity, QofEventId event_id, gpointer event_data)
 {
@@ -236,10 +647,59 @@ qof_event_gen (QofInstance *entity, QofEventId event_id, gpointer event_data)
     if (!entity)
         return;
 
+    if (event_id == QOF_EVENT_DESTROY)
+        drop_changes (entity);
+
     if (suspend_counter)
+    {
+        dropped_events++;
+        return;
+    }
+
+    if (batch_depth && batch_event (entity, event_id, event_data))
         return;
 
     qof_event_generate_internal (entity, event_id, event_data);
 }
 
+guint
+qof_event_get_dropped_count (void)
+{
+    return dropped_events;
+}
+
+void
+qof_event_foreach_handler_stats (QofEventHandlerStatsCB cb, gpointer user_data)
+{
+    GList *node;
+
+    g_return_if_fail (cb);
+
+    for (node = handlers; node; node = node->next)
+    {
+        HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
+
+        if (hi->handler)
+            cb (hi->handler_id, hi->handler, hi->user_data, hi->delivered,
+                hi->usecs, user_data);
+    }
+}
+
+void
+qof_event_set_profiling (gboolean on)
+{
+    GList *node;
+
+    if (on && !profiling)
+    {
+        for (node = handlers; node; node = node->next)
+        {
+            HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
+            hi->delivered = 0;
+            hi->usecs = 0;
+        }
+    }
+    profiling = on;
+}
+
 /* =========================== END OF FILE ======================= */
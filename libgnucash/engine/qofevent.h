@@ -98,6 +98,29 @@ typedef void (*QofEventHandler) (QofInstance *ent,  QofEventId event_type,
  */
 gint qof_event_register_handler (QofEventHandler handler, gpointer handler_data);
 
+/** \brief Register a handler for some events on one type of entity.
+ *
+ * The handler is only invoked for entities whose e_type is entity_type
+ * and for events that share a bit with event_mask, so a handler that
+ * only watches, say, accounts is not called for each of the events a
+ * bulk import generates on splits and transactions.  Handlers are
+ * still invoked newest first, whichever way they were registered.
+ *
+ * @param handler:   handler to register
+ * @param handler_data: data provided when handler is invoked
+ * @param entity_type: the type of entity to receive events for, or NULL
+ *                   for every type
+ * @param event_mask: the events to receive, e.g.
+ *                   QOF_EVENT_MODIFY | QOF_EVENT_DESTROY
+ *
+ * @return id identifying handler, to be passed to
+ * qof_event_unregister_handler
+ */
+gint qof_event_register_filtered_handler (QofEventHandler handler,
+                                          gpointer handler_data,
+                                          QofIdTypeConst entity_type,
+                                          QofEventId event_mask);
+
 /** \brief Unregister an event handler.
  *
  * @param handler_id: the id of the handler to unregister
@@ -139,6 +162,69 @@ void qof_event_suspend (void);
 /** Resume engine event generation. */
 void qof_event_resume (void);
 
+/** \brief Start collecting engine events instead of delivering them.
+ *
+ * Until the matching qof_event_end_batch, an event generated on an
+ * entity is held back, and raising it again on the same entity adds
+ * nothing.  Closing the outermost batch delivers each held event once,
+ * grouped by entity in the order the entities were first touched.
+ *
+ * Events with event data are held too, and only raising one again
+ * with equal data adds nothing, if their data was registered with
+ * qof_event_register_batch_data.  Other events with data, and
+ * QOF_EVENT_DESTROY, are still delivered at once, after the entity's
+ * held events.  A destroyed entity's held events with data are
+ * delivered before the QOF_EVENT_DESTROY and the rest are discarded,
+ * as are all the held events of an entity, or with data that is an
+ * instance, that is freed before the batch closes.  Unlike
+ * qof_event_suspend no event is lost, so handlers need no full refresh
+ * afterwards.
+ *
+ * Batches nest.
+ */
+void qof_event_begin_batch (void);
+
+/** Close a batch opened by qof_event_begin_batch. */
+void qof_event_end_batch (void);
+
+/** \brief Let a batch hold events that carry event data.
+ *
+ * @param entity_type: the type of entity the events are raised on, or
+ *                   NULL for every type
+ * @param event_id:  the event
+ * @param size:      the number of bytes the event data points at, which
+ *                   are copied, or 0 if the event data is a QofInstance,
+ *                   which is passed on if it still exists when the
+ *                   batch closes
+ */
+void qof_event_register_batch_data (QofIdTypeConst entity_type,
+                                    QofEventId event_id, gsize size);
+
+/** \brief Callback for qof_event_foreach_handler_stats.
+ *
+ * @param handler_id: the id returned when the handler was registered
+ * @param handler:   the handler
+ * @param handler_data: data provided when the handler is invoked
+ * @param delivered: the number of events the handler has been invoked for
+ * @param usecs:     the time spent in the handler while profiling was on,
+ *                   including any events it generated itself
+ * @param user_data: data passed to qof_event_foreach_handler_stats
+ */
+typedef void (*QofEventHandlerStatsCB) (gint handler_id,
+                                        QofEventHandler handler,
+                                        gpointer handler_data,
+                                        guint64 delivered, gint64 usecs,
+                                        gpointer user_data);
+
+/** Report how many events have been delivered to each registered
+ * handler, newest handler first. */
+void qof_event_foreach_handler_stats (QofEventHandlerStatsCB cb,
+                                      gpointer user_data);
+
+/** Turn timing of event handlers on or off.  Turning it on resets the
+ * counts and times reported by qof_event_foreach_handler_stats. */
+void qof_event_set_profiling (gboolean profiling);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1209,10 +1209,7 @@ qof_instance_kvp_remove_guid (const QofInstance *inst, const char *path,
     {
     case KvpValue::Type::FRAME:
         if (kvp_match_guid (v, {key}, guid))
-        {
             delete inst->kvp_data->set_path({path}, nullptr);
-            delete v;
-        }
         break;
     case KvpValue::Type::GLIST:
     {
@@ -1225,6 +1222,9 @@ qof_instance_kvp_remove_guid (const QofInstance *inst, const char *path,
                 list = g_list_delete_link (list, node);
                 v->set(list);
                 delete val;
+                /* Put the edited list back so that the frame records the
+                 * path as changed; set_path hands back v itself. */
+                inst->kvp_data->set_path({path}, v);
                 break;
             }
         }
@@ -1253,7 +1253,10 @@ qof_instance_kvp_merge_guids (const QofInstance *target,
     {
     case KvpValue::Type::FRAME:
         if (target_val)
+        {
             target_val->add(v);
+            target->kvp_data->mark_dirty();
+        }
         else
             target->kvp_data->set_path({path}, v);
         donor->kvp_data->set({path}, nullptr); //Contents moved, Don't delete!
@@ -1264,6 +1267,7 @@ qof_instance_kvp_merge_guids (const QofInstance *target,
             auto list = target_val->get<GList*>();
             list = g_list_concat(list, v->get<GList*>());
             target_val->set(list);
+            target->kvp_data->mark_dirty();
         }
         else
             target->kvp_data->set({path}, v);
@@ -71,6 +71,12 @@ QofQueryParamList * qof_query_sort_get_param_path (const QofQuerySort *querysort
 gint qof_query_sort_get_sort_options (const QofQuerySort *querysort);
 gboolean qof_query_sort_get_increasing (const QofQuerySort *querysort);
 
+/* Tests use this to run the parallel scan of qof_query_set_parallel()
+ * on small books: scan collections of at least min_objects on n_threads
+ * threads, or one per processor if n_threads is 0.  The defaults are
+ * 20000 and 0. */
+void qof_query_set_parallel_scan (guint min_objects, guint n_threads);
+
 #ifdef __cplusplus
 }
 #endif
@@ -32,9 +32,12 @@ extern "C"
 #include <string.h>
 }
 
+#include <algorithm>
+
 #include "qof.h"
 #include "qof-backend.hpp"
 #include "qofbook-p.h"
+#include "qofevent-p.h"
 #include "qofclass-p.h"
 #include "qofquery-p.h"
 #include "qofquerycore-p.h"
@@ -93,6 +96,9 @@ struct _QofQuery
     /* The maximum number of results to return */
     gint              max_results;
 
+    /* Whether the terms may be tested from several threads */
+    gboolean          parallel;
+
     /* list of books that will be participating in the query */
     GList *           books;
 
@@ -106,11 +112,25 @@ struct _QofQuery
     GList *           results;
 };
 
+typedef struct
+{
+    gpointer          object;
+    gint              seq;      /* Order found, to break ties in the sort */
+} QofQueryMatch;
+
 typedef struct _QofQueryCB
 {
     QofQuery *        query;
     GList *           list;
     gint              count;
+
+    /* With max_results set, the best matches so far, kept as a heap of
+     * QofQueryMatch with the least of them at the front. */
+    GArray *          top;
+
+    /* If set, matches are passed to it instead of being collected. */
+    QofInstanceForeachCB foreach_cb;
+    gpointer          foreach_data;
 } QofQueryCB;
 
 /* initial_term will be owned by the new Query */
@@ -362,53 +382,68 @@ sort_func (const gconstpointer a, const gconstpointer b, const gpointer q)
  * object passes the seive.
  */
 
-static int
-check_object (const QofQuery *q, gpointer object)
+static gboolean
+check_term (const QofQueryTerm *qt, gpointer object)
 {
-    const GList     * and_ptr;
-    const GList     * or_ptr;
-    const QofQueryTerm * qt;
-    int       and_terms_ok = 1;
+    const GSList *node;
+    QofParam *param = NULL;
+    gpointer conv_obj = object;
 
-    for (or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+    /* XXX: Don't know how to do this conversion -- do we care? */
+    if (!qt->param_fcns || !qt->pred_fcn)
+        return TRUE;
+
+    /* iterate through the conversions */
+    for (node = qt->param_fcns; node; node = node->next)
     {
-        and_terms_ok = 1;
-        for (and_ptr = static_cast<GList*>(or_ptr->data); and_ptr;
-	     and_ptr = static_cast<GList*>(and_ptr->next))
-        {
-            qt = (QofQueryTerm *)(and_ptr->data);
-            if (qt->param_fcns && qt->pred_fcn)
-            {
-                const GSList *node;
-                QofParam *param = NULL;
-                gpointer conv_obj = object;
+        param = static_cast<QofParam*>(node->data);
 
-                /* iterate through the conversions */
-                for (node = qt->param_fcns; node; node = node->next)
-                {
-                    param = static_cast<QofParam*>(node->data);
+        /* The last term is the actual parameter getter */
+        if (!node->next) break;
 
-                    /* The last term is the actual parameter getter */
-                    if (!node->next) break;
+        conv_obj = param->param_getfcn (conv_obj, param);
+    }
 
-                    conv_obj = param->param_getfcn (conv_obj, param);
-                }
+    return ((qt->pred_fcn)(conv_obj, param, qt->pdata)) != qt->invert;
+}
 
-                if (((qt->pred_fcn)(conv_obj, param, qt->pdata)) == qt->invert)
-                {
-                    and_terms_ok = 0;
-                    break;
-                }
-            }
-            else
-            {
-                /* XXX: Don't know how to do this conversion -- do we care? */
-            }
-        }
-        if (and_terms_ok)
-        {
+static int param_list_cmp (const QofQueryParamList *l1,
+                           const QofQueryParamList *l2);
+
+/* Whether an index on served_path has already applied this term. */
+static gboolean
+term_is_served (const QofQueryTerm *qt, const QofQueryParamList *served_path)
+{
+    return served_path && !qt->invert && qt->param_fcns && qt->pred_fcn &&
+           !param_list_cmp (qt->param_list, served_path);
+}
+
+static gboolean
+check_and_terms (const GList *and_terms, gpointer object,
+                 const QofQueryParamList *served_path)
+{
+    const GList *and_ptr;
+
+    for (and_ptr = and_terms; and_ptr; and_ptr = and_ptr->next)
+    {
+        auto qt = static_cast<const QofQueryTerm*>(and_ptr->data);
+        if (term_is_served (qt, served_path))
+            continue;
+        if (!check_term (qt, object))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static int
+check_object (const QofQuery *q, gpointer object)
+{
+    const GList     * or_ptr;
+
+    for (or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+    {
+        if (check_and_terms (static_cast<GList*>(or_ptr->data), object, NULL))
             return 1;
-        }
     }
 
     /* If there are no terms, assume a "match any" applies.
@@ -567,6 +602,91 @@ static void compile_terms (QofQuery *q)
     LEAVE (" query=%p", q);
 }
 
+static gboolean
+query_is_sorted (const QofQuery *q)
+{
+    return q->primary_sort.comp_fcn || q->primary_sort.obj_cmp ||
+           (q->primary_sort.use_default && q->defaultSort);
+}
+
+/* Orders matches the way sorting the whole list of them would: by the
+ * query's sort order, then, as the sort is stable, by when they were
+ * found. */
+static int
+match_cmp (const QofQuery *q, const QofQueryMatch *a, const QofQueryMatch *b)
+{
+    if (query_is_sorted (q))
+    {
+        int retval = sort_func (a->object, b->object, (gpointer) q);
+        if (retval)
+            return retval;
+    }
+    return (a->seq > b->seq) - (a->seq < b->seq);
+}
+
+/* Cropping keeps the last max_results of the sorted matches, so only
+ * that many of the greatest need to be kept while the search runs. */
+static void
+add_top_match (QofQueryCB *qcb, gpointer object)
+{
+    const QofQuery *q = qcb->query;
+    QofQueryMatch match = { object, qcb->count };
+    auto greater = [q] (const QofQueryMatch& a, const QofQueryMatch& b)
+                   {
+                       return match_cmp (q, &a, &b) > 0;
+                   };
+    QofQueryMatch *heap;
+    guint len = qcb->top->len;
+
+    if (len < (guint) q->max_results)
+    {
+        g_array_append_val (qcb->top, match);
+        heap = reinterpret_cast<QofQueryMatch*>(qcb->top->data);
+        std::push_heap (heap, heap + len + 1, greater);
+        return;
+    }
+
+    heap = reinterpret_cast<QofQueryMatch*>(qcb->top->data);
+    if (len == 0 || match_cmp (q, &match, heap) < 0)
+        return;
+    std::pop_heap (heap, heap + len, greater);
+    heap[len - 1] = match;
+    std::push_heap (heap, heap + len, greater);
+}
+
+/* Frees top, returning its matches as a list in ascending order. */
+static GList *
+top_matches_to_list (const QofQuery *q, GArray *top)
+{
+    auto heap = reinterpret_cast<QofQueryMatch*>(top->data);
+    GList *list = NULL;
+    guint i;
+
+    /* Greatest first, so prepending leaves the list ascending. */
+    std::sort_heap (heap, heap + top->len,
+                    [q] (const QofQueryMatch& a, const QofQueryMatch& b)
+                    {
+                        return match_cmp (q, &a, &b) > 0;
+                    });
+    for (i = 0; i < top->len; i++)
+        list = g_list_prepend (list, heap[i].object);
+
+    g_array_free (top, TRUE);
+    return list;
+}
+
+static void
+add_match (QofQueryCB *qcb, gpointer object)
+{
+    if (qcb->foreach_cb)
+        qcb->foreach_cb (static_cast<QofInstance*>(object), qcb->foreach_data);
+    else if (qcb->top)
+        add_top_match (qcb, object);
+    else
+        qcb->list = g_list_prepend (qcb->list, object);
+    qcb->count++;
+}
+
 static void check_item_cb (gpointer object, gpointer user_data)
 {
     QofQueryCB* ql = static_cast<QofQueryCB*>(user_data);
@@ -574,10 +694,7 @@ static void check_item_cb (gpointer object, gpointer user_data)
     if (!object || !ql) return;
 
     if (check_object (ql->query, object))
-    {
-        ql->list = g_list_prepend (ql->list, object);
-        ql->count++;
-    }
+        add_match (ql, object);
     return;
 }
 
@@ -755,64 +872,356 @@ static GList * qof_query_run_internal (QofQuery *q,
 
         memset (&qcb, 0, sizeof (qcb));
         qcb.query = q;
+        if (q->max_results > -1)
+            qcb.top = g_array_new (FALSE, FALSE, sizeof (QofQueryMatch));
 
         /* Run the query callback */
         run_cb(&qcb, cb_arg);
 
         matching_objects = qcb.list;
         object_count = qcb.count;
+
+        if (qcb.top)
+        {
+            PINFO ("kept %u of %d matching objects", qcb.top->len,
+                   object_count);
+            matching_objects = top_matches_to_list (q, qcb.top);
+            object_count = MIN (object_count, q->max_results);
+        }
     }
     PINFO ("matching objects=%p count=%d", matching_objects, object_count);
 
-    /* There is no absolute need to reverse this list, since it's being
-     * sorted below. However, in the common case, we will be searching
-     * in a confined location where the objects are already in order,
-     * thus reversing will put us in the correct order we want and make
-     * the sorting go much faster.
-     */
-    matching_objects = g_list_reverse(matching_objects);
+    /* A limited query has already kept just the matches it returns, in
+     * order. */
+    if (q->max_results < 0)
+    {
+        /* There is no absolute need to reverse this list, since it's
+         * being sorted below. However, in the common case, we will be
+         * searching in a confined location where the objects are
+         * already in order, thus reversing will put us in the correct
+         * order we want and make the sorting go much faster.
+         */
+        matching_objects = g_list_reverse(matching_objects);
 
-    /* Now sort the matching objects based on the search criteria */
-    if (q->primary_sort.comp_fcn || q->primary_sort.obj_cmp ||
-            (q->primary_sort.use_default && q->defaultSort))
+        /* Now sort the matching objects based on the search criteria */
+        if (query_is_sorted (q))
+        {
+            matching_objects = g_list_sort_with_data(matching_objects,
+                                                     sort_func, q);
+        }
+    }
+
+    q->changed = 0;
+
+    g_list_free(q->results);
+    q->results = matching_objects;
+
+    LEAVE (" q=%p", q);
+    return matching_objects;
+}
+
+/* ==================================================================== */
+/* Index-driven evaluation.  An and-list that has terms on an indexed
+ * parameter path is run by letting the index enumerate the objects
+ * that satisfy those terms and checking only the remaining ones. */
+
+typedef struct
+{
+    QofIdTypeConst      obj_type;
+    QofQueryParamList * param_path;
+    const QofQueryIndex * index;
+} QofQueryIndexDef;
+
+static GList *query_indexes = NULL;
+
+void
+qof_query_register_index (QofIdTypeConst obj_type,
+                          QofQueryParamList *param_path,
+                          const QofQueryIndex *index)
+{
+    QofQueryIndexDef *def;
+    GList *node;
+
+    g_return_if_fail (obj_type);
+    g_return_if_fail (param_path);
+    g_return_if_fail (index && index->estimate && index->foreach);
+
+    for (node = query_indexes; node; node = node->next)
     {
-        matching_objects = g_list_sort_with_data(matching_objects, sort_func, q);
+        def = static_cast<QofQueryIndexDef*>(node->data);
+        if (!g_strcmp0 (def->obj_type, obj_type) &&
+            !param_list_cmp (def->param_path, param_path))
+        {
+            def->index = index;
+            return;
+        }
     }
 
-    /* Crop the list to limit the number of splits. */
-    if ((object_count > q->max_results) && (q->max_results > -1))
+    def = g_new0 (QofQueryIndexDef, 1);
+    def->obj_type = obj_type;
+    def->param_path = g_slist_copy (param_path);
+    def->index = index;
+    query_indexes = g_list_prepend (query_indexes, def);
+}
+
+static void
+free_query_indexes (void)
+{
+    GList *node;
+
+    for (node = query_indexes; node; node = node->next)
+    {
+        auto def = static_cast<QofQueryIndexDef*>(node->data);
+        g_slist_free (def->param_path);
+        g_free (def);
+    }
+    g_list_free (query_indexes);
+    query_indexes = NULL;
+}
+
+/* How one and-list is run: which index enumerates its candidates,
+ * with which predicates, and which terms are left to check. */
+typedef struct
+{
+    const QofQueryIndexDef * def;
+    GSList *                 pred_data;
+    const GList *            and_terms;
+} QofQueryPlanStep;
+
+typedef struct
+{
+    QofQueryCB *             qcb;
+    const QofQueryPlanStep * step;
+    GHashTable *             seen;
+} QofQueryIndexCB;
+
+static void
+free_query_plan (GList *plan)
+{
+    GList *node;
+
+    for (node = plan; node; node = node->next)
+    {
+        auto step = static_cast<QofQueryPlanStep*>(node->data);
+        g_slist_free (step->pred_data);
+        g_free (step);
+    }
+    g_list_free (plan);
+}
+
+/* Pick the cheapest index for each and-list.  Returns NULL if some
+ * and-list has no usable index or the indexes together would visit
+ * at least as many objects as scanning the whole collection. */
+static GList *
+plan_query (const QofQuery *q, QofBook *book)
+{
+    GList *plan = NULL;
+    const GList *or_ptr;
+    gint64 total = 0;
+
+    if (!query_indexes || !q->terms)
+        return NULL;
+
+    for (or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
     {
-        if (q->max_results > 0)
+        auto and_terms = static_cast<const GList*>(or_ptr->data);
+        QofQueryPlanStep *best = NULL;
+        gint64 best_estimate = -1;
+        const GList *node;
+
+        for (node = query_indexes; node; node = node->next)
         {
-            GList *mptr;
+            auto def = static_cast<const QofQueryIndexDef*>(node->data);
+            GSList *pred_data = NULL;
+            const GList *and_ptr;
+            gint64 estimate;
+
+            if (g_strcmp0 (def->obj_type, q->search_for))
+                continue;
+
+            for (and_ptr = and_terms; and_ptr; and_ptr = and_ptr->next)
+            {
+                auto qt = static_cast<const QofQueryTerm*>(and_ptr->data);
+                if (term_is_served (qt, def->param_path))
+                    pred_data = g_slist_prepend (pred_data, qt->pdata);
+            }
+            if (!pred_data)
+                continue;
 
-            /* mptr is set to the first node of what will be the new list */
-            mptr = g_list_nth(matching_objects, object_count - q->max_results);
-            /* mptr should not be NULL, but let's be safe */
-            if (mptr != NULL)
+            estimate = def->index->estimate (book, pred_data);
+            if (estimate < 0 || (best && estimate >= best_estimate))
             {
-                if (mptr->prev != NULL) mptr->prev->next = NULL;
-                mptr->prev = NULL;
+                g_slist_free (pred_data);
+                continue;
             }
-            g_list_free(matching_objects);
-            matching_objects = mptr;
+            if (!best)
+                best = g_new0 (QofQueryPlanStep, 1);
+            else
+                g_slist_free (best->pred_data);
+            best->def = def;
+            best->pred_data = pred_data;
+            best->and_terms = and_terms;
+            best_estimate = estimate;
         }
-        else
+
+        if (!best)
         {
-            /* q->max_results == 0 */
-            g_list_free(matching_objects);
-            matching_objects = NULL;
+            free_query_plan (plan);
+            return NULL;
         }
-        object_count = q->max_results;
+        plan = g_list_prepend (plan, best);
+        total += best_estimate;
     }
 
-    q->changed = 0;
+    if (total >= (gint64) qof_collection_count (qof_book_get_collection
+                                                (book, q->search_for)))
+    {
+        free_query_plan (plan);
+        return NULL;
+    }
+    return g_list_reverse (plan);
+}
 
-    g_list_free(q->results);
-    q->results = matching_objects;
+static void
+check_indexed_item_cb (QofInstance *object, gpointer user_data)
+{
+    auto icb = static_cast<QofQueryIndexCB*>(user_data);
 
-    LEAVE (" q=%p", q);
-    return matching_objects;
+    if (!object) return;
+    if (icb->seen && g_hash_table_contains (icb->seen, object))
+        return;
+    if (!check_and_terms (icb->step->and_terms, object,
+                          icb->step->def->param_path))
+        return;
+    if (icb->seen)
+        g_hash_table_add (icb->seen, object);
+
+    add_match (icb->qcb, object);
+}
+
+static void
+run_query_plan (QofQueryCB *qcb, QofBook *book, GList *plan)
+{
+    QofQueryIndexCB icb;
+    GList *node;
+
+    icb.qcb = qcb;
+    /* An object can satisfy more than one and-list. */
+    icb.seen = plan->next ? g_hash_table_new (g_direct_hash, g_direct_equal)
+                          : NULL;
+
+    for (node = plan; node; node = node->next)
+    {
+        icb.step = static_cast<const QofQueryPlanStep*>(node->data);
+        icb.step->def->index->foreach (book, icb.step->pred_data,
+                                       check_indexed_item_cb, &icb);
+    }
+
+    if (icb.seen)
+        g_hash_table_destroy (icb.seen);
+}
+
+/* ==================================================================== */
+/* Parallel scan.  The objects are snapshotted in the order a serial
+ * scan visits them and cut into slices, each tested on a pool thread.
+ * The matches are then added slice by slice on the calling thread, so
+ * the results, including which ties survive max_results, are the same
+ * as a serial scan's. */
+
+/* Collections smaller than this aren't worth the threads. */
+static guint parallel_scan_min_objects = 20000;
+/* Zero for one thread per processor. */
+static guint parallel_scan_threads = 0;
+/* Slices per thread, so a slow one doesn't hold up the rest. */
+static const guint parallel_scan_slices_per_thread = 4;
+
+typedef struct
+{
+    const QofQuery * query;
+    gpointer *       objects;
+    guint            n_objects;
+    GPtrArray *      matches;
+} QofQueryScanSlice;
+
+static void
+scan_slice (gpointer data, gpointer user_data)
+{
+    auto slice = static_cast<QofQueryScanSlice*>(data);
+    guint i;
+
+    for (i = 0; i < slice->n_objects; i++)
+        if (check_object (slice->query, slice->objects[i]))
+            g_ptr_array_add (slice->matches, slice->objects[i]);
+}
+
+static void
+snapshot_object_cb (gpointer object, gpointer user_data)
+{
+    g_ptr_array_add (static_cast<GPtrArray*>(user_data), object);
+}
+
+/* Returns FALSE, having done nothing, if the scan should be serial. */
+static gboolean
+run_query_parallel (QofQueryCB *qcb, QofBook *book)
+{
+    const QofQuery *q = qcb->query;
+    QofQueryScanSlice *slices;
+    GPtrArray *objects;
+    GThreadPool *pool;
+    guint n_threads, n_slices, slice_size, count, i, j;
+
+    n_threads = parallel_scan_threads ? parallel_scan_threads :
+                g_get_num_processors ();
+    if (!q->parallel || !q->terms || n_threads < 2)
+        return FALSE;
+
+    count = qof_collection_count (qof_book_get_collection (book,
+                                                           q->search_for));
+    if (count < parallel_scan_min_objects)
+        return FALSE;
+
+    pool = g_thread_pool_new (scan_slice, NULL, n_threads, TRUE, NULL);
+    if (!pool)
+        return FALSE;
+
+    objects = g_ptr_array_sized_new (count);
+    qof_object_foreach (q->search_for, book,
+                        (QofInstanceForeachCB) snapshot_object_cb, objects);
+
+    n_slices = n_threads * parallel_scan_slices_per_thread;
+    slice_size = (objects->len + n_slices - 1) / n_slices;
+    slices = g_new0 (QofQueryScanSlice, n_slices);
+    for (i = 0; i < n_slices; i++)
+    {
+        guint begin = MIN (i * slice_size, objects->len);
+
+        slices[i].query = q;
+        slices[i].objects = objects->pdata + begin;
+        slices[i].n_objects = MIN (slice_size, objects->len - begin);
+        slices[i].matches = g_ptr_array_new ();
+        g_thread_pool_push (pool, &slices[i], NULL);
+    }
+    /* Wait for every slice to finish. */
+    g_thread_pool_free (pool, FALSE, TRUE);
+
+    PINFO ("scanned %u objects in %u slices", objects->len, n_slices);
+    for (i = 0; i < n_slices; i++)
+    {
+        for (j = 0; j < slices[i].matches->len; j++)
+            add_match (qcb, g_ptr_array_index (slices[i].matches, j));
+        g_ptr_array_free (slices[i].matches, TRUE);
+    }
+
+    g_free (slices);
+    g_ptr_array_free (objects, TRUE);
+    return TRUE;
+}
+
+void
+qof_query_set_parallel_scan (guint min_objects, guint n_threads)
+{
+    parallel_scan_min_objects = min_objects;
+    parallel_scan_threads = n_threads;
 }
 
 static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
@@ -840,6 +1249,17 @@ static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
             }
         }
 #endif
+        GList *plan = plan_query (qcb->query, book);
+        if (plan)
+        {
+            run_query_plan (qcb, book, plan);
+            free_query_plan (plan);
+            continue;
+        }
+
+        if (run_query_parallel (qcb, book))
+            continue;
+
         /* And then iterate over all the objects */
         qof_object_foreach (qcb->query->search_for, book,
                             (QofInstanceForeachCB) check_item_cb, qcb);
@@ -852,6 +1272,34 @@ GList * qof_query_run (QofQuery *q)
     return qof_query_run_internal(q, qof_query_run_cb, NULL);
 }
 
+void
+qof_query_run_foreach (QofQuery *q, QofInstanceForeachCB cb,
+                       gpointer user_data)
+{
+    QofQueryCB qcb;
+
+    if (!q) return;
+    g_return_if_fail (q->search_for);
+    g_return_if_fail (q->books);
+    g_return_if_fail (cb);
+    ENTER (" q=%p", q);
+
+    if (q->changed)
+    {
+        query_clear_compiles (q);
+        compile_terms (q);
+        q->changed = 0;
+    }
+
+    memset (&qcb, 0, sizeof (qcb));
+    qcb.query = q;
+    qcb.foreach_cb = cb;
+    qcb.foreach_data = user_data;
+    qof_query_run_cb (&qcb, NULL);
+
+    LEAVE (" q=%p count=%d", q, qcb.count);
+}
+
 static void qof_query_run_subq_cb(QofQueryCB* qcb, gpointer cb_arg)
 {
     QofQuery* pq = static_cast<QofQuery*>(cb_arg);
@@ -886,6 +1334,348 @@ qof_query_last_run (QofQuery *query)
     return query->results;
 }
 
+/* ==================================================================== */
+/* Live queries */
+
+typedef struct
+{
+    QofIdTypeConst      obj_type;
+    QofIdTypeConst      related_type;
+    QofQueryRelatedFunc get_objects;
+} QofQueryRelatedDef;
+
+static GList *query_related = NULL;
+
+void
+qof_query_register_related (QofIdTypeConst obj_type,
+                            QofIdTypeConst related_type,
+                            QofQueryRelatedFunc get_objects)
+{
+    QofQueryRelatedDef *def;
+    GList *node;
+
+    g_return_if_fail (obj_type);
+    g_return_if_fail (related_type);
+    g_return_if_fail (get_objects);
+
+    for (node = query_related; node; node = node->next)
+    {
+        def = static_cast<QofQueryRelatedDef*>(node->data);
+        if (!g_strcmp0 (def->obj_type, obj_type) &&
+            !g_strcmp0 (def->related_type, related_type))
+        {
+            def->get_objects = get_objects;
+            return;
+        }
+    }
+
+    def = g_new0 (QofQueryRelatedDef, 1);
+    def->obj_type = obj_type;
+    def->related_type = related_type;
+    def->get_objects = get_objects;
+    query_related = g_list_prepend (query_related, def);
+}
+
+static QofQueryRelatedFunc
+find_related (QofIdTypeConst obj_type, QofIdTypeConst related_type)
+{
+    GList *node;
+
+    for (node = query_related; node; node = node->next)
+    {
+        auto def = static_cast<QofQueryRelatedDef*>(node->data);
+        if (!g_strcmp0 (def->obj_type, obj_type) &&
+            !g_strcmp0 (def->related_type, related_type))
+            return def->get_objects;
+    }
+    return NULL;
+}
+
+struct _QofLiveQuery
+{
+    /* A private copy.  It keeps the caller's max_results, so that it
+     * still compares equal to the query it was made from, but is run
+     * without it so that every match is kept and objects moving in and
+     * out of the trimmed results can be told apart from ones that never
+     * matched. */
+    QofQuery *       query;
+
+    /* The matches in sort order, and each match's iter. */
+    GSequence *      matches;
+    GHashTable *     iters;
+
+    GList *          results;
+    gboolean         results_dirty;
+
+    /* Set when events were dropped while suspended, so the matches may
+     * hold destroyed objects and must not be looked at again. */
+    gboolean         stale;
+    guint            dropped;
+
+    /* One handler for the searched type and one for each related type. */
+    GArray *         handler_ids;
+    QofLiveQueryCB   cb;
+    gpointer         user_data;
+};
+
+static gint
+live_query_cmp (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    auto q = static_cast<QofQuery*>(user_data);
+
+    if (query_is_sorted (q))
+    {
+        int retval = sort_func (a, b, q);
+        if (retval)
+            return retval;
+    }
+    return (a > b) - (a < b);
+}
+
+static void
+live_query_notify (QofLiveQuery *lq, gpointer object,
+                   QofLiveQueryChange change, gint position)
+{
+    lq->results_dirty = TRUE;
+    if (lq->cb)
+        lq->cb (lq, object, change, position, lq->user_data);
+}
+
+static void
+live_query_load (QofLiveQuery *lq)
+{
+    GList *node;
+    gint max_results;
+
+    g_sequence_remove_range (g_sequence_get_begin_iter (lq->matches),
+                             g_sequence_get_end_iter (lq->matches));
+    g_hash_table_remove_all (lq->iters);
+
+    lq->dropped = qof_event_get_dropped_count ();
+    lq->stale = FALSE;
+    lq->results_dirty = TRUE;
+
+    max_results = lq->query->max_results;
+    lq->query->max_results = -1;
+    for (node = qof_query_run (lq->query); node; node = node->next)
+        g_hash_table_insert (lq->iters, node->data,
+                             g_sequence_append (lq->matches, node->data));
+    lq->query->max_results = max_results;
+
+    /* qof_query_run() leaves ties, and everything in an unsorted query,
+     * in the order they were found, but inserting and moving matches
+     * needs them in live_query_cmp() order. */
+    g_sequence_sort (lq->matches, live_query_cmp, lq->query);
+}
+
+/* Test one object again and move it in or out of the matches. */
+static void
+live_query_update (QofLiveQuery *lq, QofInstance *inst, gboolean gone)
+{
+    auto iter = static_cast<GSequenceIter*>
+        (g_hash_table_lookup (lq->iters, inst));
+    gboolean match;
+    gint old_pos, new_pos;
+
+    match = !gone && !qof_instance_get_destroying (inst) &&
+            check_object (lq->query, inst);
+
+    if (!iter)
+    {
+        if (!match)
+            return;
+        iter = g_sequence_insert_sorted (lq->matches, inst, live_query_cmp,
+                                         lq->query);
+        g_hash_table_insert (lq->iters, inst, iter);
+        live_query_notify (lq, inst, QOF_LIVE_QUERY_INSERTED,
+                           g_sequence_iter_get_position (iter));
+        return;
+    }
+
+    old_pos = g_sequence_iter_get_position (iter);
+    if (!match)
+    {
+        g_sequence_remove (iter);
+        g_hash_table_remove (lq->iters, inst);
+        live_query_notify (lq, inst, QOF_LIVE_QUERY_REMOVED, old_pos);
+        return;
+    }
+
+    /* Its sort keys may have changed. */
+    g_sequence_sort_changed (iter, live_query_cmp, lq->query);
+    new_pos = g_sequence_iter_get_position (iter);
+    if (new_pos == old_pos)
+    {
+        live_query_notify (lq, inst, QOF_LIVE_QUERY_CHANGED, new_pos);
+        return;
+    }
+    live_query_notify (lq, inst, QOF_LIVE_QUERY_REMOVED, old_pos);
+    live_query_notify (lq, inst, QOF_LIVE_QUERY_INSERTED, new_pos);
+}
+
+/* Test several objects again, such as the splits of a changed
+ * transaction.  Their sort keys may all have changed, and moving or
+ * inserting one needs every other match in order, so all of them are
+ * taken out before any is tested and put back. */
+static void
+live_query_update_list (QofLiveQuery *lq, GList *objects)
+{
+    GList *node;
+
+    for (node = objects; node; node = node->next)
+    {
+        auto iter = static_cast<GSequenceIter*>
+            (g_hash_table_lookup (lq->iters, node->data));
+        gint pos;
+
+        if (!iter)
+            continue;
+        pos = g_sequence_iter_get_position (iter);
+        g_sequence_remove (iter);
+        g_hash_table_remove (lq->iters, node->data);
+        live_query_notify (lq, node->data, QOF_LIVE_QUERY_REMOVED, pos);
+    }
+
+    for (node = objects; node; node = node->next)
+        live_query_update (lq, static_cast<QofInstance*>(node->data), FALSE);
+}
+
+static void
+live_query_event_handler (QofInstance *ent, QofEventId event_type,
+                          gpointer handler_data, gpointer event_data)
+{
+    auto lq = static_cast<QofLiveQuery*>(handler_data);
+    QofQueryRelatedFunc get_objects;
+    GList *node;
+
+    if (lq->stale)
+        return;
+    if (lq->dropped != qof_event_get_dropped_count ())
+    {
+        lq->stale = TRUE;
+        live_query_notify (lq, NULL, QOF_LIVE_QUERY_RESET, -1);
+        return;
+    }
+
+    if (!g_list_find (lq->query->books, qof_instance_get_book (ent)))
+        return;
+
+    if (!g_strcmp0 (ent->e_type, lq->query->search_for))
+    {
+        live_query_update (lq, ent, event_type == QOF_EVENT_DESTROY);
+        return;
+    }
+
+    get_objects = find_related (lq->query->search_for, ent->e_type);
+    if (get_objects)
+        live_query_update_list (lq, get_objects (ent));
+}
+
+#define LIVE_QUERY_EVENTS (QOF_EVENT_CREATE | QOF_EVENT_MODIFY | \
+                           QOF_EVENT_DESTROY | QOF_EVENT_ADD | \
+                           QOF_EVENT_REMOVE)
+
+/* Only events on the searched type and its related types can change
+ * the matches, so the handler isn't called for any others. */
+static void
+live_query_register_handlers (QofLiveQuery *lq)
+{
+    GList *node;
+    gint id;
+
+    lq->handler_ids = g_array_new (FALSE, FALSE, sizeof (gint));
+    id = qof_event_register_filtered_handler (live_query_event_handler, lq,
+                                              lq->query->search_for,
+                                              LIVE_QUERY_EVENTS);
+    g_array_append_val (lq->handler_ids, id);
+
+    for (node = query_related; node; node = node->next)
+    {
+        auto def = static_cast<QofQueryRelatedDef*>(node->data);
+        if (g_strcmp0 (def->obj_type, lq->query->search_for))
+            continue;
+        id = qof_event_register_filtered_handler (live_query_event_handler,
+                                                  lq, def->related_type,
+                                                  LIVE_QUERY_EVENTS);
+        g_array_append_val (lq->handler_ids, id);
+    }
+}
+
+QofLiveQuery *
+qof_live_query_new (QofQuery *query, QofLiveQueryCB cb, gpointer user_data)
+{
+    QofLiveQuery *lq;
+
+    g_return_val_if_fail (query, NULL);
+    g_return_val_if_fail (query->search_for, NULL);
+
+    lq = g_new0 (QofLiveQuery, 1);
+    lq->query = qof_query_copy (query);
+    lq->matches = g_sequence_new (NULL);
+    lq->iters = g_hash_table_new (g_direct_hash, g_direct_equal);
+    lq->cb = cb;
+    lq->user_data = user_data;
+
+    live_query_load (lq);
+    live_query_register_handlers (lq);
+    return lq;
+}
+
+void
+qof_live_query_destroy (QofLiveQuery *lq)
+{
+    if (!lq) return;
+
+    for (guint i = 0; i < lq->handler_ids->len; i++)
+        qof_event_unregister_handler (g_array_index (lq->handler_ids, gint, i));
+    g_array_free (lq->handler_ids, TRUE);
+    g_list_free (lq->results);
+    g_hash_table_destroy (lq->iters);
+    g_sequence_free (lq->matches);
+    qof_query_destroy (lq->query);
+    g_free (lq);
+}
+
+QofQuery *
+qof_live_query_get_query (QofLiveQuery *lq)
+{
+    g_return_val_if_fail (lq, NULL);
+    return lq->query;
+}
+
+GList *
+qof_live_query_get_results (QofLiveQuery *lq)
+{
+    GSequenceIter *iter, *begin;
+    gint length;
+
+    g_return_val_if_fail (lq, NULL);
+
+    if (lq->stale || lq->dropped != qof_event_get_dropped_count ())
+        live_query_load (lq);
+    if (!lq->results_dirty)
+        return lq->results;
+
+    g_list_free (lq->results);
+    lq->results = NULL;
+
+    /* Like a cropped query result, keep the last max_results. */
+    length = g_sequence_get_length (lq->matches);
+    begin = g_sequence_get_begin_iter (lq->matches);
+    if (lq->query->max_results > -1 && length > lq->query->max_results)
+        begin = g_sequence_get_iter_at_pos (lq->matches,
+                                            length - lq->query->max_results);
+
+    iter = g_sequence_get_end_iter (lq->matches);
+    while (iter != begin)
+    {
+        iter = g_sequence_iter_prev (iter);
+        lq->results = g_list_prepend (lq->results, g_sequence_get (iter));
+    }
+    lq->results_dirty = FALSE;
+    return lq->results;
+}
+
 void qof_query_clear (QofQuery *query)
 {
     QofQuery *q2 = qof_query_create ();
@@ -1051,6 +1841,7 @@ QofQuery * qof_query_invert (QofQuery *q)
     case 0:
         retval = qof_query_create();
         retval->max_results = q->max_results;
+        retval->parallel = q->parallel;
         break;
 
         /* This is the DeMorgan expansion for a single AND expression. */
@@ -1058,6 +1849,7 @@ QofQuery * qof_query_invert (QofQuery *q)
     case 1:
         retval = qof_query_create();
         retval->max_results = q->max_results;
+        retval->parallel = q->parallel;
         retval->books = g_list_copy (q->books);
         retval->search_for = q->search_for;
         retval->changed = 1;
@@ -1091,6 +1883,7 @@ QofQuery * qof_query_invert (QofQuery *q)
         retval = qof_query_merge(iright, ileft, QOF_QUERY_AND);
         retval->books          = g_list_copy (q->books);
         retval->max_results    = q->max_results;
+        retval->parallel       = q->parallel;
         retval->search_for     = q->search_for;
         retval->changed        = 1;
 
@@ -1151,6 +1944,7 @@ qof_query_merge(QofQuery *q1, QofQuery *q2, QofQueryOp op)
             g_list_concat(copy_or_terms(q1->terms), copy_or_terms(q2->terms));
         retval->books           = merge_books (q1->books, q2->books);
         retval->max_results    = q1->max_results;
+        retval->parallel       = q1->parallel && q2->parallel;
         retval->changed        = 1;
         break;
 
@@ -1158,6 +1952,7 @@ qof_query_merge(QofQuery *q1, QofQuery *q2, QofQueryOp op)
         retval = qof_query_create();
         retval->books          = merge_books (q1->books, q2->books);
         retval->max_results    = q1->max_results;
+        retval->parallel       = q1->parallel && q2->parallel;
         retval->changed        = 1;
 
         /* g_list_append() can take forever, so let's build the list in
@@ -1275,6 +2070,12 @@ void qof_query_set_max_results (QofQuery *q, int n)
     q->max_results = n;
 }
 
+void qof_query_set_parallel (QofQuery *q, gboolean parallel)
+{
+    if (!q) return;
+    q->parallel = parallel;
+}
+
 void qof_query_add_guid_list_match (QofQuery *q, QofQueryParamList *param_list,
                                     GList *guid_list, QofGuidMatch options,
                                     QofQueryOp op)
@@ -1350,6 +2151,9 @@ void qof_query_init (void)
 
 void qof_query_shutdown (void)
 {
+    free_query_indexes ();
+    g_list_free_full (query_related, g_free);
+    query_related = NULL;
     qof_class_shutdown ();
     qof_query_core_shutdown ();
 }
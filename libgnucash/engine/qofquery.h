@@ -227,6 +227,15 @@ GList * qof_query_run (QofQuery *query);
  */
 GList * qof_query_last_run (QofQuery *query);
 
+/** Perform the query, passing each matching object to cb as it is
+ *  found instead of collecting them in a list.  The objects come in
+ *  no particular order: the sort order and max_results are ignored,
+ *  and qof_query_last_run() is not changed.  cb must not create or
+ *  destroy objects of the searched-for type.
+ */
+void qof_query_run_foreach (QofQuery *query, QofInstanceForeachCB cb,
+                            gpointer user_data);
+
 /** Perform a subquery, return the results.
  *  Instead of running over a book, the subquery runs over the results
  *  of the primary query.
@@ -237,6 +246,91 @@ GList * qof_query_last_run (QofQuery *query);
 GList * qof_query_run_subquery (QofQuery *subquery,
                                 const QofQuery* primary_query);
 
+/** An index lets qof_query_run() visit only the objects that can
+ *  match a term on one parameter path instead of every object in the
+ *  book.  Both functions get the predicate data of all the
+ *  non-inverted terms of one and-list that use the path.
+ *
+ *  estimate returns about how many objects foreach would visit, or -1
+ *  if the index can't serve that combination of predicates.
+ *
+ *  foreach must call cb exactly once for every object in the book
+ *  that satisfies all the predicates, and may call it for no other.
+ *  The remaining terms are checked on the objects it visits.
+ */
+typedef struct _QofQueryIndex
+{
+    gint64 (*estimate) (QofBook *book, GSList *pred_data);
+    void (*foreach) (QofBook *book, GSList *pred_data,
+                     QofInstanceForeachCB cb, gpointer user_data);
+} QofQueryIndex;
+
+/** Register an index over the objects of type obj_type for terms on
+ *  param_path.  The path is copied; the index must outlive the query
+ *  subsystem.
+ */
+void qof_query_register_index (QofIdTypeConst obj_type,
+                               QofQueryParamList *param_path,
+                               const QofQueryIndex *index);
+
+/** Returns the objects whose query terms may have changed along with
+ *  inst, in a list owned by inst. */
+typedef GList * (*QofQueryRelatedFunc) (QofInstance *inst);
+
+/** Tell live queries for obj_type that an event on an instance of
+ *  related_type can change how get_objects' results match.
+ */
+void qof_query_register_related (QofIdTypeConst obj_type,
+                                 QofIdTypeConst related_type,
+                                 QofQueryRelatedFunc get_objects);
+
+/** A live query keeps the results of a query current by testing only
+ *  the objects named in engine events, rather than running the query
+ *  again over the whole book.
+ */
+typedef struct _QofLiveQuery QofLiveQuery;
+
+typedef enum
+{
+    QOF_LIVE_QUERY_INSERTED,
+    QOF_LIVE_QUERY_REMOVED,
+    QOF_LIVE_QUERY_CHANGED,
+    /** Events were missed; everything must be fetched again. */
+    QOF_LIVE_QUERY_RESET,
+} QofLiveQueryChange;
+
+/** Reports a change to the results.  position is the object's index
+ *  in the sorted results without regard to max_results: its old index
+ *  for QOF_LIVE_QUERY_REMOVED, else its new one.  A moved object is
+ *  reported as removed and then inserted, as is each of the objects
+ *  tested again for an event on a related object, such as the splits
+ *  of a changed transaction.  For QOF_LIVE_QUERY_RESET
+ *  object is NULL and position -1.
+ */
+typedef void (*QofLiveQueryCB) (QofLiveQuery *lq, gpointer object,
+                                QofLiveQueryChange change, gint position,
+                                gpointer user_data);
+
+/** Run a copy of query and follow engine events to keep its results
+ *  current.  cb may be NULL.  The live query must be destroyed before
+ *  the books it searches.
+ */
+QofLiveQuery * qof_live_query_new (QofQuery *query, QofLiveQueryCB cb,
+                                   gpointer user_data);
+void qof_live_query_destroy (QofLiveQuery *lq);
+
+/** The live query's own copy of the query, which compares equal to
+ *  the query it was made from; don't change it. */
+QofQuery * qof_live_query_get_query (QofLiveQuery *lq);
+
+/** The current results, sorted and trimmed to max_results as
+ *  qof_query_run() would return them, except that objects the query's
+ *  sort doesn't tell apart are in address order rather than the order
+ *  they were found.  Do NOT free the list; it is replaced by the next
+ *  call.
+ */
+GList * qof_live_query_get_results (QofLiveQuery *lq);
+
 /** Remove all query terms from query.  query matches nothing
  *  after qof_query_clear().
  */
@@ -357,9 +451,18 @@ void qof_query_set_sort_increasing (QofQuery *q, gboolean prim_inc,
  * only the last bit of results are returned.  For example,
  * if the sort order is set to be increasing date order, then
  * only the objects with the most recent dates will be returned.
+ * Only that many matches are held while the query runs.
  */
 void qof_query_set_max_results (QofQuery *q, int n);
 
+/** Allow the terms of q to be tested on a large collection from
+ *  several threads at once when no index narrows the search.  Only set
+ *  this if every getter in the query's terms is read-only, see
+ *  QofAccessFunc.  The results are the same either way; sorting
+ *  always happens on the calling thread.
+ */
+void qof_query_set_parallel (QofQuery *q, gboolean parallel);
+
 /** Compare two queries for equality.
  * Query terms are compared each to each.
  * This is a simplistic
@@ -189,6 +189,38 @@ TEST_F (KvpFrameTest, Empty)
     EXPECT_FALSE(f2.empty());
 }
 
+TEST_F (KvpFrameTest, DirtyKeys)
+{
+    auto top = t_root.get_slot ({"top"})->get<KvpFrame*> ();
+    EXPECT_TRUE (t_root.all_dirty ());
+    EXPECT_TRUE (t_root.is_dirty ());
+
+    t_root.mark_clean ();
+    EXPECT_FALSE (t_root.all_dirty ());
+    EXPECT_FALSE (t_root.is_dirty ());
+    EXPECT_FALSE (top->is_dirty ());
+
+    delete t_root.set_path ({"top", "first"}, new KvpValue {INT64_C (16)});
+    EXPECT_TRUE (t_root.is_dirty ());
+    EXPECT_TRUE (t_root.get_dirty_keys ().empty ());
+    EXPECT_EQ (std::vector<std::string> {"first"}, top->get_dirty_keys ());
+
+    delete t_root.set ({"new"}, new KvpValue {INT64_C (17)});
+    delete t_root.set ({"top", "third"}, nullptr);
+    EXPECT_EQ (std::vector<std::string> {"new"}, t_root.get_dirty_keys ());
+    auto top_keys = top->get_dirty_keys ();
+    EXPECT_EQ (2u, top_keys.size ());
+    assert_contains (top_keys, "third");
+
+    t_root.mark_clean ();
+    EXPECT_FALSE (t_root.is_dirty ());
+    t_root.mark_dirty ();
+    EXPECT_TRUE (t_root.all_dirty ());
+
+    KvpFrameImpl copy {t_root};
+    EXPECT_TRUE (copy.all_dirty ());
+}
+
 TEST (KvpFrameTestForEachPrefix, for_each_prefix_1)
 {
     KvpFrame fr;
@@ -396,6 +396,224 @@ mock_get_display_name(const QofInstance* inst)
     return display_name;
 }
 
+static GString *event_order;
+
+static void
+record_event_handler( QofInstance *ent, QofEventId event_type,
+                      gpointer handler_data, gpointer event_data )
+{
+    g_string_append( event_order, static_cast<const char*>(handler_data) );
+}
+
+static void
+count_handler_stats( gint handler_id, QofEventHandler handler,
+                     gpointer handler_data, guint64 delivered, gint64 usecs,
+                     gpointer user_data )
+{
+    if ( handler != record_event_handler )
+        return;
+    g_string_append_printf( static_cast<GString*>(user_data), "%s%" G_GUINT64_FORMAT " ",
+                            static_cast<const char*>(handler_data), delivered );
+}
+
+static void
+test_instance_filtered_events( Fixture *fixture, gconstpointer pData )
+{
+    gint any1, typed, other, any2;
+    GString *stats = g_string_new( NULL );
+
+    fixture->inst->e_type = "test type";
+    event_order = g_string_new( NULL );
+    qof_event_set_profiling( TRUE );
+    any1 = qof_event_register_handler( record_event_handler, (gpointer)"a" );
+    typed = qof_event_register_filtered_handler( record_event_handler, (gpointer)"t",
+                                                 "test type", QOF_EVENT_MODIFY );
+    other = qof_event_register_filtered_handler( record_event_handler, (gpointer)"o",
+                                                 "other type", QOF_EVENT_ALL );
+    any2 = qof_event_register_handler( record_event_handler, (gpointer)"b" );
+
+    g_test_message( "Typed handlers run in registration order with the others" );
+    qof_event_gen( fixture->inst, QOF_EVENT_MODIFY, NULL );
+    g_assert_cmpstr( event_order->str, ==, "bta" );
+
+    g_test_message( "Events outside the mask are not delivered" );
+    g_string_truncate( event_order, 0 );
+    qof_event_gen( fixture->inst, QOF_EVENT_DESTROY, NULL );
+    g_assert_cmpstr( event_order->str, ==, "ba" );
+
+    g_test_message( "Handlers for other types are not run" );
+    g_string_truncate( event_order, 0 );
+    fixture->inst->e_type = "third type";
+    qof_event_gen( fixture->inst, QOF_EVENT_MODIFY, NULL );
+    g_assert_cmpstr( event_order->str, ==, "ba" );
+
+    qof_event_foreach_handler_stats( count_handler_stats, stats );
+    g_assert_cmpstr( stats->str, ==, "b3 o0 t1 a3 " );
+
+    qof_event_set_profiling( FALSE );
+    qof_event_unregister_handler( any1 );
+    qof_event_unregister_handler( typed );
+    qof_event_unregister_handler( other );
+    qof_event_unregister_handler( any2 );
+    g_string_free( stats, TRUE );
+    g_string_free( event_order, TRUE );
+    fixture->inst->e_type = NULL;
+}
+
+static void
+record_event_type( QofInstance *ent, QofEventId event_type,
+                   gpointer handler_data, gpointer event_data )
+{
+    char c = event_type == QOF_EVENT_CREATE ? 'c' :
+             event_type == QOF_EVENT_MODIFY ? 'm' :
+             event_type == QOF_EVENT_DESTROY ? 'd' : '?';
+    g_string_append_c( event_order, event_data ? g_ascii_toupper( c ) : c );
+}
+
+static void
+test_instance_batched_events( Fixture *fixture, gconstpointer pData )
+{
+    gint id;
+
+    event_order = g_string_new( NULL );
+    id = qof_event_register_handler( record_event_type, NULL );
+
+    g_test_message( "Events are held and delivered once when the batch closes" );
+    qof_event_begin_batch();
+    qof_event_gen( fixture->inst, QOF_EVENT_CREATE, NULL );
+    qof_event_gen( fixture->inst, QOF_EVENT_MODIFY, NULL );
+    qof_event_begin_batch();
+    qof_event_gen( fixture->inst, QOF_EVENT_MODIFY, NULL );
+    qof_event_end_batch();
+    g_assert_cmpstr( event_order->str, ==, "" );
+    qof_event_end_batch();
+    g_assert_cmpstr( event_order->str, ==, "cm" );
+
+    g_test_message( "Events with data go out at once, after the held ones" );
+    g_string_truncate( event_order, 0 );
+    qof_event_begin_batch();
+    qof_event_gen( fixture->inst, QOF_EVENT_MODIFY, NULL );
+    qof_event_gen( fixture->inst, QOF_EVENT_MODIFY, fixture );
+    g_assert_cmpstr( event_order->str, ==, "mM" );
+    qof_event_gen( fixture->inst, QOF_EVENT_MODIFY, NULL );
+    qof_event_end_batch();
+    g_assert_cmpstr( event_order->str, ==, "mMm" );
+
+    g_test_message( "Destroying an entity drops its held events" );
+    g_string_truncate( event_order, 0 );
+    qof_event_begin_batch();
+    qof_event_gen( fixture->inst, QOF_EVENT_MODIFY, NULL );
+    qof_event_gen( fixture->inst, QOF_EVENT_DESTROY, NULL );
+    g_assert_cmpstr( event_order->str, ==, "d" );
+    qof_event_end_batch();
+    g_assert_cmpstr( event_order->str, ==, "d" );
+
+    qof_event_unregister_handler( id );
+    g_string_free( event_order, TRUE );
+}
+
+#define TEST_EVENT_COPIED QOF_MAKE_EVENT( QOF_EVENT_BASE + 10 )
+#define TEST_EVENT_INSTANCE QOF_MAKE_EVENT( QOF_EVENT_BASE + 11 )
+
+/* Copied data is an int, written as its value; instance data as 'i'. */
+static void
+record_event_data( QofInstance *ent, QofEventId event_type,
+                   gpointer handler_data, gpointer event_data )
+{
+    if ( event_type == TEST_EVENT_COPIED )
+        g_string_append_printf( event_order, "%d",
+                                *static_cast<int*>(event_data) );
+    else if ( event_type == TEST_EVENT_INSTANCE )
+        g_string_append_c( event_order, 'i' );
+    else if ( event_type == QOF_EVENT_MODIFY )
+        g_string_append_c( event_order, 'm' );
+    else if ( event_type == QOF_EVENT_DESTROY )
+        g_string_append_c( event_order, 'd' );
+}
+
+static void
+test_instance_batched_event_data( Fixture *fixture, gconstpointer pData )
+{
+    QofInstance *other;
+    int value;
+    gint id;
+
+    event_order = g_string_new( NULL );
+    id = qof_event_register_handler( record_event_data, NULL );
+    fixture->inst->e_type = "batch type";
+    qof_event_register_batch_data( "batch type", TEST_EVENT_COPIED,
+                                   sizeof( int ) );
+    qof_event_register_batch_data( "batch type", TEST_EVENT_INSTANCE, 0 );
+
+    g_test_message( "Registered data is copied and coalesced on its value" );
+    qof_event_begin_batch();
+    value = 1;
+    qof_event_gen( fixture->inst, TEST_EVENT_COPIED, &value );
+    value = 2;
+    qof_event_gen( fixture->inst, TEST_EVENT_COPIED, &value );
+    value = 1;
+    qof_event_gen( fixture->inst, TEST_EVENT_COPIED, &value );
+    value = 3;
+    g_assert_cmpstr( event_order->str, ==, "" );
+    qof_event_end_batch();
+    g_assert_cmpstr( event_order->str, ==, "12" );
+
+    g_test_message( "Events with an instance that goes away are dropped" );
+    g_string_truncate( event_order, 0 );
+    other = static_cast<QofInstance*>(g_object_new( QOF_TYPE_INSTANCE, NULL ));
+    qof_event_begin_batch();
+    qof_event_gen( fixture->inst, TEST_EVENT_INSTANCE, other );
+    qof_event_gen( fixture->inst, TEST_EVENT_INSTANCE, other );
+    qof_event_gen( fixture->inst, QOF_EVENT_MODIFY, NULL );
+    g_object_unref( other );
+    qof_event_end_batch();
+    g_assert_cmpstr( event_order->str, ==, "m" );
+
+    g_test_message( "An entity freed in a batch isn't kept alive or told" );
+    g_string_truncate( event_order, 0 );
+    other = static_cast<QofInstance*>(g_object_new( QOF_TYPE_INSTANCE, NULL ));
+    g_object_add_weak_pointer( G_OBJECT( other ), (gpointer*) &other );
+    qof_event_begin_batch();
+    qof_event_gen( other, QOF_EVENT_MODIFY, NULL );
+    g_object_unref( other );
+    g_assert_null( other );
+    qof_event_end_batch();
+    g_assert_cmpstr( event_order->str, ==, "" );
+
+    g_test_message( "A destroy first delivers the held events with data" );
+    g_string_truncate( event_order, 0 );
+    other = static_cast<QofInstance*>(g_object_new( QOF_TYPE_INSTANCE, NULL ));
+    qof_event_begin_batch();
+    qof_event_gen( fixture->inst, QOF_EVENT_MODIFY, NULL );
+    value = 4;
+    qof_event_gen( fixture->inst, TEST_EVENT_COPIED, &value );
+    qof_event_gen( other, QOF_EVENT_DESTROY, NULL );
+    g_assert_cmpstr( event_order->str, ==, "4d" );
+    qof_event_end_batch();
+    g_assert_cmpstr( event_order->str, ==, "4dm" );
+    g_object_unref( other );
+
+    g_test_message( "A destroy sends held data only once, and nothing else" );
+    g_string_truncate( event_order, 0 );
+    other = static_cast<QofInstance*>(g_object_new( QOF_TYPE_INSTANCE, NULL ));
+    qof_event_begin_batch();
+    qof_event_gen( fixture->inst, QOF_EVENT_MODIFY, NULL );
+    qof_event_gen( other, QOF_EVENT_DESTROY, NULL );
+    g_assert_cmpstr( event_order->str, ==, "d" );
+    value = 5;
+    qof_event_gen( fixture->inst, TEST_EVENT_COPIED, &value );
+    qof_event_gen( other, QOF_EVENT_DESTROY, NULL );
+    qof_event_gen( other, QOF_EVENT_DESTROY, NULL );
+    g_assert_cmpstr( event_order->str, ==, "d5dd" );
+    qof_event_end_batch();
+    g_assert_cmpstr( event_order->str, ==, "d5ddm" );
+    g_object_unref( other );
+
+    qof_event_unregister_handler( id );
+    g_string_free( event_order, TRUE );
+    fixture->inst->e_type = NULL;
+}
+
 static void
 test_instance_display_name( Fixture *fixture, gconstpointer pData )
 {
@@ -990,6 +1208,9 @@ test_suite_qofinstance ( void )
     GNC_TEST_ADD_FUNC( suitename, "version compare", test_instance_version_cmp );
     GNC_TEST_ADD( suitename, "get set dirty", Fixture, NULL, setup, test_instance_get_set_dirty, teardown );
     GNC_TEST_ADD( suitename, "display name", Fixture, NULL, setup, test_instance_display_name, teardown );
+    GNC_TEST_ADD( suitename, "filtered events", Fixture, NULL, setup, test_instance_filtered_events, teardown );
+    GNC_TEST_ADD( suitename, "batched events", Fixture, NULL, setup, test_instance_batched_events, teardown );
+    GNC_TEST_ADD( suitename, "batched event data", Fixture, NULL, setup, test_instance_batched_event_data, teardown );
     GNC_TEST_ADD( suitename, "begin edit", Fixture, NULL, setup, test_instance_begin_edit, teardown );
     GNC_TEST_ADD( suitename, "commit edit", Fixture, NULL, setup, test_instance_commit_edit, teardown );
     GNC_TEST_ADD( suitename, "commit edit part 2", Fixture, NULL, setup, test_instance_commit_edit_part2, teardown );
@@ -25,6 +25,7 @@ extern "C"
 #include <config.h>
 #include <glib.h>
 #include "qof.h"
+#include "qofquery-p.h"
 #include "cashobjects.h"
 #include "Transaction.h"
 #include "TransLog.h"
@@ -67,6 +68,317 @@ test_trans_query (Transaction *trans, gpointer data)
     return 0;
 }
 
+typedef struct
+{
+    time64 lo;
+    time64 hi;
+    guint count;
+} DateCount;
+
+static void
+count_split_in_range (QofInstance *inst, gpointer data)
+{
+    DateCount *dc = static_cast<DateCount*>(data);
+    time64 date = xaccTransRetDatePosted (xaccSplitGetParent (GNC_SPLIT (inst)));
+
+    if (date >= dc->lo && date <= dc->hi)
+        dc->count++;
+}
+
+static gboolean
+query_finds_split (QofBook *book, Account *acc, Split *split)
+{
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    gboolean found;
+
+    qof_query_set_book (q, book);
+    xaccQueryAddSingleAccountMatch (q, acc, QOF_QUERY_AND);
+    found = g_list_find (qof_query_run (q), split) != NULL;
+    qof_query_destroy (q);
+    return found;
+}
+
+/* A split moved to another account inside an open edit is still in its
+ * old account's split list, so a query must not use the indexes until
+ * the transaction is committed. */
+static void
+test_split_moved_in_open_edit (QofBook *book, Split *split)
+{
+    Transaction *trans = xaccSplitGetParent (split);
+    Account *from = xaccSplitGetAccount (split);
+    Account *to = xaccMallocAccount (book);
+
+    xaccAccountBeginEdit (to);
+    xaccAccountSetCommodity (to, xaccAccountGetCommodity (from));
+    gnc_account_append_child (gnc_account_get_root (from), to);
+    xaccAccountCommitEdit (to);
+
+    xaccTransBeginEdit (trans);
+    xaccSplitSetAccount (split, to);
+    do_test (query_finds_split (book, to, split),
+             "open edit: split found under its new account");
+    do_test (!query_finds_split (book, from, split),
+             "open edit: split not found under its old account");
+    xaccTransRollbackEdit (trans);
+
+    do_test (xaccSplitGetAccount (split) == from &&
+             query_finds_split (book, from, split) &&
+             !query_finds_split (book, to, split),
+             "rolled back: split found under its old account");
+}
+
+/* The split indexes must return just what scanning every split would. */
+static void
+test_split_indexes (QofBook *book, Account *root)
+{
+    GList *accounts = gnc_account_get_descendants (root);
+    GList *node, *list;
+    Split *first = NULL;
+    QofQuery *q;
+    DateCount dc;
+
+    for (node = accounts; node; node = node->next)
+    {
+        Account *acc = GNC_ACCOUNT (node->data);
+
+        if (!first && xaccAccountGetSplitList (acc))
+            first = GNC_SPLIT (xaccAccountGetSplitList (acc)->data);
+
+        q = qof_query_create_for (GNC_ID_SPLIT);
+        qof_query_set_book (q, book);
+        xaccQueryAddSingleAccountMatch (q, acc, QOF_QUERY_AND);
+        list = qof_query_run (q);
+        if (g_list_length (list) != g_list_length (xaccAccountGetSplitList (acc)))
+            failure_args ("account query", __FILE__, __LINE__,
+                          "%d splits found, expected %d", g_list_length (list),
+                          g_list_length (xaccAccountGetSplitList (acc)));
+        for (; list; list = list->next)
+            if (xaccSplitGetAccount (GNC_SPLIT (list->data)) != acc)
+                failure ("account query found a split of another account");
+        qof_query_destroy (q);
+    }
+    g_list_free (accounts);
+
+    if (!first)
+        return;
+
+    dc.lo = xaccTransRetDatePosted (xaccSplitGetParent (first));
+    dc.hi = dc.lo + 30 * 24 * 3600;
+    dc.count = 0;
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_SPLIT),
+                            count_split_in_range, &dc);
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    xaccQueryAddDateMatchTT (q, TRUE, dc.lo, TRUE, dc.hi, QOF_QUERY_AND);
+    list = qof_query_run (q);
+    if (g_list_length (list) != dc.count)
+        failure_args ("date query", __FILE__, __LINE__,
+                      "%d splits found, expected %d", g_list_length (list),
+                      dc.count);
+    else
+        success ("split indexes match a scan");
+    qof_query_destroy (q);
+
+    test_split_moved_in_open_edit (book, first);
+}
+
+static void
+count_match (QofInstance *inst, gpointer data)
+{
+    (*static_cast<guint*>(data))++;
+}
+
+/* A limited query keeps the tail of what the unlimited one returns. */
+static void
+test_max_results (QofBook *book)
+{
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    GList *all, *limited, *tail;
+    guint n_all, streamed = 0;
+    const int limit = 5;
+
+    qof_query_set_book (q, book);
+    all = g_list_copy (qof_query_run (q));
+    n_all = g_list_length (all);
+
+    qof_query_run_foreach (q, count_match, &streamed);
+    if (streamed != n_all)
+        failure_args ("streamed query", __FILE__, __LINE__,
+                      "%d objects streamed, expected %d", streamed, n_all);
+
+    qof_query_set_max_results (q, limit);
+    limited = qof_query_run (q);
+    tail = g_list_nth (all, n_all > (guint) limit ? n_all - limit : 0);
+    for (; tail && limited; tail = tail->next, limited = limited->next)
+        if (tail->data != limited->data)
+            break;
+    if (tail || limited)
+        failure ("limited query doesn't match the end of the full one");
+    else
+        success ("limited query keeps the last results");
+
+    qof_query_destroy (q);
+    g_list_free (all);
+}
+
+/* Same objects in the same order.  The default split sort ends on the
+ * GUID, so there are no ties to be ordered differently. */
+static gboolean
+same_results (GList *l1, GList *l2)
+{
+    for (; l1 && l2; l1 = l1->next, l2 = l2->next)
+        if (l1->data != l2->data)
+            return FALSE;
+    return !l1 && !l2;
+}
+
+/* A parallel scan, forced on for this small book, finds what a serial
+ * one does in the same order, also when limited to max_results. */
+static void
+test_parallel_query (QofBook *book)
+{
+    QofQuery *serial = qof_query_create_for (GNC_ID_SPLIT);
+    QofQuery *parallel;
+    GList *expected;
+    gboolean same = TRUE;
+    const int limits[] = { -1, 5 };
+
+    qof_query_set_book (serial, book);
+    /* No index covers the cleared flag, so every split is scanned. */
+    xaccQueryAddClearedMatch (serial, static_cast<cleared_match_t>
+                              (CLEARED_NO | CLEARED_CLEARED), QOF_QUERY_AND);
+    parallel = qof_query_copy (serial);
+    qof_query_set_parallel (parallel, TRUE);
+
+    qof_query_set_parallel_scan (1, 4);
+    for (guint i = 0; i < G_N_ELEMENTS (limits); i++)
+    {
+        qof_query_set_max_results (serial, limits[i]);
+        qof_query_set_max_results (parallel, limits[i]);
+        expected = qof_query_run (serial);
+        if (!expected || !same_results (qof_query_run (parallel), expected))
+        {
+            failure_args ("parallel query", __FILE__, __LINE__,
+                          "results differ with max_results %d", limits[i]);
+            same = FALSE;
+        }
+    }
+    qof_query_set_parallel_scan (20000, 0);
+    if (same)
+        success ("parallel query matches a serial one");
+
+    qof_query_destroy (parallel);
+    qof_query_destroy (serial);
+}
+
+/* Moving a transaction's date moves all of its splits in a query over
+ * every split at once. */
+static void
+test_live_query_date_change (QofBook *book)
+{
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    QofLiveQuery *lq;
+    Transaction *trans = NULL;
+    GList *all;
+
+    qof_query_set_book (q, book);
+    lq = qof_live_query_new (q, NULL, NULL);
+    if (!same_results (qof_live_query_get_results (lq), qof_query_run (q)))
+        failure ("live query loaded out of order");
+
+    for (all = qof_query_run (q); all; all = all->next)
+    {
+        Transaction *t = xaccSplitGetParent (GNC_SPLIT (all->data));
+        if (g_list_length (xaccTransGetSplitList (t)) > 1)
+        {
+            trans = t;
+            break;
+        }
+    }
+    if (!trans)
+    {
+        qof_live_query_destroy (lq);
+        qof_query_destroy (q);
+        return;
+    }
+
+    /* To the far end of the splits, then back to the other end. */
+    xaccTransBeginEdit (trans);
+    xaccTransSetDatePostedSecsNormalized (trans, gnc_time (NULL) +
+                                          3650 * 24 * 3600);
+    xaccTransCommitEdit (trans);
+    if (!same_results (qof_live_query_get_results (lq), qof_query_run (q)))
+        failure ("live query misplaced the splits of a moved transaction");
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetDatePostedSecsNormalized (trans, 0);
+    xaccTransCommitEdit (trans);
+    if (!same_results (qof_live_query_get_results (lq), qof_query_run (q)))
+        failure ("live query misplaced the splits of a moved transaction");
+
+    qof_live_query_destroy (lq);
+
+    /* A limited live query still compares equal to its query. */
+    qof_query_set_max_results (q, 3);
+    lq = qof_live_query_new (q, NULL, NULL);
+    if (!qof_query_equal (qof_live_query_get_query (lq), q))
+        failure ("live query doesn't compare equal to its query");
+    if (!same_results (qof_live_query_get_results (lq), qof_query_run (q)))
+        failure ("limited live query differs from its query");
+    else
+        success ("live query keeps moved splits in order");
+
+    qof_live_query_destroy (lq);
+    qof_query_destroy (q);
+}
+
+/* A live query follows changes without being run again. */
+static void
+test_live_query (QofBook *book, Account *root)
+{
+    GList *accounts = gnc_account_get_descendants (root);
+    QofQuery *q;
+    QofLiveQuery *lq;
+    Transaction *trans;
+
+    if (!accounts)
+        return;
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    xaccQueryAddSingleAccountMatch (q, GNC_ACCOUNT (accounts->data),
+                                    QOF_QUERY_AND);
+    lq = qof_live_query_new (q, NULL, NULL);
+
+    add_random_transactions_to_book (book, 5);
+    if (!same_results (qof_live_query_get_results (lq), qof_query_run (q)))
+        failure ("live query missed new transactions");
+
+    trans = get_random_transaction (book);
+    if (trans)
+    {
+        make_random_changes_to_transaction_and_splits (book, trans, accounts);
+        if (!same_results (qof_live_query_get_results (lq),
+                           qof_query_run (q)))
+            failure ("live query missed a changed transaction");
+
+        xaccTransBeginEdit (trans);
+        xaccTransDestroy (trans);
+        xaccTransCommitEdit (trans);
+        if (!same_results (qof_live_query_get_results (lq),
+                           qof_query_run (q)))
+            failure ("live query kept a destroyed transaction");
+    }
+    success ("live query follows changes");
+
+    qof_live_query_destroy (lq);
+    qof_query_destroy (q);
+    g_list_free (accounts);
+
+    test_live_query_date_change (book);
+}
+
 static void
 run_test (void)
 {
@@ -81,6 +393,10 @@ run_test (void)
     add_random_transactions_to_book (book, 20);
 
     xaccAccountTreeForEachTransaction (root, test_trans_query, book);
+    test_split_indexes (book, root);
+    test_max_results (book);
+    test_parallel_query (book);
+    test_live_query (book, root);
 
     qof_session_end (session);
 }
@@ -43,6 +43,7 @@ void test_suite_account (void);
 
 #include <qofinstance-p.h>
 #include <kvp-frame.hpp>
+#include <vector>
 
 typedef struct
 {
@@ -1174,6 +1175,21 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     g_assert (!priv->balance_dirty);
     test_signal_assert_hits (sig1, 4);
     test_signal_assert_hits (sig3, 1);
+    /* Resorting clears sort_dirty and leaves the list in split order */
+    xaccAccountSortSplits (fixture->acct, TRUE);
+    g_assert (!priv->sort_dirty);
+    g_assert_cmpint (xaccAccountCountSplits (fixture->acct, FALSE), ==, 2);
+    g_assert_cmpint (xaccSplitOrder (static_cast<Split*>(priv->splits->data),
+                                     static_cast<Split*>(priv->splits->next->data)),
+                     <, 0);
+    /* Re-adding a removed split puts it back in order */
+    g_assert (gnc_account_insert_split (fixture->acct, split3));
+    g_assert_cmpint (xaccAccountCountSplits (fixture->acct, FALSE), ==, 3);
+    for (auto node = priv->splits; node && node->next; node = node->next)
+        g_assert_cmpint (xaccSplitOrder (static_cast<Split*>(node->data),
+                                         static_cast<Split*>(node->next->data)),
+                         <, 0);
+    g_assert (gnc_account_remove_split (fixture->acct, split3));
 
     /* Clean up the handlers */
     test_signal_free (sig3);
@@ -1329,6 +1345,171 @@ test_xaccAccountRecomputeBalance (Fixture *fixture, gconstpointer pData)
     g_assert (!priv->balance_dirty);
 }
 
+static void
+test_xaccAccountRecomputeBalance_incremental (Fixture *fixture, gconstpointer pData)
+{
+    AccountPrivate *priv = fixture->func->get_private (fixture->acct);
+    guint n_splits = g_list_length (priv->splits);
+    Split *split = static_cast<Split*>(g_list_nth_data (priv->splits,
+                                                         n_splits / 2));
+    std::vector<gnc_numeric> balances, cleared, reconciled;
+
+    priv->balance_dirty = TRUE;
+    xaccAccountRecomputeBalance (fixture->acct);
+    /* Changing the middle split only recomputes from there on, but has
+     * to give the same running balances as a full recompute. */
+    xaccTransBeginEdit (xaccSplitGetParent (split));
+    xaccSplitSetReconcile (split, xaccSplitGetReconcile (split) == NREC ?
+                           CREC : NREC);
+    g_assert (!priv->balance_dirty);
+    /* Skip the scrubbing in xaccTransCommitEdit, as setup does. */
+    qof_commit_edit (QOF_INSTANCE (xaccSplitGetParent (split)));
+    for (auto node = priv->splits; node; node = node->next)
+    {
+        auto s = static_cast<Split*>(node->data);
+        balances.push_back (xaccSplitGetBalance (s));
+        cleared.push_back (xaccSplitGetClearedBalance (s));
+        reconciled.push_back (xaccSplitGetReconciledBalance (s));
+    }
+    priv->balance_dirty = TRUE;
+    priv->balance_dirty_from = 0;
+    xaccAccountRecomputeBalance (fixture->acct);
+    size_t i = 0;
+    for (auto node = priv->splits; node; node = node->next, ++i)
+    {
+        auto s = static_cast<Split*>(node->data);
+        g_assert (gnc_numeric_eq (balances[i], xaccSplitGetBalance (s)));
+        g_assert (gnc_numeric_eq (cleared[i], xaccSplitGetClearedBalance (s)));
+        g_assert (gnc_numeric_eq (reconciled[i],
+                                  xaccSplitGetReconciledBalance (s)));
+    }
+    g_assert_cmpuint (i, ==, n_splits);
+}
+
+static void
+test_xaccAccountRecomputeBalance_resort (Fixture *fixture, gconstpointer pData)
+{
+    AccountPrivate *priv = fixture->func->get_private (fixture->acct);
+    auto split = static_cast<Split*>(g_list_last (priv->splits)->data);
+    auto first = static_cast<Split*>(priv->splits->data);
+    auto txn = xaccSplitGetParent (split);
+    auto total = gnc_numeric_zero ();
+    Split *prev = NULL;
+
+    priv->balance_dirty = TRUE;
+    xaccAccountRecomputeBalance (fixture->acct);
+    /* Move the last split before the first and change its amount; the
+     * split is queued for an incremental resort. */
+    xaccTransBeginEdit (txn);
+    xaccTransSetDatePostedSecs (txn, xaccTransGetDate (xaccSplitGetParent (first))
+                                - 86400);
+    xaccSplitSetAmount (split, gnc_numeric_neg (xaccSplitGetAmount (split)));
+    qof_commit_edit (QOF_INSTANCE (txn));
+    /* A full sort is requested before the balances are brought up to
+     * date, which has to recompute all of them. */
+    gnc_account_set_sort_dirty (fixture->acct);
+    xaccAccountRecomputeBalance (fixture->acct);
+    for (auto node = priv->splits; node; node = node->next)
+        total = gnc_numeric_add_fixed (total, xaccSplitGetAmount (
+                                           static_cast<Split*>(node->data)));
+    g_assert (gnc_numeric_eq (xaccAccountGetBalance (fixture->acct), total));
+
+    xaccAccountSortSplits (fixture->acct, TRUE);
+    xaccAccountRecomputeBalance (fixture->acct);
+    total = gnc_numeric_zero ();
+    for (auto node = priv->splits; node; node = node->next)
+    {
+        auto s = static_cast<Split*>(node->data);
+        if (prev)
+            g_assert_cmpint (xaccSplitOrder (prev, s), <=, 0);
+        total = gnc_numeric_add_fixed (total, xaccSplitGetAmount (s));
+        g_assert (gnc_numeric_eq (total, xaccSplitGetBalance (s)));
+        prev = s;
+    }
+}
+
+static void
+check_split_order (Account *acct)
+{
+    Split *prev = NULL;
+    auto total = gnc_numeric_zero ();
+
+    for (auto node = xaccAccountGetSplitList (acct); node; node = node->next)
+    {
+        auto s = static_cast<Split*>(node->data);
+        if (prev)
+            g_assert_cmpint (xaccSplitOrder (prev, s), <, 0);
+        total = gnc_numeric_add_fixed (total, xaccSplitGetAmount (s));
+        g_assert (gnc_numeric_eq (total, xaccSplitGetBalance (s)));
+        prev = s;
+    }
+}
+
+/* Changes that only touch the transaction or the book, not the split,
+ * still move the split. */
+static void
+test_xaccAccountSortSplits_trans_keys (Fixture *fixture, gconstpointer pData)
+{
+    AccountPrivate *priv = fixture->func->get_private (fixture->acct);
+    auto book = gnc_account_get_book (fixture->acct);
+    time64 date = gnc_time (NULL);
+    Transaction *last_txn = NULL;
+    gchar desc[2] = "b";
+    gint num = 0;
+
+    /* Put all the splits on one day, entered at once, so that the number
+     * and then the description decide their order.  The split actions
+     * number them the other way round. */
+    for (auto node = priv->splits; node; node = node->next)
+    {
+        auto split = static_cast<Split*>(node->data);
+        auto txn = xaccSplitGetParent (split);
+        gchar *str = g_strdup_printf ("%d", ++num);
+
+        xaccTransBeginEdit (txn);
+        xaccTransSetDatePostedSecs (txn, date);
+        xaccTransSetDateEnteredSecs (txn, date);
+        xaccTransSetNum (txn, str);
+        xaccTransSetDescription (txn, desc);
+        xaccTransCommitEdit (txn);
+        g_free (str);
+        str = g_strdup_printf ("%d", 100 - num);
+        xaccSplitSetAction (split, str);
+        g_free (str);
+        desc[0]++;
+        last_txn = txn;
+    }
+    g_assert (last_txn);
+    gnc_account_set_sort_dirty (fixture->acct);
+    check_split_order (fixture->acct);
+
+    /* Give every transaction the same number: now only the description
+     * of the last one changes and it has to go first. */
+    for (auto node = priv->splits; node; node = node->next)
+    {
+        auto txn = xaccSplitGetParent (static_cast<Split*>(node->data));
+        xaccTransBeginEdit (txn);
+        xaccTransSetNum (txn, "1");
+        xaccTransCommitEdit (txn);
+    }
+    check_split_order (fixture->acct);
+    xaccTransBeginEdit (last_txn);
+    xaccTransSetDescription (last_txn, "a");
+    xaccTransCommitEdit (last_txn);
+    check_split_order (fixture->acct);
+    g_assert (xaccSplitGetParent (static_cast<Split*>(
+                  xaccAccountGetSplitList (fixture->acct)->data)) == last_txn);
+
+    /* Numbering by split action reverses the order without any change
+     * to the splits. */
+    qof_instance_set (QOF_INSTANCE (book), "split-action-num-field", "t",
+                      NULL);
+    check_split_order (fixture->acct);
+    qof_instance_set (QOF_INSTANCE (book), "split-action-num-field", "f",
+                      NULL);
+    check_split_order (fixture->acct);
+}
+
 /* xaccAccountOrder
 int
 xaccAccountOrder (const Account *aa, const Account *ab)// C: 11 in 3 */
@@ -1932,6 +2113,31 @@ test_xaccAccountGetBalanceAsOfDate (Fixture *fixture, gconstpointer pData)
     dval = gnc_numeric_to_double (val);
     g_assert_cmpfloat (dval, == , dbal);
 }
+/* xaccAccountGetBalancesAsOfDates
+void
+xaccAccountGetBalancesAsOfDates (Account *acc, const time64 *dates,
+                                 gsize n_dates, gnc_numeric *balances)*/
+static void
+test_xaccAccountGetBalancesAsOfDates (Fixture *fixture, gconstpointer pData)
+{
+    const time64 day = 24 * 3600;
+    time64 now = gnc_time (NULL);
+    time64 dates[] = { now, now - 3 * day, now - 1000 * day, now + 1000 * day,
+                       now - day };
+    const gsize n_dates = G_N_ELEMENTS (dates);
+    gnc_numeric balances[G_N_ELEMENTS (dates)];
+
+    xaccAccountGetBalancesAsOfDates (fixture->acct, dates, n_dates, balances);
+    for (gsize i = 0; i < n_dates; i++)
+        g_assert (gnc_numeric_equal (balances[i],
+                                     xaccAccountGetBalanceAsOfDate (fixture->acct,
+                                                                    dates[i])));
+    /* Before all splits the balance is zero, after all of them it's the
+     * account balance. */
+    g_assert (gnc_numeric_zero_p (balances[2]));
+    g_assert (gnc_numeric_equal (balances[3],
+                                 xaccAccountGetBalance (fixture->acct)));
+}
 /* xaccAccountGetPresentBalance
 gnc_numeric
 xaccAccountGetPresentBalance (const Account *acc)// C: 4 in 2 */
@@ -1958,6 +2164,39 @@ test_xaccAccountGetPresentBalance (Fixture *fixture, gconstpointer pData)
     dval = gnc_numeric_to_double (val);
     g_assert_cmpfloat (dval, == , dbal);
 }
+/* gnc_account_set_split_loader
+ * gnc_account_has_split_loader
+ * gnc_account_get_start_balance
+ */
+static void
+count_split_loads (Account *acc, gpointer data)
+{
+    ++*static_cast<int*>(data);
+}
+
+static void
+test_gnc_account_split_loader (Fixture *fixture, gconstpointer pData)
+{
+    int loads = 0;
+    gnc_numeric start = gnc_numeric_create (1500, 100);
+    gint64 n_splits = xaccAccountCountSplits (fixture->acct, FALSE);
+
+    g_assert (!gnc_account_has_split_loader (fixture->acct));
+    gnc_account_set_split_loader (fixture->acct, count_split_loads, &loads);
+    g_assert (gnc_account_has_split_loader (fixture->acct));
+
+    gnc_account_set_start_balance (fixture->acct, start);
+    g_assert (gnc_numeric_equal (gnc_account_get_start_balance (fixture->acct),
+                                 start));
+    xaccAccountGetBalance (fixture->acct);
+    g_assert_cmpint (loads, ==, 0);
+
+    g_assert_cmpint (xaccAccountCountSplits (fixture->acct, FALSE), ==, n_splits);
+    g_assert_cmpint (loads, ==, 1);
+    g_assert (!gnc_account_has_split_loader (fixture->acct));
+    xaccAccountGetSplitList (fixture->acct);
+    g_assert_cmpint (loads, ==, 1);
+}
 /*
  * xaccAccountConvertBalanceToCurrency
  * xaccAccountConvertBalanceToCurrencyAsOfDate are wrappers around
@@ -2560,6 +2799,9 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "gnc account insert & remove split", Fixture, NULL, setup, test_gnc_account_insert_remove_split,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccount Insert and Remove Lot", Fixture, &good_data, setup, test_xaccAccountInsertRemoveLot,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountRecomputeBalance", Fixture, &some_data, setup, test_xaccAccountRecomputeBalance,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountRecomputeBalance Incremental", Fixture, &some_data, setup, test_xaccAccountRecomputeBalance_incremental,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountRecomputeBalance Resort", Fixture, &some_data, setup, test_xaccAccountRecomputeBalance_resort,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountSortSplits Transaction Keys", Fixture, &some_data, setup, test_xaccAccountSortSplits_trans_keys,  teardown );
     GNC_TEST_ADD_FUNC (suitename, "xaccAccountOrder", test_xaccAccountOrder );
     GNC_TEST_ADD (suitename, "qofAccountSetParent", Fixture, &some_data, setup, test_qofAccountSetParent,  teardown );
     GNC_TEST_ADD (suitename, "gnc account append/remove child", Fixture, NULL, setup, test_gnc_account_append_remove_child,  teardown );
@@ -2578,7 +2820,9 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "gnc account get full name", Fixture, &good_data, setup, test_gnc_account_get_full_name,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetProjectedMinimumBalance", Fixture, &some_data, setup, test_xaccAccountGetProjectedMinimumBalance,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetBalanceAsOfDate", Fixture, &some_data, setup, test_xaccAccountGetBalanceAsOfDate,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountGetBalancesAsOfDates", Fixture, &some_data, setup, test_xaccAccountGetBalancesAsOfDates,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetPresentBalance", Fixture, &some_data, setup, test_xaccAccountGetPresentBalance,  teardown );
+    GNC_TEST_ADD (suitename, "gnc account split loader", Fixture, &some_data, setup, test_gnc_account_split_loader,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountFindOpenLots", Fixture, &complex_data, setup, test_xaccAccountFindOpenLots,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountForEachLot", Fixture, &complex_data, setup, test_xaccAccountForEachLot,  teardown );
 
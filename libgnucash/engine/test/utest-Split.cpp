@@ -588,11 +588,13 @@ test_xaccSplitCommitEdit (Fixture *fixture, gconstpointer pData)
 
     xaccSplitCommitEdit (fixture->split);
 
+    /* The split was inserted into the account, so it was put in order
+     * directly instead of marking the whole account for a resort. */
     g_object_get (fixture->split->acc,
                   "sort-dirty", &sort_dirty,
                   "balance-dirty", &balance_dirty,
                   NULL);
-    g_assert_cmpint (sort_dirty, ==, TRUE);
+    g_assert_cmpint (sort_dirty, ==, FALSE);
     g_assert_cmpint (balance_dirty, ==, FALSE);
     g_assert (qof_instance_is_dirty (QOF_INSTANCE (fixture->split->parent)));
     g_assert (qof_instance_is_dirty (QOF_INSTANCE (fixture->split)));
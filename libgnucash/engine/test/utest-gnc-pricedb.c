@@ -1129,11 +1129,64 @@ test_gnc_pricedb_lookup_nearest_in_time64 (PriceDBFixture *fixture, gconstpointe
     g_assert_cmpstr(GET_CUR_NAME(price), ==, "AUD");
     g_assert_cmpstr(GET_COM_NAME(price), ==, "USD");
 }
-// Not Used
 /* gnc_pricedb_lookup_latest_before_t64
 GNCPrice *
 gnc_pricedb_lookup_latest_before_t64 (GNCPriceDB *db,// Local: 0:0:0
 */
+static void
+test_gnc_pricedb_lookup_latest_before_t64 (PriceDBFixture *fixture, gconstpointer pData)
+{
+    time64 t1 = gnc_dmy2time64(31, 7, 2013);
+    time64 t2 = gnc_dmy2time64(1, 8, 2013);
+    GNCPrice *price =
+        gnc_pricedb_lookup_latest_before_t64(fixture->pricedb,
+                                             fixture->com->usd,
+                                             fixture->com->aud, t1);
+    g_assert_cmpstr(GET_COM_NAME(price), ==, "AUD");
+    g_assert_cmpstr(GET_CUR_NAME(price), ==, "USD");
+    g_assert_cmpint(gnc_price_get_time64(price), ==,
+                    gnc_dmy2time64(17, 11, 2012));
+    gnc_price_unref(price);
+    price = gnc_pricedb_lookup_latest_before_t64(fixture->pricedb,
+                                                 fixture->com->usd,
+                                                 fixture->com->aud, t2);
+    g_assert_cmpstr(GET_COM_NAME(price), ==, "USD");
+    g_assert_cmpint(gnc_price_get_time64(price), ==, t2);
+    gnc_price_unref(price);
+    price = gnc_pricedb_lookup_at_time64(fixture->pricedb, fixture->com->aud,
+                                         fixture->com->usd, t2);
+    g_assert_cmpstr(GET_COM_NAME(price), ==, "USD");
+    gnc_price_unref(price);
+    g_assert(gnc_pricedb_lookup_at_time64(fixture->pricedb, fixture->com->aud,
+                                          fixture->com->usd, t1) == NULL);
+    g_assert(gnc_pricedb_lookup_latest_before_t64(fixture->pricedb,
+                                                  fixture->com->usd,
+                                                  fixture->com->aud,
+                                                  gnc_dmy2time64(1, 1, 2009))
+             == NULL);
+}
+
+static void
+test_gnc_pricedb_add_price_same_day (PriceDBFixture *fixture, gconstpointer pData)
+{
+    GNCPriceDB *db = fixture->pricedb;
+    QofBook *book = qof_instance_get_book(QOF_INSTANCE(db));
+    Commodities *c = fixture->com;
+    time64 t = gnc_dmy2time64(1, 8, 2013) + 3600;
+    PriceList *prices;
+    GNCPrice *price;
+
+    gnc_pricedb_add_price(db, construct_price(book, c->usd, c->aud, t,
+                                              PRICE_SOURCE_FQ,
+                                           gnc_numeric_create(111878, 100000)));
+    prices = gnc_pricedb_get_prices(db, c->usd, c->aud);
+    g_assert_cmpint(g_list_length(prices), ==, 5);
+    gnc_price_list_destroy(prices);
+    price = gnc_pricedb_lookup_day_t64(db, c->usd, c->aud, t);
+    g_assert_cmpint(gnc_price_get_time64(price), ==, t);
+    gnc_price_unref(price);
+    g_assert_cmpint(gnc_pricedb_num_prices(db, c->usd), ==, 11);
+}
 /* direct_balance_conversion
 static gnc_numeric
 direct_balance_conversion (GNCPriceDB *db, gnc_numeric bal,// Local: 2:0:0
@@ -1248,6 +1301,74 @@ test_gnc_pricedb_convert_balance_nearest_price_t64 (PriceDBFixture *fixture, gco
     g_assert_cmpint(result.denom, ==, 100);
 
 }
+
+static void
+test_gnc_pricedb_convert_balance_cache (PriceDBFixture *fixture, gconstpointer pData)
+{
+    GNCPriceDB *db = fixture->pricedb;
+    QofBook *book = qof_instance_get_book(QOF_INSTANCE(db));
+    Commodities *c = fixture->com;
+    gnc_numeric from = gnc_numeric_create(10000, 100);
+    gnc_numeric result =
+        gnc_pricedb_convert_balance_latest_price(db, from, c->usd, c->aud);
+    g_assert_cmpint(result.num, ==, 11478);
+    result = gnc_pricedb_convert_balance_latest_price(db, from, c->usd, c->aud);
+    g_assert_cmpint(result.num, ==, 11478);
+    g_assert_cmpint(gnc_pricedb_get_conversion_cache_misses(db), ==, 1);
+    g_assert_cmpint(gnc_pricedb_get_conversion_cache_hits(db), ==, 1);
+
+    /* No price connects BGN to anything yet. */
+    result = gnc_pricedb_convert_balance_latest_price(db, from, c->bgn, c->aud);
+    g_assert(gnc_numeric_zero_p(result));
+    g_assert_cmpint(gnc_pricedb_get_conversion_cache_misses(db), ==, 2);
+
+    /* Adding a price flushes the cache, and BGN->EUR->GBP->USD->AUD is
+     * longer than the two-stage conversion can find. */
+    gnc_pricedb_add_price(db, construct_price(book, c->bgn, c->eur,
+                                              gnc_dmy2time64(12, 11, 2014),
+                                              PRICE_SOURCE_FQ,
+                                              gnc_numeric_create(5113, 10000)));
+    result = gnc_pricedb_convert_balance_latest_price(db, from, c->bgn, c->aud);
+    g_assert_cmpint(result.num, ==, 7295);
+    g_assert_cmpint(result.denom, ==, 100);
+    g_assert_cmpint(gnc_pricedb_get_conversion_cache_misses(db), ==, 3);
+    result = gnc_pricedb_convert_balance_latest_price(db, from, c->usd, c->aud);
+    g_assert_cmpint(gnc_pricedb_get_conversion_cache_misses(db), ==, 4);
+    g_assert_cmpint(gnc_pricedb_get_conversion_cache_hits(db), ==, 1);
+}
+
+static void
+test_gnc_pricedb_convert_balance_cache_limit (PriceDBFixture *fixture, gconstpointer pData)
+{
+    GNCPriceDB *db = fixture->pricedb;
+    Commodities *c = fixture->com;
+    gnc_numeric from = gnc_numeric_create(10000, 100);
+    time64 t = gnc_dmy2time64(15, 8, 2011);
+    int i;
+
+    /* One more conversion time than the cache holds pushes out the
+     * first one. */
+    for (i = 0; i <= CONVERSION_CACHE_SIZE; ++i)
+        gnc_pricedb_convert_balance_nearest_price_t64(db, from, c->usd,
+                                                      c->aud, t + i);
+    g_assert_cmpint(gnc_pricedb_get_conversion_cache_misses(db), ==,
+                    CONVERSION_CACHE_SIZE + 1);
+    g_assert_cmpint(g_hash_table_size(db->conversion_cache), ==,
+                    CONVERSION_CACHE_SIZE);
+
+    /* Using an entry keeps it; the first time was dropped. */
+    gnc_pricedb_convert_balance_nearest_price_t64(db, from, c->usd, c->aud,
+                                                  t + 1);
+    g_assert_cmpint(gnc_pricedb_get_conversion_cache_hits(db), ==, 1);
+    gnc_pricedb_convert_balance_nearest_price_t64(db, from, c->usd, c->aud, t);
+    g_assert_cmpint(gnc_pricedb_get_conversion_cache_misses(db), ==,
+                    CONVERSION_CACHE_SIZE + 2);
+    gnc_pricedb_convert_balance_nearest_price_t64(db, from, c->usd, c->aud,
+                                                  t + 1);
+    g_assert_cmpint(gnc_pricedb_get_conversion_cache_hits(db), ==, 2);
+    g_assert_cmpint(g_hash_table_size(db->conversion_cache), ==,
+                    CONVERSION_CACHE_SIZE);
+}
 /* pricedb_foreach_pricelist
 static void
 pricedb_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)// Local: 0:1:0
@@ -1498,12 +1619,16 @@ test_suite_gnc_pricedb (void)
     GNC_TEST_ADD (suitename, "gnc pricedb lookup day", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_day_t64, teardown);
 // GNC_TEST_ADD (suitename, "lookup nearest in time", Fixture, NULL, setup, test_lookup_nearest_in_time, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb lookup nearest in time", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_nearest_in_time64, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb lookup latest before", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_latest_before_t64, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb add price same day", PriceDBFixture, NULL, setup, test_gnc_pricedb_add_price_same_day, teardown);
 // GNC_TEST_ADD (suitename, "direct balance conversion", Fixture, NULL, setup, test_direct_balance_conversion, teardown);
 // GNC_TEST_ADD (suitename, "extract common prices", Fixture, NULL, setup, test_extract_common_prices, teardown);
 // GNC_TEST_ADD (suitename, "convert balance", Fixture, NULL, setup, test_convert_balance, teardown);
 // GNC_TEST_ADD (suitename, "indirect balance conversion", Fixture, NULL, setup, test_indirect_balance_conversion, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb convert balance latest price", PriceDBFixture, NULL, setup, test_gnc_pricedb_convert_balance_latest_price, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb convert balance nearest price", PriceDBFixture, NULL, setup, test_gnc_pricedb_convert_balance_nearest_price_t64, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb convert balance cache", PriceDBFixture, NULL, setup, test_gnc_pricedb_convert_balance_cache, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb convert balance cache limit", PriceDBFixture, NULL, setup, test_gnc_pricedb_convert_balance_cache_limit, teardown);
 // GNC_TEST_ADD (suitename, "pricedb foreach pricelist", Fixture, NULL, setup, test_pricedb_foreach_pricelist, teardown);
 // GNC_TEST_ADD (suitename, "pricedb foreach currencies hash", Fixture, NULL, setup, test_pricedb_foreach_currencies_hash, teardown);
 // GNC_TEST_ADD (suitename, "unstable price traversal", Fixture, NULL, setup, test_unstable_price_traversal, teardown);